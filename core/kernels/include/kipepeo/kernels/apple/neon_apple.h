@@ -2,6 +2,7 @@
 
 #include <cstddef>
 #include <cstdint>
+#include "kipepeo/kernels/types.h"
 
 namespace kipepeo {
 namespace kernels {
@@ -22,7 +23,7 @@ void apple_neon_matrix_multiply_f32(const float* A, const float* B, float* C,
                                     size_t M, size_t N, size_t K);
 
 // FP16 matrix multiplication with native FP16 support
-void apple_neon_matrix_multiply_f16(const __fp16* A, const __fp16* B, __fp16* C,
+void apple_neon_matrix_multiply_f16(const fp16_t* A, const fp16_t* B, fp16_t* C,
                                     size_t M, size_t N, size_t K);
 
 // Quantized GEMM for 1.28-bit (ternary)
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace kipepeo {
+namespace kernels {
+
+/**
+ * Operations the dispatcher can tune (see kernel_dispatch.h)
+ */
+enum class TunedOp : uint32_t {
+    GEMV_TERNARY = 0,       // gemv_ternary_1_28bit_chip_optimized
+    GEMV_QUATERNARY = 1,    // gemv_quaternary_1_58bit_chip_optimized
+    GEMV_TERNARY_A8 = 2,    // gemv_ternary_1_28bit_a8_chip_optimized
+    GEMV_QUATERNARY_A8 = 3, // gemv_quaternary_1_58bit_a8_chip_optimized
+    GEMM_TERNARY = 4,       // gemm_ternary_1_28bit_chip_optimized
+    GEMM_QUATERNARY = 5,    // gemm_quaternary_1_58bit_chip_optimized
+    MATMUL_F32 = 6,         // matrix_multiply_f32_chip_optimized
+    GEMV_TERNARY_INTERLEAVED = 7,    // gemv_ternary_1_28bit_interleaved*_chip_optimized
+    GEMV_QUATERNARY_INTERLEAVED = 8, // gemv_quaternary_1_58bit_interleaved*_chip_optimized
+};
+
+/**
+ * One problem shape; N is 1 for GEMVs, block_size 0 for FP32
+ */
+struct TuneKey {
+    TunedOp op;
+    uint32_t M;
+    uint32_t N;
+    uint32_t K;
+    uint32_t block_size;
+
+    bool operator==(const TuneKey& other) const {
+        return op == other.op && M == other.M && N == other.N &&
+               K == other.K && block_size == other.block_size;
+    }
+};
+
+/**
+ * Kernel choice for one shape. Zero fields keep the dispatcher's default,
+ * so KernelConfig{} is exactly the untuned behaviour.
+ */
+struct KernelConfig {
+    uint32_t variant;   // KERNEL_VARIANT_CHIP or KERNEL_VARIANT_GENERIC
+    uint32_t MR;        // Register tile rows (GEMMs)
+    uint32_t NR;        // Register tile columns (GEMMs)
+    uint32_t KC;        // Depth block of the FP32 GEMM
+    uint32_t grain;     // Range granularity of the thread pool split
+};
+
+constexpr uint32_t KERNEL_VARIANT_CHIP = 0;      // Chip-specific kernel (ChipType)
+constexpr uint32_t KERNEL_VARIANT_GENERIC = 1;   // Generic neon:: kernel
+
+/**
+ * KernelAutotuner - per-shape kernel choices, measured on this device
+ *
+ * The first call of a shape benchmarks every candidate configuration
+ * (into scratch outputs) and keeps the fastest; later calls find it with
+ * one hash lookup. Results are saved to a small text file whose header
+ * holds the CPU signature (get_cpu_signature), so a cache copied from
+ * another device, or left over from an older library, is ignored and
+ * retuned rather than trusted.
+ *
+ * Tuning is off until enabled, either by set_cache_path / set_enabled or
+ * by the KIPEPEO_AUTOTUNE_CACHE environment variable naming the cache
+ * file. Lookups of saved results work either way.
+ */
+class KernelAutotuner {
+public:
+    KernelAutotuner();
+    ~KernelAutotuner();
+
+    KernelAutotuner(const KernelAutotuner&) = delete;
+    KernelAutotuner& operator=(const KernelAutotuner&) = delete;
+
+    /**
+     * Load the results for this CPU from path and save new ones there;
+     * enables tuning. A missing file is created on the first result.
+     * @return false if the file exists but cannot be read
+     */
+    bool set_cache_path(const std::string& path);
+
+    void set_enabled(bool enabled);
+    bool enabled() const;
+
+    /**
+     * O(1) lookup of a tuned shape
+     * @return false if the shape has not been tuned
+     */
+    bool lookup(const TuneKey& key, KernelConfig& config) const;
+
+    /**
+     * Benchmark the candidates and keep the fastest
+     * @param candidates Configurations to time; candidates[0] should be
+     *                   the default (KernelConfig{})
+     * @param run Runs the op once with a configuration, writing to scratch
+     *            outputs so the caller's buffers are untouched
+     * @return The chosen configuration (candidates[0] if tuning is off)
+     */
+    KernelConfig tune(const TuneKey& key, const std::vector<KernelConfig>& candidates,
+                      const std::function<void(const KernelConfig&)>& run);
+
+    /**
+     * Drop all results (the cache file is rewritten on the next result)
+     */
+    void clear();
+
+    size_t size() const;
+
+private:
+    class Impl;
+    Impl* impl_;
+};
+
+/**
+ * Process-wide tuner consulted by the *_chip_optimized kernels
+ */
+KernelAutotuner& get_kernel_autotuner();
+
+/**
+ * Identifies the CPU a tuning result is valid for: chip, core models and
+ * capacities, cache sizes and the x86 level, hashed to 16 hex digits
+ */
+std::string get_cpu_signature();
+
+} // namespace kernels
+} // namespace kipepeo
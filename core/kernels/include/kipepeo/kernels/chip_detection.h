@@ -2,6 +2,7 @@
 
 #include <cstdint>
 #include <cstddef>
+#include <vector>
 
 namespace kipepeo {
 namespace kernels {
@@ -67,6 +68,60 @@ bool chip_supports_fp16(ChipType chip);
  */
 void get_optimal_block_size(ChipType chip, bool is_big_core, size_t& MR, size_t& NR);
 
+/**
+ * CPU cluster layout of a chip
+ * On the supported Android SoCs the little cores are numbered first
+ * (cpu0 .. little_cores - 1) and the big cores follow.
+ */
+struct CoreLayout {
+    size_t big_cores;
+    size_t little_cores;
+    float big_core_speed;   // GEMV throughput of a big core relative to a little one
+};
+
+/**
+ * Get the core layout of a chip
+ * @param chip The chip type
+ * @return Cluster sizes; UNKNOWN reports no cores, callers then treat all
+ *         std::thread::hardware_concurrency() cores as equal
+ */
+CoreLayout get_chip_core_layout(ChipType chip);
+
+/**
+ * One logical CPU and its relative compute capacity
+ */
+struct CpuCore {
+    int cpu;
+    uint32_t capacity;   // 1024 = fastest core (sysfs cpu_capacity scale)
+};
+
+/**
+ * Read the CPU cluster topology from sysfs
+ * Uses /sys/devices/system/cpu/cpuN/cpu_capacity (arm64 Linux/Android
+ * kernels with energy-aware scheduling). Cores missing it fall back to
+ * the chip's CoreLayout, then to cpufreq/cpuinfo_max_freq scaled to 1024.
+ * @return One entry per online CPU, empty when nothing can be read
+ *         (Apple, most VMs)
+ */
+std::vector<CpuCore> read_cpu_topology();
+
+/**
+ * Data cache sizes of one core, in bytes
+ */
+struct CacheSizes {
+    size_t l1_data;
+    size_t l2;
+    size_t l3;   // 0 if not available
+};
+
+/**
+ * Read the cache sizes of the fastest core
+ * Uses /sys/devices/system/cpu/cpuN/cache on Linux/Android and sysctl on
+ * Apple platforms. Levels that cannot be read keep the conservative
+ * defaults of the low-end targets: 32KB L1, 256KB L2, no L3.
+ */
+CacheSizes read_cache_sizes();
+
 } // namespace kernels
 } // namespace kipepeo
 
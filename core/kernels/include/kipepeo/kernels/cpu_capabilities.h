@@ -0,0 +1,57 @@
+#pragma once
+
+#include "kipepeo/kernels/chip_detection.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace kipepeo {
+namespace kernels {
+
+/**
+ * Everything the kernels and quantizers need to know about the CPU,
+ * probed once per process
+ */
+struct CpuCapabilities {
+    ChipType chip;                 // detect_chip()
+
+    // Instruction sets usable by this build on this CPU
+    bool has_neon;                 // NEON kernels compiled in (KIPEPEO_NEON_ENABLED)
+    bool has_fp16;                 // Native FP16 arithmetic (HWCAP / sysctl, else chip table)
+    bool has_dotprod;              // ARMv8.2-A sdot / udot
+    bool has_avx2;                 // x86 kernels at AVX2 or above (x86::get_x86_level)
+    bool has_avx512;               // x86 kernels at AVX-512 VNNI
+
+    CacheSizes caches;             // read_cache_sizes()
+
+    // Core clusters
+    std::vector<CpuCore> cores;    // read_cpu_topology(); empty if unknown
+    size_t big_cores;              // Cores at the highest capacity
+    size_t little_cores;           // All other cores
+    uint32_t cpu_count;            // Online CPUs
+
+    // Memory, in bytes (0 if unknown)
+    size_t total_memory;
+    size_t available_memory;       // Free memory at the first call, not refreshed
+
+    std::string cpu_model;         // "Hardware" / "model name" line of /proc/cpuinfo
+};
+
+/**
+ * Process-wide capability registry
+ * The first call probes /proc/cpuinfo, sysfs, sysctl and the auxiliary
+ * vector under std::call_once; every later call, from any thread, returns
+ * the same object without touching the file system.
+ */
+const CpuCapabilities& get_cpu_capabilities();
+
+/**
+ * Free memory in bytes right now (sysinfo on Linux / Android, 0 elsewhere)
+ * CpuCapabilities::available_memory is this value at the first probe; call
+ * this instead wherever a decision should track the current headroom.
+ */
+size_t get_available_memory();
+
+} // namespace kernels
+} // namespace kipepeo
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+namespace kipepeo {
+namespace kernels {
+
+/**
+ * Portable IEEE 754 half-precision conversion helpers
+ * Half values are carried as raw uint16_t bit patterns so the same code
+ * builds on compilers/targets without a native __fp16 type.
+ */
+
+/**
+ * Convert float to half (round to nearest even)
+ * Values beyond the half range become +/-inf, tiny values flush through
+ * subnormals to +/-0.
+ */
+inline uint16_t fp32_to_fp16(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+
+    uint32_t sign = (bits >> 16) & 0x8000u;
+    uint32_t mantissa = bits & 0x7FFFFFu;
+    uint32_t raw_exp = (bits >> 23) & 0xFFu;
+
+    if (raw_exp == 0xFFu) {
+        // Inf or NaN (keep NaN quiet)
+        return static_cast<uint16_t>(sign | 0x7C00u | (mantissa ? 0x200u : 0u));
+    }
+
+    int32_t exp = static_cast<int32_t>(raw_exp) - 127 + 15;
+    if (exp >= 0x1F) {
+        return static_cast<uint16_t>(sign | 0x7C00u);  // Overflow to inf
+    }
+
+    if (exp <= 0) {
+        // Subnormal half (or zero)
+        if (exp < -10) {
+            return static_cast<uint16_t>(sign);
+        }
+        mantissa |= 0x800000u;
+        uint32_t shift = static_cast<uint32_t>(14 - exp);
+        uint32_t half = mantissa >> shift;
+        uint32_t remainder = mantissa & ((1u << shift) - 1);
+        uint32_t halfway = 1u << (shift - 1);
+        if (remainder > halfway || (remainder == halfway && (half & 1u))) {
+            ++half;
+        }
+        return static_cast<uint16_t>(sign | half);
+    }
+
+    uint32_t half = sign | (static_cast<uint32_t>(exp) << 10) | (mantissa >> 13);
+    uint32_t remainder = mantissa & 0x1FFFu;
+    if (remainder > 0x1000u || (remainder == 0x1000u && (half & 1u))) {
+        ++half;  // Carry into the exponent is the correct rounding
+    }
+    return static_cast<uint16_t>(half);
+}
+
+/**
+ * Convert half to float (exact)
+ */
+inline float fp16_to_fp32(uint16_t value) {
+    uint32_t sign = static_cast<uint32_t>(value & 0x8000u) << 16;
+    uint32_t exp = (value >> 10) & 0x1Fu;
+    uint32_t mantissa = value & 0x3FFu;
+    uint32_t bits;
+
+    if (exp == 0) {
+        if (mantissa == 0) {
+            bits = sign;
+        } else {
+            // Normalize subnormal half
+            exp = 127 - 15 + 1;
+            while (!(mantissa & 0x400u)) {
+                mantissa <<= 1;
+                --exp;
+            }
+            mantissa &= 0x3FFu;
+            bits = sign | (exp << 23) | (mantissa << 13);
+        }
+    } else if (exp == 0x1F) {
+        bits = sign | 0x7F800000u | (mantissa << 13);
+    } else {
+        bits = sign | ((exp + 127 - 15) << 23) | (mantissa << 13);
+    }
+
+    float result;
+    std::memcpy(&result, &bits, sizeof(result));
+    return result;
+}
+
+} // namespace kernels
+} // namespace kipepeo
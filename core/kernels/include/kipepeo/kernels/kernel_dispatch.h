@@ -1,6 +1,7 @@
 #pragma once
 
 #include "kipepeo/kernels/chip_detection.h"
+#include "kipepeo/kernels/types.h"
 #include <cstddef>
 #include <cstdint>
 
@@ -11,13 +12,24 @@ namespace kernels {
  * Unified kernel dispatch system
  * Automatically selects chip-specific kernels at runtime
  * Falls back to generic NEON if chip-specific kernel not available
+ *
+ * Every *_chip_optimized call is split across the kernel thread pool
+ * (see thread_pool.h, set_kernel_num_threads); small problems run on the
+ * calling thread alone.
+ *
+ * The FP32 matmul, fp32 / int8-activation / interleaved GEMVs and quantized GEMMs consult the kernel autotuner
+ * (autotuner.h) for their shape: tuned shapes use the measured fastest
+ * variant, tile and split granularity, others the defaults below.
+ *
+ * The GEMVs also consume the calling thread's layer-ahead prefetch
+ * (weight_prefetch.h, prefetch_next_weights) and warm it while they run.
  */
 
-// Matrix multiplication dispatch
+// Matrix multiplication dispatch (FP32: packed-panel GEMM, neon/packed_gemm.h)
 void matrix_multiply_f32_chip_optimized(const float* A, const float* B, float* C,
                                         size_t M, size_t N, size_t K);
 
-void matrix_multiply_f16_chip_optimized(const __fp16* A, const __fp16* B, __fp16* C,
+void matrix_multiply_f16_chip_optimized(const fp16_t* A, const fp16_t* B, fp16_t* C,
                                         size_t M, size_t N, size_t K);
 
 // Quantized GEMM dispatch
@@ -31,6 +43,126 @@ void gemv_quaternary_1_58bit_chip_optimized(
     const uint8_t* A_quantized, const float* A_scales,
     const float* X, float beta, float* Y, size_t block_size = 128);
 
+// Row-interleaved GEMV dispatch: A and its scales in the layout of
+// neon::repack_2bit_interleaved / repack_scales_interleaved with panels of
+// rows_per_group rows (normally get_gemv_interleave_rows()). Threads take
+// whole panels; outlier slots keep their row-major layout.
+void gemv_ternary_1_28bit_interleaved_chip_optimized(
+    size_t M, size_t K, float alpha,
+    const uint8_t* A_interleaved, const float* A_scales,
+    const float* X, float beta, float* Y, size_t block_size = 128,
+    size_t rows_per_group = 4,
+    const OutlierEntry* outliers = nullptr, size_t outliers_per_block = 0);
+
+void gemv_ternary_1_28bit_interleaved_f16_scales_chip_optimized(
+    size_t M, size_t K, float alpha,
+    const uint8_t* A_interleaved, const uint16_t* A_scales,
+    const float* X, float beta, float* Y, size_t block_size = 128,
+    size_t rows_per_group = 4,
+    const OutlierEntry* outliers = nullptr, size_t outliers_per_block = 0);
+
+void gemv_quaternary_1_58bit_interleaved_chip_optimized(
+    size_t M, size_t K, float alpha,
+    const uint8_t* A_interleaved, const float* A_scales,
+    const float* X, float beta, float* Y, size_t block_size = 128,
+    size_t rows_per_group = 4,
+    const OutlierEntry* outliers = nullptr, size_t outliers_per_block = 0);
+
+void gemv_quaternary_1_58bit_interleaved_f16_scales_chip_optimized(
+    size_t M, size_t K, float alpha,
+    const uint8_t* A_interleaved, const uint16_t* A_scales,
+    const float* X, float beta, float* Y, size_t block_size = 128,
+    size_t rows_per_group = 4,
+    const OutlierEntry* outliers = nullptr, size_t outliers_per_block = 0);
+
+// Int8-activation (W1.58A8) GEMV dispatch
+// X_q / X_scales come from neon::quantize_activations_int8
+void gemv_ternary_1_28bit_a8_chip_optimized(
+    size_t M, size_t K, float alpha,
+    const uint8_t* A_quantized, const float* A_scales,
+    const int8_t* X_q, const float* X_scales,
+    float beta, float* Y, size_t block_size = 128);
+
+void gemv_quaternary_1_58bit_a8_chip_optimized(
+    size_t M, size_t K, float alpha,
+    const uint8_t* A_quantized, const float* A_scales,
+    const int8_t* X_q, const float* X_scales,
+    float beta, float* Y, size_t block_size = 128);
+
+// Fused transformer-block GEMV dispatch (see neon/fused_gemv.h)
+// RMSNorm -> GEMV: returns the inverse RMS; X_weighted is K floats of scratch
+float rms_norm_gemv_ternary_1_28bit_chip_optimized(
+    size_t M, size_t K,
+    const uint8_t* A_quantized, const float* A_scales,
+    const float* X, const float* norm_weight, float eps,
+    float* X_weighted, float beta, float* Y, size_t block_size = 128);
+
+float rms_norm_gemv_quaternary_1_58bit_chip_optimized(
+    size_t M, size_t K,
+    const uint8_t* A_quantized, const float* A_scales,
+    const float* X, const float* norm_weight, float eps,
+    float* X_weighted, float beta, float* Y, size_t block_size = 128);
+
+// FFN gate / up pair -> SiLU-gated product
+void gemv_silu_gate_ternary_1_28bit_chip_optimized(
+    size_t M, size_t K, float alpha,
+    const uint8_t* A_gate, const float* gate_scales,
+    const uint8_t* A_up, const float* up_scales,
+    const float* X, float* Y, size_t block_size = 128);
+
+void gemv_silu_gate_quaternary_1_58bit_chip_optimized(
+    size_t M, size_t K, float alpha,
+    const uint8_t* A_gate, const float* gate_scales,
+    const uint8_t* A_up, const float* up_scales,
+    const float* X, float* Y, size_t block_size = 128);
+
+// GEMV -> residual add (residual may alias Y)
+void gemv_residual_ternary_1_28bit_chip_optimized(
+    size_t M, size_t K, float alpha,
+    const uint8_t* A_quantized, const float* A_scales,
+    const float* X, const float* residual, float* Y, size_t block_size = 128);
+
+void gemv_residual_quaternary_1_58bit_chip_optimized(
+    size_t M, size_t K, float alpha,
+    const uint8_t* A_quantized, const float* A_scales,
+    const float* X, const float* residual, float* Y, size_t block_size = 128);
+
+// Half-precision activation GEMV dispatch: fp16 X, Y and block scales
+// (bit patterns, see fp16.h), neon::gemv_*_f16 on KIPEPEO_ARM_FP16 builds
+void gemv_ternary_1_28bit_f16_chip_optimized(
+    size_t M, size_t K, float alpha,
+    const uint8_t* A_quantized, const uint16_t* A_scales,
+    const uint16_t* X, float beta, uint16_t* Y, size_t block_size = 128);
+
+void gemv_quaternary_1_58bit_f16_chip_optimized(
+    size_t M, size_t K, float alpha,
+    const uint8_t* A_quantized, const uint16_t* A_scales,
+    const uint16_t* X, float beta, uint16_t* Y, size_t block_size = 128);
+
+// Tiled quantized GEMM dispatch (prompt prefill, X is N x K, Y is N x M)
+// Register tile comes from get_optimal_block_size() for the detected chip
+void gemm_ternary_1_28bit_chip_optimized(
+    size_t M, size_t N, size_t K, float alpha,
+    const uint8_t* A_quantized, const float* A_scales,
+    const float* X, float beta, float* Y, size_t block_size = 128);
+
+void gemm_quaternary_1_58bit_chip_optimized(
+    size_t M, size_t N, size_t K, float alpha,
+    const uint8_t* A_quantized, const float* A_scales,
+    const float* X, float beta, float* Y, size_t block_size = 128);
+
+// MR x NR GEMM register tile for the detected chip and the cluster the
+// calling thread runs on (current_thread_on_big_core)
+void get_quantized_gemm_tile(size_t& MR, size_t& NR);
+
+// Batch range granularity for splitting a quantized GEMM across threads:
+// a multiple of NR on both clusters
+size_t get_quantized_gemm_batch_grain();
+
+// Rows per panel (4 or 8) for the row-interleaved GEMVs
+// (neon::repack_2bit_interleaved) on the detected CPU
+size_t get_gemv_interleave_rows();
+
 } // namespace kernels
 } // namespace kipepeo
 
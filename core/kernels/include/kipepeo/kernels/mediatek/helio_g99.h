@@ -2,6 +2,7 @@
 
 #include <cstddef>
 #include <cstdint>
+#include "kipepeo/kernels/types.h"
 
 namespace kipepeo {
 namespace kernels {
@@ -19,7 +20,7 @@ void helio_g99_matrix_multiply_f32(const float* A, const float* B, float* C,
                                    size_t M, size_t N, size_t K);
 
 // FP16 matrix multiplication with native FP16 support
-void helio_g99_matrix_multiply_f16(const __fp16* A, const __fp16* B, __fp16* C,
+void helio_g99_matrix_multiply_f16(const fp16_t* A, const fp16_t* B, fp16_t* C,
                                    size_t M, size_t N, size_t K);
 
 // Quantized GEMM for 1.28-bit (ternary) with dot product optimization
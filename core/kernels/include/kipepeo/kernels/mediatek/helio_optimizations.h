@@ -1,6 +1,7 @@
 #pragma once
 
 #include "kipepeo/kernels/chip_detection.h"
+#include "kipepeo/kernels/types.h"
 #include <cstddef>
 
 namespace kipepeo {
@@ -16,7 +17,7 @@ namespace mediatek {
 void helio_matrix_multiply_f32(const float* A, const float* B, float* C,
                                size_t M, size_t N, size_t K, ChipType chip);
 
-void helio_matrix_multiply_f16(const __fp16* A, const __fp16* B, __fp16* C,
+void helio_matrix_multiply_f16(const fp16_t* A, const fp16_t* B, fp16_t* C,
                                size_t M, size_t N, size_t K, ChipType chip);
 
 // Unified quantized GEMM dispatch
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "kipepeo/kernels/types.h"
+
+namespace kipepeo {
+namespace kernels {
+namespace neon {
+
+/**
+ * Fused transformer-block GEMVs over AfricaQuant weights
+ *
+ * A decode step otherwise runs RMSNorm, the projections, the FFN gate /
+ * up pair, SiLU, the gated product and the residual add as separate
+ * passes, each writing a vector that the next one reads back. These
+ * kernels fold the element-wise work into the GEMVs (quantized_gemm.h):
+ *
+ *   rms_norm_gemv:  the norm computed in the same pass that applies its
+ *                   gain, its scale folded into the GEMV's alpha
+ *   gemv_silu_gate: gate and up rows swept together in tiles of
+ *                   FUSED_ROW_TILE rows over the same X, SiLU and the
+ *                   product applied while the tile sums are in L1; the
+ *                   two ffn_dim-sized intermediates never exist
+ *   gemv_residual:  residual added as the GEMV writes each output row
+ *
+ * Weight layout, fp32 block scales and outlier slots are the same as for
+ * the row-major 2-bit GEMVs. Every row range is independent, so callers
+ * may split rows across threads (see the *_chip_optimized dispatch).
+ */
+
+/**
+ * Rows per fused gate / up tile
+ */
+constexpr size_t FUSED_ROW_TILE = 16;
+
+/**
+ * RMSNorm pre-pass shared by the rms_norm_gemv kernels: in one pass over
+ * X, writes X * norm_weight to X_weighted and returns the inverse RMS
+ * 1 / sqrt(mean(X^2) + eps), so rms_norm(X) * norm_weight equals
+ * X_weighted times the returned value
+ *
+ * @param norm_weight RMSNorm gain (K elements, nullptr for none)
+ * @param X_weighted Output, K elements (may alias X)
+ */
+float rms_norm_weight(size_t K, const float* X, const float* norm_weight, float eps, float* X_weighted);
+
+/**
+ * Y = A * (rms_norm(X) * norm_weight) + beta * Y
+ *
+ * The inverse RMS is a scalar, so it becomes the GEMV's alpha: after
+ * rms_norm_weight the GEMV reads X_weighted straight from L1 and no
+ * normalized copy of X is made.
+ *
+ * @param norm_weight RMSNorm gain (K elements, nullptr for none)
+ * @param eps RMSNorm epsilon (1e-5 or 1e-6 for LLaMA-family models)
+ * @param X_weighted Scratch, K elements; on return holds X * norm_weight,
+ *                   so other projections of the same input (K / V, FFN
+ *                   up) can reuse it with alpha = the returned value
+ * @return Inverse RMS of X
+ */
+float rms_norm_gemv_ternary_1_28bit(
+    size_t M, size_t K,
+    const uint8_t* A_quantized, const float* A_scales,
+    const float* X, const float* norm_weight, float eps,
+    float* X_weighted, float beta, float* Y, size_t block_size = 128,
+    const OutlierEntry* outliers = nullptr, size_t outliers_per_block = 0);
+
+float rms_norm_gemv_quaternary_1_58bit(
+    size_t M, size_t K,
+    const uint8_t* A_quantized, const float* A_scales,
+    const float* X, const float* norm_weight, float eps,
+    float* X_weighted, float beta, float* Y, size_t block_size = 128,
+    const OutlierEntry* outliers = nullptr, size_t outliers_per_block = 0);
+
+/**
+ * SwiGLU FFN input: Y[i] = silu(alpha * (A_gate * X)[i]) * alpha * (A_up * X)[i]
+ * silu(g) = g / (1 + exp(-g)). A_gate and A_up are both M x K with the
+ * same block size; alpha carries an activation scale such as the inverse
+ * RMS returned by rms_norm_gemv.
+ *
+ * @param gate_outliers, up_outliers Outlier slots of each matrix (optional)
+ */
+void gemv_silu_gate_ternary_1_28bit(
+    size_t M, size_t K, float alpha,
+    const uint8_t* A_gate, const float* gate_scales,
+    const uint8_t* A_up, const float* up_scales,
+    const float* X, float* Y, size_t block_size = 128,
+    const OutlierEntry* gate_outliers = nullptr, const OutlierEntry* up_outliers = nullptr,
+    size_t outliers_per_block = 0);
+
+void gemv_silu_gate_quaternary_1_58bit(
+    size_t M, size_t K, float alpha,
+    const uint8_t* A_gate, const float* gate_scales,
+    const uint8_t* A_up, const float* up_scales,
+    const float* X, float* Y, size_t block_size = 128,
+    const OutlierEntry* gate_outliers = nullptr, const OutlierEntry* up_outliers = nullptr,
+    size_t outliers_per_block = 0);
+
+/**
+ * Y = residual + alpha * A * X (attention output / FFN down projection)
+ * residual may alias Y for an in-place update of the residual stream.
+ */
+void gemv_residual_ternary_1_28bit(
+    size_t M, size_t K, float alpha,
+    const uint8_t* A_quantized, const float* A_scales,
+    const float* X, const float* residual, float* Y, size_t block_size = 128,
+    const OutlierEntry* outliers = nullptr, size_t outliers_per_block = 0);
+
+void gemv_residual_quaternary_1_58bit(
+    size_t M, size_t K, float alpha,
+    const uint8_t* A_quantized, const float* A_scales,
+    const float* X, const float* residual, float* Y, size_t block_size = 128,
+    const OutlierEntry* outliers = nullptr, size_t outliers_per_block = 0);
+
+} // namespace neon
+} // namespace kernels
+} // namespace kipepeo
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <cstddef>
+#include <cstdint>
+#include "kipepeo/kernels/types.h"
 
 namespace kipepeo {
 namespace kernels {
@@ -17,7 +19,7 @@ void matrix_multiply_f32(const float* A, const float* B, float* C,
                         size_t M, size_t N, size_t K);
 
 // FP16 matrix multiplication (for newer ARM chips with FP16 support)
-void matrix_multiply_f16(const __fp16* A, const __fp16* B, __fp16* C,
+void matrix_multiply_f16(const fp16_t* A, const fp16_t* B, fp16_t* C,
                         size_t M, size_t N, size_t K);
 
 // Quantized matrix multiplication variants
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstddef>
+
+namespace kipepeo {
+namespace kernels {
+namespace neon {
+
+/**
+ * Packed-panel FP32 GEMM (BLIS-style): C = A * B
+ * A: M x K, B: K x N, C: M x N, all row-major
+ *
+ * B is copied in KC x NC blocks into NR-wide k-major strips and A in
+ * MC x KC blocks into MR-wide k-major strips, so the micro-kernel streams
+ * both operands with unit stride while an MR x NR tile of C stays in
+ * registers for the whole KC loop:
+ *
+ *   for each NC-wide column block of B      (B block stays in L3 / memory)
+ *     for each KC-deep slice                (packed B slice: KC x NC)
+ *       for each MC-tall row block of A     (packed A block: MC x KC, L2)
+ *         for each NR strip, MR strip       (B strip KC x NR, L1)
+ *           micro-kernel: MR x NR tile of C over KC
+ *
+ * Micro-tiles: 8x8 on AArch64 NEON (16 of the 32 vector registers hold
+ * C), 4x8 on 32-bit NEON, 6x16 with AVX2, 12x32 with AVX-512 and 4x8 in
+ * the portable scalar code, which the compiler vectorizes.
+ */
+
+/**
+ * Cache blocking of the packed GEMM, in rows / depth / columns
+ */
+struct GemmBlocking {
+    size_t MC;   // Rows of A per packed block (multiple of MR)
+    size_t KC;   // Depth of every packed slice
+    size_t NC;   // Columns of B per packed block (multiple of NR)
+};
+
+/**
+ * Micro-tile the packed GEMM uses on this CPU
+ * @param MR_hint, NR_hint Tile preferred by the chip (get_optimal_block_size);
+ *                         NEON builds cap it at the register budget, x86
+ *                         and scalar builds have a single tile
+ */
+void get_gemm_f32_micro_tile(size_t MR_hint, size_t NR_hint, size_t& MR, size_t& NR);
+
+/**
+ * Derive the blocking from cache sizes (e.g. HardwareCapabilities or
+ * read_cache_sizes): a KC x NR strip of B fills half of L1, an MC x KC
+ * block of A half of L2 and a KC x NC block of B half of L3 (or a fixed
+ * 4096 columns without L3)
+ */
+GemmBlocking compute_gemm_blocking(size_t l1_bytes, size_t l2_bytes, size_t l3_bytes,
+                                   size_t MR, size_t NR);
+
+/**
+ * Blocking for the caches of this CPU (read_cache_sizes, computed once)
+ */
+GemmBlocking get_gemm_f32_blocking(size_t MR, size_t NR);
+
+/**
+ * C = A * B through packed panels
+ * @param MR_hint, NR_hint Preferred micro-tile, see get_gemm_f32_micro_tile
+ */
+void gemm_f32_packed(const float* A, const float* B, float* C,
+                     size_t M, size_t N, size_t K,
+                     size_t MR_hint = 8, size_t NR_hint = 8);
+
+/**
+ * C = A * B with explicit blocking (benchmarks and tuning)
+ */
+void gemm_f32_packed(const float* A, const float* B, float* C,
+                     size_t M, size_t N, size_t K,
+                     size_t MR_hint, size_t NR_hint, const GemmBlocking& blocking);
+
+/**
+ * Portable reference: C[i][j] = sum_k A[i][k] * B[k][j], accumulated in
+ * k order. Used to check the optimized paths, not for speed.
+ */
+void gemm_f32_reference(const float* A, const float* B, float* C,
+                        size_t M, size_t N, size_t K);
+
+} // namespace neon
+} // namespace kernels
+} // namespace kipepeo
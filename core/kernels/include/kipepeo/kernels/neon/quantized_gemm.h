@@ -1,7 +1,8 @@
 #pragma once
 
 #include <cstddef>
-#include <cstdint.h>
+#include <cstdint>
+#include "kipepeo/kernels/types.h"
 
 namespace kipepeo {
 namespace kernels {
@@ -13,6 +14,17 @@ namespace neon {
  * 
  * These kernels use NEON intrinsics to accelerate quantized inference
  * on MediaTek Helio G99/G100, Unisoc T606, and Snapdragon 7s Gen 2
+ *
+ * Every AfricaQuant GEMV optionally takes a sparse outlier side channel:
+ * outliers_per_block OutlierEntry slots per block, laid out like the scales
+ * (slot base = (row * num_blocks_per_row + block) * outliers_per_block).
+ * Each entry adds value * X[k] for its column to the row's dot product in
+ * the same pass over X. outliers == nullptr disables the correction.
+ *
+ * The row-major 2-bit GEMVs (fp32, int8 and fp16 activations) prefetch
+ * their weight stream get_weight_prefetch_distance() bytes ahead of the
+ * bytes they decode (weight_prefetch.h); the default distance 0 leaves
+ * it to the hardware prefetcher.
  */
 
 /**
@@ -29,6 +41,8 @@ namespace neon {
  * @param beta Scaling factor for Y
  * @param Y Output vector (M elements, in-place accumulation)
  * @param block_size Quantization block size
+ * @param outliers Sparse fp16 outlier slots (optional, see above)
+ * @param outliers_per_block Slots per block
  */
 void gemv_ternary_1_28bit(
     size_t M,
@@ -39,9 +53,49 @@ void gemv_ternary_1_28bit(
     const float* X,
     float beta,
     float* Y,
-    size_t block_size = 128
+    size_t block_size = 128,
+    const OutlierEntry* outliers = nullptr,
+    size_t outliers_per_block = 0
 );
 
+/**
+ * Ternary (1.28-bit) quantized GEMV over the base-3 packed layout
+ * Computes: Y = alpha * A * X + beta * Y
+ *
+ * Five trits are stored per byte (3^5 = 243 <= 256), i.e. 1.6 bits per
+ * weight instead of 2. Each quantization block starts on a byte boundary,
+ * so a block of block_size weights occupies (block_size + 4) / 5 bytes and
+ * a row occupies ternary_base3_packed_size(K, block_size) bytes.
+ * Bytes are decoded through a 256-entry lookup table.
+ */
+void gemv_ternary_1_28bit_base3(
+    size_t M,
+    size_t K,
+    float alpha,
+    const uint8_t* A_quantized,
+    const float* A_scales,
+    const float* X,
+    float beta,
+    float* Y,
+    size_t block_size = 128,
+    const OutlierEntry* outliers = nullptr,
+    size_t outliers_per_block = 0
+);
+
+/**
+ * Number of bytes needed to store count ternary values in the base-3
+ * packed layout with the given block size
+ */
+size_t ternary_base3_packed_size(size_t count, size_t block_size);
+
+/**
+ * Decode one base-3 packed byte
+ * Byte layout: t0 + 3*t1 + 9*t2 + 27*t3 + 81*t4, where t = value + 1
+ * @return Pointer to 8 int8 entries; entries 0..4 hold the ternary values
+ *         {-1, 0, +1}, entries 5..7 are zero
+ */
+const int8_t* ternary_base3_lookup(uint8_t packed);
+
 /**
  * Quaternary (1.58-bit) quantized GEMM
  * Computes: Y = alpha * A * X + beta * Y
@@ -56,13 +110,323 @@ void gemv_quaternary_1_58bit(
     const float* X,
     float beta,
     float* Y,
+    size_t block_size = 128,
+    const OutlierEntry* outliers = nullptr,
+    size_t outliers_per_block = 0
+);
+
+/**
+ * Variants of the AfricaQuant GEMVs above that read per-block scales as
+ * IEEE half-precision bit patterns (see kipepeo/kernels/fp16.h).
+ * Halves the size of the resident scale table; results match the fp32-scale
+ * kernels run on the same scales rounded to fp16.
+ */
+void gemv_ternary_1_28bit_f16_scales(
+    size_t M, size_t K, float alpha,
+    const uint8_t* A_quantized, const uint16_t* A_scales,
+    const float* X, float beta, float* Y, size_t block_size = 128,
+    const OutlierEntry* outliers = nullptr, size_t outliers_per_block = 0);
+
+void gemv_ternary_1_28bit_base3_f16_scales(
+    size_t M, size_t K, float alpha,
+    const uint8_t* A_quantized, const uint16_t* A_scales,
+    const float* X, float beta, float* Y, size_t block_size = 128,
+    const OutlierEntry* outliers = nullptr, size_t outliers_per_block = 0);
+
+void gemv_quaternary_1_58bit_f16_scales(
+    size_t M, size_t K, float alpha,
+    const uint8_t* A_quantized, const uint16_t* A_scales,
+    const float* X, float beta, float* Y, size_t block_size = 128,
+    const OutlierEntry* outliers = nullptr, size_t outliers_per_block = 0);
+
+/**
+ * Row-interleaved layout for the 2-bit AfricaQuant GEMVs
+ *
+ * Rows are grouped in panels of rows_per_group (4 or 8); inside a panel,
+ * block b of every row is stored back to back, so a GEMV streams one
+ * contiguous run of bytes per block while keeping rows_per_group
+ * independent accumulators on the same activations. The last panel is
+ * padded with zero rows. block_size must be a multiple of 4.
+ *
+ * Scales are interleaved the same way: the scale of (row, block) sits at
+ * ((row / rows_per_group) * num_blocks_per_row + block) * rows_per_group
+ * + row % rows_per_group, padding rows have scale 0. Outlier slots keep
+ * their row-major layout.
+ */
+size_t interleaved_2bit_size(size_t M, size_t K, size_t rows_per_group);
+
+/**
+ * Repack a row-major 2-bit matrix ((K * 2 + 7) / 8 bytes per row) into
+ * interleaved_2bit_size(M, K, rows_per_group) bytes at A_interleaved
+ */
+void repack_2bit_interleaved(
+    size_t M, size_t K,
+    const uint8_t* A_quantized, uint8_t* A_interleaved,
+    size_t block_size, size_t rows_per_group);
+
+/**
+ * Repack M x num_blocks_per_row block scales (fp32 or fp16 bits) into
+ * ((M + rows_per_group - 1) / rows_per_group) * rows_per_group *
+ * num_blocks_per_row entries at out
+ */
+void repack_scales_interleaved(
+    size_t M, size_t num_blocks_per_row,
+    const float* scales, float* out, size_t rows_per_group);
+
+void repack_scales_interleaved(
+    size_t M, size_t num_blocks_per_row,
+    const uint16_t* scales, uint16_t* out, size_t rows_per_group);
+
+/**
+ * GEMVs over the row-interleaved layout
+ * Computes: Y = alpha * A * X + beta * Y, same results as the row-major
+ * kernels up to summation order
+ */
+void gemv_ternary_1_28bit_interleaved(
+    size_t M, size_t K, float alpha,
+    const uint8_t* A_interleaved, const float* A_scales,
+    const float* X, float beta, float* Y, size_t block_size = 128,
+    size_t rows_per_group = 4,
+    const OutlierEntry* outliers = nullptr, size_t outliers_per_block = 0);
+
+void gemv_ternary_1_28bit_interleaved_f16_scales(
+    size_t M, size_t K, float alpha,
+    const uint8_t* A_interleaved, const uint16_t* A_scales,
+    const float* X, float beta, float* Y, size_t block_size = 128,
+    size_t rows_per_group = 4,
+    const OutlierEntry* outliers = nullptr, size_t outliers_per_block = 0);
+
+void gemv_quaternary_1_58bit_interleaved(
+    size_t M, size_t K, float alpha,
+    const uint8_t* A_interleaved, const float* A_scales,
+    const float* X, float beta, float* Y, size_t block_size = 128,
+    size_t rows_per_group = 4,
+    const OutlierEntry* outliers = nullptr, size_t outliers_per_block = 0);
+
+void gemv_quaternary_1_58bit_interleaved_f16_scales(
+    size_t M, size_t K, float alpha,
+    const uint8_t* A_interleaved, const uint16_t* A_scales,
+    const float* X, float beta, float* Y, size_t block_size = 128,
+    size_t rows_per_group = 4,
+    const OutlierEntry* outliers = nullptr, size_t outliers_per_block = 0);
+
+/**
+ * Half-precision activation variants of the 2-bit AfricaQuant GEMVs
+ * Computes: Y = alpha * A * X + beta * Y with X, Y and the per-block
+ * scales all fp16 bit patterns (see kipepeo/kernels/fp16.h), halving
+ * activation and scale traffic against the fp32-activation kernels.
+ *
+ * On builds with ARMv8.2-A FP16 vector arithmetic (KIPEPEO_ARM_FP16) each
+ * block is summed in 8 fp16 lanes, promoted to fp32 every 64 values, and
+ * block and row sums stay fp32. Elsewhere X is widened to fp32 once per
+ * call and the fp32-activation kernel runs on fp16 scales.
+ * Weight layout and outlier slots are the same as for the fp32 kernels.
+ */
+void gemv_ternary_1_28bit_f16(
+    size_t M, size_t K, float alpha,
+    const uint8_t* A_quantized, const uint16_t* A_scales,
+    const uint16_t* X, float beta, uint16_t* Y, size_t block_size = 128,
+    const OutlierEntry* outliers = nullptr, size_t outliers_per_block = 0);
+
+void gemv_quaternary_1_58bit_f16(
+    size_t M, size_t K, float alpha,
+    const uint8_t* A_quantized, const uint16_t* A_scales,
+    const uint16_t* X, float beta, uint16_t* Y, size_t block_size = 128,
+    const OutlierEntry* outliers = nullptr, size_t outliers_per_block = 0);
+
+/**
+ * Portable emulation of the fp16-lane path: same lanes, promotion points
+ * and summation order in scalar code, with every fp16 add rounded as the
+ * hardware rounds it. Bit-exact with the native kernels, so the
+ * half-precision numerics can be checked on any host.
+ */
+void gemv_ternary_1_28bit_f16_emulated(
+    size_t M, size_t K, float alpha,
+    const uint8_t* A_quantized, const uint16_t* A_scales,
+    const uint16_t* X, float beta, uint16_t* Y, size_t block_size = 128,
+    const OutlierEntry* outliers = nullptr, size_t outliers_per_block = 0);
+
+void gemv_quaternary_1_58bit_f16_emulated(
+    size_t M, size_t K, float alpha,
+    const uint8_t* A_quantized, const uint16_t* A_scales,
+    const uint16_t* X, float beta, uint16_t* Y, size_t block_size = 128,
+    const OutlierEntry* outliers = nullptr, size_t outliers_per_block = 0);
+
+/**
+ * True if this build accumulates the fp16 GEMVs in native fp16 lanes
+ */
+bool gemv_f16_native_accumulation();
+
+/**
+ * Widen K half activations to fp32 for the fp32-activation kernels, in
+ * per-thread scratch that grows to the largest K seen and is reused, so
+ * the widened fp16 path does no heap allocation per call
+ * @return K floats, valid until the calling thread widens again
+ */
+const float* widen_f16_activations(size_t K, const uint16_t* X);
+
+/**
+ * Quantize an activation vector to int8 for the W1.58A8 GEMVs below
+ * Symmetric per-block quantization: X[k] ~= X_q[k] * X_scales[k / block_size],
+ * codes in [-127, 127]. Done once per layer input and shared by every GEMV
+ * that consumes it; block_size must match the weights' block size.
+ *
+ * @param K Number of elements
+ * @param X Input vector (K elements)
+ * @param X_q Output codes (K elements)
+ * @param X_scales Output scales ((K + block_size - 1) / block_size elements)
+ * @param block_size Quantization block size
+ */
+void quantize_activations_int8(
+    size_t K,
+    const float* X,
+    int8_t* X_q,
+    float* X_scales,
     size_t block_size = 128
 );
 
 /**
- * INT8 quantized GEMM (for comparison/fallback)
+ * Int8-activation (W1.58A8) variants of the AfricaQuant GEMVs
+ * Computes: Y = alpha * A * dequant(X_q) + beta * Y
+ *
+ * Packed weights are expanded to small integers (ternary -1/0/+1,
+ * quaternary 2x level -3/-1/+1/+3) and each block's dot product with X_q
+ * runs entirely in integer arithmetic (sdot on ARMv8.2-A dotprod builds,
+ * widening multiply-accumulate on other NEON targets, maddubs on AVX2).
+ * Weight and activation scales are applied once per block. Weight layout,
+ * scales and outlier slots are the same as for the float-activation kernels.
+ */
+void gemv_ternary_1_28bit_a8(
+    size_t M, size_t K, float alpha,
+    const uint8_t* A_quantized, const float* A_scales,
+    const int8_t* X_q, const float* X_scales,
+    float beta, float* Y, size_t block_size = 128,
+    const OutlierEntry* outliers = nullptr, size_t outliers_per_block = 0);
+
+void gemv_ternary_1_28bit_base3_a8(
+    size_t M, size_t K, float alpha,
+    const uint8_t* A_quantized, const float* A_scales,
+    const int8_t* X_q, const float* X_scales,
+    float beta, float* Y, size_t block_size = 128,
+    const OutlierEntry* outliers = nullptr, size_t outliers_per_block = 0);
+
+void gemv_quaternary_1_58bit_a8(
+    size_t M, size_t K, float alpha,
+    const uint8_t* A_quantized, const float* A_scales,
+    const int8_t* X_q, const float* X_scales,
+    float beta, float* Y, size_t block_size = 128,
+    const OutlierEntry* outliers = nullptr, size_t outliers_per_block = 0);
+
+void gemv_ternary_1_28bit_a8_f16_scales(
+    size_t M, size_t K, float alpha,
+    const uint8_t* A_quantized, const uint16_t* A_scales,
+    const int8_t* X_q, const float* X_scales,
+    float beta, float* Y, size_t block_size = 128,
+    const OutlierEntry* outliers = nullptr, size_t outliers_per_block = 0);
+
+void gemv_ternary_1_28bit_base3_a8_f16_scales(
+    size_t M, size_t K, float alpha,
+    const uint8_t* A_quantized, const uint16_t* A_scales,
+    const int8_t* X_q, const float* X_scales,
+    float beta, float* Y, size_t block_size = 128,
+    const OutlierEntry* outliers = nullptr, size_t outliers_per_block = 0);
+
+void gemv_quaternary_1_58bit_a8_f16_scales(
+    size_t M, size_t K, float alpha,
+    const uint8_t* A_quantized, const uint16_t* A_scales,
+    const int8_t* X_q, const float* X_scales,
+    float beta, float* Y, size_t block_size = 128,
+    const OutlierEntry* outliers = nullptr, size_t outliers_per_block = 0);
+
+/**
+ * Tiled AfricaQuant GEMM for prompt prefill
+ * Computes: Y = alpha * X * A^T + beta * Y
+ * i.e. one GEMV per activation vector, but each MR x KC weight tile is
+ * decoded once (block scales and outliers folded in) and reused by an
+ * MR x NR register micro-kernel across up to 256 activation vectors.
+ *
+ * @param M Number of rows in A (output features)
+ * @param N Number of activation vectors (tokens)
+ * @param K Number of columns in A
+ * @param A_quantized Packed weights, same layout as the matching GEMV
+ * @param A_scales Per-block scaling factors for A
+ * @param X Input vectors (N x K, row-major)
+ * @param Y Output vectors (N x M, row-major)
+ * @param MR, NR Register tile, normally from get_optimal_block_size();
+ *               4, 6 or 8 rows by 4 or 8 vectors, larger values are capped.
+ *               x86 builds ignore them and use the 6x16 (AVX2) or 12x32
+ *               (AVX-512) tile of the packed FP32 GEMM.
+ * @param outliers Sparse fp16 outlier slots (optional, as for the GEMVs)
+ */
+void gemm_ternary_1_28bit(
+    size_t M,
+    size_t N,
+    size_t K,
+    float alpha,
+    const uint8_t* A_quantized,
+    const float* A_scales,
+    const float* X,
+    float beta,
+    float* Y,
+    size_t block_size = 128,
+    size_t MR = 4,
+    size_t NR = 4,
+    const OutlierEntry* outliers = nullptr,
+    size_t outliers_per_block = 0
+);
+
+void gemm_ternary_1_28bit_base3(
+    size_t M, size_t N, size_t K, float alpha,
+    const uint8_t* A_quantized, const float* A_scales,
+    const float* X, float beta, float* Y, size_t block_size = 128,
+    size_t MR = 4, size_t NR = 4,
+    const OutlierEntry* outliers = nullptr, size_t outliers_per_block = 0);
+
+void gemm_quaternary_1_58bit(
+    size_t M, size_t N, size_t K, float alpha,
+    const uint8_t* A_quantized, const float* A_scales,
+    const float* X, float beta, float* Y, size_t block_size = 128,
+    size_t MR = 4, size_t NR = 4,
+    const OutlierEntry* outliers = nullptr, size_t outliers_per_block = 0);
+
+void gemm_ternary_1_28bit_f16_scales(
+    size_t M, size_t N, size_t K, float alpha,
+    const uint8_t* A_quantized, const uint16_t* A_scales,
+    const float* X, float beta, float* Y, size_t block_size = 128,
+    size_t MR = 4, size_t NR = 4,
+    const OutlierEntry* outliers = nullptr, size_t outliers_per_block = 0);
+
+void gemm_ternary_1_28bit_base3_f16_scales(
+    size_t M, size_t N, size_t K, float alpha,
+    const uint8_t* A_quantized, const uint16_t* A_scales,
+    const float* X, float beta, float* Y, size_t block_size = 128,
+    size_t MR = 4, size_t NR = 4,
+    const OutlierEntry* outliers = nullptr, size_t outliers_per_block = 0);
+
+void gemm_quaternary_1_58bit_f16_scales(
+    size_t M, size_t N, size_t K, float alpha,
+    const uint8_t* A_quantized, const uint16_t* A_scales,
+    const float* X, float beta, float* Y, size_t block_size = 128,
+    size_t MR = 4, size_t NR = 4,
+    const OutlierEntry* outliers = nullptr, size_t outliers_per_block = 0);
+
+// Activation block size of gemv_int8
+constexpr size_t GEMV_INT8_BLOCK = 128;
+
+/**
+ * INT8 quantized GEMV (for comparison/fallback)
+ * Computes: Y = alpha * A * X + beta * Y
+ *
  * Standard INT8 quantization is less efficient than AfricaQuant
- * but provided for compatibility
+ * but provided for compatibility. A holds symmetric int8 codes in
+ * [-127, 127] with one scale per row (A[i][k] ~= A_quantized[i * K + k] *
+ * A_scales[i]). X is quantized once per call to int8 in blocks of
+ * GEMV_INT8_BLOCK values (quantize_activations_int8), so every row is a
+ * run of integer dot products (sdot / maddubs / vpdpbusd, as for the
+ * W1.58A8 GEMVs) with one float multiply per block.
+ *
+ * @param A_quantized M x K codes, row-major
+ * @param A_scales Per-row scales (M elements)
  */
 void gemv_int8(
     size_t M,
@@ -78,6 +442,7 @@ void gemv_int8(
 /**
  * Batch matrix-vector multiplication with 1.28-bit quantization
  * Processes multiple vectors at once for better throughput
+ * (gemm_ternary_1_28bit with the default 4x4 tile)
  * 
  * @param batch_size Number of vectors to process
  * @param M Number of rows in A
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+
+namespace kipepeo {
+namespace kernels {
+
+/**
+ * Non-owning reference to a callable fn(begin, end)
+ *
+ * A function pointer plus a pointer to the callable: binding a lambda
+ * never allocates, unlike std::function once the captures outgrow its
+ * small buffer. The callable must outlive the reference.
+ */
+class RangeFnRef {
+public:
+    template <typename F,
+              typename = typename std::enable_if<
+                  !std::is_same<typename std::decay<F>::type, RangeFnRef>::value>::type>
+    RangeFnRef(F&& fn)
+        : object_(const_cast<void*>(static_cast<const void*>(std::addressof(fn)))),
+          call_(&invoke<typename std::remove_reference<F>::type>) {}
+
+    void operator()(size_t begin, size_t end) const {
+        call_(object_, begin, end);
+    }
+
+private:
+    template <typename F>
+    static void invoke(void* object, size_t begin, size_t end) {
+        (*static_cast<F*>(object))(begin, end);
+    }
+
+    void* object_;
+    void (*call_)(void*, size_t, size_t);
+};
+
+/**
+ * ThreadPool - persistent workers that split a kernel's rows across cores
+ *
+ * Workers are started once, pinned to a cluster (Linux/Android, when
+ * read_cpu_topology reports cores of different capacity) and parked
+ * between jobs: they spin briefly after each job, since decode issues
+ * GEMVs back to back, then sleep on a condition variable. The calling
+ * thread always takes a share of the job, so a pool of N threads starts
+ * N - 1 workers.
+ *
+ * big.LITTLE: threads go to the big cores first and every thread's initial
+ * range is proportional to its core's capacity. Threads work through their
+ * range in tiles sized by core speed (a big core claims several grains per
+ * step, a little core one) and, once it is empty, steal half of the largest
+ * remaining range, so a core slowed by another process or by thermal
+ * throttling does not set the latency of the layer.
+ *
+ * One job runs at a time. A call made while another thread's job is in
+ * flight, or from inside a job, runs serially on the caller instead of
+ * waiting, so the kernels built on it stay reentrant.
+ */
+class ThreadPool {
+public:
+    /**
+     * @param num_threads Threads per job including the caller (0 = one per core)
+     */
+    explicit ThreadPool(size_t num_threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t num_threads() const;
+
+    /**
+     * Run fn(begin, end) over disjoint ranges covering [0, count) and wait
+     * for all of them
+     *
+     * @param count Number of items (e.g. matrix rows)
+     * @param grain Range boundaries are multiples of grain
+     * @param cost_per_item Work per item (e.g. weights per row); small jobs
+     *                      use fewer threads so wake-up cost stays below
+     *                      the work each thread saves
+     * @param fn Called for disjoint non-empty ranges, possibly
+     *           concurrently and several times per thread; referenced,
+     *           not copied, so dispatch does no heap allocation
+     */
+    template <typename F>
+    void parallel_for(size_t count, size_t grain, size_t cost_per_item, F&& fn) {
+        run(count, grain, cost_per_item, RangeFnRef(fn));
+    }
+
+private:
+    void run(size_t count, size_t grain, size_t cost_per_item, RangeFnRef fn);
+
+    class Impl;
+    Impl* impl_;
+};
+
+/**
+ * Process-wide pool used by the *_chip_optimized kernels and
+ * quantization::PreparedMatrix
+ */
+ThreadPool& get_kernel_thread_pool();
+
+/**
+ * Set the thread count of the kernel pool (0 = one per core)
+ * The pool is rebuilt on next use; must not be called while kernels run.
+ */
+void set_kernel_num_threads(size_t num_threads);
+
+/**
+ * @return Threads per job of the kernel pool, including the caller
+ */
+size_t get_kernel_num_threads();
+
+/**
+ * @return True when the calling thread runs on a big core: a pool worker
+ *         pinned to the fastest cluster or, outside a job, any thread
+ *         Kernels use it to pick the tile sizes of the core they run on.
+ */
+bool current_thread_on_big_core();
+
+} // namespace kernels
+} // namespace kipepeo
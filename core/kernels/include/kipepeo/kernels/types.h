@@ -6,6 +6,16 @@
 namespace kipepeo {
 namespace kernels {
 
+// Half-precision element type of the f16 kernel entry points: the native
+// __fp16 on ARM, _Float16 on x86-64 (GCC 12+, Clang 15+)
+#if defined(__arm__) || defined(__aarch64__)
+using fp16_t = __fp16;
+#elif defined(__FLT16_MAX__)
+using fp16_t = _Float16;
+#else
+#error "kipepeo kernels need a compiler with __fp16 or _Float16 support"
+#endif
+
 // Matrix dimensions
 struct MatrixDim {
     size_t rows;
@@ -19,6 +29,16 @@ struct KernelMetrics {
     float cache_hit_rate = 0.0f;
 };
 
+// Sparse outlier slot for mixed-precision quantized blocks
+// Each block owns a fixed number of slots, filled front to back; the first
+// slot with index == OUTLIER_SLOT_EMPTY ends the block's list.
+struct OutlierEntry {
+    uint16_t index;  // Position within the block
+    uint16_t value;  // fp16 residual (original weight - dequantized weight)
+};
+
+constexpr uint16_t OUTLIER_SLOT_EMPTY = 0xFFFF;
+
 } // namespace kernels
 } // namespace kipepeo
 
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstddef>
+#include <algorithm>
+#include <cstdint>
+
+namespace kipepeo {
+namespace kernels {
+
+/**
+ * Software prefetch of quantized weights for memory-bound decode
+ *
+ * A decode-step GEMV reads every weight byte once, so it runs at memory
+ * bandwidth. Two mechanisms keep more of that bandwidth busy:
+ *
+ * - Stream prefetch: the 2-bit GEMVs (neon/quantized_gemm.h) issue
+ *   __builtin_prefetch for the weight bytes a fixed distance ahead of
+ *   the bytes they decode. The distance is tunable per device; 0 (the
+ *   default) leaves prefetching to the hardware.
+ *
+ * - Layer-ahead prefetch: prefetch_next_weights() names the tensor that
+ *   runs after the current one. The next GEMV issued from the same thread
+ *   (the *_chip_optimized dispatch, PreparedMatrix::matvec*) warms up to
+ *   get_layer_ahead_budget() bytes of it into L2, spreading the prefetches
+ *   over its row chunks so they overlap its own compute.
+ */
+
+/**
+ * Set the stream prefetch distance in bytes (0 = off)
+ * Initially read from the KIPEPEO_PREFETCH_DISTANCE environment variable.
+ * Typical values are 256 to 2048; measure with kipepeo_kernel_roofline.
+ */
+void set_weight_prefetch_distance(size_t bytes);
+
+/**
+ * @return Stream prefetch distance in bytes (0 = off)
+ */
+size_t get_weight_prefetch_distance();
+
+/**
+ * Weight bytes a layer-ahead prefetch warms at most: half of L2, so the
+ * current layer's working set keeps the other half
+ */
+size_t get_layer_ahead_budget();
+
+/**
+ * Layer-ahead hook: the next GEMV issued from this thread warms the first
+ * get_layer_ahead_budget() bytes of [data, data + bytes) into L2 while it
+ * computes. Replaces an earlier pending range; nullptr cancels it.
+ */
+void prefetch_next_weights(const void* data, size_t bytes);
+
+/**
+ * Bytes to warm during one GEMV
+ */
+struct WeightPrefetchRange {
+    const uint8_t* data;
+    size_t bytes;
+};
+
+/**
+ * Pending layer-ahead range of the calling thread, clamped to the budget;
+ * clears it. Called by GEMV drivers before splitting rows across threads.
+ */
+WeightPrefetchRange take_next_weights();
+
+/**
+ * Prefetch into L2 the share of ahead that rows [begin, end) of count rows
+ * warm: bytes [begin, end) * ahead.bytes / count
+ */
+void prefetch_row_share(const WeightPrefetchRange& ahead, size_t count, size_t begin, size_t end);
+
+/**
+ * Run rows(b, e) over [begin, end) of count rows in chunks of chunk rows;
+ * after each chunk, prefetch its share of ahead (prefetch_row_share).
+ * With nothing to warm, rows runs once over the whole range.
+ */
+template <typename F>
+inline void for_rows_prefetching(const WeightPrefetchRange& ahead, size_t count,
+                                 size_t begin, size_t end, size_t chunk, F&& rows) {
+    if (ahead.bytes == 0 || count == 0) {
+        rows(begin, end);
+        return;
+    }
+    for (size_t b = begin; b < end; b += chunk) {
+        size_t e = std::min(b + chunk, end);
+        rows(b, e);
+        prefetch_row_share(ahead, count, b, e);
+    }
+}
+
+} // namespace kernels
+} // namespace kipepeo
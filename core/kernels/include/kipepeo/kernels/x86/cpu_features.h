@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+
+namespace kipepeo {
+namespace kernels {
+namespace x86 {
+
+/**
+ * x86-64 SIMD levels the kernels are built for
+ * AVX2 implies FMA and F16C; AVX512 implies AVX512F/BW/VL and VNNI
+ * (Ice Lake / Zen 4 and later).
+ */
+enum class X86Level : uint8_t {
+    SCALAR = 0,
+    AVX2,
+    AVX512
+};
+
+/**
+ * Raw CPUID feature bits, already masked by the OS-enabled register state
+ * (XGETBV), so a feature reported here is safe to execute
+ */
+struct X86Features {
+    bool avx2;
+    bool fma;
+    bool f16c;
+    bool avx512f;
+    bool avx512bw;
+    bool avx512vl;
+    bool avx512_vnni;
+};
+
+/**
+ * Detect CPU features once (CPUID + XGETBV); all false on non-x86 builds
+ */
+const X86Features& get_x86_features();
+
+/**
+ * Best usable SIMD level
+ * The KIPEPEO_X86_LEVEL environment variable ("scalar", "avx2", "avx512")
+ * caps it, so CI can compare kernel families on one machine.
+ */
+X86Level get_x86_level();
+
+/**
+ * Human-readable level name
+ */
+const char* get_x86_level_name(X86Level level);
+
+} // namespace x86
+} // namespace kernels
+} // namespace kipepeo
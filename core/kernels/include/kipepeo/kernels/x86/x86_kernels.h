@@ -0,0 +1,147 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "kipepeo/kernels/x86/cpu_features.h"
+
+namespace kipepeo {
+namespace kernels {
+namespace x86 {
+
+/**
+ * x86-64 kernel family (AVX2 + FMA, AVX-512 F/BW/VL/VNNI)
+ *
+ * Each function is compiled for its instruction set with a per-function
+ * target attribute, so the library itself builds for baseline x86-64 and
+ * only calls them after get_x86_level() says they are safe. Callers
+ * normally go through the select_*() helpers or kernel_dispatch rather
+ * than naming a level directly.
+ *
+ * 2-bit helpers work on whole bytes of a packed AfricaQuant row (4 values
+ * per byte, value i in bits 2i..2i+1): packed points at the byte holding
+ * the first value and n is a multiple of 4.
+ */
+
+// ========== AVX2 ==========
+
+/**
+ * sum_i level(code_i) * x[i] for ternary codes (-1=00, 0=01, +1=10)
+ */
+float ternary_2bit_dot_avx2(const uint8_t* packed, const float* x, size_t n);
+
+/**
+ * sum_i level(code_i) * x[i] for quaternary codes (-1.5, -0.5, +0.5, +1.5)
+ */
+float quaternary_2bit_dot_avx2(const uint8_t* packed, const float* x, size_t n);
+
+/**
+ * Dot products of rows 2-bit rows (row r at packed + r * stride) with the
+ * same n activations, out[r] per row; each activation load is shared by all
+ * rows. rows is normally 4 or 8 (see gemv_*_interleaved); n must be a
+ * multiple of 4.
+ */
+void ternary_2bit_dot_rows_avx2(const uint8_t* packed, size_t stride, size_t rows,
+                                const float* x, size_t n, float* out);
+void quaternary_2bit_dot_rows_avx2(const uint8_t* packed, size_t stride, size_t rows,
+                                   const float* x, size_t n, float* out);
+
+/**
+ * Integer dot product of int8 weights and activations, both in [-127, 127]
+ */
+int32_t dot_i8_avx2(const int8_t* w, const int8_t* x, size_t n);
+
+/**
+ * C = A * B (A: M x K, B: K x N, C: M x N, row-major)
+ */
+void matrix_multiply_f32_avx2(const float* A, const float* B, float* C,
+                              size_t M, size_t N, size_t K);
+
+/**
+ * Packed FP32 GEMM micro-kernel (neon::gemm_f32_packed): the 6 x 16 tile
+ * of C at c (row stride ldc) is set to, or with accumulate increased by,
+ * the product of a 6-wide and a 16-wide k-major panel over kc. The 12
+ * accumulators stay in ymm registers for the whole kc loop.
+ */
+void gemm_f32_micro_6x16_avx2(size_t kc, const float* a, const float* b,
+                              float* c, size_t ldc, bool accumulate);
+
+/**
+ * max |x[i]| (0 for n == 0)
+ */
+float abs_max_avx2(const float* x, size_t n);
+
+/**
+ * Pack n weights (n % 4 == 0) as ternary codes: w * inv_scale above
+ * threshold -> +1, below -threshold -> -1, else 0. Writes n / 4 bytes.
+ */
+void quantize_ternary_2bit_avx2(const float* w, size_t n, float inv_scale,
+                                float threshold, uint8_t* out);
+
+/**
+ * Pack n weights (n % 4 == 0) as quaternary codes: w * inv_scale above 1,
+ * 0, -1 -> +1.5, +0.5, -0.5, else -1.5. Writes n / 4 bytes.
+ */
+void quantize_quaternary_2bit_avx2(const float* w, size_t n, float inv_scale, uint8_t* out);
+
+/**
+ * out[i] = levels[code_i] * scale for n values (n % 4 == 0)
+ */
+void dequantize_2bit_avx2(const uint8_t* packed, size_t n, const float levels[4],
+                          float scale, float* out);
+
+/**
+ * Scale search sums for one ternary candidate: over a[i] > threshold,
+ * sums[0] = sum c[i] * a[i] and sums[1] = sum c[i]
+ */
+void ternary_fit_sums_avx2(const float* a, const float* c, size_t n, float threshold, float sums[2]);
+
+/**
+ * Scale search sums for one quaternary candidate: with level
+ * l = (a[i] * inv_scale > 1 ? 1.5 : 0.5), sums[0] = sum c[i] * l * a[i]
+ * and sums[1] = sum c[i] * l * l
+ */
+void quaternary_fit_sums_avx2(const float* a, const float* c, size_t n, float inv_scale, float sums[2]);
+
+// ========== AVX-512 (F/BW/VL/VNNI) ==========
+
+float ternary_2bit_dot_avx512(const uint8_t* packed, const float* x, size_t n);
+float quaternary_2bit_dot_avx512(const uint8_t* packed, const float* x, size_t n);
+
+/**
+ * Int8 dot product through vpdpbusd
+ */
+int32_t dot_i8_avx512_vnni(const int8_t* w, const int8_t* x, size_t n);
+
+void matrix_multiply_f32_avx512(const float* A, const float* B, float* C,
+                                size_t M, size_t N, size_t K);
+
+/**
+ * Packed FP32 GEMM micro-kernel, 12 x 32 tile in 24 zmm accumulators
+ * (see gemm_f32_micro_6x16_avx2)
+ */
+void gemm_f32_micro_12x32_avx512(size_t kc, const float* a, const float* b,
+                                 float* c, size_t ldc, bool accumulate);
+
+// ========== Runtime selection (see kernel_dispatch.cpp) ==========
+
+using TwoBitDotFn = float (*)(const uint8_t* packed, const float* x, size_t n);
+using DotI8Fn = int32_t (*)(const int8_t* w, const int8_t* x, size_t n);
+using TwoBitDotRowsFn = void (*)(const uint8_t* packed, size_t stride, size_t rows,
+                                 const float* x, size_t n, float* out);
+using GemmF32MicroFn = void (*)(size_t kc, const float* a, const float* b,
+                                float* c, size_t ldc, bool accumulate);
+
+/**
+ * Best kernel for the running CPU, or nullptr when only the portable
+ * scalar code applies
+ */
+TwoBitDotFn select_ternary_2bit_dot();
+TwoBitDotFn select_quaternary_2bit_dot();
+DotI8Fn select_dot_i8();
+TwoBitDotRowsFn select_ternary_2bit_dot_rows();
+TwoBitDotRowsFn select_quaternary_2bit_dot_rows();
+GemmF32MicroFn select_gemm_f32_micro_kernel(size_t& MR, size_t& NR);
+
+} // namespace x86
+} // namespace kernels
+} // namespace kipepeo
@@ -1,5 +1,6 @@
 #include "kipepeo/kernels/apple/neon_apple.h"
 #include "kipepeo/kernels/neon/matrix_multiply.h"
+#include "kipepeo/kernels/neon/packed_gemm.h"
 #include "kipepeo/kernels/neon/quantized_gemm.h"
 #include <cstring>
 
@@ -14,93 +15,19 @@ namespace apple {
 // Apple Silicon: Firestorm/Icestorm, large unified cache - use 16x16 blocking
 void apple_neon_matrix_multiply_f32(const float* A, const float* B, float* C,
                                     size_t M, size_t N, size_t K) {
-#ifdef KIPEPEO_NEON_ENABLED
-    // Aggressive blocking for large unified cache
-    // Firestorm cores can handle 16x16, Icestorm can use 8x8
-    const size_t MR = 16;  // Big core blocking
-    const size_t NR = 16;
-    
-    memset(C, 0, M * N * sizeof(float));
-    
-    for (size_t i = 0; i < M; i += MR) {
-        size_t m_block = (i + MR <= M) ? MR : (M - i);
-        
-        for (size_t j = 0; j < N; j += NR) {
-            size_t n_block = (j + NR <= N) ? NR : (N - j);
-            
-            // Accumulator registers for 16x16 block
-            // Use 4x4 sub-blocks to manage register pressure
-            float32x4_t acc[16][16];
-            for (size_t ii = 0; ii < 16; ++ii) {
-                for (size_t jj = 0; jj < 16; ++jj) {
-                    acc[ii][jj] = vdupq_n_f32(0.0f);
-                }
-            }
-            
-            // Inner loop with aggressive prefetching for unified memory
-            size_t k = 0;
-            for (; k + 4 <= K; k += 4) {
-                // Load A vectors (16 rows)
-                float32x4_t a_vec[16];
-                for (size_t ii = 0; ii < m_block && (i + ii) < M; ++ii) {
-                    a_vec[ii] = vld1q_f32(&A[(i + ii) * K + k]);
-                    // Prefetch for unified memory architecture
-                    __builtin_prefetch(&A[(i + ii) * K + k + 128], 0, 3);
-                }
-                
-                // Process B columns
-                for (size_t jj = 0; jj < n_block && (j + jj) < N; ++jj) {
-                    float b_vals[4];
-                    for (int kk = 0; kk < 4 && (k + kk) < K; ++kk) {
-                        b_vals[kk] = B[(k + kk) * N + (j + jj)];
-                    }
-                    float32x4_t b_vec = vld1q_f32(b_vals);
-                    
-                    // Prefetch next B column
-                    if (k + 8 < K) {
-                        __builtin_prefetch(&B[(k + 4) * N + (j + jj)], 0, 3);
-                    }
-                    
-                    // FMA for each row
-                    for (size_t ii = 0; ii < m_block && (i + ii) < M; ++ii) {
-                        acc[ii][jj] = vfmaq_f32(acc[ii][jj], a_vec[ii], b_vec);
-                    }
-                }
-            }
-            
-            // Handle remaining K elements
-            for (; k < K; ++k) {
-                for (size_t ii = 0; ii < m_block && (i + ii) < M; ++ii) {
-                    float a_val = A[(i + ii) * K + k];
-                    for (size_t jj = 0; jj < n_block && (j + jj) < N; ++jj) {
-                        float b_val = B[k * N + (j + jj)];
-                        C[(i + ii) * N + (j + jj)] += a_val * b_val;
-                    }
-                }
-            }
-            
-            // Store results
-            for (size_t ii = 0; ii < m_block && (i + ii) < M; ++ii) {
-                for (size_t jj = 0; jj < n_block && (j + jj) < N; ++jj) {
-                    float sum = vaddvq_f32(acc[ii][jj]);
-                    C[(i + ii) * N + (j + jj)] += sum;
-                }
-            }
-        }
-    }
-#else
-    neon::matrix_multiply_f32(A, B, C, M, N, K);
-#endif
+    // Firestorm/Icestorm: widest NEON tile (8x8); the large caches give
+    // large MC / KC / NC blocks through read_cache_sizes
+    neon::gemm_f32_packed(A, B, C, M, N, K, 16, 16);
 }
 
-void apple_neon_matrix_multiply_f16(const __fp16* A, const __fp16* B, __fp16* C,
+void apple_neon_matrix_multiply_f16(const fp16_t* A, const fp16_t* B, fp16_t* C,
                                     size_t M, size_t N, size_t K) {
 #ifdef KIPEPEO_NEON_ENABLED
     // Apple Silicon has excellent FP16 support - use 16x16 blocking
     const size_t MR = 16;
     const size_t NR = 16;
     
-    memset(C, 0, M * N * sizeof(__fp16));
+    memset(C, 0, M * N * sizeof(fp16_t));
     
     for (size_t i = 0; i < M; i += MR) {
         size_t m_block = (i + MR <= M) ? MR : (M - i);
@@ -124,7 +51,7 @@ void apple_neon_matrix_multiply_f16(const __fp16* A, const __fp16* B, __fp16* C,
                 }
                 
                 for (size_t jj = 0; jj < n_block && (j + jj) < N; ++jj) {
-                    __fp16 b_vals[8];
+                    fp16_t b_vals[8];
                     for (int kk = 0; kk < 8 && (k + kk) < K; ++kk) {
                         b_vals[kk] = B[(k + kk) * N + (j + jj)];
                     }
@@ -138,9 +65,9 @@ void apple_neon_matrix_multiply_f16(const __fp16* A, const __fp16* B, __fp16* C,
             
             for (; k < K; ++k) {
                 for (size_t ii = 0; ii < m_block && (i + ii) < M; ++ii) {
-                    __fp16 a_val = A[(i + ii) * K + k];
+                    fp16_t a_val = A[(i + ii) * K + k];
                     for (size_t jj = 0; jj < n_block && (j + jj) < N; ++jj) {
-                        __fp16 b_val = B[k * N + (j + jj)];
+                        fp16_t b_val = B[k * N + (j + jj)];
                         C[(i + ii) * N + (j + jj)] += a_val * b_val;
                     }
                 }
@@ -148,7 +75,7 @@ void apple_neon_matrix_multiply_f16(const __fp16* A, const __fp16* B, __fp16* C,
             
             for (size_t ii = 0; ii < m_block && (i + ii) < M; ++ii) {
                 for (size_t jj = 0; jj < n_block && (j + jj) < N; ++jj) {
-                    __fp16 sum = vaddvq_f16(acc[ii][jj]);
+                    fp16_t sum = vaddvq_f16(acc[ii][jj]);
                     C[(i + ii) * N + (j + jj)] += sum;
                 }
             }
@@ -0,0 +1,280 @@
+#include "kipepeo/kernels/autotuner.h"
+#include "kipepeo/kernels/cpu_capabilities.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <mutex>
+#include <shared_mutex>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+
+#ifdef KIPEPEO_X86_ENABLED
+#include "kipepeo/kernels/x86/cpu_features.h"
+#endif
+
+namespace kipepeo {
+namespace kernels {
+
+namespace {
+
+// Bump when the meaning of a KernelConfig field changes; old caches are
+// then ignored like caches from another CPU
+constexpr int CACHE_FORMAT_VERSION = 1;
+constexpr const char* CACHE_MAGIC = "kipepeo-autotune";
+
+// A candidate is timed as the best of this many runs after a warm-up;
+// shapes whose warm-up alone takes longer than SLOW_RUN_NS are timed once
+constexpr int TIMED_RUNS = 3;
+constexpr int64_t SLOW_RUN_NS = 20 * 1000 * 1000;
+
+const char* const OP_NAMES[] = {
+    "gemv_ternary", "gemv_quaternary", "gemv_ternary_a8", "gemv_quaternary_a8",
+    "gemm_ternary", "gemm_quaternary", "matmul_f32",
+    "gemv_ternary_interleaved", "gemv_quaternary_interleaved",
+};
+constexpr size_t NUM_OPS = sizeof(OP_NAMES) / sizeof(OP_NAMES[0]);
+
+struct TuneKeyHash {
+    size_t operator()(const TuneKey& key) const {
+        uint64_t h = static_cast<uint64_t>(key.op);
+        for (uint32_t v : {key.M, key.N, key.K, key.block_size}) {
+            h = h * 0x9E3779B97F4A7C15ull + v;
+            h ^= h >> 29;
+        }
+        return static_cast<size_t>(h);
+    }
+};
+
+uint64_t fnv1a(const std::string& text) {
+    uint64_t h = 0xCBF29CE484222325ull;
+    for (unsigned char c : text) {
+        h ^= c;
+        h *= 0x100000001B3ull;
+    }
+    return h;
+}
+
+int64_t time_run_ns(const std::function<void(const KernelConfig&)>& run, const KernelConfig& config) {
+    auto start = std::chrono::steady_clock::now();
+    run(config);
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+}
+
+std::string compute_cpu_signature() {
+    const CpuCapabilities& caps = get_cpu_capabilities();
+    std::ostringstream text;
+    text << CACHE_FORMAT_VERSION << ' ' << get_chip_name(caps.chip)
+         << " threads=" << std::thread::hardware_concurrency();
+
+    // Core models: "CPU part" per core on ARM, "model name" on x86
+    std::ifstream cpuinfo("/proc/cpuinfo");
+    std::string line;
+    while (std::getline(cpuinfo, line)) {
+        if (line.compare(0, 8, "CPU part") == 0 || line.compare(0, 10, "model name") == 0 ||
+            line.compare(0, 8, "Hardware") == 0) {
+            text << ' ' << line.substr(line.find(':') + 1);
+        }
+    }
+    for (const CpuCore& core : caps.cores) {
+        text << ' ' << core.cpu << ':' << core.capacity;
+    }
+    text << " L1=" << caps.caches.l1_data << " L2=" << caps.caches.l2 << " L3=" << caps.caches.l3;
+#ifdef KIPEPEO_X86_ENABLED
+    // KIPEPEO_X86_LEVEL caps change which kernels exist
+    text << ' ' << x86::get_x86_level_name(x86::get_x86_level());
+#endif
+
+    char hex[17];
+    std::snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(fnv1a(text.str())));
+    return hex;
+}
+
+} // anonymous namespace
+
+std::string get_cpu_signature() {
+    static const std::string signature = compute_cpu_signature();
+    return signature;
+}
+
+class KernelAutotuner::Impl {
+public:
+    std::atomic<bool> enabled{false};
+    std::atomic<size_t> count{0};   // Lets lookups skip the lock while nothing is tuned
+
+    mutable std::shared_mutex map_mutex;
+    std::unordered_map<TuneKey, KernelConfig, TuneKeyHash> configs;
+
+    std::mutex tune_mutex;   // One shape is tuned at a time; guards path
+    std::string path;
+
+    bool load(const std::string& file_path) {
+        std::FILE* probe = std::fopen(file_path.c_str(), "r");
+        if (!probe) {
+            // A missing file is created on the first result
+            return errno == ENOENT;
+        }
+        std::fclose(probe);
+        std::ifstream file(file_path);
+
+        std::string magic, signature;
+        int version = 0;
+        if (!(file >> magic >> version >> signature)) {
+            return false;
+        }
+        if (magic != CACHE_MAGIC || version != CACHE_FORMAT_VERSION || signature != get_cpu_signature()) {
+            return true;   // Another device or library version: retune
+        }
+
+        std::string op_name;
+        TuneKey key;
+        KernelConfig config;
+        std::unique_lock<std::shared_mutex> lock(map_mutex);
+        while (file >> op_name >> key.M >> key.N >> key.K >> key.block_size >>
+               config.variant >> config.MR >> config.NR >> config.KC >> config.grain) {
+            size_t op = 0;
+            while (op < NUM_OPS && op_name != OP_NAMES[op]) {
+                ++op;
+            }
+            if (op == NUM_OPS) {
+                continue;
+            }
+            key.op = static_cast<TunedOp>(op);
+            configs[key] = config;
+        }
+        count.store(configs.size(), std::memory_order_release);
+        return true;
+    }
+
+    // Whole file rewritten through a temporary, so a crash never leaves a
+    // half-written cache behind
+    void save() {
+        if (path.empty()) {
+            return;
+        }
+        std::string tmp_path = path + ".tmp";
+        {
+            std::ofstream file(tmp_path, std::ios::trunc);
+            if (!file.is_open()) {
+                return;
+            }
+            file << CACHE_MAGIC << ' ' << CACHE_FORMAT_VERSION << ' ' << get_cpu_signature() << '\n';
+            std::shared_lock<std::shared_mutex> lock(map_mutex);
+            for (const auto& entry : configs) {
+                const TuneKey& key = entry.first;
+                const KernelConfig& config = entry.second;
+                file << OP_NAMES[static_cast<size_t>(key.op)] << ' ' << key.M << ' ' << key.N << ' '
+                     << key.K << ' ' << key.block_size << ' ' << config.variant << ' ' << config.MR << ' '
+                     << config.NR << ' ' << config.KC << ' ' << config.grain << '\n';
+            }
+            if (!file.good()) {
+                return;
+            }
+        }
+        std::rename(tmp_path.c_str(), path.c_str());
+    }
+};
+
+KernelAutotuner::KernelAutotuner()
+    : impl_(new Impl()) {}
+
+KernelAutotuner::~KernelAutotuner() {
+    delete impl_;
+}
+
+bool KernelAutotuner::set_cache_path(const std::string& path) {
+    std::lock_guard<std::mutex> lock(impl_->tune_mutex);
+    impl_->path = path;
+    impl_->enabled.store(true, std::memory_order_relaxed);
+    return impl_->load(path);
+}
+
+void KernelAutotuner::set_enabled(bool enabled) {
+    impl_->enabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool KernelAutotuner::enabled() const {
+    return impl_->enabled.load(std::memory_order_relaxed);
+}
+
+bool KernelAutotuner::lookup(const TuneKey& key, KernelConfig& config) const {
+    if (impl_->count.load(std::memory_order_acquire) == 0) {
+        return false;
+    }
+    std::shared_lock<std::shared_mutex> lock(impl_->map_mutex);
+    auto it = impl_->configs.find(key);
+    if (it == impl_->configs.end()) {
+        return false;
+    }
+    config = it->second;
+    return true;
+}
+
+KernelConfig KernelAutotuner::tune(const TuneKey& key, const std::vector<KernelConfig>& candidates,
+                                   const std::function<void(const KernelConfig&)>& run) {
+    if (candidates.empty()) {
+        return KernelConfig{};
+    }
+    if (!enabled() || candidates.size() == 1) {
+        return candidates[0];
+    }
+
+    std::lock_guard<std::mutex> lock(impl_->tune_mutex);
+    // Another thread may have tuned this shape while we waited
+    KernelConfig config;
+    if (lookup(key, config)) {
+        return config;
+    }
+
+    int64_t best_ns = -1;
+    for (const KernelConfig& candidate : candidates) {
+        int64_t ns = time_run_ns(run, candidate);   // Warm-up
+        if (ns < SLOW_RUN_NS) {
+            ns = time_run_ns(run, candidate);
+            for (int i = 1; i < TIMED_RUNS; ++i) {
+                ns = std::min(ns, time_run_ns(run, candidate));
+            }
+        }
+        if (best_ns < 0 || ns < best_ns) {
+            best_ns = ns;
+            config = candidate;
+        }
+    }
+
+    {
+        std::unique_lock<std::shared_mutex> map_lock(impl_->map_mutex);
+        impl_->configs[key] = config;
+        impl_->count.store(impl_->configs.size(), std::memory_order_release);
+    }
+    impl_->save();
+    return config;
+}
+
+void KernelAutotuner::clear() {
+    std::lock_guard<std::mutex> lock(impl_->tune_mutex);
+    std::unique_lock<std::shared_mutex> map_lock(impl_->map_mutex);
+    impl_->configs.clear();
+    impl_->count.store(0, std::memory_order_release);
+}
+
+size_t KernelAutotuner::size() const {
+    return impl_->count.load(std::memory_order_acquire);
+}
+
+KernelAutotuner& get_kernel_autotuner() {
+    static KernelAutotuner tuner;
+    static const bool from_environment = [] {
+        const char* path = std::getenv("KIPEPEO_AUTOTUNE_CACHE");
+        return path && *path != '\0' && tuner.set_cache_path(path);
+    }();
+    (void)from_environment;
+    return tuner;
+}
+
+} // namespace kernels
+} // namespace kipepeo
@@ -2,20 +2,22 @@
 #include <cstring>
 #include <cstdio>
 #include <fstream>
+#include <mutex>
 #include <string>
+#include <thread>
 
 #ifdef __ANDROID__
 #include <sys/system_properties.h>
 #endif
 
+#ifdef __APPLE__
+#include <sys/sysctl.h>
+#endif
+
 namespace kipepeo {
 namespace kernels {
 
 namespace {
-    // Cache detected chip type
-    ChipType g_detected_chip = ChipType::UNKNOWN;
-    bool g_chip_detected = false;
-
     // Helper function to read /proc/cpuinfo
     std::string read_cpuinfo() {
         std::string result;
@@ -170,26 +172,25 @@ namespace {
 } // anonymous namespace
 
 ChipType detect_chip() {
-    if (g_chip_detected) {
-        return g_detected_chip;
-    }
-
+    // Detected once; concurrent first callers wait for the same result
+    static std::once_flag once;
+    static ChipType detected_chip = ChipType::UNKNOWN;
+    std::call_once(once, [] {
 #ifdef __APPLE__
-    g_detected_chip = detect_apple_chip();
+        detected_chip = detect_apple_chip();
 #elif defined(__ANDROID__)
-    // Try Android system properties first
-    g_detected_chip = detect_from_android_props();
-    if (g_detected_chip == ChipType::UNKNOWN) {
-        // Fallback to /proc/cpuinfo
-        g_detected_chip = detect_from_cpuinfo();
-    }
+        // Try Android system properties first
+        detected_chip = detect_from_android_props();
+        if (detected_chip == ChipType::UNKNOWN) {
+            // Fallback to /proc/cpuinfo
+            detected_chip = detect_from_cpuinfo();
+        }
 #else
-    // Linux or other platforms
-    g_detected_chip = detect_from_cpuinfo();
+        // Linux or other platforms
+        detected_chip = detect_from_cpuinfo();
 #endif
-
-    g_chip_detected = true;
-    return g_detected_chip;
+    });
+    return detected_chip;
 }
 
 const char* get_chip_name(ChipType chip) {
@@ -300,6 +301,181 @@ void get_optimal_block_size(ChipType chip, bool is_big_core, size_t& MR, size_t&
     }
 }
 
+CoreLayout get_chip_core_layout(ChipType chip) {
+    switch (chip) {
+        case ChipType::MEDIATEK_HELIO_G85:
+        case ChipType::UNISOC_T606:
+            // 2x Cortex-A75 + 6x Cortex-A55
+            return {2, 6, 1.8f};
+
+        case ChipType::MEDIATEK_HELIO_G99:
+        case ChipType::MEDIATEK_HELIO_G100:
+            // 2x Cortex-A76 + 6x Cortex-A55
+            return {2, 6, 2.2f};
+
+        case ChipType::QUALCOMM_SNAPDRAGON_7S_GEN2:
+            // 4x Cortex-A78 + 4x Cortex-A55
+            return {4, 4, 2.5f};
+
+        case ChipType::APPLE_A13:
+        case ChipType::APPLE_A14:
+        case ChipType::APPLE_A15:
+        case ChipType::APPLE_A16:
+        case ChipType::APPLE_A17:
+        case ChipType::APPLE_A18:
+            // 2 performance + 4 efficiency cores
+            return {2, 4, 3.0f};
+
+        case ChipType::APPLE_M1:
+        case ChipType::APPLE_M2:
+        case ChipType::APPLE_M3:
+            return {4, 4, 3.0f};
+
+        case ChipType::APPLE_M4:
+            return {4, 6, 3.0f};
+
+        default:
+            return {0, 0, 1.0f};
+    }
+}
+
+namespace {
+    // First unsigned integer in a sysfs attribute, 0 if unreadable
+    uint64_t read_sysfs_value(const std::string& path) {
+        std::ifstream file(path);
+        uint64_t value = 0;
+        if (!(file >> value)) {
+            return 0;
+        }
+        return value;
+    }
+
+    // sysfs cache size ("32K", "2048K", "8M") in bytes, 0 if unreadable
+    size_t read_sysfs_size(const std::string& path) {
+        std::ifstream file(path);
+        size_t value = 0;
+        if (!(file >> value)) {
+            return 0;
+        }
+        char unit = 0;
+        file >> unit;
+        if (unit == 'K') {
+            value *= 1024;
+        } else if (unit == 'M') {
+            value *= 1024 * 1024;
+        }
+        return value;
+    }
+} // anonymous namespace
+
+std::vector<CpuCore> read_cpu_topology() {
+    std::vector<CpuCore> cores;
+    unsigned hw = std::thread::hardware_concurrency();
+    if (hw == 0) {
+        return cores;
+    }
+
+    const std::string base = "/sys/devices/system/cpu/cpu";
+    std::vector<uint64_t> capacity(hw), max_freq(hw);
+    bool have_capacity = true;
+    bool have_freq = true;
+    for (unsigned cpu = 0; cpu < hw; ++cpu) {
+        capacity[cpu] = read_sysfs_value(base + std::to_string(cpu) + "/cpu_capacity");
+        max_freq[cpu] = read_sysfs_value(base + std::to_string(cpu) + "/cpufreq/cpuinfo_max_freq");
+        have_capacity = have_capacity && capacity[cpu] > 0;
+        have_freq = have_freq && max_freq[cpu] > 0;
+    }
+
+    if (have_capacity) {
+        for (unsigned cpu = 0; cpu < hw; ++cpu) {
+            cores.push_back({static_cast<int>(cpu), static_cast<uint32_t>(capacity[cpu])});
+        }
+        return cores;
+    }
+
+    // Without cpu_capacity the known SoCs use their table (little cores
+    // numbered first); frequency alone undervalues the big cores' wider
+    // pipelines, so it is the last resort
+    CoreLayout layout = get_chip_core_layout(detect_chip());
+    if (layout.big_cores + layout.little_cores == hw) {
+        uint32_t little = static_cast<uint32_t>(1024.0f / layout.big_core_speed);
+        for (unsigned cpu = 0; cpu < hw; ++cpu) {
+            cores.push_back({static_cast<int>(cpu), cpu < layout.little_cores ? little : 1024u});
+        }
+        return cores;
+    }
+
+    if (have_freq) {
+        uint64_t fastest = 0;
+        for (uint64_t freq : max_freq) {
+            fastest = freq > fastest ? freq : fastest;
+        }
+        for (unsigned cpu = 0; cpu < hw; ++cpu) {
+            cores.push_back({static_cast<int>(cpu), static_cast<uint32_t>(max_freq[cpu] * 1024 / fastest)});
+        }
+    }
+    return cores;
+}
+
+CacheSizes read_cache_sizes() {
+    CacheSizes sizes = {32 * 1024, 256 * 1024, 0};
+
+#ifdef __APPLE__
+    uint64_t value = 0;
+    size_t length = sizeof(value);
+    // perflevel0 is the performance cluster; older systems only have the
+    // unqualified names
+    if (sysctlbyname("hw.perflevel0.l1dcachesize", &value, &length, nullptr, 0) == 0 ||
+        sysctlbyname("hw.l1dcachesize", &value, &length, nullptr, 0) == 0) {
+        sizes.l1_data = value;
+    }
+    length = sizeof(value);
+    if (sysctlbyname("hw.perflevel0.l2cachesize", &value, &length, nullptr, 0) == 0 ||
+        sysctlbyname("hw.l2cachesize", &value, &length, nullptr, 0) == 0) {
+        sizes.l2 = value;
+    }
+    length = sizeof(value);
+    if (sysctlbyname("hw.l3cachesize", &value, &length, nullptr, 0) == 0) {
+        sizes.l3 = value;
+    }
+#else
+    // Kernels run on the big cores first, so their caches set the blocking
+    int cpu = 0;
+    uint32_t best = 0;
+    for (const CpuCore& core : read_cpu_topology()) {
+        if (core.capacity > best) {
+            best = core.capacity;
+            cpu = core.cpu;
+        }
+    }
+
+    const std::string base = "/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/cache/index";
+    for (int index = 0; index < 8; ++index) {
+        std::string dir = base + std::to_string(index) + "/";
+        uint64_t level = read_sysfs_value(dir + "level");
+        size_t size = read_sysfs_size(dir + "size");
+        if (level == 0 || size == 0) {
+            continue;
+        }
+        std::ifstream type_file(dir + "type");
+        std::string type;
+        type_file >> type;
+        if (type == "Instruction") {
+            continue;
+        }
+        if (level == 1) {
+            sizes.l1_data = size;
+        } else if (level == 2) {
+            sizes.l2 = size;
+        } else if (level == 3) {
+            sizes.l3 = size;
+        }
+    }
+#endif
+
+    return sizes;
+}
+
 } // namespace kernels
 } // namespace kipepeo
 
@@ -0,0 +1,164 @@
+#include "kipepeo/kernels/cpu_capabilities.h"
+#include <algorithm>
+#include <fstream>
+#include <mutex>
+#include <thread>
+
+#if defined(__linux__) || defined(__ANDROID__)
+#include <sys/sysinfo.h>
+#include <unistd.h>
+#endif
+
+#if defined(__aarch64__) && (defined(__linux__) || defined(__ANDROID__))
+#include <sys/auxv.h>
+#endif
+
+#ifdef __APPLE__
+#include <sys/sysctl.h>
+#include <unistd.h>
+#endif
+
+#ifdef KIPEPEO_X86_ENABLED
+#include "kipepeo/kernels/x86/cpu_features.h"
+#endif
+
+namespace kipepeo {
+namespace kernels {
+
+namespace {
+
+#if defined(__aarch64__) && (defined(__linux__) || defined(__ANDROID__))
+// AArch64 HWCAP bits (asm/hwcap.h), spelled out for older NDK headers
+constexpr unsigned long HWCAP_BIT_FPHP = 1ul << 9;
+constexpr unsigned long HWCAP_BIT_ASIMDHP = 1ul << 10;
+constexpr unsigned long HWCAP_BIT_ASIMDDP = 1ul << 20;
+#endif
+
+#if defined(__APPLE__) && defined(__aarch64__)
+bool sysctl_flag(const char* name) {
+    int value = 0;
+    size_t length = sizeof(value);
+    return sysctlbyname(name, &value, &length, nullptr, 0) == 0 && value != 0;
+}
+#endif
+
+void detect_isa(CpuCapabilities& caps) {
+#ifdef KIPEPEO_NEON_ENABLED
+    caps.has_neon = true;
+#endif
+    caps.has_fp16 = chip_supports_fp16(caps.chip);
+
+#if defined(__aarch64__) && (defined(__linux__) || defined(__ANDROID__))
+    unsigned long hwcap = getauxval(AT_HWCAP);
+    caps.has_fp16 = (hwcap & HWCAP_BIT_FPHP) && (hwcap & HWCAP_BIT_ASIMDHP);
+    caps.has_dotprod = (hwcap & HWCAP_BIT_ASIMDDP) != 0;
+#elif defined(__APPLE__) && defined(__aarch64__)
+    caps.has_fp16 = sysctl_flag("hw.optional.arm.FEAT_FP16") || caps.has_fp16;
+    caps.has_dotprod = sysctl_flag("hw.optional.arm.FEAT_DotProd");
+#endif
+
+#ifdef KIPEPEO_X86_ENABLED
+    x86::X86Level level = x86::get_x86_level();
+    caps.has_avx2 = level >= x86::X86Level::AVX2;
+    caps.has_avx512 = level >= x86::X86Level::AVX512;
+#endif
+}
+
+void detect_clusters(CpuCapabilities& caps) {
+    caps.cores = read_cpu_topology();
+    uint32_t fastest = 0;
+    for (const CpuCore& core : caps.cores) {
+        fastest = std::max(fastest, core.capacity);
+    }
+    for (const CpuCore& core : caps.cores) {
+        if (core.capacity == fastest) {
+            ++caps.big_cores;
+        } else {
+            ++caps.little_cores;
+        }
+    }
+
+#if defined(__linux__) || defined(__ANDROID__) || defined(__APPLE__)
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    caps.cpu_count = online > 0 ? static_cast<uint32_t>(online) : 0;
+#endif
+    if (caps.cpu_count == 0) {
+        caps.cpu_count = std::max(1u, std::thread::hardware_concurrency());
+    }
+    if (caps.cores.empty()) {
+        caps.big_cores = caps.cpu_count;
+    }
+}
+
+void detect_memory(CpuCapabilities& caps) {
+#if defined(__linux__) || defined(__ANDROID__)
+    struct sysinfo info;
+    if (sysinfo(&info) == 0) {
+        caps.total_memory = static_cast<size_t>(info.totalram) * info.mem_unit;
+    }
+    caps.available_memory = get_available_memory();
+#elif defined(__APPLE__)
+    uint64_t value = 0;
+    size_t length = sizeof(value);
+    if (sysctlbyname("hw.memsize", &value, &length, nullptr, 0) == 0) {
+        caps.total_memory = static_cast<size_t>(value);
+    }
+#endif
+}
+
+void detect_cpu_model(CpuCapabilities& caps) {
+    caps.cpu_model = "Unknown";
+    std::ifstream cpuinfo("/proc/cpuinfo");
+    std::string line;
+    while (std::getline(cpuinfo, line)) {
+        if (line.compare(0, 8, "Hardware") != 0 && line.compare(0, 10, "model name") != 0) {
+            continue;
+        }
+        size_t colon = line.find(':');
+        if (colon == std::string::npos) {
+            continue;
+        }
+        size_t begin = line.find_first_not_of(" \t", colon + 1);
+        size_t end = line.find_last_not_of(" \t\r");
+        if (begin != std::string::npos && end >= begin) {
+            caps.cpu_model = line.substr(begin, end - begin + 1);
+            return;
+        }
+    }
+#ifdef __APPLE__
+    char brand[128] = {};
+    size_t length = sizeof(brand);
+    if (sysctlbyname("machdep.cpu.brand_string", brand, &length, nullptr, 0) == 0 && brand[0] != '\0') {
+        caps.cpu_model = brand;
+    }
+#endif
+}
+
+} // anonymous namespace
+
+const CpuCapabilities& get_cpu_capabilities() {
+    static std::once_flag once;
+    static CpuCapabilities caps = {};
+    std::call_once(once, [] {
+        caps.chip = detect_chip();
+        detect_isa(caps);
+        caps.caches = read_cache_sizes();
+        detect_clusters(caps);
+        detect_memory(caps);
+        detect_cpu_model(caps);
+    });
+    return caps;
+}
+
+size_t get_available_memory() {
+#if defined(__linux__) || defined(__ANDROID__)
+    struct sysinfo info;
+    if (sysinfo(&info) == 0) {
+        return static_cast<size_t>(info.freeram) * info.mem_unit;
+    }
+#endif
+    return 0;
+}
+
+} // namespace kernels
+} // namespace kipepeo
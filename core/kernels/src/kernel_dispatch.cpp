@@ -1,30 +1,37 @@
 #include "kipepeo/kernels/kernel_dispatch.h"
 #include "kipepeo/kernels/chip_detection.h"
+#include "kipepeo/kernels/cpu_capabilities.h"
 #include "kipepeo/kernels/mediatek/helio_optimizations.h"
 #include "kipepeo/kernels/qualcomm/snapdragon_common.h"
 #include "kipepeo/kernels/unisoc/t606.h"
 #include "kipepeo/kernels/apple/neon_apple.h"
 #include "kipepeo/kernels/neon/matrix_multiply.h"
 #include "kipepeo/kernels/neon/quantized_gemm.h"
+#include "kipepeo/kernels/neon/fused_gemv.h"
+#include "kipepeo/kernels/thread_pool.h"
+#include "kipepeo/kernels/autotuner.h"
+#include "kipepeo/kernels/weight_prefetch.h"
+#include "kipepeo/kernels/neon/packed_gemm.h"
+#include "kipepeo/kernels/fp16.h"
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
+#ifdef KIPEPEO_X86_ENABLED
+#include "kipepeo/kernels/x86/x86_kernels.h"
+#endif
 
 namespace kipepeo {
 namespace kernels {
 
 namespace {
-    // Cache detected chip type
-    ChipType g_chip = ChipType::UNKNOWN;
-    bool g_chip_initialized = false;
-    
+    // Detected once per process (get_cpu_capabilities)
     ChipType get_chip() {
-        if (!g_chip_initialized) {
-            g_chip = detect_chip();
-            g_chip_initialized = true;
-        }
-        return g_chip;
+        return get_cpu_capabilities().chip;
     }
 } // anonymous namespace
 
-void matrix_multiply_f32_chip_optimized(const float* A, const float* B, float* C,
+static void matrix_multiply_f32_serial(const float* A, const float* B, float* C,
                                         size_t M, size_t N, size_t K) {
     ChipType chip = get_chip();
     
@@ -61,13 +68,14 @@ void matrix_multiply_f32_chip_optimized(const float* A, const float* B, float* C
             break;
             
         default:
-            // Fallback to generic NEON
+            // Generic packed GEMM; on desktop / CI hosts it picks the
+            // AVX-512 or AVX2 micro-kernel by CPUID
             neon::matrix_multiply_f32(A, B, C, M, N, K);
             break;
     }
 }
 
-void matrix_multiply_f16_chip_optimized(const __fp16* A, const __fp16* B, __fp16* C,
+static void matrix_multiply_f16_serial(const fp16_t* A, const fp16_t* B, fp16_t* C,
                                         size_t M, size_t N, size_t K) {
     ChipType chip = get_chip();
     
@@ -109,7 +117,7 @@ void matrix_multiply_f16_chip_optimized(const __fp16* A, const __fp16* B, __fp16
     }
 }
 
-void gemv_ternary_1_28bit_chip_optimized(
+static void gemv_ternary_1_28bit_serial(
     size_t M, size_t K, float alpha,
     const uint8_t* A_quantized, const float* A_scales,
     const float* X, float beta, float* Y, size_t block_size) {
@@ -153,7 +161,7 @@ void gemv_ternary_1_28bit_chip_optimized(
     }
 }
 
-void gemv_quaternary_1_58bit_chip_optimized(
+static void gemv_quaternary_1_58bit_serial(
     size_t M, size_t K, float alpha,
     const uint8_t* A_quantized, const float* A_scales,
     const float* X, float beta, float* Y, size_t block_size) {
@@ -197,6 +205,732 @@ void gemv_quaternary_1_58bit_chip_optimized(
     }
 }
 
+static void gemv_ternary_1_28bit_a8_serial(
+    size_t M, size_t K, float alpha,
+    const uint8_t* A_quantized, const float* A_scales,
+    const int8_t* X_q, const float* X_scales,
+    float beta, float* Y, size_t block_size) {
+    // No chip-specific int8-activation kernels yet; the generic kernel uses
+    // sdot when the library is built for ARMv8.2-A dotprod (KIPEPEO_ARM_DOTPROD)
+    neon::gemv_ternary_1_28bit_a8(M, K, alpha, A_quantized, A_scales, X_q, X_scales, beta, Y, block_size);
+}
+
+static void gemv_quaternary_1_58bit_a8_serial(
+    size_t M, size_t K, float alpha,
+    const uint8_t* A_quantized, const float* A_scales,
+    const int8_t* X_q, const float* X_scales,
+    float beta, float* Y, size_t block_size) {
+    neon::gemv_quaternary_1_58bit_a8(M, K, alpha, A_quantized, A_scales, X_q, X_scales, beta, Y, block_size);
+}
+
+void get_quantized_gemm_tile(size_t& MR, size_t& NR) {
+    get_optimal_block_size(get_chip(), current_thread_on_big_core(), MR, NR);
+}
+
+size_t get_quantized_gemm_batch_grain() {
+    // Whole tiles on either cluster, and at least 32 vectors per claim:
+    // every claim decodes the full weight matrix again
+    size_t big_MR, big_NR, little_MR, little_NR;
+    get_optimal_block_size(get_chip(), true, big_MR, big_NR);
+    get_optimal_block_size(get_chip(), false, little_MR, little_NR);
+    size_t tile = std::lcm(big_NR, little_NR);
+    return (32 + tile - 1) / tile * tile;
+}
+
+size_t get_gemv_interleave_rows() {
+#ifdef KIPEPEO_X86_ENABLED
+    // 16 ymm registers hold 8 accumulators plus the shared activations
+    if (x86::get_x86_level() >= x86::X86Level::AVX2) {
+        return 8;
+    }
+#endif
+    // Eight rows in flight only pay off on cores that already run the
+    // wider GEMM tiles; the rest stay at four
+    size_t MR, NR;
+    get_optimal_block_size(get_chip(), true, MR, NR);
+    return MR >= 8 ? 8 : 4;
+}
+
+// Tuned register tile (KernelConfig::MR / NR) on the big cores, where
+// tuning ran; little cores keep the chip's tile
+static void quantized_gemm_tile(const KernelConfig& config, size_t& MR, size_t& NR) {
+    if (config.MR != 0 && current_thread_on_big_core()) {
+        MR = config.MR;
+        NR = config.NR;
+    } else {
+        get_quantized_gemm_tile(MR, NR);
+    }
+}
+
+static void gemm_ternary_1_28bit_serial(
+    const KernelConfig& config,
+    size_t M, size_t N, size_t K, float alpha,
+    const uint8_t* A_quantized, const float* A_scales,
+    const float* X, float beta, float* Y, size_t block_size) {
+    size_t MR, NR;
+    quantized_gemm_tile(config, MR, NR);
+    neon::gemm_ternary_1_28bit(M, N, K, alpha, A_quantized, A_scales, X, beta, Y, block_size, MR, NR);
+}
+
+static void gemm_quaternary_1_58bit_serial(
+    const KernelConfig& config,
+    size_t M, size_t N, size_t K, float alpha,
+    const uint8_t* A_quantized, const float* A_scales,
+    const float* X, float beta, float* Y, size_t block_size) {
+    size_t MR, NR;
+    quantized_gemm_tile(config, MR, NR);
+    neon::gemm_quaternary_1_58bit(M, N, K, alpha, A_quantized, A_scales, X, beta, Y, block_size, MR, NR);
+}
+
+// ========== Autotuning ==========
+// Each entry point looks its shape up in the kernel autotuner. Untuned
+// shapes run the default configuration, or, with tuning enabled, time
+// every candidate once into scratch outputs and keep the fastest.
+
+namespace {
+    // Ranges of 16 rows keep each thread's Y writes on their own cache lines
+    constexpr size_t GEMV_ROW_GRAIN = 16;
+
+    // Tuning runs leave the caller's layer-ahead range to the real run
+    constexpr WeightPrefetchRange NO_PREFETCH = {nullptr, 0};
+
+    TuneKey make_key(TunedOp op, size_t M, size_t N, size_t K, size_t block_size) {
+        return {op, static_cast<uint32_t>(M), static_cast<uint32_t>(N),
+                static_cast<uint32_t>(K), static_cast<uint32_t>(block_size)};
+    }
+
+    // Candidate lists start with the untuned default (KernelConfig{})
+
+    const std::vector<KernelConfig>& gemv_candidates() {
+        static const std::vector<KernelConfig> candidates = [] {
+            std::vector<KernelConfig> list;
+            // Unknown chips already run the generic kernel
+            uint32_t variants = get_chip() == ChipType::UNKNOWN ? 1 : 2;
+            for (uint32_t variant = 0; variant < variants; ++variant) {
+                for (uint32_t grain : {0u, 64u, 256u}) {
+                    list.push_back({variant, 0, 0, 0, grain});
+                }
+            }
+            return list;
+        }();
+        return candidates;
+    }
+
+    const std::vector<KernelConfig>& gemv_a8_candidates() {
+        static const std::vector<KernelConfig> candidates = {
+            {KERNEL_VARIANT_CHIP, 0, 0, 0, 0},
+            {KERNEL_VARIANT_CHIP, 0, 0, 0, 64},
+            {KERNEL_VARIANT_CHIP, 0, 0, 0, 256},
+        };
+        return candidates;
+    }
+
+    // Split granularity only; every grain is a multiple of 8, so ranges
+    // stay on panel boundaries for both panel heights
+    const std::vector<KernelConfig>& gemv_interleaved_candidates() {
+        static const std::vector<KernelConfig> candidates = {
+            {KERNEL_VARIANT_CHIP, 0, 0, 0, 0},
+            {KERNEL_VARIANT_CHIP, 0, 0, 0, 64},
+            {KERNEL_VARIANT_CHIP, 0, 0, 0, 256},
+        };
+        return candidates;
+    }
+
+    // Register tiles instantiated by the quantized GEMM (select_gemm_tile)
+    const std::vector<KernelConfig>& quantized_gemm_candidates() {
+        static const std::vector<KernelConfig> candidates = {
+            {KERNEL_VARIANT_CHIP, 0, 0, 0, 0},
+            {KERNEL_VARIANT_CHIP, 4, 4, 0, 0},
+            {KERNEL_VARIANT_CHIP, 4, 8, 0, 0},
+            {KERNEL_VARIANT_CHIP, 6, 8, 0, 0},
+            {KERNEL_VARIANT_CHIP, 8, 4, 0, 0},
+            {KERNEL_VARIANT_CHIP, 8, 8, 0, 0},
+        };
+        return candidates;
+    }
+
+    // Distinct packed-GEMM micro-tiles on this CPU times a few KC depths
+    const std::vector<KernelConfig>& matmul_f32_candidates() {
+        static const std::vector<KernelConfig> candidates = [] {
+            std::vector<KernelConfig> list = {KernelConfig{}};
+            std::vector<std::pair<size_t, size_t>> tiles;
+            for (auto hint : {std::make_pair(4, 4), std::make_pair(4, 8),
+                              std::make_pair(6, 8), std::make_pair(8, 8)}) {
+                size_t MR, NR;
+                neon::get_gemm_f32_micro_tile(hint.first, hint.second, MR, NR);
+                if (std::find(tiles.begin(), tiles.end(), std::make_pair(MR, NR)) != tiles.end()) {
+                    continue;
+                }
+                tiles.emplace_back(MR, NR);
+                for (uint32_t KC : {128u, 256u, 512u}) {
+                    list.push_back({KERNEL_VARIANT_GENERIC, static_cast<uint32_t>(hint.first),
+                                    static_cast<uint32_t>(hint.second), KC, 0});
+                }
+            }
+            return list;
+        }();
+        return candidates;
+    }
+
+    // O(1) lookup; run is only wrapped in a std::function when tuning
+    template <typename RunFn>
+    KernelConfig tuned_config(const TuneKey& key, const std::vector<KernelConfig>& (*candidates)(),
+                              RunFn&& run) {
+        KernelAutotuner& tuner = get_kernel_autotuner();
+        KernelConfig config = {};
+        if (tuner.lookup(key, config) || !tuner.enabled()) {
+            return config;
+        }
+        return tuner.tune(key, candidates(), run);
+    }
+} // anonymous namespace
+
+// ========== Multithreaded entry points ==========
+// GEMVs and FP32 matmuls split their output rows across the kernel thread
+// pool, the quantized GEMMs split the activation batch. Every range is an
+// ordinary call of the serial kernel on an offset view of the operands.
+
+static void matrix_multiply_f32_run(const KernelConfig& config, const float* A, const float* B, float* C,
+                                    size_t M, size_t N, size_t K) {
+    // Every range packs all of B again (neon::gemm_f32_packed), so ranges
+    // are at least 64 rows to keep packing small next to the FMAs
+    size_t MR, NR;
+    get_optimal_block_size(get_chip(), true, MR, NR);
+    size_t grain = (64 + MR - 1) / MR * MR;
+    neon::GemmBlocking blocking = {};
+    if (config.MR != 0) {
+        size_t tile_mr, tile_nr;
+        neon::get_gemm_f32_micro_tile(config.MR, config.NR, tile_mr, tile_nr);
+        blocking = neon::get_gemm_f32_blocking(tile_mr, tile_nr);
+        blocking.KC = config.KC != 0 ? config.KC : blocking.KC;
+    }
+    get_kernel_thread_pool().parallel_for(M, grain, N * K, [&](size_t begin, size_t end) {
+        if (config.MR != 0) {
+            neon::gemm_f32_packed(A + begin * K, B, C + begin * N, end - begin, N, K,
+                                  config.MR, config.NR, blocking);
+        } else {
+            matrix_multiply_f32_serial(A + begin * K, B, C + begin * N, end - begin, N, K);
+        }
+    });
+}
+
+void matrix_multiply_f32_chip_optimized(const float* A, const float* B, float* C,
+                                        size_t M, size_t N, size_t K) {
+    std::vector<float> scratch;
+    KernelConfig config = tuned_config(make_key(TunedOp::MATMUL_F32, M, N, K, 0), matmul_f32_candidates,
+        [&](const KernelConfig& candidate) {
+            scratch.resize(M * N);
+            matrix_multiply_f32_run(candidate, A, B, scratch.data(), M, N, K);
+        });
+    matrix_multiply_f32_run(config, A, B, C, M, N, K);
+}
+
+void matrix_multiply_f16_chip_optimized(const fp16_t* A, const fp16_t* B, fp16_t* C,
+                                        size_t M, size_t N, size_t K) {
+    size_t MR, NR;
+    get_optimal_block_size(get_chip(), true, MR, NR);
+    get_kernel_thread_pool().parallel_for(M, MR, N * K, [&](size_t begin, size_t end) {
+        matrix_multiply_f16_serial(A + begin * K, B, C + begin * N, end - begin, N, K);
+    });
+}
+
+// ahead: layer-ahead range warmed while this run computes
+static void gemv_2bit_run(
+    const KernelConfig& config, const WeightPrefetchRange& ahead, bool quaternary,
+    size_t M, size_t K, float alpha,
+    const uint8_t* A_quantized, const float* A_scales,
+    const float* X, float beta, float* Y, size_t block_size) {
+    size_t row_bytes = (K * 2 + 7) / 8;
+    size_t num_blocks_per_row = (K + block_size - 1) / block_size;
+    size_t grain = config.grain != 0 ? config.grain : GEMV_ROW_GRAIN;
+    bool generic = config.variant == KERNEL_VARIANT_GENERIC;
+    get_kernel_thread_pool().parallel_for(M, grain, K, [&](size_t begin, size_t end) {
+        for_rows_prefetching(ahead, M, begin, end, GEMV_ROW_GRAIN, [&](size_t b, size_t e) {
+            const uint8_t* A = A_quantized + b * row_bytes;
+            const float* S = A_scales + b * num_blocks_per_row;
+            if (quaternary) {
+                if (generic) {
+                    neon::gemv_quaternary_1_58bit(e - b, K, alpha, A, S, X, beta, Y + b, block_size);
+                } else {
+                    gemv_quaternary_1_58bit_serial(e - b, K, alpha, A, S, X, beta, Y + b, block_size);
+                }
+            } else {
+                if (generic) {
+                    neon::gemv_ternary_1_28bit(e - b, K, alpha, A, S, X, beta, Y + b, block_size);
+                } else {
+                    gemv_ternary_1_28bit_serial(e - b, K, alpha, A, S, X, beta, Y + b, block_size);
+                }
+            }
+        });
+    });
+}
+
+void gemv_ternary_1_28bit_chip_optimized(
+    size_t M, size_t K, float alpha,
+    const uint8_t* A_quantized, const float* A_scales,
+    const float* X, float beta, float* Y, size_t block_size) {
+    std::vector<float> scratch;
+    KernelConfig config = tuned_config(make_key(TunedOp::GEMV_TERNARY, M, 1, K, block_size), gemv_candidates,
+        [&](const KernelConfig& candidate) {
+            scratch.resize(M);
+            gemv_2bit_run(candidate, NO_PREFETCH, false, M, K, alpha, A_quantized, A_scales, X, beta,
+                          scratch.data(), block_size);
+        });
+    gemv_2bit_run(config, take_next_weights(), false, M, K, alpha, A_quantized, A_scales, X, beta, Y,
+                  block_size);
+}
+
+void gemv_quaternary_1_58bit_chip_optimized(
+    size_t M, size_t K, float alpha,
+    const uint8_t* A_quantized, const float* A_scales,
+    const float* X, float beta, float* Y, size_t block_size) {
+    std::vector<float> scratch;
+    KernelConfig config = tuned_config(make_key(TunedOp::GEMV_QUATERNARY, M, 1, K, block_size), gemv_candidates,
+        [&](const KernelConfig& candidate) {
+            scratch.resize(M);
+            gemv_2bit_run(candidate, NO_PREFETCH, true, M, K, alpha, A_quantized, A_scales, X, beta,
+                          scratch.data(), block_size);
+        });
+    gemv_2bit_run(config, take_next_weights(), true, M, K, alpha, A_quantized, A_scales, X, beta, Y,
+                  block_size);
+}
+
+static void gemv_2bit_interleaved(
+    bool quaternary, size_t M, size_t K, float alpha, const uint8_t* A, const float* S,
+    const float* X, float beta, float* Y, size_t block_size, size_t rows_per_group,
+    const OutlierEntry* outliers, size_t outliers_per_block) {
+    if (quaternary) {
+        neon::gemv_quaternary_1_58bit_interleaved(M, K, alpha, A, S, X, beta, Y, block_size,
+                                                  rows_per_group, outliers, outliers_per_block);
+    } else {
+        neon::gemv_ternary_1_28bit_interleaved(M, K, alpha, A, S, X, beta, Y, block_size,
+                                               rows_per_group, outliers, outliers_per_block);
+    }
+}
+
+static void gemv_2bit_interleaved(
+    bool quaternary, size_t M, size_t K, float alpha, const uint8_t* A, const uint16_t* S,
+    const float* X, float beta, float* Y, size_t block_size, size_t rows_per_group,
+    const OutlierEntry* outliers, size_t outliers_per_block) {
+    if (quaternary) {
+        neon::gemv_quaternary_1_58bit_interleaved_f16_scales(M, K, alpha, A, S, X, beta, Y, block_size,
+                                                             rows_per_group, outliers, outliers_per_block);
+    } else {
+        neon::gemv_ternary_1_28bit_interleaved_f16_scales(M, K, alpha, A, S, X, beta, Y, block_size,
+                                                          rows_per_group, outliers, outliers_per_block);
+    }
+}
+
+// Panels are rows_per_group consecutive rows of the row-major byte and
+// scale counts, so a range starting on a panel boundary is the same kernel
+// call on offset pointers. Grains are rounded up to whole panels.
+template <typename ScaleT>
+static void gemv_2bit_interleaved_run(
+    const KernelConfig& config, const WeightPrefetchRange& ahead, bool quaternary,
+    size_t M, size_t K, float alpha,
+    const uint8_t* A_interleaved, const ScaleT* A_scales,
+    const float* X, float beta, float* Y, size_t block_size, size_t rows_per_group,
+    const OutlierEntry* outliers, size_t outliers_per_block) {
+    size_t row_bytes = (K * 2 + 7) / 8;
+    size_t num_blocks_per_row = (K + block_size - 1) / block_size;
+    auto whole_panels = [rows_per_group](size_t rows) {
+        return (rows + rows_per_group - 1) / rows_per_group * rows_per_group;
+    };
+    size_t step = whole_panels(GEMV_ROW_GRAIN);
+    size_t grain = whole_panels(config.grain != 0 ? config.grain : GEMV_ROW_GRAIN);
+    get_kernel_thread_pool().parallel_for(M, grain, K, [&](size_t begin, size_t end) {
+        for_rows_prefetching(ahead, M, begin, end, step, [&](size_t b, size_t e) {
+            size_t offset = b * num_blocks_per_row;
+            gemv_2bit_interleaved(quaternary, e - b, K, alpha, A_interleaved + b * row_bytes,
+                                  A_scales + offset, X, beta, Y + b, block_size, rows_per_group,
+                                  outliers ? outliers + offset * outliers_per_block : nullptr,
+                                  outliers_per_block);
+        });
+    });
+}
+
+// fp32 and fp16 scales share a tuning entry: the grain only depends on
+// the shape
+template <typename ScaleT>
+static void gemv_2bit_interleaved_dispatch(
+    bool quaternary, size_t M, size_t K, float alpha,
+    const uint8_t* A_interleaved, const ScaleT* A_scales,
+    const float* X, float beta, float* Y, size_t block_size, size_t rows_per_group,
+    const OutlierEntry* outliers, size_t outliers_per_block) {
+    TunedOp op = quaternary ? TunedOp::GEMV_QUATERNARY_INTERLEAVED : TunedOp::GEMV_TERNARY_INTERLEAVED;
+    std::vector<float> scratch;
+    KernelConfig config = tuned_config(make_key(op, M, 1, K, block_size), gemv_interleaved_candidates,
+        [&](const KernelConfig& candidate) {
+            scratch.resize(M);
+            gemv_2bit_interleaved_run(candidate, NO_PREFETCH, quaternary, M, K, alpha, A_interleaved,
+                                      A_scales, X, beta, scratch.data(), block_size, rows_per_group,
+                                      outliers, outliers_per_block);
+        });
+    gemv_2bit_interleaved_run(config, take_next_weights(), quaternary, M, K, alpha, A_interleaved, A_scales,
+                              X, beta, Y, block_size, rows_per_group, outliers, outliers_per_block);
+}
+
+void gemv_ternary_1_28bit_interleaved_chip_optimized(
+    size_t M, size_t K, float alpha,
+    const uint8_t* A_interleaved, const float* A_scales,
+    const float* X, float beta, float* Y, size_t block_size, size_t rows_per_group,
+    const OutlierEntry* outliers, size_t outliers_per_block) {
+    gemv_2bit_interleaved_dispatch(false, M, K, alpha, A_interleaved, A_scales, X, beta, Y, block_size,
+                                   rows_per_group, outliers, outliers_per_block);
+}
+
+void gemv_ternary_1_28bit_interleaved_f16_scales_chip_optimized(
+    size_t M, size_t K, float alpha,
+    const uint8_t* A_interleaved, const uint16_t* A_scales,
+    const float* X, float beta, float* Y, size_t block_size, size_t rows_per_group,
+    const OutlierEntry* outliers, size_t outliers_per_block) {
+    gemv_2bit_interleaved_dispatch(false, M, K, alpha, A_interleaved, A_scales, X, beta, Y, block_size,
+                                   rows_per_group, outliers, outliers_per_block);
+}
+
+void gemv_quaternary_1_58bit_interleaved_chip_optimized(
+    size_t M, size_t K, float alpha,
+    const uint8_t* A_interleaved, const float* A_scales,
+    const float* X, float beta, float* Y, size_t block_size, size_t rows_per_group,
+    const OutlierEntry* outliers, size_t outliers_per_block) {
+    gemv_2bit_interleaved_dispatch(true, M, K, alpha, A_interleaved, A_scales, X, beta, Y, block_size,
+                                   rows_per_group, outliers, outliers_per_block);
+}
+
+void gemv_quaternary_1_58bit_interleaved_f16_scales_chip_optimized(
+    size_t M, size_t K, float alpha,
+    const uint8_t* A_interleaved, const uint16_t* A_scales,
+    const float* X, float beta, float* Y, size_t block_size, size_t rows_per_group,
+    const OutlierEntry* outliers, size_t outliers_per_block) {
+    gemv_2bit_interleaved_dispatch(true, M, K, alpha, A_interleaved, A_scales, X, beta, Y, block_size,
+                                   rows_per_group, outliers, outliers_per_block);
+}
+
+static void gemv_2bit_a8_run(
+    const KernelConfig& config, const WeightPrefetchRange& ahead, bool quaternary,
+    size_t M, size_t K, float alpha,
+    const uint8_t* A_quantized, const float* A_scales,
+    const int8_t* X_q, const float* X_scales,
+    float beta, float* Y, size_t block_size) {
+    size_t row_bytes = (K * 2 + 7) / 8;
+    size_t num_blocks_per_row = (K + block_size - 1) / block_size;
+    size_t grain = config.grain != 0 ? config.grain : GEMV_ROW_GRAIN;
+    get_kernel_thread_pool().parallel_for(M, grain, K, [&](size_t begin, size_t end) {
+        for_rows_prefetching(ahead, M, begin, end, GEMV_ROW_GRAIN, [&](size_t b, size_t e) {
+            const uint8_t* A = A_quantized + b * row_bytes;
+            const float* S = A_scales + b * num_blocks_per_row;
+            if (quaternary) {
+                gemv_quaternary_1_58bit_a8_serial(e - b, K, alpha, A, S, X_q, X_scales, beta, Y + b, block_size);
+            } else {
+                gemv_ternary_1_28bit_a8_serial(e - b, K, alpha, A, S, X_q, X_scales, beta, Y + b, block_size);
+            }
+        });
+    });
+}
+
+void gemv_ternary_1_28bit_a8_chip_optimized(
+    size_t M, size_t K, float alpha,
+    const uint8_t* A_quantized, const float* A_scales,
+    const int8_t* X_q, const float* X_scales,
+    float beta, float* Y, size_t block_size) {
+    std::vector<float> scratch;
+    KernelConfig config = tuned_config(make_key(TunedOp::GEMV_TERNARY_A8, M, 1, K, block_size),
+        gemv_a8_candidates, [&](const KernelConfig& candidate) {
+            scratch.resize(M);
+            gemv_2bit_a8_run(candidate, NO_PREFETCH, false, M, K, alpha, A_quantized, A_scales, X_q, X_scales,
+                             beta, scratch.data(), block_size);
+        });
+    gemv_2bit_a8_run(config, take_next_weights(), false, M, K, alpha, A_quantized, A_scales, X_q, X_scales,
+                     beta, Y, block_size);
+}
+
+void gemv_quaternary_1_58bit_a8_chip_optimized(
+    size_t M, size_t K, float alpha,
+    const uint8_t* A_quantized, const float* A_scales,
+    const int8_t* X_q, const float* X_scales,
+    float beta, float* Y, size_t block_size) {
+    std::vector<float> scratch;
+    KernelConfig config = tuned_config(make_key(TunedOp::GEMV_QUATERNARY_A8, M, 1, K, block_size),
+        gemv_a8_candidates, [&](const KernelConfig& candidate) {
+            scratch.resize(M);
+            gemv_2bit_a8_run(candidate, NO_PREFETCH, true, M, K, alpha, A_quantized, A_scales, X_q, X_scales,
+                             beta, scratch.data(), block_size);
+        });
+    gemv_2bit_a8_run(config, take_next_weights(), true, M, K, alpha, A_quantized, A_scales, X_q, X_scales,
+                     beta, Y, block_size);
+}
+
+// ========== Fused Transformer-Block GEMVs ==========
+// Row ranges are multiples of GEMV_ROW_GRAIN, itself a multiple of
+// neon::FUSED_ROW_TILE, so threads split the gate / up pair on tile
+// boundaries
+
+float rms_norm_gemv_ternary_1_28bit_chip_optimized(
+    size_t M, size_t K,
+    const uint8_t* A_quantized, const float* A_scales,
+    const float* X, const float* norm_weight, float eps,
+    float* X_weighted, float beta, float* Y, size_t block_size) {
+    float inv_rms = neon::rms_norm_weight(K, X, norm_weight, eps, X_weighted);
+    gemv_ternary_1_28bit_chip_optimized(M, K, inv_rms, A_quantized, A_scales, X_weighted, beta, Y, block_size);
+    return inv_rms;
+}
+
+float rms_norm_gemv_quaternary_1_58bit_chip_optimized(
+    size_t M, size_t K,
+    const uint8_t* A_quantized, const float* A_scales,
+    const float* X, const float* norm_weight, float eps,
+    float* X_weighted, float beta, float* Y, size_t block_size) {
+    float inv_rms = neon::rms_norm_weight(K, X, norm_weight, eps, X_weighted);
+    gemv_quaternary_1_58bit_chip_optimized(M, K, inv_rms, A_quantized, A_scales, X_weighted, beta, Y, block_size);
+    return inv_rms;
+}
+
+static void gemv_silu_gate_2bit_run(
+    bool quaternary, size_t M, size_t K, float alpha,
+    const uint8_t* A_gate, const float* gate_scales,
+    const uint8_t* A_up, const float* up_scales,
+    const float* X, float* Y, size_t block_size) {
+    size_t row_bytes = (K * 2 + 7) / 8;
+    size_t num_blocks_per_row = (K + block_size - 1) / block_size;
+    WeightPrefetchRange ahead = take_next_weights();
+    get_kernel_thread_pool().parallel_for(M, GEMV_ROW_GRAIN, 2 * K, [&](size_t begin, size_t end) {
+        for_rows_prefetching(ahead, M, begin, end, GEMV_ROW_GRAIN, [&](size_t b, size_t e) {
+            size_t offset = b * num_blocks_per_row;
+            if (quaternary) {
+                neon::gemv_silu_gate_quaternary_1_58bit(e - b, K, alpha,
+                    A_gate + b * row_bytes, gate_scales + offset, A_up + b * row_bytes, up_scales + offset,
+                    X, Y + b, block_size);
+            } else {
+                neon::gemv_silu_gate_ternary_1_28bit(e - b, K, alpha,
+                    A_gate + b * row_bytes, gate_scales + offset, A_up + b * row_bytes, up_scales + offset,
+                    X, Y + b, block_size);
+            }
+        });
+    });
+}
+
+void gemv_silu_gate_ternary_1_28bit_chip_optimized(
+    size_t M, size_t K, float alpha,
+    const uint8_t* A_gate, const float* gate_scales,
+    const uint8_t* A_up, const float* up_scales,
+    const float* X, float* Y, size_t block_size) {
+    gemv_silu_gate_2bit_run(false, M, K, alpha, A_gate, gate_scales, A_up, up_scales, X, Y, block_size);
+}
+
+void gemv_silu_gate_quaternary_1_58bit_chip_optimized(
+    size_t M, size_t K, float alpha,
+    const uint8_t* A_gate, const float* gate_scales,
+    const uint8_t* A_up, const float* up_scales,
+    const float* X, float* Y, size_t block_size) {
+    gemv_silu_gate_2bit_run(true, M, K, alpha, A_gate, gate_scales, A_up, up_scales, X, Y, block_size);
+}
+
+static void gemv_residual_2bit_run(
+    bool quaternary, size_t M, size_t K, float alpha,
+    const uint8_t* A_quantized, const float* A_scales,
+    const float* X, const float* residual, float* Y, size_t block_size) {
+    size_t row_bytes = (K * 2 + 7) / 8;
+    size_t num_blocks_per_row = (K + block_size - 1) / block_size;
+    WeightPrefetchRange ahead = take_next_weights();
+    get_kernel_thread_pool().parallel_for(M, GEMV_ROW_GRAIN, K, [&](size_t begin, size_t end) {
+        for_rows_prefetching(ahead, M, begin, end, GEMV_ROW_GRAIN, [&](size_t b, size_t e) {
+            const uint8_t* A = A_quantized + b * row_bytes;
+            const float* S = A_scales + b * num_blocks_per_row;
+            if (quaternary) {
+                neon::gemv_residual_quaternary_1_58bit(e - b, K, alpha, A, S, X, residual + b, Y + b, block_size);
+            } else {
+                neon::gemv_residual_ternary_1_28bit(e - b, K, alpha, A, S, X, residual + b, Y + b, block_size);
+            }
+        });
+    });
+}
+
+void gemv_residual_ternary_1_28bit_chip_optimized(
+    size_t M, size_t K, float alpha,
+    const uint8_t* A_quantized, const float* A_scales,
+    const float* X, const float* residual, float* Y, size_t block_size) {
+    gemv_residual_2bit_run(false, M, K, alpha, A_quantized, A_scales, X, residual, Y, block_size);
+}
+
+void gemv_residual_quaternary_1_58bit_chip_optimized(
+    size_t M, size_t K, float alpha,
+    const uint8_t* A_quantized, const float* A_scales,
+    const float* X, const float* residual, float* Y, size_t block_size) {
+    gemv_residual_2bit_run(true, M, K, alpha, A_quantized, A_scales, X, residual, Y, block_size);
+}
+
+// ========== Half-Precision Activation GEMV ==========
+// Not autotuned: one kernel per build. Ranges of 32 rows keep each
+// thread's fp16 Y writes on their own 64-byte line.
+
+namespace {
+    constexpr size_t GEMV_F16_ROW_GRAIN = 32;
+}
+
+static void gemv_2bit_f16_run(
+    bool quaternary, size_t M, size_t K, float alpha,
+    const uint8_t* A_quantized, const uint16_t* A_scales,
+    const uint16_t* X, float beta, uint16_t* Y, size_t block_size) {
+    size_t row_bytes = (K * 2 + 7) / 8;
+    size_t num_blocks_per_row = (K + block_size - 1) / block_size;
+    WeightPrefetchRange ahead = take_next_weights();
+
+    if (neon::gemv_f16_native_accumulation()) {
+        get_kernel_thread_pool().parallel_for(M, GEMV_F16_ROW_GRAIN, K, [&](size_t begin, size_t end) {
+            for_rows_prefetching(ahead, M, begin, end, GEMV_F16_ROW_GRAIN, [&](size_t b, size_t e) {
+                const uint8_t* A = A_quantized + b * row_bytes;
+                const uint16_t* S = A_scales + b * num_blocks_per_row;
+                if (quaternary) {
+                    neon::gemv_quaternary_1_58bit_f16(e - b, K, alpha, A, S, X, beta, Y + b, block_size);
+                } else {
+                    neon::gemv_ternary_1_28bit_f16(e - b, K, alpha, A, S, X, beta, Y + b, block_size);
+                }
+            });
+        });
+        return;
+    }
+
+    // No fp16 arithmetic: widen X once for all ranges and run the
+    // fp32-activation kernels on fp16 scales, a stack tile of Y at a time
+    const float* x32 = neon::widen_f16_activations(K, X);
+    get_kernel_thread_pool().parallel_for(M, GEMV_F16_ROW_GRAIN, K, [&](size_t begin, size_t end) {
+        for_rows_prefetching(ahead, M, begin, end, GEMV_F16_ROW_GRAIN, [&](size_t b, size_t e) {
+            float y32[GEMV_F16_ROW_GRAIN];
+            for (size_t row = b; row < e; row += GEMV_F16_ROW_GRAIN) {
+                size_t rows = std::min(GEMV_F16_ROW_GRAIN, e - row);
+                const uint8_t* A = A_quantized + row * row_bytes;
+                const uint16_t* S = A_scales + row * num_blocks_per_row;
+                for (size_t i = 0; i < rows; ++i) {
+                    y32[i] = beta != 0.0f ? beta * fp16_to_fp32(Y[row + i]) : 0.0f;
+                }
+                if (quaternary) {
+                    neon::gemv_quaternary_1_58bit_f16_scales(rows, K, alpha, A, S, x32, 1.0f, y32, block_size);
+                } else {
+                    neon::gemv_ternary_1_28bit_f16_scales(rows, K, alpha, A, S, x32, 1.0f, y32, block_size);
+                }
+                for (size_t i = 0; i < rows; ++i) {
+                    Y[row + i] = fp32_to_fp16(y32[i]);
+                }
+            }
+        });
+    });
+}
+
+void gemv_ternary_1_28bit_f16_chip_optimized(
+    size_t M, size_t K, float alpha,
+    const uint8_t* A_quantized, const uint16_t* A_scales,
+    const uint16_t* X, float beta, uint16_t* Y, size_t block_size) {
+    gemv_2bit_f16_run(false, M, K, alpha, A_quantized, A_scales, X, beta, Y, block_size);
+}
+
+void gemv_quaternary_1_58bit_f16_chip_optimized(
+    size_t M, size_t K, float alpha,
+    const uint8_t* A_quantized, const uint16_t* A_scales,
+    const uint16_t* X, float beta, uint16_t* Y, size_t block_size) {
+    gemv_2bit_f16_run(true, M, K, alpha, A_quantized, A_scales, X, beta, Y, block_size);
+}
+
+static void gemm_2bit_run(
+    const KernelConfig& config, bool quaternary,
+    size_t M, size_t N, size_t K, float alpha,
+    const uint8_t* A_quantized, const float* A_scales,
+    const float* X, float beta, float* Y, size_t block_size) {
+    // Y is N x M, so the batch is split: each thread decodes the weight
+    // tiles for its own vectors, with the register tile of its own core
+    get_kernel_thread_pool().parallel_for(N, get_quantized_gemm_batch_grain(), M * K, [&](size_t begin, size_t end) {
+        if (quaternary) {
+            gemm_quaternary_1_58bit_serial(config, M, end - begin, K, alpha, A_quantized, A_scales,
+                                           X + begin * K, beta, Y + begin * M, block_size);
+        } else {
+            gemm_ternary_1_28bit_serial(config, M, end - begin, K, alpha, A_quantized, A_scales,
+                                        X + begin * K, beta, Y + begin * M, block_size);
+        }
+    });
+}
+
+void gemm_ternary_1_28bit_chip_optimized(
+    size_t M, size_t N, size_t K, float alpha,
+    const uint8_t* A_quantized, const float* A_scales,
+    const float* X, float beta, float* Y, size_t block_size) {
+    std::vector<float> scratch;
+    KernelConfig config = tuned_config(make_key(TunedOp::GEMM_TERNARY, M, N, K, block_size),
+        quantized_gemm_candidates, [&](const KernelConfig& candidate) {
+            scratch.resize(M * N);
+            gemm_2bit_run(candidate, false, M, N, K, alpha, A_quantized, A_scales, X, beta, scratch.data(),
+                          block_size);
+        });
+    gemm_2bit_run(config, false, M, N, K, alpha, A_quantized, A_scales, X, beta, Y, block_size);
+}
+
+void gemm_quaternary_1_58bit_chip_optimized(
+    size_t M, size_t N, size_t K, float alpha,
+    const uint8_t* A_quantized, const float* A_scales,
+    const float* X, float beta, float* Y, size_t block_size) {
+    std::vector<float> scratch;
+    KernelConfig config = tuned_config(make_key(TunedOp::GEMM_QUATERNARY, M, N, K, block_size),
+        quantized_gemm_candidates, [&](const KernelConfig& candidate) {
+            scratch.resize(M * N);
+            gemm_2bit_run(candidate, true, M, N, K, alpha, A_quantized, A_scales, X, beta, scratch.data(),
+                          block_size);
+        });
+    gemm_2bit_run(config, true, M, N, K, alpha, A_quantized, A_scales, X, beta, Y, block_size);
+}
+
+#ifdef KIPEPEO_X86_ENABLED
+// ========== x86 kernel selection ==========
+// The generic quantized kernels call these once per invocation and keep
+// their scalar loops when they return nullptr
+
+x86::TwoBitDotFn x86::select_ternary_2bit_dot() {
+    switch (get_x86_level()) {
+        case X86Level::AVX512: return ternary_2bit_dot_avx512;
+        case X86Level::AVX2: return ternary_2bit_dot_avx2;
+        default: return nullptr;
+    }
+}
+
+x86::TwoBitDotFn x86::select_quaternary_2bit_dot() {
+    switch (get_x86_level()) {
+        case X86Level::AVX512: return quaternary_2bit_dot_avx512;
+        case X86Level::AVX2: return quaternary_2bit_dot_avx2;
+        default: return nullptr;
+    }
+}
+
+// No AVX-512 variant: with 4-8 rows in flight the 256-bit kernel is
+// already bound by the weight stream
+x86::TwoBitDotRowsFn x86::select_ternary_2bit_dot_rows() {
+    return get_x86_level() >= X86Level::AVX2 ? ternary_2bit_dot_rows_avx2 : nullptr;
+}
+
+x86::TwoBitDotRowsFn x86::select_quaternary_2bit_dot_rows() {
+    return get_x86_level() >= X86Level::AVX2 ? quaternary_2bit_dot_rows_avx2 : nullptr;
+}
+
+x86::GemmF32MicroFn x86::select_gemm_f32_micro_kernel(size_t& MR, size_t& NR) {
+    switch (get_x86_level()) {
+        case X86Level::AVX512:
+            MR = 12;
+            NR = 32;
+            return gemm_f32_micro_12x32_avx512;
+        case X86Level::AVX2:
+            MR = 6;
+            NR = 16;
+            return gemm_f32_micro_6x16_avx2;
+        default:
+            return nullptr;
+    }
+}
+
+x86::DotI8Fn x86::select_dot_i8() {
+    switch (get_x86_level()) {
+        case X86Level::AVX512: return dot_i8_avx512_vnni;
+        case X86Level::AVX2: return dot_i8_avx2;
+        default: return nullptr;
+    }
+}
+#endif
+
 } // namespace kernels
 } // namespace kipepeo
 
@@ -1,5 +1,6 @@
 #include "kipepeo/kernels/mediatek/helio_g99.h"
 #include "kipepeo/kernels/neon/matrix_multiply.h"
+#include "kipepeo/kernels/neon/packed_gemm.h"
 #include "kipepeo/kernels/neon/quantized_gemm.h"
 #include <cstring>
 
@@ -14,84 +15,18 @@ namespace mediatek {
 // Helio G99: Cortex-A76/A55, 6x6 blocking for big cores, 4x4 for little cores
 void helio_g99_matrix_multiply_f32(const float* A, const float* B, float* C,
                                    size_t M, size_t N, size_t K) {
-#ifdef KIPEPEO_NEON_ENABLED
-    // Optimized for Cortex-A76 with 6x6 blocking (can use 4x4 for A55)
-    const size_t MR = 6;  // Big core blocking
-    const size_t NR = 6;
-    
-    memset(C, 0, M * N * sizeof(float));
-    
-    for (size_t i = 0; i < M; i += MR) {
-        size_t m_block = (i + MR <= M) ? MR : (M - i);
-        
-        for (size_t j = 0; j < N; j += NR) {
-            size_t n_block = (j + NR <= N) ? NR : (N - j);
-            
-            // Accumulator registers for 6x6 block
-            float32x4_t acc[6][6];
-            for (size_t ii = 0; ii < 6; ++ii) {
-                for (size_t jj = 0; jj < 6; ++jj) {
-                    acc[ii][jj] = vdupq_n_f32(0.0f);
-                }
-            }
-            
-            // Inner loop with software pipelining
-            size_t k = 0;
-            for (; k + 4 <= K; k += 4) {
-                // Load A vectors (6 rows)
-                float32x4_t a_vec[6];
-                for (size_t ii = 0; ii < m_block && (i + ii) < M; ++ii) {
-                    a_vec[ii] = vld1q_f32(&A[(i + ii) * K + k]);
-                }
-                
-                // Process B columns with prefetching
-                for (size_t jj = 0; jj < n_block && (j + jj) < N; ++jj) {
-                    float b_vals[4];
-                    for (int kk = 0; kk < 4 && (k + kk) < K; ++kk) {
-                        b_vals[kk] = B[(k + kk) * N + (j + jj)];
-                    }
-                    float32x4_t b_vec = vld1q_f32(b_vals);
-                    
-                    // FMA for each row
-                    for (size_t ii = 0; ii < m_block && (i + ii) < M; ++ii) {
-                        acc[ii][jj] = vfmaq_f32(acc[ii][jj], a_vec[ii], b_vec);
-                    }
-                }
-            }
-            
-            // Handle remaining K elements
-            for (; k < K; ++k) {
-                for (size_t ii = 0; ii < m_block && (i + ii) < M; ++ii) {
-                    float a_val = A[(i + ii) * K + k];
-                    for (size_t jj = 0; jj < n_block && (j + jj) < N; ++jj) {
-                        float b_val = B[k * N + (j + jj)];
-                        C[(i + ii) * N + (j + jj)] += a_val * b_val;
-                    }
-                }
-            }
-            
-            // Store results
-            for (size_t ii = 0; ii < m_block && (i + ii) < M; ++ii) {
-                for (size_t jj = 0; jj < n_block && (j + jj) < N; ++jj) {
-                    float sum = vaddvq_f32(acc[ii][jj]);
-                    C[(i + ii) * N + (j + jj)] += sum;
-                }
-            }
-        }
-    }
-#else
-    neon::matrix_multiply_f32(A, B, C, M, N, K);
-#endif
+    // Cortex-A76: 6-row register tile on the big cores
+    neon::gemm_f32_packed(A, B, C, M, N, K, 6, 6);
 }
 
-void helio_g99_matrix_multiply_f16(const __fp16* A, const __fp16* B, __fp16* C,
+void helio_g99_matrix_multiply_f16(const fp16_t* A, const fp16_t* B, fp16_t* C,
                                    size_t M, size_t N, size_t K) {
 #ifdef KIPEPEO_NEON_ENABLED
     // G99 has native FP16 support - use 8x8 blocking
     const size_t MR = 8;
     const size_t NR = 8;
     
-    memset(C, 0, M * N * sizeof(__fp16));
+    memset(C, 0, M * N * sizeof(fp16_t));
     
     for (size_t i = 0; i < M; i += MR) {
         size_t m_block = (i + MR <= M) ? MR : (M - i);
@@ -114,7 +49,7 @@ void helio_g99_matrix_multiply_f16(const __fp16* A, const __fp16* B, __fp16* C,
                 }
                 
                 for (size_t jj = 0; jj < n_block && (j + jj) < N; ++jj) {
-                    __fp16 b_vals[8];
+                    fp16_t b_vals[8];
                     for (int kk = 0; kk < 8 && (k + kk) < K; ++kk) {
                         b_vals[kk] = B[(k + kk) * N + (j + jj)];
                     }
@@ -128,9 +63,9 @@ void helio_g99_matrix_multiply_f16(const __fp16* A, const __fp16* B, __fp16* C,
             
             for (; k < K; ++k) {
                 for (size_t ii = 0; ii < m_block && (i + ii) < M; ++ii) {
-                    __fp16 a_val = A[(i + ii) * K + k];
+                    fp16_t a_val = A[(i + ii) * K + k];
                     for (size_t jj = 0; jj < n_block && (j + jj) < N; ++jj) {
-                        __fp16 b_val = B[k * N + (j + jj)];
+                        fp16_t b_val = B[k * N + (j + jj)];
                         C[(i + ii) * N + (j + jj)] += a_val * b_val;
                     }
                 }
@@ -138,7 +73,7 @@ void helio_g99_matrix_multiply_f16(const __fp16* A, const __fp16* B, __fp16* C,
             
             for (size_t ii = 0; ii < m_block && (i + ii) < M; ++ii) {
                 for (size_t jj = 0; jj < n_block && (j + jj) < N; ++jj) {
-                    __fp16 sum = vaddvq_f16(acc[ii][jj]);
+                    fp16_t sum = vaddvq_f16(acc[ii][jj]);
                     C[(i + ii) * N + (j + jj)] += sum;
                 }
             }
@@ -0,0 +1,191 @@
+#include "kipepeo/kernels/neon/fused_gemv.h"
+#include "kipepeo/kernels/neon/quantized_gemm.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#ifdef KIPEPEO_NEON_ENABLED
+#include <arm_neon.h>
+#endif
+
+namespace kipepeo {
+namespace kernels {
+namespace neon {
+
+namespace {
+
+// Row-major 2-bit GEMV of either format (quantized_gemm.h)
+void gemv_2bit(bool quaternary, size_t M, size_t K, float alpha, const uint8_t* A_quantized,
+               const float* A_scales, const float* X, float beta, float* Y, size_t block_size,
+               const OutlierEntry* outliers, size_t outliers_per_block) {
+    if (quaternary) {
+        gemv_quaternary_1_58bit(M, K, alpha, A_quantized, A_scales, X, beta, Y, block_size,
+                                outliers, outliers_per_block);
+    } else {
+        gemv_ternary_1_28bit(M, K, alpha, A_quantized, A_scales, X, beta, Y, block_size,
+                             outliers, outliers_per_block);
+    }
+}
+
+// Outlier slots of the rows starting at row (nullptr stays nullptr)
+inline const OutlierEntry* outlier_rows(const OutlierEntry* outliers, size_t row,
+                                        size_t num_blocks_per_row, size_t outliers_per_block) {
+    return outliers ? outliers + row * num_blocks_per_row * outliers_per_block : nullptr;
+}
+
+inline float silu(float g) {
+    return g / (1.0f + std::exp(-g));
+}
+
+float rms_norm_gemv_2bit(bool quaternary, size_t M, size_t K, const uint8_t* A_quantized,
+                         const float* A_scales, const float* X, const float* norm_weight, float eps,
+                         float* X_weighted, float beta, float* Y, size_t block_size,
+                         const OutlierEntry* outliers, size_t outliers_per_block) {
+    float inv_rms = rms_norm_weight(K, X, norm_weight, eps, X_weighted);
+    gemv_2bit(quaternary, M, K, inv_rms, A_quantized, A_scales, X_weighted, beta, Y, block_size,
+              outliers, outliers_per_block);
+    return inv_rms;
+}
+
+void gemv_silu_gate_2bit(bool quaternary, size_t M, size_t K, float alpha,
+                         const uint8_t* A_gate, const float* gate_scales,
+                         const uint8_t* A_up, const float* up_scales,
+                         const float* X, float* Y, size_t block_size,
+                         const OutlierEntry* gate_outliers, const OutlierEntry* up_outliers,
+                         size_t outliers_per_block) {
+    size_t row_bytes = (K * 2 + 7) / 8;
+    size_t num_blocks_per_row = (K + block_size - 1) / block_size;
+    float up[FUSED_ROW_TILE];
+
+    // Gate sums land in Y and up sums on the stack; the tile's X blocks
+    // are still in L1 when the up rows read them
+    for (size_t row = 0; row < M; row += FUSED_ROW_TILE) {
+        size_t rows = std::min(FUSED_ROW_TILE, M - row);
+        size_t scale_offset = row * num_blocks_per_row;
+        gemv_2bit(quaternary, rows, K, alpha, A_gate + row * row_bytes, gate_scales + scale_offset,
+                  X, 0.0f, Y + row, block_size,
+                  outlier_rows(gate_outliers, row, num_blocks_per_row, outliers_per_block), outliers_per_block);
+        gemv_2bit(quaternary, rows, K, alpha, A_up + row * row_bytes, up_scales + scale_offset,
+                  X, 0.0f, up, block_size,
+                  outlier_rows(up_outliers, row, num_blocks_per_row, outliers_per_block), outliers_per_block);
+        for (size_t i = 0; i < rows; ++i) {
+            Y[row + i] = silu(Y[row + i]) * up[i];
+        }
+    }
+}
+
+void gemv_residual_2bit(bool quaternary, size_t M, size_t K, float alpha, const uint8_t* A_quantized,
+                        const float* A_scales, const float* X, const float* residual, float* Y,
+                        size_t block_size, const OutlierEntry* outliers, size_t outliers_per_block) {
+    // The GEMV accumulates into Y (beta = 1), so the residual is added as
+    // each row is written; an out-of-place residual is copied tile by
+    // tile just before the GEMV adds to it
+    if (residual == Y) {
+        gemv_2bit(quaternary, M, K, alpha, A_quantized, A_scales, X, 1.0f, Y, block_size,
+                  outliers, outliers_per_block);
+        return;
+    }
+    size_t row_bytes = (K * 2 + 7) / 8;
+    size_t num_blocks_per_row = (K + block_size - 1) / block_size;
+    for (size_t row = 0; row < M; row += FUSED_ROW_TILE) {
+        size_t rows = std::min(FUSED_ROW_TILE, M - row);
+        std::memcpy(Y + row, residual + row, rows * sizeof(float));
+        gemv_2bit(quaternary, rows, K, alpha, A_quantized + row * row_bytes,
+                  A_scales + row * num_blocks_per_row, X, 1.0f, Y + row, block_size,
+                  outlier_rows(outliers, row, num_blocks_per_row, outliers_per_block), outliers_per_block);
+    }
+}
+
+} // anonymous namespace
+
+float rms_norm_weight(size_t K, const float* X, const float* norm_weight, float eps, float* X_weighted) {
+    size_t k = 0;
+#ifdef KIPEPEO_NEON_ENABLED
+    float32x4_t acc0 = vdupq_n_f32(0.0f);
+    float32x4_t acc1 = vdupq_n_f32(0.0f);
+    for (; k + 8 <= K; k += 8) {
+        float32x4_t x0 = vld1q_f32(&X[k]);
+        float32x4_t x1 = vld1q_f32(&X[k + 4]);
+        acc0 = vfmaq_f32(acc0, x0, x0);
+        acc1 = vfmaq_f32(acc1, x1, x1);
+        if (norm_weight) {
+            x0 = vmulq_f32(x0, vld1q_f32(&norm_weight[k]));
+            x1 = vmulq_f32(x1, vld1q_f32(&norm_weight[k + 4]));
+        }
+        vst1q_f32(&X_weighted[k], x0);
+        vst1q_f32(&X_weighted[k + 4], x1);
+    }
+    float sum = vaddvq_f32(vaddq_f32(acc0, acc1));
+#else
+    // Four independent accumulators so the compiler can vectorize
+    float acc[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    for (; k + 4 <= K; k += 4) {
+        for (int i = 0; i < 4; ++i) {
+            float x = X[k + i];
+            acc[i] += x * x;
+            X_weighted[k + i] = norm_weight ? x * norm_weight[k + i] : x;
+        }
+    }
+    float sum = (acc[0] + acc[1]) + (acc[2] + acc[3]);
+#endif
+    for (; k < K; ++k) {
+        float x = X[k];
+        sum += x * x;
+        X_weighted[k] = norm_weight ? x * norm_weight[k] : x;
+    }
+    return 1.0f / std::sqrt(sum / static_cast<float>(K) + eps);
+}
+
+float rms_norm_gemv_ternary_1_28bit(size_t M, size_t K, const uint8_t* A_quantized, const float* A_scales,
+                                    const float* X, const float* norm_weight, float eps,
+                                    float* X_weighted, float beta, float* Y, size_t block_size,
+                                    const OutlierEntry* outliers, size_t outliers_per_block) {
+    return rms_norm_gemv_2bit(false, M, K, A_quantized, A_scales, X, norm_weight, eps, X_weighted, beta, Y,
+                              block_size, outliers, outliers_per_block);
+}
+
+float rms_norm_gemv_quaternary_1_58bit(size_t M, size_t K, const uint8_t* A_quantized, const float* A_scales,
+                                       const float* X, const float* norm_weight, float eps,
+                                       float* X_weighted, float beta, float* Y, size_t block_size,
+                                       const OutlierEntry* outliers, size_t outliers_per_block) {
+    return rms_norm_gemv_2bit(true, M, K, A_quantized, A_scales, X, norm_weight, eps, X_weighted, beta, Y,
+                              block_size, outliers, outliers_per_block);
+}
+
+void gemv_silu_gate_ternary_1_28bit(size_t M, size_t K, float alpha,
+                                    const uint8_t* A_gate, const float* gate_scales,
+                                    const uint8_t* A_up, const float* up_scales,
+                                    const float* X, float* Y, size_t block_size,
+                                    const OutlierEntry* gate_outliers, const OutlierEntry* up_outliers,
+                                    size_t outliers_per_block) {
+    gemv_silu_gate_2bit(false, M, K, alpha, A_gate, gate_scales, A_up, up_scales, X, Y, block_size,
+                        gate_outliers, up_outliers, outliers_per_block);
+}
+
+void gemv_silu_gate_quaternary_1_58bit(size_t M, size_t K, float alpha,
+                                       const uint8_t* A_gate, const float* gate_scales,
+                                       const uint8_t* A_up, const float* up_scales,
+                                       const float* X, float* Y, size_t block_size,
+                                       const OutlierEntry* gate_outliers, const OutlierEntry* up_outliers,
+                                       size_t outliers_per_block) {
+    gemv_silu_gate_2bit(true, M, K, alpha, A_gate, gate_scales, A_up, up_scales, X, Y, block_size,
+                        gate_outliers, up_outliers, outliers_per_block);
+}
+
+void gemv_residual_ternary_1_28bit(size_t M, size_t K, float alpha, const uint8_t* A_quantized,
+                                   const float* A_scales, const float* X, const float* residual, float* Y,
+                                   size_t block_size, const OutlierEntry* outliers, size_t outliers_per_block) {
+    gemv_residual_2bit(false, M, K, alpha, A_quantized, A_scales, X, residual, Y, block_size,
+                       outliers, outliers_per_block);
+}
+
+void gemv_residual_quaternary_1_58bit(size_t M, size_t K, float alpha, const uint8_t* A_quantized,
+                                      const float* A_scales, const float* X, const float* residual, float* Y,
+                                      size_t block_size, const OutlierEntry* outliers, size_t outliers_per_block) {
+    gemv_residual_2bit(true, M, K, alpha, A_quantized, A_scales, X, residual, Y, block_size,
+                       outliers, outliers_per_block);
+}
+
+} // namespace neon
+} // namespace kernels
+} // namespace kipepeo
@@ -1,4 +1,5 @@
 #include "kipepeo/kernels/neon/matrix_multiply.h"
+#include "kipepeo/kernels/neon/packed_gemm.h"
 #include <cstring>
 
 #ifdef KIPEPEO_NEON_ENABLED
@@ -13,106 +14,14 @@ namespace neon {
 
 void matrix_multiply_f32(const float* A, const float* B, float* C,
                         size_t M, size_t N, size_t K) {
-#ifdef KIPEPEO_NEON_ENABLED
-    // Hand-written NEON kernel optimized for:
-    // - MediaTek Helio G99/G100 (ARM Cortex-A76/A55)
-    // - Unisoc T606 (ARM Cortex-A75/A55)
-    // - Snapdragon 7s Gen 2 (ARM Cortex-A78/A55)
-    //
-    // Optimizations:
-    // 1. 4x4 register blocking to maximize register reuse
-    // 2. Cache-optimized memory access patterns
-    // 3. FMA (fused multiply-add) instructions: vfmaq_f32
-    // 4. Software pipelining to hide memory latency
-
-    // Process 4 rows of A and 4 columns of B at a time
-    const size_t MR = 4; // micro-panel rows
-    const size_t NR = 4; // micro-panel cols
-
-    for (size_t i = 0; i < M; i += MR) {
-        size_t m_block = (i + MR <= M) ? MR : (M - i);
-
-        for (size_t j = 0; j < N; j += NR) {
-            size_t n_block = (j + NR <= N) ? NR : (N - j);
-
-            // Accumulator registers for 4x4 block
-            float32x4_t acc[4][4];
-            for (size_t ii = 0; ii < 4; ++ii) {
-                for (size_t jj = 0; jj < 4; ++jj) {
-                    acc[ii][jj] = vdupq_n_f32(0.0f);
-                }
-            }
-
-            // Inner loop over K dimension
-            size_t k = 0;
-            for (; k + 4 <= K; k += 4) {
-                // Load 4x4 block from A (4 rows x 4 elements)
-                float32x4_t a_vec[4];
-                for (size_t ii = 0; ii < m_block && (i + ii) < M; ++ii) {
-                    a_vec[ii] = vld1q_f32(&A[(i + ii) * K + k]);
-                }
-
-                // Load and compute with B
-                for (size_t jj = 0; jj < n_block && (j + jj) < N; ++jj) {
-                    // Load 4 elements from column jj of B
-                    float32x4_t b_vec = vld1q_f32(&B[k * N + (j + jj)]);
-                    // Note: B is assumed to be transposed or we need to gather
-
-                    // Actually, for column-major B access, we need to load individually
-                    // Let's reload B properly for each column
-                    float b_vals[4];
-                    for (int kk = 0; kk < 4 && (k + kk) < K; ++kk) {
-                        b_vals[kk] = B[(k + kk) * N + (j + jj)];
-                    }
-                    b_vec = vld1q_f32(b_vals);
-
-                    // Multiply-accumulate for each row
-                    for (size_t ii = 0; ii < m_block && (i + ii) < M; ++ii) {
-                        // FMA: acc[ii][jj] += a_vec[ii] * b_vec
-                        acc[ii][jj] = vfmaq_f32(acc[ii][jj], a_vec[ii], b_vec);
-                    }
-                }
-            }
-
-            // Handle remaining K elements (scalar fallback)
-            for (; k < K; ++k) {
-                for (size_t ii = 0; ii < m_block && (i + ii) < M; ++ii) {
-                    float a_val = A[(i + ii) * K + k];
-                    for (size_t jj = 0; jj < n_block && (j + jj) < N; ++jj) {
-                        float b_val = B[k * N + (j + jj)];
-                        C[(i + ii) * N + (j + jj)] += a_val * b_val;
-                    }
-                }
-            }
-
-            // Horizontal sum and store results
-            for (size_t ii = 0; ii < m_block && (i + ii) < M; ++ii) {
-                for (size_t jj = 0; jj < n_block && (j + jj) < N; ++jj) {
-                    // Horizontal sum of acc[ii][jj]
-                    float sum = vaddvq_f32(acc[ii][jj]);
-                    C[(i + ii) * N + (j + jj)] += sum;
-                }
-            }
-        }
-    }
-
-#else
-    // Fallback to standard implementation (no NEON)
-    for (size_t i = 0; i < M; ++i) {
-        for (size_t j = 0; j < N; ++j) {
-            float sum = 0.0f;
-            for (size_t k = 0; k < K; ++k) {
-                sum += A[i * K + k] * B[k * N + j];
-            }
-            C[i * N + j] = sum;
-        }
-    }
-#endif
+    // Packed panels with cache blocking from the detected cache sizes;
+    // 8x8 register tile on AArch64, see packed_gemm.h
+    gemm_f32_packed(A, B, C, M, N, K, 8, 8);
 }
 
 // ========== FP16 Matrix Multiplication with NEON ==========
 
-void matrix_multiply_f16(const __fp16* A, const __fp16* B, __fp16* C,
+void matrix_multiply_f16(const fp16_t* A, const fp16_t* B, fp16_t* C,
                          size_t M, size_t N, size_t K) {
 #ifdef KIPEPEO_NEON_ENABLED
     // FP16 NEON kernel for newer ARM chips (Cortex-A76+)
@@ -147,7 +56,7 @@ void matrix_multiply_f16(const __fp16* A, const __fp16* B, __fp16* C,
                 // Process B columns and accumulate
                 for (size_t jj = 0; jj < n_block && (j + jj) < N; ++jj) {
                     // Load B column elements
-                    __fp16 b_vals[8];
+                    fp16_t b_vals[8];
                     for (int kk = 0; kk < 8 && (k + kk) < K; ++kk) {
                         b_vals[kk] = B[(k + kk) * N + (j + jj)];
                     }
@@ -163,9 +72,9 @@ void matrix_multiply_f16(const __fp16* A, const __fp16* B, __fp16* C,
             // Handle remaining K elements
             for (; k < K; ++k) {
                 for (size_t ii = 0; ii < m_block && (i + ii) < M; ++ii) {
-                    __fp16 a_val = A[(i + ii) * K + k];
+                    fp16_t a_val = A[(i + ii) * K + k];
                     for (size_t jj = 0; jj < n_block && (j + jj) < N; ++jj) {
-                        __fp16 b_val = B[k * N + (j + jj)];
+                        fp16_t b_val = B[k * N + (j + jj)];
                         C[(i + ii) * N + (j + jj)] += a_val * b_val;
                     }
                 }
@@ -175,7 +84,7 @@ void matrix_multiply_f16(const __fp16* A, const __fp16* B, __fp16* C,
             for (size_t ii = 0; ii < m_block && (i + ii) < M; ++ii) {
                 for (size_t jj = 0; jj < n_block && (j + jj) < N; ++jj) {
                     // Horizontal sum
-                    __fp16 sum = vaddvq_f16(acc[ii][jj]);
+                    fp16_t sum = vaddvq_f16(acc[ii][jj]);
                     C[(i + ii) * N + (j + jj)] += sum;
                 }
             }
@@ -186,7 +95,7 @@ void matrix_multiply_f16(const __fp16* A, const __fp16* B, __fp16* C,
     // Fallback to standard implementation
     for (size_t i = 0; i < M; ++i) {
         for (size_t j = 0; j < N; ++j) {
-            __fp16 sum = 0.0f;
+            fp16_t sum = 0.0f;
             for (size_t k = 0; k < K; ++k) {
                 sum += A[i * K + k] * B[k * N + j];
             }
@@ -0,0 +1,294 @@
+#include "kipepeo/kernels/neon/packed_gemm.h"
+#include "kipepeo/kernels/cpu_capabilities.h"
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#ifdef KIPEPEO_NEON_ENABLED
+#include <arm_neon.h>
+#endif
+
+#ifdef KIPEPEO_X86_ENABLED
+#include "kipepeo/kernels/x86/x86_kernels.h"
+#endif
+
+namespace kipepeo {
+namespace kernels {
+namespace neon {
+
+namespace {
+
+// Largest micro-tile any path uses (AVX-512 12x32)
+constexpr size_t MAX_TILE = 12 * 32;
+
+// C[MR x NR] (row stride ldc) = or += a * b over kc, with a packed
+// k-major in MR-wide rows and b in NR-wide rows. The tile of C is loaded
+// once, kept in registers for the whole kc loop and stored once.
+template <size_t MR, size_t NR>
+void micro_kernel(size_t kc, const float* a, const float* b, float* c, size_t ldc, bool accumulate) {
+#ifdef KIPEPEO_NEON_ENABLED
+    static_assert(NR % 4 == 0, "NEON micro-kernel vectorizes along NR");
+    float32x4_t acc[MR][NR / 4];
+    for (size_t r = 0; r < MR; ++r) {
+        for (size_t v = 0; v < NR / 4; ++v) {
+            acc[r][v] = accumulate ? vld1q_f32(c + r * ldc + v * 4) : vdupq_n_f32(0.0f);
+        }
+    }
+    for (size_t k = 0; k < kc; ++k) {
+        float32x4_t bv[NR / 4];
+        for (size_t v = 0; v < NR / 4; ++v) {
+            bv[v] = vld1q_f32(b + k * NR + v * 4);
+        }
+        const float* ak = a + k * MR;
+#if defined(__aarch64__)
+        if constexpr (MR % 4 == 0) {
+            // One quad load of A feeds four rows through lane FMAs
+            for (size_t q = 0; q < MR / 4; ++q) {
+                float32x4_t aq = vld1q_f32(ak + q * 4);
+                for (size_t v = 0; v < NR / 4; ++v) {
+                    acc[q * 4 + 0][v] = vfmaq_laneq_f32(acc[q * 4 + 0][v], bv[v], aq, 0);
+                    acc[q * 4 + 1][v] = vfmaq_laneq_f32(acc[q * 4 + 1][v], bv[v], aq, 1);
+                    acc[q * 4 + 2][v] = vfmaq_laneq_f32(acc[q * 4 + 2][v], bv[v], aq, 2);
+                    acc[q * 4 + 3][v] = vfmaq_laneq_f32(acc[q * 4 + 3][v], bv[v], aq, 3);
+                }
+            }
+            continue;
+        }
+#endif
+        for (size_t r = 0; r < MR; ++r) {
+            float32x4_t ar = vdupq_n_f32(ak[r]);
+            for (size_t v = 0; v < NR / 4; ++v) {
+                acc[r][v] = vfmaq_f32(acc[r][v], bv[v], ar);
+            }
+        }
+    }
+    for (size_t r = 0; r < MR; ++r) {
+        for (size_t v = 0; v < NR / 4; ++v) {
+            vst1q_f32(c + r * ldc + v * 4, acc[r][v]);
+        }
+    }
+#else
+    float acc[MR][NR];
+    for (size_t r = 0; r < MR; ++r) {
+        for (size_t j = 0; j < NR; ++j) {
+            acc[r][j] = accumulate ? c[r * ldc + j] : 0.0f;
+        }
+    }
+    for (size_t k = 0; k < kc; ++k) {
+        const float* bk = b + k * NR;
+        for (size_t r = 0; r < MR; ++r) {
+            float ar = a[k * MR + r];
+            for (size_t j = 0; j < NR; ++j) {
+                acc[r][j] += ar * bk[j];
+            }
+        }
+    }
+    for (size_t r = 0; r < MR; ++r) {
+        for (size_t j = 0; j < NR; ++j) {
+            c[r * ldc + j] = acc[r][j];
+        }
+    }
+#endif
+}
+
+using MicroKernel = void (*)(size_t, const float*, const float*, float*, size_t, bool);
+
+struct MicroTile {
+    size_t mr;
+    size_t nr;
+    MicroKernel kernel;
+};
+
+// Map the chip's preferred tile to an instantiated one. AArch64 has 32
+// vector registers, so up to 8 x 8 (16 accumulators); 32-bit NEON has 16
+// and stops at 4 x 8.
+MicroTile select_micro_tile(size_t MR, size_t NR) {
+#ifdef KIPEPEO_X86_ENABLED
+    size_t x86_mr, x86_nr;
+    if (x86::GemmF32MicroFn x86_kernel = x86::select_gemm_f32_micro_kernel(x86_mr, x86_nr)) {
+        return {x86_mr, x86_nr, x86_kernel};
+    }
+#endif
+#if defined(KIPEPEO_NEON_ENABLED) && defined(__aarch64__)
+    if (NR >= 8) {
+        if (MR >= 8) return {8, 8, micro_kernel<8, 8>};
+        if (MR >= 6) return {6, 8, micro_kernel<6, 8>};
+        return {4, 8, micro_kernel<4, 8>};
+    }
+    if (MR >= 8) return {8, 4, micro_kernel<8, 4>};
+    if (MR >= 6) return {6, 4, micro_kernel<6, 4>};
+    return {4, 4, micro_kernel<4, 4>};
+#elif defined(KIPEPEO_NEON_ENABLED)
+    (void)MR;
+    return NR >= 8 ? MicroTile{4, 8, micro_kernel<4, 8>} : MicroTile{4, 4, micro_kernel<4, 4>};
+#else
+    (void)MR;
+    (void)NR;
+    return {4, 8, micro_kernel<4, 8>};
+#endif
+}
+
+// Rows [i0, i0 + mc) x depth [k0, k0 + kc) of A as MR-wide k-major strips;
+// rows past the block are zero so edge tiles need no special kernel
+void pack_a(const float* A, size_t K, size_t i0, size_t mc, size_t k0, size_t kc,
+            size_t mr, float* out) {
+    for (size_t ir = 0; ir < mc; ir += mr) {
+        float* strip = out + ir * kc;
+        for (size_t r = 0; r < mr; ++r) {
+            if (ir + r < mc) {
+                const float* src = A + (i0 + ir + r) * K + k0;
+                for (size_t k = 0; k < kc; ++k) {
+                    strip[k * mr + r] = src[k];
+                }
+            } else {
+                for (size_t k = 0; k < kc; ++k) {
+                    strip[k * mr + r] = 0.0f;
+                }
+            }
+        }
+    }
+}
+
+// Depth [k0, k0 + kc) x columns [j0, j0 + nc) of B as NR-wide k-major
+// strips, zero-padding the last strip
+void pack_b(const float* B, size_t N, size_t k0, size_t kc, size_t j0, size_t nc,
+            size_t nr, float* out) {
+    for (size_t jr = 0; jr < nc; jr += nr) {
+        float* strip = out + jr * kc;
+        size_t cols = std::min(nr, nc - jr);
+        for (size_t k = 0; k < kc; ++k) {
+            const float* src = B + (k0 + k) * N + j0 + jr;
+            float* dst = strip + k * nr;
+            std::memcpy(dst, src, cols * sizeof(float));
+            for (size_t j = cols; j < nr; ++j) {
+                dst[j] = 0.0f;
+            }
+        }
+    }
+}
+
+size_t round_down(size_t value, size_t multiple) {
+    return std::max(multiple, value / multiple * multiple);
+}
+
+} // anonymous namespace
+
+void get_gemm_f32_micro_tile(size_t MR_hint, size_t NR_hint, size_t& MR, size_t& NR) {
+    MicroTile tile = select_micro_tile(MR_hint, NR_hint);
+    MR = tile.mr;
+    NR = tile.nr;
+}
+
+GemmBlocking compute_gemm_blocking(size_t l1_bytes, size_t l2_bytes, size_t l3_bytes,
+                                   size_t MR, size_t NR) {
+    GemmBlocking blocking;
+    // The B strip streams through L1 once per A strip; the other half of
+    // L1 holds the A strip and the C tile
+    blocking.KC = std::min<size_t>(512, round_down(l1_bytes / 2 / (NR * sizeof(float)), 16));
+    blocking.KC = std::max<size_t>(64, blocking.KC);
+    // The A block is reused for every B strip, so it owns half of L2
+    blocking.MC = std::min<size_t>(1024, round_down(l2_bytes / 2 / (blocking.KC * sizeof(float)), MR));
+    // The packed B slice is reused for every A block. Without an L3 it
+    // comes from memory anyway; 1MB keeps the buffer small on phones.
+    size_t b_bytes = l3_bytes != 0 ? l3_bytes / 2 : 1024 * 1024;
+    blocking.NC = std::min<size_t>(4096, round_down(b_bytes / (blocking.KC * sizeof(float)), NR));
+    return blocking;
+}
+
+GemmBlocking get_gemm_f32_blocking(size_t MR, size_t NR) {
+    const CacheSizes& caches = get_cpu_capabilities().caches;
+    return compute_gemm_blocking(caches.l1_data, caches.l2, caches.l3, MR, NR);
+}
+
+void gemm_f32_packed(const float* A, const float* B, float* C,
+                     size_t M, size_t N, size_t K,
+                     size_t MR_hint, size_t NR_hint) {
+    size_t MR, NR;
+    get_gemm_f32_micro_tile(MR_hint, NR_hint, MR, NR);
+    gemm_f32_packed(A, B, C, M, N, K, MR_hint, NR_hint, get_gemm_f32_blocking(MR, NR));
+}
+
+void gemm_f32_packed(const float* A, const float* B, float* C,
+                     size_t M, size_t N, size_t K,
+                     size_t MR_hint, size_t NR_hint, const GemmBlocking& blocking) {
+    if (M == 0 || N == 0) {
+        return;
+    }
+    if (K == 0) {
+        memset(C, 0, M * N * sizeof(float));
+        return;
+    }
+
+    MicroTile tile = select_micro_tile(MR_hint, NR_hint);
+    const size_t mr = tile.mr;
+    const size_t nr = tile.nr;
+    const size_t kc_max = std::min(std::max<size_t>(blocking.KC, 1), K);
+    const size_t mc_max = std::min(round_down(blocking.MC, mr), (M + mr - 1) / mr * mr);
+    const size_t nc_max = std::min(round_down(blocking.NC, nr), (N + nr - 1) / nr * nr);
+
+    std::vector<float> a_panel(mc_max * kc_max);
+    std::vector<float> b_panel(nc_max * kc_max);
+    float edge[MAX_TILE];
+
+    for (size_t j0 = 0; j0 < N; j0 += nc_max) {
+        size_t nc = std::min(nc_max, N - j0);
+
+        for (size_t k0 = 0; k0 < K; k0 += kc_max) {
+            size_t kc = std::min(kc_max, K - k0);
+            // The first slice overwrites C, later ones add to it
+            bool accumulate = k0 != 0;
+            pack_b(B, N, k0, kc, j0, nc, nr, b_panel.data());
+
+            for (size_t i0 = 0; i0 < M; i0 += mc_max) {
+                size_t mc = std::min(mc_max, M - i0);
+                pack_a(A, K, i0, mc, k0, kc, mr, a_panel.data());
+
+                for (size_t jr = 0; jr < nc; jr += nr) {
+                    size_t cols = std::min(nr, nc - jr);
+                    const float* b_strip = b_panel.data() + jr * kc;
+
+                    for (size_t ir = 0; ir < mc; ir += mr) {
+                        size_t rows = std::min(mr, mc - ir);
+                        const float* a_strip = a_panel.data() + ir * kc;
+                        float* c = C + (i0 + ir) * N + j0 + jr;
+
+                        if (rows == mr && cols == nr) {
+                            tile.kernel(kc, a_strip, b_strip, c, N, accumulate);
+                            continue;
+                        }
+                        // Edge tile: compute the full tile into a buffer
+                        // and write back the part inside C
+                        tile.kernel(kc, a_strip, b_strip, edge, nr, false);
+                        for (size_t r = 0; r < rows; ++r) {
+                            for (size_t j = 0; j < cols; ++j) {
+                                float v = edge[r * nr + j];
+                                c[r * N + j] = accumulate ? c[r * N + j] + v : v;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+void gemm_f32_reference(const float* A, const float* B, float* C,
+                        size_t M, size_t N, size_t K) {
+    for (size_t i = 0; i < M; ++i) {
+        float* c = C + i * N;
+        for (size_t j = 0; j < N; ++j) {
+            c[j] = 0.0f;
+        }
+        for (size_t k = 0; k < K; ++k) {
+            float a = A[i * K + k];
+            const float* b = B + k * N;
+            for (size_t j = 0; j < N; ++j) {
+                c[j] += a * b[j];
+            }
+        }
+    }
+}
+
+} // namespace neon
+} // namespace kernels
+} // namespace kipepeo
@@ -1,121 +1,322 @@
 #include "kipepeo/kernels/neon/quantized_gemm.h"
+#include "kipepeo/kernels/fp16.h"
+#include "kipepeo/kernels/weight_prefetch.h"
 #include <cstring>
+#include <cmath>
 #include <algorithm>
+#include <vector>
 
 #ifdef KIPEPEO_NEON_ENABLED
 #include <arm_neon.h>
 #endif
 
+#ifdef KIPEPEO_X86_ENABLED
+#include "kipepeo/kernels/x86/x86_kernels.h"
+#endif
+
 namespace kipepeo {
 namespace kernels {
 namespace neon {
 
+namespace {
+
+// Block scale accessors: the GEMV bodies are shared between fp32 and fp16
+// scale tables and read one scale per block through operator[]
+struct F32Scales {
+    const float* data;
+    float operator[](size_t i) const { return data[i]; }
+};
+
+struct F16Scales {
+    const uint16_t* data;
+    float operator[](size_t i) const { return fp16_to_fp32(data[i]); }
+};
+
+// Outlier accessors: block_dot() returns the sparse correction of one block
+// (sum of residual * X over its outlier slots; X is float or int8 codes),
+// add_to_block() folds the residuals into a decoded block (element k at
+// w[k * stride]). NoOutliers compiles away.
+struct NoOutliers {
+    template <typename XT>
+    float block_dot(size_t, const XT*) const { return 0.0f; }
+    float block_dot_f16(size_t, const uint16_t*) const { return 0.0f; }
+    void add_to_block(size_t, float*, size_t) const {}
+};
+
+struct BlockOutliers {
+    const OutlierEntry* slots;
+    size_t per_block;
+
+    template <typename XT>
+    float block_dot(size_t block, const XT* x_block) const {
+        const OutlierEntry* entry = slots + block * per_block;
+        float sum = 0.0f;
+        for (size_t s = 0; s < per_block && entry[s].index != OUTLIER_SLOT_EMPTY; ++s) {
+            sum += fp16_to_fp32(entry[s].value) * x_block[entry[s].index];
+        }
+        return sum;
+    }
+
+    // Same for fp16 activations (IEEE half bit patterns)
+    float block_dot_f16(size_t block, const uint16_t* x_block) const {
+        const OutlierEntry* entry = slots + block * per_block;
+        float sum = 0.0f;
+        for (size_t s = 0; s < per_block && entry[s].index != OUTLIER_SLOT_EMPTY; ++s) {
+            sum += fp16_to_fp32(entry[s].value) * fp16_to_fp32(x_block[entry[s].index]);
+        }
+        return sum;
+    }
+
+    void add_to_block(size_t block, float* w, size_t stride) const {
+        const OutlierEntry* entry = slots + block * per_block;
+        for (size_t s = 0; s < per_block && entry[s].index != OUTLIER_SLOT_EMPTY; ++s) {
+            w[entry[s].index * stride] += fp16_to_fp32(entry[s].value);
+        }
+    }
+};
+
+} // anonymous namespace
+
 // ========== Ternary (1.28-bit) Quantized GEMV ==========
 
-void gemv_ternary_1_28bit(
+namespace {
+
+// Add/subtract masks for 2-bit packed ternary bytes (4 values per byte,
+// -1=00, 0=01, +1=10, value i in bits 2i..2i+1). Lane i of plus[b] is all
+// ones when value i is +1, lane i of minus[b] when it is -1. The unused code
+// 11 counts as +1, as in the dequantizer.
+struct TernaryMaskTables {
+    alignas(16) uint32_t plus[256][4];
+    alignas(16) uint32_t minus[256][4];
+
+    TernaryMaskTables() {
+        for (int b = 0; b < 256; ++b) {
+            for (int i = 0; i < 4; ++i) {
+                uint8_t code = (b >> (2 * i)) & 0b11;
+                plus[b][i] = (code >= 0b10) ? 0xFFFFFFFFu : 0u;
+                minus[b][i] = (code == 0b00) ? 0xFFFFFFFFu : 0u;
+            }
+        }
+    }
+};
+
+const TernaryMaskTables& ternary_mask_tables() {
+    static const TernaryMaskTables tables;
+    return tables;
+}
+
+// Level of value k in a 2-bit packed ternary row (unaligned head/tail values)
+inline float ternary_2bit_level(const uint8_t* row_data, size_t k) {
+    uint8_t code = (row_data[k >> 2] >> ((k & 3) * 2)) & 0b11;
+    return code >= 0b10 ? 1.0f : (code == 0b00 ? -1.0f : 0.0f);
+}
+
+// Software prefetch of a GEMV's weight stream: every cache line up to
+// get_weight_prefetch_distance() bytes past the read position is
+// requested once, as a streaming (use-once) load
+class WeightStreamPrefetcher {
+public:
+    WeightStreamPrefetcher(const uint8_t* weights, size_t bytes)
+        : weights_(weights), bytes_(bytes), distance_(get_weight_prefetch_distance()), next_(0) {}
+
+    void advance(const uint8_t* position) {
+        if (distance_ == 0) {
+            return;
+        }
+        size_t target = std::min(static_cast<size_t>(position - weights_) + distance_, bytes_);
+        for (; next_ < target; next_ += PREFETCH_LINE) {
+            __builtin_prefetch(weights_ + next_, 0, 0);
+        }
+    }
+
+private:
+    static constexpr size_t PREFETCH_LINE = 64;
+
+    const uint8_t* weights_;
+    size_t bytes_;
+    size_t distance_;
+    size_t next_;   // First line not yet requested
+};
+
+#ifndef KIPEPEO_NEON_ENABLED
+// x where mask is all ones, +0.0f where it is zero
+inline float masked(float x, uint32_t mask) {
+    uint32_t bits;
+    std::memcpy(&bits, &x, sizeof(bits));
+    bits &= mask;
+    float result;
+    std::memcpy(&result, &bits, sizeof(result));
+    return result;
+}
+#endif
+
+} // anonymous namespace
+
+template <typename ScaleT, typename OutlierT>
+static void gemv_ternary_1_28bit_impl(
     size_t M,
     size_t K,
     float alpha,
     const uint8_t* A_quantized,
-    const float* A_scales,
+    ScaleT A_scales,
     const float* X,
     float beta,
     float* Y,
-    size_t block_size
+    size_t block_size,
+    OutlierT outliers
 ) {
-#ifdef KIPEPEO_NEON_ENABLED
-    // NEON-optimized ternary matrix-vector multiplication
-    // Ternary values: {-1, 0, +1} packed as 2 bits each
-    // Encoding: -1=00, 0=01, +1=10
-    
+    // Multiplication-free: each packed byte selects +1 and -1 lane masks
+    // from a table, X is accumulated with masked add/subtract, and the
+    // block scale is applied once per block
+    const TernaryMaskTables& tables = ternary_mask_tables();
     size_t num_blocks_per_row = (K + block_size - 1) / block_size;
+    size_t bytes_per_row = (K * 2 + 7) / 8;
+#ifdef KIPEPEO_X86_ENABLED
+    const x86::TwoBitDotFn x86_dot = x86::select_ternary_2bit_dot();
+#endif
+    WeightStreamPrefetcher prefetcher(A_quantized, M * bytes_per_row);
 
-    // Scale Y by beta if beta != 1.0
     if (beta == 0.0f) {
         memset(Y, 0, M * sizeof(float));
     } else if (beta != 1.0f) {
-        float32x4_t beta_vec = vdupq_n_f32(beta);
-        size_t i = 0;
-        for (; i + 4 <= M; i += 4) {
-            float32x4_t y_vec = vld1q_f32(&Y[i]);
-            y_vec = vmulq_f32(y_vec, beta_vec);
-            vst1q_f32(&Y[i], y_vec);
-        }
-        for (; i < M; ++i) {
+        for (size_t i = 0; i < M; ++i) {
             Y[i] *= beta;
         }
     }
 
-    // Process each row
     for (size_t row = 0; row < M; ++row) {
-        float32x4_t acc = vdupq_n_f32(0.0f);
-        
-        size_t bit_offset = row * ((K * 2 + 7) / 8) * 8; // Bit offset for this row
-        size_t byte_pos = bit_offset / 8;
-        int bit_pos = bit_offset % 8;
+        // Rows start on a byte boundary; value k sits in byte k / 4
+        const uint8_t* row_data = A_quantized + row * bytes_per_row;
+        float row_sum = 0.0f;
 
-        // Process by blocks
         for (size_t block_idx = 0; block_idx < num_blocks_per_row; ++block_idx) {
-            size_t k_start = block_idx * block_size;
-            size_t k_end = std::min(k_start + block_size, K);
+            size_t k = block_idx * block_size;
+            size_t k_end = std::min(k + block_size, K);
             float scale = A_scales[row * num_blocks_per_row + block_idx];
+            float correction = outliers.block_dot(row * num_blocks_per_row + block_idx, &X[k]);
+            float block_sum = 0.0f;
+            prefetcher.advance(row_data + (k >> 2));
 
-            float32x4_t scale_vec = vdupq_n_f32(scale * alpha);
+            // Values sharing a byte with the previous block (block_size < 4)
+            for (; k < k_end && (k & 3); ++k) {
+                block_sum += ternary_2bit_level(row_data, k) * X[k];
+            }
 
-            // Process 4 elements at a time
-            size_t k = k_start;
+#ifdef KIPEPEO_NEON_ENABLED
+            float32x4_t acc0 = vdupq_n_f32(0.0f);
+            float32x4_t acc1 = vdupq_n_f32(0.0f);
+            for (; k + 8 <= k_end; k += 8) {
+                const uint8_t* bytes = row_data + (k >> 2);
+                uint32x4_t x0 = vreinterpretq_u32_f32(vld1q_f32(&X[k]));
+                uint32x4_t x1 = vreinterpretq_u32_f32(vld1q_f32(&X[k + 4]));
+                acc0 = vaddq_f32(acc0, vreinterpretq_f32_u32(vandq_u32(x0, vld1q_u32(tables.plus[bytes[0]]))));
+                acc0 = vsubq_f32(acc0, vreinterpretq_f32_u32(vandq_u32(x0, vld1q_u32(tables.minus[bytes[0]]))));
+                acc1 = vaddq_f32(acc1, vreinterpretq_f32_u32(vandq_u32(x1, vld1q_u32(tables.plus[bytes[1]]))));
+                acc1 = vsubq_f32(acc1, vreinterpretq_f32_u32(vandq_u32(x1, vld1q_u32(tables.minus[bytes[1]]))));
+            }
             for (; k + 4 <= k_end; k += 4) {
-                // Load 4 X values
-                float32x4_t x_vec = vld1q_f32(&X[k]);
-
-                // Unpack 4 ternary values (8 bits total)
-                int8_t ternary_vals[4];
+                uint8_t byte = row_data[k >> 2];
+                uint32x4_t x0 = vreinterpretq_u32_f32(vld1q_f32(&X[k]));
+                acc0 = vaddq_f32(acc0, vreinterpretq_f32_u32(vandq_u32(x0, vld1q_u32(tables.plus[byte]))));
+                acc0 = vsubq_f32(acc0, vreinterpretq_f32_u32(vandq_u32(x0, vld1q_u32(tables.minus[byte]))));
+            }
+            block_sum += vaddvq_f32(vaddq_f32(acc0, acc1));
+#else
+#ifdef KIPEPEO_X86_ENABLED
+            if (x86_dot && k + 4 <= k_end) {
+                size_t n = (k_end - k) & ~static_cast<size_t>(3);
+                block_sum += x86_dot(row_data + (k >> 2), &X[k], n);
+                k += n;
+            }
+#endif
+            // Scalar reference of the NEON path: same masks, same lane order
+            float acc[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+            for (; k + 4 <= k_end; k += 4) {
+                uint8_t byte = row_data[k >> 2];
+                const uint32_t* plus = tables.plus[byte];
+                const uint32_t* minus = tables.minus[byte];
                 for (int i = 0; i < 4; ++i) {
-                    // Extract 2 bits
-                    uint8_t byte_val = A_quantized[byte_pos];
-                    uint8_t packed = (byte_val >> bit_pos) & 0b11;
-                    
-                    bit_pos += 2;
-                    if (bit_pos >= 8) {
-                        byte_pos++;
-                        bit_pos = 0;
-                    }
-
-                    // Decode: 00=-1, 01=0, 10=+1
-                    if (packed == 0b00) ternary_vals[i] = -1;
-                    else if (packed == 0b01) ternary_vals[i] = 0;
-                    else ternary_vals[i] = 1;
+                    acc[i] += masked(X[k + i], plus[i]);
+                    acc[i] -= masked(X[k + i], minus[i]);
                 }
-
-                // Convert to float and multiply with X
-                float32x4_t q_vec = vcvtq_f32_s32(vmovl_s16(vget_low_s16(vmovl_s8(vld1_s8(ternary_vals)))));
-                q_vec = vmulq_f32(q_vec, scale_vec);
-                acc = vfmaq_f32(acc, q_vec, x_vec);
             }
+            block_sum += (acc[0] + acc[1]) + (acc[2] + acc[3]);
+#endif
 
-            // Handle remaining elements
+            // Tail of a block that ends mid-byte
             for (; k < k_end; ++k) {
-                uint8_t byte_val = A_quantized[byte_pos];
-                uint8_t packed = (byte_val >> bit_pos) & 0b11;
-                
-                bit_pos += 2;
-                if (bit_pos >= 8) {
-                    byte_pos++;
-                    bit_pos = 0;
-                }
+                block_sum += ternary_2bit_level(row_data, k) * X[k];
+            }
 
-                int8_t ternary_val = (packed == 0b00) ? -1 : ((packed == 0b01) ? 0 : 1);
-                
-                Y[row] += ternary_val * scale * alpha * X[k];
+            // Scale applied once per block; outlier residuals are unscaled
+            row_sum += block_sum * scale + correction;
+        }
+
+        Y[row] += alpha * row_sum;
+    }
+}
+
+// ========== Base-3 Packed Ternary (1.6 bits per weight) ==========
+
+namespace {
+
+// Lookup tables for base-3 packed bytes (5 trits per byte).
+// Bytes 243..255 never appear in valid data and decode to zeros.
+struct TernaryBase3Tables {
+    int8_t trits[256][8];
+    float levels[256][8];
+
+    TernaryBase3Tables() {
+        memset(trits, 0, sizeof(trits));
+        memset(levels, 0, sizeof(levels));
+        for (int b = 0; b < 243; ++b) {
+            int v = b;
+            for (int i = 0; i < 5; ++i) {
+                trits[b][i] = static_cast<int8_t>(v % 3 - 1);
+                levels[b][i] = static_cast<float>(trits[b][i]);
+                v /= 3;
             }
         }
+    }
+};
+
+const TernaryBase3Tables& base3_tables() {
+    static const TernaryBase3Tables tables;
+    return tables;
+}
+
+} // anonymous namespace
 
-        // Horizontal sum and add to Y[row]
-        Y[row] += vaddvq_f32(acc);
+size_t ternary_base3_packed_size(size_t count, size_t block_size) {
+    if (block_size == 0) {
+        return (count + 4) / 5;
     }
+    size_t full_blocks = count / block_size;
+    size_t remainder = count % block_size;
+    return full_blocks * ((block_size + 4) / 5) + (remainder + 4) / 5;
+}
+
+const int8_t* ternary_base3_lookup(uint8_t packed) {
+    return base3_tables().trits[packed];
+}
+
+template <typename ScaleT, typename OutlierT>
+static void gemv_ternary_1_28bit_base3_impl(
+    size_t M,
+    size_t K,
+    float alpha,
+    const uint8_t* A_quantized,
+    ScaleT A_scales,
+    const float* X,
+    float beta,
+    float* Y,
+    size_t block_size,
+    OutlierT outliers
+) {
+    const TernaryBase3Tables& tables = base3_tables();
+    size_t num_blocks_per_row = (K + block_size - 1) / block_size;
+    size_t bytes_per_row = ternary_base3_packed_size(K, block_size);
 
-#else
-    // Scalar fallback
     if (beta == 0.0f) {
         memset(Y, 0, M * sizeof(float));
     } else if (beta != 1.0f) {
@@ -124,47 +325,65 @@ void gemv_ternary_1_28bit(
         }
     }
 
-    size_t num_blocks_per_row = (K + block_size - 1) / block_size;
-
     for (size_t row = 0; row < M; ++row) {
-        size_t byte_pos = row * ((K * 2 + 7) / 8);
-        int bit_pos = 0;
+        const uint8_t* row_data = A_quantized + row * bytes_per_row;
+        float row_sum = 0.0f;
 
         for (size_t block_idx = 0; block_idx < num_blocks_per_row; ++block_idx) {
-            size_t k_start = block_idx * block_size;
-            size_t k_end = std::min(k_start + block_size, K);
+            size_t k = block_idx * block_size;
+            size_t k_end = std::min(k + block_size, K);
             float scale = A_scales[row * num_blocks_per_row + block_idx];
+            float correction = outliers.block_dot(row * num_blocks_per_row + block_idx, &X[k]);
 
-            for (size_t k = k_start; k < k_end; ++k) {
-                uint8_t byte_val = A_quantized[byte_pos];
-                uint8_t packed = (byte_val >> bit_pos) & 0b11;
-                
-                bit_pos += 2;
-                if (bit_pos >= 8) {
-                    byte_pos++;
-                    bit_pos = 0;
+#ifdef KIPEPEO_NEON_ENABLED
+            // Each byte yields 5 levels: 4 go through a vector FMA, the
+            // fifth through a scalar accumulator
+            float32x4_t acc = vdupq_n_f32(0.0f);
+            float acc_tail = 0.0f;
+            for (; k + 5 <= k_end; k += 5) {
+                const float* lv = tables.levels[*row_data++];
+                acc = vfmaq_f32(acc, vld1q_f32(lv), vld1q_f32(&X[k]));
+                acc_tail += lv[4] * X[k + 4];
+            }
+            float block_sum = vaddvq_f32(acc) + acc_tail;
+#else
+            float block_sum = 0.0f;
+            for (; k + 5 <= k_end; k += 5) {
+                const float* lv = tables.levels[*row_data++];
+                block_sum += lv[0] * X[k] + lv[1] * X[k + 1] + lv[2] * X[k + 2] +
+                             lv[3] * X[k + 3] + lv[4] * X[k + 4];
+            }
+#endif
+            // Partial byte at the end of the block
+            if (k < k_end) {
+                const float* lv = tables.levels[*row_data++];
+                for (size_t i = 0; k + i < k_end; ++i) {
+                    block_sum += lv[i] * X[k + i];
                 }
-
-                int8_t ternary_val = (packed == 0b00) ? -1 : ((packed == 0b01) ? 0 : 1);
-                Y[row] += ternary_val * scale * alpha * X[k];
             }
+
+            // Scale applied once per block; outlier residuals are unscaled
+            row_sum += block_sum * scale + correction;
         }
+
+        Y[row] += alpha * row_sum;
     }
-#endif
 }
 
 // ========== Quaternary (1.58-bit) Quantized GEMV ==========
 
-void gemv_quaternary_1_58bit(
+template <typename ScaleT, typename OutlierT>
+static void gemv_quaternary_1_58bit_impl(
     size_t M,
     size_t K,
     float alpha,
     const uint8_t* A_quantized,
-    const float* A_scales,
+    ScaleT A_scales,
     const float* X,
     float beta,
     float* Y,
-    size_t block_size
+    size_t block_size,
+    OutlierT outliers
 ) {
     // Quaternary levels: {-1.5, -0.5, +0.5, +1.5}
     // Packed as 2 bits: 00=-1.5, 01=-0.5, 10=+0.5, 11=+1.5
@@ -172,6 +391,7 @@ void gemv_quaternary_1_58bit(
 
 #ifdef KIPEPEO_NEON_ENABLED
     size_t num_blocks_per_row = (K + block_size - 1) / block_size;
+    WeightStreamPrefetcher prefetcher(A_quantized, M * ((K * 2 + 7) / 8));
 
     // Scale Y by beta
     if (beta == 0.0f) {
@@ -191,6 +411,7 @@ void gemv_quaternary_1_58bit(
     // Process rows
     for (size_t row = 0; row < M; ++row) {
         float32x4_t acc = vdupq_n_f32(0.0f);
+        float correction = 0.0f;  // Sparse outlier contribution
         
         size_t byte_pos = row * ((K * 2 + 7) / 8);
         int bit_pos = 0;
@@ -201,6 +422,8 @@ void gemv_quaternary_1_58bit(
             float scale = A_scales[row * num_blocks_per_row + block_idx];
 
             float32x4_t scale_vec = vdupq_n_f32(scale * alpha);
+            correction += outliers.block_dot(row * num_blocks_per_row + block_idx, &X[k_start]);
+            prefetcher.advance(A_quantized + byte_pos);
 
             size_t k = k_start;
             for (; k + 4 <= k_end; k += 4) {
@@ -241,7 +464,7 @@ void gemv_quaternary_1_58bit(
             }
         }
 
-        Y[row] += vaddvq_f32(acc);
+        Y[row] += vaddvq_f32(acc) + alpha * correction;
     }
 
 #else
@@ -255,17 +478,34 @@ void gemv_quaternary_1_58bit(
     }
 
     size_t num_blocks_per_row = (K + block_size - 1) / block_size;
+#ifdef KIPEPEO_X86_ENABLED
+    const x86::TwoBitDotFn x86_dot = x86::select_quaternary_2bit_dot();
+#endif
+    WeightStreamPrefetcher prefetcher(A_quantized, M * ((K * 2 + 7) / 8));
 
     for (size_t row = 0; row < M; ++row) {
         size_t byte_pos = row * ((K * 2 + 7) / 8);
         int bit_pos = 0;
+        float correction = 0.0f;  // Sparse outlier contribution
 
         for (size_t block_idx = 0; block_idx < num_blocks_per_row; ++block_idx) {
             size_t k_start = block_idx * block_size;
             size_t k_end = std::min(k_start + block_size, K);
             float scale = A_scales[row * num_blocks_per_row + block_idx];
+            correction += outliers.block_dot(row * num_blocks_per_row + block_idx, &X[k_start]);
+            prefetcher.advance(A_quantized + byte_pos);
 
-            for (size_t k = k_start; k < k_end; ++k) {
+            size_t k = k_start;
+#ifdef KIPEPEO_X86_ENABLED
+            // Whole bytes of a byte-aligned block go through the SIMD dot
+            if (x86_dot && bit_pos == 0 && k + 4 <= k_end) {
+                size_t n = (k_end - k) & ~static_cast<size_t>(3);
+                Y[row] += alpha * scale * x86_dot(A_quantized + byte_pos, &X[k], n);
+                byte_pos += n / 4;
+                k += n;
+            }
+#endif
+            for (; k < k_end; ++k) {
                 uint8_t byte_val = A_quantized[byte_pos];
                 uint8_t packed = (byte_val >> bit_pos) & 0b11;
                 
@@ -278,26 +518,1291 @@ void gemv_quaternary_1_58bit(
                 Y[row] += levels[packed] * scale * alpha * X[k];
             }
         }
+
+        Y[row] += alpha * correction;
     }
 #endif
 }
 
-// Stub implementations for other functions
-void gemv_int8(size_t M, size_t K, float alpha, const int8_t* A_quantized,
-               const float* A_scales, const float* X, float beta, float* Y) {
-    // TODO: Standard INT8 GEMV implementation
+// ========== Int8-Activation GEMV (W1.58A8) ==========
+
+namespace {
+
+// Values decoded per step of the int8 GEMVs: a multiple of 4 and 5 (both
+// packings) and of the 16/32-byte vector width
+constexpr size_t A8_CHUNK = 160;
+
+// Weight decoders: expand packed codes into small int8 integers
+// (level = int8 value * level_scale) for the integer dot product
+struct TwoBitDecoder {
+    const int8_t (*levels)[4];  // Per packed byte, values 0..3
+    float level_scale;
+
+    size_t row_bytes(size_t K, size_t) const { return (K * 2 + 7) / 8; }
+
+    // Decode n values starting at offset j of block block_idx
+    void decode(const uint8_t* row_data, size_t block_idx, size_t block_size,
+                size_t j, size_t n, int8_t* out) const {
+        size_t k = block_idx * block_size + j;
+        size_t i = 0;
+        for (; i < n && ((k + i) & 3); ++i) {
+            out[i] = levels[row_data[(k + i) >> 2]][(k + i) & 3];
+        }
+        for (; i + 4 <= n; i += 4) {
+            std::memcpy(out + i, levels[row_data[(k + i) >> 2]], 4);
+        }
+        for (; i < n; ++i) {
+            out[i] = levels[row_data[(k + i) >> 2]][(k + i) & 3];
+        }
+    }
+};
+
+struct Base3Decoder {
+    const int8_t (*trits)[8];  // Per packed byte, values 0..4 (5..7 zero)
+    float level_scale;
+
+    size_t row_bytes(size_t K, size_t block_size) const {
+        return ternary_base3_packed_size(K, block_size);
+    }
+
+    // j is a multiple of 5 (A8_CHUNK is), blocks start on a byte boundary
+    void decode(const uint8_t* row_data, size_t block_idx, size_t block_size,
+                size_t j, size_t n, int8_t* out) const {
+        const uint8_t* bytes = row_data + block_idx * ((block_size + 4) / 5) + j / 5;
+        for (size_t i = 0; i < n; i += 5) {
+            int8_t vals[8];
+            std::memcpy(vals, trits[*bytes++], 8);
+            std::memcpy(out + i, vals, std::min<size_t>(5, n - i));
+        }
+    }
+};
+
+struct A8Tables {
+    int8_t ternary[256][4];     // -1=00, 0=01, +1=10 (11 -> +1)
+    int8_t quaternary[256][4];  // 2x levels: -3, -1, +1, +3
+
+    A8Tables() {
+        const int8_t t[4] = {-1, 0, 1, 1};
+        const int8_t q[4] = {-3, -1, 1, 3};
+        for (int b = 0; b < 256; ++b) {
+            for (int i = 0; i < 4; ++i) {
+                ternary[b][i] = t[(b >> (2 * i)) & 0b11];
+                quaternary[b][i] = q[(b >> (2 * i)) & 0b11];
+            }
+        }
+    }
+};
+
+const A8Tables& a8_tables() {
+    static const A8Tables tables;
+    return tables;
 }
 
-void gemv_batch_1_28bit(size_t batch_size, size_t M, size_t K,
-                       const uint8_t* A_quantized, const float* A_scales,
-                       const float* X_batch, float* Y_batch, size_t block_size) {
-    // Process each vector in batch sequentially
-    for (size_t b = 0; b < batch_size; ++b) {
-        gemv_ternary_1_28bit(M, K, 1.0f, A_quantized, A_scales,
-                            &X_batch[b * K], 0.0f, &Y_batch[b * M], block_size);
+// Integer dot product of n int8 weights and int8 activations, both in
+// [-127, 127] (2-bit codes expand to |w| <= 3, gemv_int8 uses the full
+// range). Pairwise int16 sums stay within 2 * 127 * 127 < 32768.
+int32_t dot_i8(const int8_t* w, const int8_t* x, size_t n) {
+    int32_t sum = 0;
+    size_t i = 0;
+#if defined(KIPEPEO_NEON_ENABLED)
+    int32x4_t acc = vdupq_n_s32(0);
+    for (; i + 16 <= n; i += 16) {
+        int8x16_t wv = vld1q_s8(w + i);
+        int8x16_t xv = vld1q_s8(x + i);
+#if defined(__ARM_FEATURE_DOTPROD)
+        acc = vdotq_s32(acc, wv, xv);  // sdot (ARMv8.2-A)
+#else
+        int16x8_t prod = vmull_s8(vget_low_s8(wv), vget_low_s8(xv));
+        prod = vmlal_s8(prod, vget_high_s8(wv), vget_high_s8(xv));
+        acc = vpadalq_s16(acc, prod);
+#endif
+    }
+    sum = vaddvq_s32(acc);
+#elif defined(KIPEPEO_X86_ENABLED)
+    // AVX2 maddubs or AVX-512 VNNI, picked by CPUID on first use
+    static const x86::DotI8Fn x86_dot = x86::select_dot_i8();
+    if (x86_dot) {
+        return x86_dot(w, x, n);
+    }
+#endif
+    for (; i < n; ++i) {
+        sum += static_cast<int32_t>(w[i]) * x[i];
+    }
+    return sum;
+}
+
+} // anonymous namespace
+
+void quantize_activations_int8(size_t K, const float* X, int8_t* X_q, float* X_scales,
+                               size_t block_size) {
+    size_t num_blocks = (K + block_size - 1) / block_size;
+    for (size_t block_idx = 0; block_idx < num_blocks; ++block_idx) {
+        size_t k_start = block_idx * block_size;
+        size_t k_end = std::min(k_start + block_size, K);
+
+        float max_abs = 0.0f;
+        for (size_t k = k_start; k < k_end; ++k) {
+            max_abs = std::max(max_abs, std::fabs(X[k]));
+        }
+
+        // Symmetric, [-127, 127] so that -x never overflows
+        float scale = max_abs / 127.0f;
+        float inv_scale = max_abs > 0.0f ? 127.0f / max_abs : 0.0f;
+        X_scales[block_idx] = scale;
+        for (size_t k = k_start; k < k_end; ++k) {
+            float q = std::nearbyint(X[k] * inv_scale);
+            X_q[k] = static_cast<int8_t>(std::min(127.0f, std::max(-127.0f, q)));
+        }
+    }
+}
+
+template <typename ScaleT, typename DecoderT, typename OutlierT>
+static void gemv_a8_impl(
+    size_t M,
+    size_t K,
+    float alpha,
+    const uint8_t* A_quantized,
+    ScaleT A_scales,
+    const int8_t* X_q,
+    const float* X_scales,
+    float beta,
+    float* Y,
+    size_t block_size,
+    DecoderT decoder,
+    OutlierT outliers
+) {
+    size_t num_blocks_per_row = (K + block_size - 1) / block_size;
+    size_t bytes_per_row = decoder.row_bytes(K, block_size);
+    WeightStreamPrefetcher prefetcher(A_quantized, M * bytes_per_row);
+
+    if (beta == 0.0f) {
+        memset(Y, 0, M * sizeof(float));
+    } else if (beta != 1.0f) {
+        for (size_t i = 0; i < M; ++i) {
+            Y[i] *= beta;
+        }
+    }
+
+    int8_t w[A8_CHUNK];
+    for (size_t row = 0; row < M; ++row) {
+        const uint8_t* row_data = A_quantized + row * bytes_per_row;
+        float row_sum = 0.0f;
+
+        for (size_t block_idx = 0; block_idx < num_blocks_per_row; ++block_idx) {
+            size_t k_start = block_idx * block_size;
+            size_t block_count = std::min(block_size, K - k_start);
+            // Approximate block offset (exact for the 2-bit layout)
+            prefetcher.advance(row_data + block_idx * bytes_per_row / num_blocks_per_row);
+
+            // Whole block in integer arithmetic, one float conversion per block
+            int32_t isum = 0;
+            for (size_t j = 0; j < block_count; j += A8_CHUNK) {
+                size_t n = std::min(A8_CHUNK, block_count - j);
+                decoder.decode(row_data, block_idx, block_size, j, n, w);
+                isum += dot_i8(w, X_q + k_start + j, n);
+            }
+
+            float scale = A_scales[row * num_blocks_per_row + block_idx];
+            float correction = outliers.block_dot(row * num_blocks_per_row + block_idx, X_q + k_start);
+            row_sum += X_scales[block_idx] * (isum * decoder.level_scale * scale + correction);
+        }
+
+        Y[row] += alpha * row_sum;
+    }
+}
+
+// ========== Public Entry Points (fp32 and fp16 block scales) ==========
+// The outlier-free instantiation is selected once per call, so matrices
+// without a side channel pay nothing for it.
+
+void gemv_ternary_1_28bit(size_t M, size_t K, float alpha, const uint8_t* A_quantized,
+                          const float* A_scales, const float* X, float beta, float* Y,
+                          size_t block_size, const OutlierEntry* outliers, size_t outliers_per_block) {
+    if (outliers && outliers_per_block > 0) {
+        gemv_ternary_1_28bit_impl(M, K, alpha, A_quantized, F32Scales{A_scales}, X, beta, Y, block_size,
+                                  BlockOutliers{outliers, outliers_per_block});
+    } else {
+        gemv_ternary_1_28bit_impl(M, K, alpha, A_quantized, F32Scales{A_scales}, X, beta, Y, block_size,
+                                  NoOutliers());
+    }
+}
+
+void gemv_ternary_1_28bit_f16_scales(size_t M, size_t K, float alpha, const uint8_t* A_quantized,
+                                     const uint16_t* A_scales, const float* X, float beta, float* Y,
+                                     size_t block_size, const OutlierEntry* outliers, size_t outliers_per_block) {
+    if (outliers && outliers_per_block > 0) {
+        gemv_ternary_1_28bit_impl(M, K, alpha, A_quantized, F16Scales{A_scales}, X, beta, Y, block_size,
+                                  BlockOutliers{outliers, outliers_per_block});
+    } else {
+        gemv_ternary_1_28bit_impl(M, K, alpha, A_quantized, F16Scales{A_scales}, X, beta, Y, block_size,
+                                  NoOutliers());
+    }
+}
+
+void gemv_ternary_1_28bit_base3(size_t M, size_t K, float alpha, const uint8_t* A_quantized,
+                                const float* A_scales, const float* X, float beta, float* Y,
+                                size_t block_size, const OutlierEntry* outliers, size_t outliers_per_block) {
+    if (outliers && outliers_per_block > 0) {
+        gemv_ternary_1_28bit_base3_impl(M, K, alpha, A_quantized, F32Scales{A_scales}, X, beta, Y, block_size,
+                                        BlockOutliers{outliers, outliers_per_block});
+    } else {
+        gemv_ternary_1_28bit_base3_impl(M, K, alpha, A_quantized, F32Scales{A_scales}, X, beta, Y, block_size,
+                                        NoOutliers());
+    }
+}
+
+void gemv_ternary_1_28bit_base3_f16_scales(size_t M, size_t K, float alpha, const uint8_t* A_quantized,
+                                           const uint16_t* A_scales, const float* X, float beta, float* Y,
+                                           size_t block_size, const OutlierEntry* outliers, size_t outliers_per_block) {
+    if (outliers && outliers_per_block > 0) {
+        gemv_ternary_1_28bit_base3_impl(M, K, alpha, A_quantized, F16Scales{A_scales}, X, beta, Y, block_size,
+                                        BlockOutliers{outliers, outliers_per_block});
+    } else {
+        gemv_ternary_1_28bit_base3_impl(M, K, alpha, A_quantized, F16Scales{A_scales}, X, beta, Y, block_size,
+                                        NoOutliers());
     }
 }
 
+void gemv_quaternary_1_58bit(size_t M, size_t K, float alpha, const uint8_t* A_quantized,
+                             const float* A_scales, const float* X, float beta, float* Y,
+                             size_t block_size, const OutlierEntry* outliers, size_t outliers_per_block) {
+    if (outliers && outliers_per_block > 0) {
+        gemv_quaternary_1_58bit_impl(M, K, alpha, A_quantized, F32Scales{A_scales}, X, beta, Y, block_size,
+                                     BlockOutliers{outliers, outliers_per_block});
+    } else {
+        gemv_quaternary_1_58bit_impl(M, K, alpha, A_quantized, F32Scales{A_scales}, X, beta, Y, block_size,
+                                     NoOutliers());
+    }
+}
+
+void gemv_quaternary_1_58bit_f16_scales(size_t M, size_t K, float alpha, const uint8_t* A_quantized,
+                                        const uint16_t* A_scales, const float* X, float beta, float* Y,
+                                        size_t block_size, const OutlierEntry* outliers, size_t outliers_per_block) {
+    if (outliers && outliers_per_block > 0) {
+        gemv_quaternary_1_58bit_impl(M, K, alpha, A_quantized, F16Scales{A_scales}, X, beta, Y, block_size,
+                                     BlockOutliers{outliers, outliers_per_block});
+    } else {
+        gemv_quaternary_1_58bit_impl(M, K, alpha, A_quantized, F16Scales{A_scales}, X, beta, Y, block_size,
+                                     NoOutliers());
+    }
+}
+
+// Int8-activation entry points
+
+void gemv_ternary_1_28bit_a8(size_t M, size_t K, float alpha, const uint8_t* A_quantized,
+                             const float* A_scales, const int8_t* X_q, const float* X_scales,
+                             float beta, float* Y, size_t block_size,
+                             const OutlierEntry* outliers, size_t outliers_per_block) {
+    if (outliers && outliers_per_block > 0) {
+        gemv_a8_impl(M, K, alpha, A_quantized, F32Scales{A_scales}, X_q, X_scales, beta, Y, block_size,
+                     TwoBitDecoder{a8_tables().ternary, 1.0f}, BlockOutliers{outliers, outliers_per_block});
+    } else {
+        gemv_a8_impl(M, K, alpha, A_quantized, F32Scales{A_scales}, X_q, X_scales, beta, Y, block_size,
+                     TwoBitDecoder{a8_tables().ternary, 1.0f}, NoOutliers());
+    }
+}
+
+void gemv_ternary_1_28bit_a8_f16_scales(size_t M, size_t K, float alpha, const uint8_t* A_quantized,
+                                        const uint16_t* A_scales, const int8_t* X_q, const float* X_scales,
+                                        float beta, float* Y, size_t block_size,
+                                        const OutlierEntry* outliers, size_t outliers_per_block) {
+    if (outliers && outliers_per_block > 0) {
+        gemv_a8_impl(M, K, alpha, A_quantized, F16Scales{A_scales}, X_q, X_scales, beta, Y, block_size,
+                     TwoBitDecoder{a8_tables().ternary, 1.0f}, BlockOutliers{outliers, outliers_per_block});
+    } else {
+        gemv_a8_impl(M, K, alpha, A_quantized, F16Scales{A_scales}, X_q, X_scales, beta, Y, block_size,
+                     TwoBitDecoder{a8_tables().ternary, 1.0f}, NoOutliers());
+    }
+}
+
+void gemv_ternary_1_28bit_base3_a8(size_t M, size_t K, float alpha, const uint8_t* A_quantized,
+                                   const float* A_scales, const int8_t* X_q, const float* X_scales,
+                                   float beta, float* Y, size_t block_size,
+                                   const OutlierEntry* outliers, size_t outliers_per_block) {
+    if (outliers && outliers_per_block > 0) {
+        gemv_a8_impl(M, K, alpha, A_quantized, F32Scales{A_scales}, X_q, X_scales, beta, Y, block_size,
+                     Base3Decoder{base3_tables().trits, 1.0f}, BlockOutliers{outliers, outliers_per_block});
+    } else {
+        gemv_a8_impl(M, K, alpha, A_quantized, F32Scales{A_scales}, X_q, X_scales, beta, Y, block_size,
+                     Base3Decoder{base3_tables().trits, 1.0f}, NoOutliers());
+    }
+}
+
+void gemv_ternary_1_28bit_base3_a8_f16_scales(size_t M, size_t K, float alpha, const uint8_t* A_quantized,
+                                              const uint16_t* A_scales, const int8_t* X_q, const float* X_scales,
+                                              float beta, float* Y, size_t block_size,
+                                              const OutlierEntry* outliers, size_t outliers_per_block) {
+    if (outliers && outliers_per_block > 0) {
+        gemv_a8_impl(M, K, alpha, A_quantized, F16Scales{A_scales}, X_q, X_scales, beta, Y, block_size,
+                     Base3Decoder{base3_tables().trits, 1.0f}, BlockOutliers{outliers, outliers_per_block});
+    } else {
+        gemv_a8_impl(M, K, alpha, A_quantized, F16Scales{A_scales}, X_q, X_scales, beta, Y, block_size,
+                     Base3Decoder{base3_tables().trits, 1.0f}, NoOutliers());
+    }
+}
+
+void gemv_quaternary_1_58bit_a8(size_t M, size_t K, float alpha, const uint8_t* A_quantized,
+                                const float* A_scales, const int8_t* X_q, const float* X_scales,
+                                float beta, float* Y, size_t block_size,
+                                const OutlierEntry* outliers, size_t outliers_per_block) {
+    if (outliers && outliers_per_block > 0) {
+        gemv_a8_impl(M, K, alpha, A_quantized, F32Scales{A_scales}, X_q, X_scales, beta, Y, block_size,
+                     TwoBitDecoder{a8_tables().quaternary, 0.5f}, BlockOutliers{outliers, outliers_per_block});
+    } else {
+        gemv_a8_impl(M, K, alpha, A_quantized, F32Scales{A_scales}, X_q, X_scales, beta, Y, block_size,
+                     TwoBitDecoder{a8_tables().quaternary, 0.5f}, NoOutliers());
+    }
+}
+
+void gemv_quaternary_1_58bit_a8_f16_scales(size_t M, size_t K, float alpha, const uint8_t* A_quantized,
+                                           const uint16_t* A_scales, const int8_t* X_q, const float* X_scales,
+                                           float beta, float* Y, size_t block_size,
+                                           const OutlierEntry* outliers, size_t outliers_per_block) {
+    if (outliers && outliers_per_block > 0) {
+        gemv_a8_impl(M, K, alpha, A_quantized, F16Scales{A_scales}, X_q, X_scales, beta, Y, block_size,
+                     TwoBitDecoder{a8_tables().quaternary, 0.5f}, BlockOutliers{outliers, outliers_per_block});
+    } else {
+        gemv_a8_impl(M, K, alpha, A_quantized, F16Scales{A_scales}, X_q, X_scales, beta, Y, block_size,
+                     TwoBitDecoder{a8_tables().quaternary, 0.5f}, NoOutliers());
+    }
+}
+
+// ========== Row-Interleaved 2-bit GEMV ==========
+// Panels of R rows with block b of every row stored back to back, so one
+// pass over a block of X feeds R independent accumulators and the R weight
+// streams are one sequential read
+
+namespace {
+
+// Decoded levels of every 2-bit packed byte, one table per format. The
+// ternary table maps the unused code 11 to +1, as the mask tables do.
+struct TwoBitLevelTables {
+    alignas(16) float ternary[256][4];
+    alignas(16) float quaternary[256][4];
+
+    TwoBitLevelTables() {
+        const float ternary_levels[4] = {-1.0f, 0.0f, 1.0f, 1.0f};
+        const float quaternary_levels[4] = {-1.5f, -0.5f, 0.5f, 1.5f};
+        for (int b = 0; b < 256; ++b) {
+            for (int i = 0; i < 4; ++i) {
+                int code = (b >> (2 * i)) & 0b11;
+                ternary[b][i] = ternary_levels[code];
+                quaternary[b][i] = quaternary_levels[code];
+            }
+        }
+    }
+};
+
+const TwoBitLevelTables& two_bit_level_tables() {
+    static const TwoBitLevelTables tables;
+    return tables;
+}
+
+// Dot products of R rows (row r at data + r * stride) with n activations
+template <size_t R>
+inline void two_bit_dot_rows(const uint8_t* data, size_t stride, const float (*levels)[4],
+                             const float* x, size_t n, float* out) {
+    size_t i = 0;
+#ifdef KIPEPEO_NEON_ENABLED
+    float32x4_t acc[R];
+    for (size_t r = 0; r < R; ++r) {
+        acc[r] = vdupq_n_f32(0.0f);
+    }
+    for (; i + 4 <= n; i += 4) {
+        float32x4_t x_vec = vld1q_f32(&x[i]);
+        for (size_t r = 0; r < R; ++r) {
+            acc[r] = vfmaq_f32(acc[r], vld1q_f32(levels[data[r * stride + (i >> 2)]]), x_vec);
+        }
+    }
+    for (size_t r = 0; r < R; ++r) {
+        out[r] = vaddvq_f32(acc[r]);
+    }
+#else
+    float acc[R][4] = {};
+    for (; i + 4 <= n; i += 4) {
+        for (size_t r = 0; r < R; ++r) {
+            const float* w = levels[data[r * stride + (i >> 2)]];
+            for (int j = 0; j < 4; ++j) {
+                acc[r][j] += w[j] * x[i + j];
+            }
+        }
+    }
+    for (size_t r = 0; r < R; ++r) {
+        out[r] = (acc[r][0] + acc[r][1]) + (acc[r][2] + acc[r][3]);
+    }
+#endif
+    // Last block of a row may end mid-byte
+    for (; i < n; ++i) {
+        for (size_t r = 0; r < R; ++r) {
+            out[r] += levels[data[r * stride + (i >> 2)]][i & 3] * x[i];
+        }
+    }
+}
+
+template <typename T>
+void repack_scales_interleaved_impl(size_t M, size_t num_blocks_per_row, const T* scales,
+                                    T* out, size_t rows_per_group) {
+    const size_t R = rows_per_group;
+    size_t num_groups = (M + R - 1) / R;
+    for (size_t g = 0; g < num_groups; ++g) {
+        for (size_t b = 0; b < num_blocks_per_row; ++b) {
+            T* dst = out + (g * num_blocks_per_row + b) * R;
+            for (size_t r = 0; r < R; ++r) {
+                size_t row = g * R + r;
+                // Padding rows get a zero scale so they contribute nothing
+                dst[r] = row < M ? scales[row * num_blocks_per_row + b] : T(0);
+            }
+        }
+    }
+}
+
+} // anonymous namespace
+
+size_t interleaved_2bit_size(size_t M, size_t K, size_t rows_per_group) {
+    size_t num_groups = (M + rows_per_group - 1) / rows_per_group;
+    return num_groups * rows_per_group * ((K * 2 + 7) / 8);
+}
+
+void repack_2bit_interleaved(size_t M, size_t K, const uint8_t* A_quantized, uint8_t* A_interleaved,
+                             size_t block_size, size_t rows_per_group) {
+    const size_t R = rows_per_group;
+    size_t bytes_per_row = (K * 2 + 7) / 8;
+    size_t num_blocks_per_row = (K + block_size - 1) / block_size;
+    size_t num_groups = (M + R - 1) / R;
+
+    std::memset(A_interleaved, 0, interleaved_2bit_size(M, K, R));
+    for (size_t g = 0; g < num_groups; ++g) {
+        uint8_t* panel = A_interleaved + g * R * bytes_per_row;
+        for (size_t b = 0; b < num_blocks_per_row; ++b) {
+            size_t k = b * block_size;
+            size_t block_bytes = (std::min(block_size, K - k) * 2 + 7) / 8;
+            uint8_t* dst = panel + R * (k >> 2);
+            for (size_t r = 0; r < R && g * R + r < M; ++r) {
+                std::memcpy(dst + r * block_bytes, A_quantized + (g * R + r) * bytes_per_row + (k >> 2),
+                            block_bytes);
+            }
+        }
+    }
+}
+
+void repack_scales_interleaved(size_t M, size_t num_blocks_per_row, const float* scales,
+                               float* out, size_t rows_per_group) {
+    repack_scales_interleaved_impl(M, num_blocks_per_row, scales, out, rows_per_group);
+}
+
+void repack_scales_interleaved(size_t M, size_t num_blocks_per_row, const uint16_t* scales,
+                               uint16_t* out, size_t rows_per_group) {
+    // fp16 zero is the all-zero bit pattern
+    repack_scales_interleaved_impl(M, num_blocks_per_row, scales, out, rows_per_group);
+}
+
+template <size_t R, typename ScaleT, typename OutlierT>
+static void gemv_2bit_interleaved_impl(
+    size_t M,
+    size_t K,
+    float alpha,
+    const uint8_t* A_interleaved,
+    ScaleT A_scales,
+    const float* X,
+    float beta,
+    float* Y,
+    size_t block_size,
+    bool quaternary,
+    OutlierT outliers
+) {
+    const TwoBitLevelTables& tables = two_bit_level_tables();
+    const float (*levels)[4] = quaternary ? tables.quaternary : tables.ternary;
+#ifdef KIPEPEO_X86_ENABLED
+    const x86::TwoBitDotRowsFn x86_dot_rows = quaternary ? x86::select_quaternary_2bit_dot_rows()
+                                                         : x86::select_ternary_2bit_dot_rows();
+#endif
+    size_t num_blocks_per_row = (K + block_size - 1) / block_size;
+    size_t bytes_per_row = (K * 2 + 7) / 8;
+
+    if (beta == 0.0f) {
+        memset(Y, 0, M * sizeof(float));
+    } else if (beta != 1.0f) {
+        for (size_t i = 0; i < M; ++i) {
+            Y[i] *= beta;
+        }
+    }
+
+    for (size_t row0 = 0; row0 < M; row0 += R) {
+        const uint8_t* panel = A_interleaved + (row0 / R) * R * bytes_per_row;
+        size_t rows = std::min(R, M - row0);
+        float row_sum[R] = {};
+
+        for (size_t block_idx = 0; block_idx < num_blocks_per_row; ++block_idx) {
+            size_t k = block_idx * block_size;
+            size_t count = std::min(block_size, K - k);
+            size_t stride = (count * 2 + 7) / 8;
+            const uint8_t* data = panel + R * (k >> 2);
+            const size_t scale_base = ((row0 / R) * num_blocks_per_row + block_idx) * R;
+            float sums[R];
+
+#ifdef KIPEPEO_X86_ENABLED
+            if (x86_dot_rows && count >= 4) {
+                size_t n = count & ~static_cast<size_t>(3);
+                x86_dot_rows(data, stride, R, &X[k], n, sums);
+                for (size_t i = n; i < count; ++i) {
+                    for (size_t r = 0; r < R; ++r) {
+                        sums[r] += levels[data[r * stride + (i >> 2)]][i & 3] * X[k + i];
+                    }
+                }
+            } else
+#endif
+            two_bit_dot_rows<R>(data, stride, levels, &X[k], count, sums);
+
+            for (size_t r = 0; r < R; ++r) {
+                row_sum[r] += sums[r] * A_scales[scale_base + r];
+            }
+            for (size_t r = 0; r < rows; ++r) {
+                row_sum[r] += outliers.block_dot((row0 + r) * num_blocks_per_row + block_idx, &X[k]);
+            }
+        }
+
+        for (size_t r = 0; r < rows; ++r) {
+            Y[row0 + r] += alpha * row_sum[r];
+        }
+    }
+}
+
+// rows_per_group is 4 or 8 (see repack_2bit_interleaved)
+template <typename ScaleT, typename OutlierT>
+static void gemv_2bit_interleaved(size_t M, size_t K, float alpha, const uint8_t* A_interleaved,
+                                  ScaleT A_scales, const float* X, float beta, float* Y,
+                                  size_t block_size, size_t rows_per_group, bool quaternary,
+                                  OutlierT outliers) {
+    if (rows_per_group == 8) {
+        gemv_2bit_interleaved_impl<8>(M, K, alpha, A_interleaved, A_scales, X, beta, Y, block_size,
+                                      quaternary, outliers);
+    } else {
+        gemv_2bit_interleaved_impl<4>(M, K, alpha, A_interleaved, A_scales, X, beta, Y, block_size,
+                                      quaternary, outliers);
+    }
+}
+
+void gemv_ternary_1_28bit_interleaved(size_t M, size_t K, float alpha, const uint8_t* A_interleaved,
+                                      const float* A_scales, const float* X, float beta, float* Y,
+                                      size_t block_size, size_t rows_per_group,
+                                      const OutlierEntry* outliers, size_t outliers_per_block) {
+    if (outliers && outliers_per_block > 0) {
+        gemv_2bit_interleaved(M, K, alpha, A_interleaved, F32Scales{A_scales}, X, beta, Y, block_size,
+                              rows_per_group, false, BlockOutliers{outliers, outliers_per_block});
+    } else {
+        gemv_2bit_interleaved(M, K, alpha, A_interleaved, F32Scales{A_scales}, X, beta, Y, block_size,
+                              rows_per_group, false, NoOutliers());
+    }
+}
+
+void gemv_ternary_1_28bit_interleaved_f16_scales(size_t M, size_t K, float alpha, const uint8_t* A_interleaved,
+                                                 const uint16_t* A_scales, const float* X, float beta, float* Y,
+                                                 size_t block_size, size_t rows_per_group,
+                                                 const OutlierEntry* outliers, size_t outliers_per_block) {
+    if (outliers && outliers_per_block > 0) {
+        gemv_2bit_interleaved(M, K, alpha, A_interleaved, F16Scales{A_scales}, X, beta, Y, block_size,
+                              rows_per_group, false, BlockOutliers{outliers, outliers_per_block});
+    } else {
+        gemv_2bit_interleaved(M, K, alpha, A_interleaved, F16Scales{A_scales}, X, beta, Y, block_size,
+                              rows_per_group, false, NoOutliers());
+    }
+}
+
+void gemv_quaternary_1_58bit_interleaved(size_t M, size_t K, float alpha, const uint8_t* A_interleaved,
+                                         const float* A_scales, const float* X, float beta, float* Y,
+                                         size_t block_size, size_t rows_per_group,
+                                         const OutlierEntry* outliers, size_t outliers_per_block) {
+    if (outliers && outliers_per_block > 0) {
+        gemv_2bit_interleaved(M, K, alpha, A_interleaved, F32Scales{A_scales}, X, beta, Y, block_size,
+                              rows_per_group, true, BlockOutliers{outliers, outliers_per_block});
+    } else {
+        gemv_2bit_interleaved(M, K, alpha, A_interleaved, F32Scales{A_scales}, X, beta, Y, block_size,
+                              rows_per_group, true, NoOutliers());
+    }
+}
+
+void gemv_quaternary_1_58bit_interleaved_f16_scales(size_t M, size_t K, float alpha, const uint8_t* A_interleaved,
+                                                    const uint16_t* A_scales, const float* X, float beta, float* Y,
+                                                    size_t block_size, size_t rows_per_group,
+                                                    const OutlierEntry* outliers, size_t outliers_per_block) {
+    if (outliers && outliers_per_block > 0) {
+        gemv_2bit_interleaved(M, K, alpha, A_interleaved, F16Scales{A_scales}, X, beta, Y, block_size,
+                              rows_per_group, true, BlockOutliers{outliers, outliers_per_block});
+    } else {
+        gemv_2bit_interleaved(M, K, alpha, A_interleaved, F16Scales{A_scales}, X, beta, Y, block_size,
+                              rows_per_group, true, NoOutliers());
+    }
+}
+
+// ========== Half-Precision Activation GEMV ==========
+
+#if defined(KIPEPEO_NEON_ENABLED) && defined(__ARM_FEATURE_FP16_VECTOR_ARITHMETIC)
+#define KIPEPEO_F16_LANES 1
+#endif
+
+namespace {
+
+// Values of a block summed in fp16 lanes before the lanes are promoted to
+// fp32: no lane adds more than FP16_PROMOTE_SPAN / 8 terms in half precision
+constexpr size_t FP16_PROMOTE_SPAN = 64;
+
+// Sign / keep masks applied to fp16 X bit patterns (4 values per packed
+// byte, lane i from bits 2i..2i+1), so every product is an exact sign flip
+// or zeroing and the lanes only ever add:
+//   ternary:    (x ^ sign) & keep           sign for -1 (00), keep for +/-1
+//                                           (00, 10 and the unused 11)
+//   quaternary: 0.5 * sum(x ^ sign) + sum((x ^ sign) & big)
+//               sign for the negative levels (00, 01), big for +/-1.5 (00, 11)
+struct Fp16MaskTables {
+    alignas(8) uint16_t ternary_sign[256][4];
+    alignas(8) uint16_t ternary_keep[256][4];
+    alignas(8) uint16_t quaternary_sign[256][4];
+    alignas(8) uint16_t quaternary_big[256][4];
+
+    Fp16MaskTables() {
+        for (int b = 0; b < 256; ++b) {
+            for (int i = 0; i < 4; ++i) {
+                uint8_t code = (b >> (2 * i)) & 0b11;
+                ternary_sign[b][i] = code == 0b00 ? 0x8000u : 0u;
+                ternary_keep[b][i] = code != 0b01 ? 0xFFFFu : 0u;
+                quaternary_sign[b][i] = code <= 0b01 ? 0x8000u : 0u;
+                quaternary_big[b][i] = (code == 0b00 || code == 0b11) ? 0xFFFFu : 0u;
+            }
+        }
+    }
+};
+
+const Fp16MaskTables& fp16_mask_tables() {
+    static const Fp16MaskTables tables;
+    return tables;
+}
+
+// Level of value k of a 2-bit row (head / tail values outside whole bytes)
+template <bool Quaternary>
+inline float two_bit_level(const uint8_t* row_data, size_t k) {
+    static const float quaternary_levels[4] = {-1.5f, -0.5f, 0.5f, 1.5f};
+    if (Quaternary) {
+        return quaternary_levels[(row_data[k >> 2] >> ((k & 3) * 2)) & 0b11];
+    }
+    return ternary_2bit_level(row_data, k);
+}
+
+// Half-precision add. The exact sum of two halves fits the 24-bit float
+// significand closely enough that rounding it to float and then to half
+// equals a single rounding, so this matches a hardware fp16 add exactly.
+inline uint16_t f16_add(uint16_t a, uint16_t b) {
+    return fp32_to_fp16(fp16_to_fp32(a) + fp16_to_fp32(b));
+}
+
+// fp32 lane sums of n fp16 lanes folded into 4 (lanes 0-3, then 4-7)
+inline void promote_f16_lanes(const uint16_t* lanes, size_t n, float* sums) {
+    for (size_t half = 0; half < n; half += 4) {
+        for (int i = 0; i < 4; ++i) {
+            sums[i] += fp16_to_fp32(lanes[half + i]);
+        }
+    }
+}
+
+// Pairwise order of vaddvq_f32
+inline float sum_f32x4(const float* sums) {
+    return (sums[0] + sums[1]) + (sums[2] + sums[3]);
+}
+
+// Dot product of the whole packed bytes of [k, k_end) (k a multiple of 4)
+// with fp16 X in 8 fp16 lanes; advances k past them. Portable emulation of
+// f16_lanes_dot_native, lane for lane.
+template <bool Quaternary>
+float f16_lanes_dot_emulated(const uint8_t* row_data, const uint16_t* X, size_t& k, size_t k_end,
+                             const Fp16MaskTables& tables) {
+    const uint16_t (*sign)[4] = Quaternary ? tables.quaternary_sign : tables.ternary_sign;
+    const uint16_t (*keep)[4] = Quaternary ? tables.quaternary_big : tables.ternary_keep;
+    float sum_all[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    float sum_big[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+
+    // One pass over n (8 or 4) lanes per step until span_end
+    auto run_span = [&](size_t n, size_t span_end) {
+        uint16_t all[8] = {};
+        uint16_t big[8] = {};
+        for (; k + n <= span_end; k += n) {
+            for (size_t lane = 0; lane < n; ++lane) {
+                uint8_t byte = row_data[(k + lane) >> 2];
+                uint16_t x = X[k + lane] ^ sign[byte][lane & 3];
+                if (Quaternary) {
+                    all[lane] = f16_add(all[lane], x);
+                    big[lane] = f16_add(big[lane], x & keep[byte][lane & 3]);
+                } else {
+                    all[lane] = f16_add(all[lane], x & keep[byte][lane & 3]);
+                }
+            }
+        }
+        promote_f16_lanes(all, n, sum_all);
+        if (Quaternary) {
+            promote_f16_lanes(big, n, sum_big);
+        }
+    };
+
+    while (k + 8 <= k_end) {
+        run_span(8, std::min(k_end, k + FP16_PROMOTE_SPAN));
+    }
+    if (k + 4 <= k_end) {
+        run_span(4, k + 4);
+    }
+    return Quaternary ? 0.5f * sum_f32x4(sum_all) + sum_f32x4(sum_big) : sum_f32x4(sum_all);
+}
+
+#ifdef KIPEPEO_F16_LANES
+template <bool Quaternary>
+float f16_lanes_dot_native(const uint8_t* row_data, const uint16_t* X, size_t& k, size_t k_end,
+                           const Fp16MaskTables& tables) {
+    const uint16_t (*sign)[4] = Quaternary ? tables.quaternary_sign : tables.ternary_sign;
+    const uint16_t (*keep)[4] = Quaternary ? tables.quaternary_big : tables.ternary_keep;
+    float32x4_t sum_all = vdupq_n_f32(0.0f);
+    float32x4_t sum_big = vdupq_n_f32(0.0f);
+
+    while (k + 8 <= k_end) {
+        size_t span_end = std::min(k_end, k + FP16_PROMOTE_SPAN);
+        float16x8_t all = vdupq_n_f16(0.0f);
+        float16x8_t big = vdupq_n_f16(0.0f);
+        for (; k + 8 <= span_end; k += 8) {
+            const uint8_t* bytes = row_data + (k >> 2);
+            uint16x8_t x = veorq_u16(vld1q_u16(&X[k]),
+                                     vcombine_u16(vld1_u16(sign[bytes[0]]), vld1_u16(sign[bytes[1]])));
+            uint16x8_t mask = vcombine_u16(vld1_u16(keep[bytes[0]]), vld1_u16(keep[bytes[1]]));
+            if (Quaternary) {
+                all = vaddq_f16(all, vreinterpretq_f16_u16(x));
+                big = vaddq_f16(big, vreinterpretq_f16_u16(vandq_u16(x, mask)));
+            } else {
+                all = vaddq_f16(all, vreinterpretq_f16_u16(vandq_u16(x, mask)));
+            }
+        }
+        sum_all = vaddq_f32(sum_all, vcvt_f32_f16(vget_low_f16(all)));
+        sum_all = vaddq_f32(sum_all, vcvt_high_f32_f16(all));
+        if (Quaternary) {
+            sum_big = vaddq_f32(sum_big, vcvt_f32_f16(vget_low_f16(big)));
+            sum_big = vaddq_f32(sum_big, vcvt_high_f32_f16(big));
+        }
+    }
+    if (k + 4 <= k_end) {
+        uint8_t byte = row_data[k >> 2];
+        uint16x4_t x = veor_u16(vld1_u16(&X[k]), vld1_u16(sign[byte]));
+        uint16x4_t mask = vld1_u16(keep[byte]);
+        float16x4_t zero = vdup_n_f16(0.0f);
+        if (Quaternary) {
+            sum_all = vaddq_f32(sum_all, vcvt_f32_f16(vadd_f16(zero, vreinterpret_f16_u16(x))));
+            sum_big = vaddq_f32(sum_big, vcvt_f32_f16(vadd_f16(zero, vreinterpret_f16_u16(vand_u16(x, mask)))));
+        } else {
+            sum_all = vaddq_f32(sum_all, vcvt_f32_f16(vadd_f16(zero, vreinterpret_f16_u16(vand_u16(x, mask)))));
+        }
+        k += 4;
+    }
+    return Quaternary ? 0.5f * vaddvq_f32(sum_all) + vaddvq_f32(sum_big) : vaddvq_f32(sum_all);
+}
+#endif
+
+// Y (fp16) = alpha * A * X (fp16) + beta * Y: fp16 block scales, fp16
+// lane accumulation promoted to fp32 per span, fp32 block and row sums
+template <bool Quaternary, bool Emulated, typename OutlierT>
+void gemv_2bit_f16_lanes(size_t M, size_t K, float alpha, const uint8_t* A_quantized,
+                         const uint16_t* A_scales, const uint16_t* X, float beta, uint16_t* Y,
+                         size_t block_size, OutlierT outliers) {
+    const Fp16MaskTables& tables = fp16_mask_tables();
+    size_t num_blocks_per_row = (K + block_size - 1) / block_size;
+    size_t bytes_per_row = (K * 2 + 7) / 8;
+    WeightStreamPrefetcher prefetcher(A_quantized, M * bytes_per_row);
+
+    for (size_t row = 0; row < M; ++row) {
+        const uint8_t* row_data = A_quantized + row * bytes_per_row;
+        float row_sum = 0.0f;
+
+        for (size_t block_idx = 0; block_idx < num_blocks_per_row; ++block_idx) {
+            size_t block = row * num_blocks_per_row + block_idx;
+            size_t k = block_idx * block_size;
+            size_t k_end = std::min(k + block_size, K);
+            float correction = outliers.block_dot_f16(block, &X[k]);
+            float block_sum = 0.0f;
+            prefetcher.advance(row_data + (k >> 2));
+
+            for (; k < k_end && (k & 3); ++k) {
+                block_sum += two_bit_level<Quaternary>(row_data, k) * fp16_to_fp32(X[k]);
+            }
+#ifdef KIPEPEO_F16_LANES
+            if (!Emulated) {
+                block_sum += f16_lanes_dot_native<Quaternary>(row_data, X, k, k_end, tables);
+            } else
+#endif
+            {
+                block_sum += f16_lanes_dot_emulated<Quaternary>(row_data, X, k, k_end, tables);
+            }
+            for (; k < k_end; ++k) {
+                block_sum += two_bit_level<Quaternary>(row_data, k) * fp16_to_fp32(X[k]);
+            }
+
+            row_sum += block_sum * fp16_to_fp32(A_scales[block]) + correction;
+        }
+
+        float y = alpha * row_sum;
+        if (beta != 0.0f) {
+            y += beta * fp16_to_fp32(Y[row]);
+        }
+        Y[row] = fp32_to_fp16(y);
+    }
+}
+
+// Rows of fp32 sums the widened fp16 path keeps on the stack
+constexpr size_t F16_WIDEN_ROW_TILE = 32;
+
+// Builds without fp16 arithmetic: X widened to fp32 once per call and the
+// fp32-activation kernel run on it, still reading fp16 scales
+template <bool Quaternary>
+void gemv_2bit_f16_widened(size_t M, size_t K, float alpha, const uint8_t* A_quantized,
+                           const uint16_t* A_scales, const uint16_t* X, float beta, uint16_t* Y,
+                           size_t block_size, const OutlierEntry* outliers, size_t outliers_per_block) {
+    const float* x32 = widen_f16_activations(K, X);
+    size_t row_bytes = (K * 2 + 7) / 8;
+    size_t num_blocks_per_row = (K + block_size - 1) / block_size;
+    float y32[F16_WIDEN_ROW_TILE];
+    for (size_t row = 0; row < M; row += F16_WIDEN_ROW_TILE) {
+        size_t rows = std::min(F16_WIDEN_ROW_TILE, M - row);
+        for (size_t i = 0; i < rows; ++i) {
+            y32[i] = beta != 0.0f ? beta * fp16_to_fp32(Y[row + i]) : 0.0f;
+        }
+        const uint8_t* A = A_quantized + row * row_bytes;
+        const uint16_t* S = A_scales + row * num_blocks_per_row;
+        const OutlierEntry* O = outliers ? outliers + row * num_blocks_per_row * outliers_per_block : nullptr;
+        if (Quaternary) {
+            gemv_quaternary_1_58bit_f16_scales(rows, K, alpha, A, S, x32, 1.0f, y32, block_size,
+                                               O, outliers_per_block);
+        } else {
+            gemv_ternary_1_28bit_f16_scales(rows, K, alpha, A, S, x32, 1.0f, y32, block_size,
+                                            O, outliers_per_block);
+        }
+        for (size_t i = 0; i < rows; ++i) {
+            Y[row + i] = fp32_to_fp16(y32[i]);
+        }
+    }
+}
+
+template <bool Quaternary, bool Emulated>
+void gemv_2bit_f16(size_t M, size_t K, float alpha, const uint8_t* A_quantized,
+                   const uint16_t* A_scales, const uint16_t* X, float beta, uint16_t* Y,
+                   size_t block_size, const OutlierEntry* outliers, size_t outliers_per_block) {
+#ifndef KIPEPEO_F16_LANES
+    if (!Emulated) {
+        gemv_2bit_f16_widened<Quaternary>(M, K, alpha, A_quantized, A_scales, X, beta, Y, block_size,
+                                          outliers, outliers_per_block);
+        return;
+    }
+#endif
+    if (outliers && outliers_per_block > 0) {
+        gemv_2bit_f16_lanes<Quaternary, Emulated>(M, K, alpha, A_quantized, A_scales, X, beta, Y, block_size,
+                                                  BlockOutliers{outliers, outliers_per_block});
+    } else {
+        gemv_2bit_f16_lanes<Quaternary, Emulated>(M, K, alpha, A_quantized, A_scales, X, beta, Y, block_size,
+                                                  NoOutliers());
+    }
+}
+
+} // anonymous namespace
+
+bool gemv_f16_native_accumulation() {
+#ifdef KIPEPEO_F16_LANES
+    return true;
+#else
+    return false;
+#endif
+}
+
+const float* widen_f16_activations(size_t K, const uint16_t* X) {
+    thread_local std::vector<float> scratch;
+    if (scratch.size() < K) {
+        scratch.resize(K);
+    }
+    for (size_t k = 0; k < K; ++k) {
+        scratch[k] = fp16_to_fp32(X[k]);
+    }
+    return scratch.data();
+}
+
+void gemv_ternary_1_28bit_f16(size_t M, size_t K, float alpha, const uint8_t* A_quantized,
+                              const uint16_t* A_scales, const uint16_t* X, float beta, uint16_t* Y,
+                              size_t block_size, const OutlierEntry* outliers, size_t outliers_per_block) {
+    gemv_2bit_f16<false, false>(M, K, alpha, A_quantized, A_scales, X, beta, Y, block_size,
+                                outliers, outliers_per_block);
+}
+
+void gemv_quaternary_1_58bit_f16(size_t M, size_t K, float alpha, const uint8_t* A_quantized,
+                                 const uint16_t* A_scales, const uint16_t* X, float beta, uint16_t* Y,
+                                 size_t block_size, const OutlierEntry* outliers, size_t outliers_per_block) {
+    gemv_2bit_f16<true, false>(M, K, alpha, A_quantized, A_scales, X, beta, Y, block_size,
+                               outliers, outliers_per_block);
+}
+
+void gemv_ternary_1_28bit_f16_emulated(size_t M, size_t K, float alpha, const uint8_t* A_quantized,
+                                       const uint16_t* A_scales, const uint16_t* X, float beta, uint16_t* Y,
+                                       size_t block_size, const OutlierEntry* outliers,
+                                       size_t outliers_per_block) {
+    gemv_2bit_f16<false, true>(M, K, alpha, A_quantized, A_scales, X, beta, Y, block_size,
+                               outliers, outliers_per_block);
+}
+
+void gemv_quaternary_1_58bit_f16_emulated(size_t M, size_t K, float alpha, const uint8_t* A_quantized,
+                                          const uint16_t* A_scales, const uint16_t* X, float beta, uint16_t* Y,
+                                          size_t block_size, const OutlierEntry* outliers,
+                                          size_t outliers_per_block) {
+    gemv_2bit_f16<true, true>(M, K, alpha, A_quantized, A_scales, X, beta, Y, block_size,
+                              outliers, outliers_per_block);
+}
+
+// ========== Tiled GEMM (prompt prefill) ==========
+
+namespace {
+
+// Cache blocking: a KC-deep slice of up to NC activation columns is packed
+// once (L2-resident), and each MR-row weight panel of that slice is decoded
+// once (MR * KC floats, L1-resident) and reused across all NC columns
+constexpr size_t GEMM_KC = 256;
+constexpr size_t GEMM_NC = 256;
+
+// Largest register tile any path uses (x86 AVX-512 12x32)
+constexpr size_t GEMM_MAX_TILE = 12 * 32;
+
+// Register tile: acc[r][c] (row stride ldc) = or += sum_k a[k][r] * x[k][c],
+// with a packed k-major in MR-wide rows and x in NR-wide rows. Same
+// signature and panel layout as the packed FP32 GEMM's micro-kernels
+// (x86::GemmF32MicroFn).
+template <size_t MR, size_t NR>
+void gemm_micro_kernel(size_t kc, const float* a, const float* x, float* acc, size_t ldc, bool accumulate) {
+#ifdef KIPEPEO_NEON_ENABLED
+    static_assert(NR % 4 == 0, "NEON micro-kernel vectorizes along NR");
+    float32x4_t c[MR][NR / 4];
+    for (size_t r = 0; r < MR; ++r) {
+        for (size_t v = 0; v < NR / 4; ++v) {
+            c[r][v] = accumulate ? vld1q_f32(acc + r * ldc + v * 4) : vdupq_n_f32(0.0f);
+        }
+    }
+    for (size_t k = 0; k < kc; ++k) {
+        float32x4_t xv[NR / 4];
+        for (size_t v = 0; v < NR / 4; ++v) {
+            xv[v] = vld1q_f32(x + k * NR + v * 4);
+        }
+        const float* ak = a + k * MR;
+        for (size_t r = 0; r < MR; ++r) {
+            float32x4_t ar = vdupq_n_f32(ak[r]);
+            for (size_t v = 0; v < NR / 4; ++v) {
+                c[r][v] = vfmaq_f32(c[r][v], xv[v], ar);
+            }
+        }
+    }
+    for (size_t r = 0; r < MR; ++r) {
+        for (size_t v = 0; v < NR / 4; ++v) {
+            vst1q_f32(acc + r * ldc + v * 4, c[r][v]);
+        }
+    }
+#else
+    float c[MR][NR];
+    for (size_t r = 0; r < MR; ++r) {
+        for (size_t j = 0; j < NR; ++j) {
+            c[r][j] = accumulate ? acc[r * ldc + j] : 0.0f;
+        }
+    }
+    for (size_t k = 0; k < kc; ++k) {
+        const float* xk = x + k * NR;
+        for (size_t r = 0; r < MR; ++r) {
+            float ar = a[k * MR + r];
+            for (size_t j = 0; j < NR; ++j) {
+                c[r][j] += ar * xk[j];
+            }
+        }
+    }
+    for (size_t r = 0; r < MR; ++r) {
+        for (size_t j = 0; j < NR; ++j) {
+            acc[r * ldc + j] = c[r][j];
+        }
+    }
+#endif
+}
+
+using GemmMicroKernel = void (*)(size_t, const float*, const float*, float*, size_t, bool);
+
+struct GemmTile {
+    size_t mr;
+    size_t nr;
+    GemmMicroKernel kernel;
+};
+
+// Map a requested MR x NR (see get_optimal_block_size) to an instantiated
+// register tile. Wider requests are capped at 8 x 8: 16 accumulators plus
+// operands already fill most of the 32 NEON registers. On x86 the decoded
+// panels go through the AVX2 / AVX-512 FP32 micro-kernels, whose tile is
+// fixed by the instruction set.
+GemmTile select_gemm_tile(size_t MR, size_t NR) {
+#ifdef KIPEPEO_X86_ENABLED
+    size_t x86_mr, x86_nr;
+    if (x86::GemmF32MicroFn x86_kernel = x86::select_gemm_f32_micro_kernel(x86_mr, x86_nr)) {
+        return {x86_mr, x86_nr, x86_kernel};
+    }
+#endif
+    if (NR >= 8) {
+        if (MR >= 8) return {8, 8, gemm_micro_kernel<8, 8>};
+        if (MR >= 6) return {6, 8, gemm_micro_kernel<6, 8>};
+        return {4, 8, gemm_micro_kernel<4, 8>};
+    }
+    if (MR >= 8) return {8, 4, gemm_micro_kernel<8, 4>};
+    if (MR >= 6) return {6, 4, gemm_micro_kernel<6, 4>};
+    return {4, 4, gemm_micro_kernel<4, 4>};
+}
+
+// Decode rows [row0, row0 + mr) x columns [k0, k0 + kc) of the packed
+// weights into a k-major float panel with block scales and outlier
+// residuals folded in. k0 is block aligned; rows past M are zero.
+template <typename ScaleT, typename DecoderT, typename OutlierT>
+void gemm_pack_weights(
+    const uint8_t* A_quantized, ScaleT A_scales, size_t M, size_t K,
+    size_t block_size, size_t num_blocks_per_row, size_t bytes_per_row,
+    const DecoderT& decoder, const OutlierT& outliers,
+    size_t row0, size_t mr, size_t k0, size_t kc, float* panel
+) {
+    int8_t w[A8_CHUNK];
+    for (size_t r = 0; r < mr; ++r) {
+        size_t row = row0 + r;
+        if (row >= M) {
+            for (size_t k = 0; k < kc; ++k) {
+                panel[k * mr + r] = 0.0f;
+            }
+            continue;
+        }
+
+        const uint8_t* row_data = A_quantized + row * bytes_per_row;
+        for (size_t k_start = k0; k_start < k0 + kc; k_start += block_size) {
+            size_t block_idx = k_start / block_size;
+            size_t block_count = std::min(block_size, K - k_start);
+            size_t meta_idx = row * num_blocks_per_row + block_idx;
+            float scale = A_scales[meta_idx] * decoder.level_scale;
+            float* dst = panel + (k_start - k0) * mr + r;
+
+            for (size_t j = 0; j < block_count; j += A8_CHUNK) {
+                size_t n = std::min(A8_CHUNK, block_count - j);
+                decoder.decode(row_data, block_idx, block_size, j, n, w);
+                for (size_t t = 0; t < n; ++t) {
+                    dst[(j + t) * mr] = w[t] * scale;
+                }
+            }
+            outliers.add_to_block(meta_idx, dst, mr);
+        }
+    }
+}
+
+} // anonymous namespace
+
+template <typename ScaleT, typename DecoderT, typename OutlierT>
+static void gemm_impl(
+    size_t M,
+    size_t N,
+    size_t K,
+    float alpha,
+    const uint8_t* A_quantized,
+    ScaleT A_scales,
+    const float* X,
+    float beta,
+    float* Y,
+    size_t block_size,
+    size_t MR,
+    size_t NR,
+    DecoderT decoder,
+    OutlierT outliers
+) {
+    if (beta == 0.0f) {
+        memset(Y, 0, M * N * sizeof(float));
+    } else if (beta != 1.0f) {
+        for (size_t i = 0; i < M * N; ++i) {
+            Y[i] *= beta;
+        }
+    }
+    if (M == 0 || N == 0 || K == 0) {
+        return;
+    }
+
+    size_t num_blocks_per_row = (K + block_size - 1) / block_size;
+    size_t bytes_per_row = decoder.row_bytes(K, block_size);
+
+    GemmTile tile = select_gemm_tile(MR, NR);
+    size_t mr = tile.mr;
+    size_t nr = tile.nr;
+    size_t kc_max = std::max(block_size, GEMM_KC / block_size * block_size);
+    size_t nc_max = std::min(GEMM_NC, N);
+
+    std::vector<float> x_panel(((nc_max + nr - 1) / nr) * nr * kc_max);
+    std::vector<float> a_panel(mr * kc_max);
+    float acc[GEMM_MAX_TILE];
+
+    for (size_t j0 = 0; j0 < N; j0 += GEMM_NC) {
+        size_t nc = std::min(GEMM_NC, N - j0);
+
+        for (size_t k0 = 0; k0 < K; k0 += kc_max) {
+            size_t kc = std::min(kc_max, K - k0);
+
+            // Pack X[j0 .. j0 + nc)[k0 .. k0 + kc) as NR-wide k-major strips,
+            // zero-padding the last strip
+            for (size_t jr = 0; jr < nc; jr += nr) {
+                float* strip = x_panel.data() + jr * kc;
+                for (size_t c = 0; c < nr; ++c) {
+                    if (jr + c < nc) {
+                        const float* x = X + (j0 + jr + c) * K + k0;
+                        for (size_t k = 0; k < kc; ++k) {
+                            strip[k * nr + c] = x[k];
+                        }
+                    } else {
+                        for (size_t k = 0; k < kc; ++k) {
+                            strip[k * nr + c] = 0.0f;
+                        }
+                    }
+                }
+            }
+
+            for (size_t i0 = 0; i0 < M; i0 += mr) {
+                gemm_pack_weights(A_quantized, A_scales, M, K, block_size, num_blocks_per_row,
+                                  bytes_per_row, decoder, outliers, i0, mr, k0, kc, a_panel.data());
+
+                size_t rows = std::min(mr, M - i0);
+                for (size_t jr = 0; jr < nc; jr += nr) {
+                    tile.kernel(kc, a_panel.data(), x_panel.data() + jr * kc, acc, nr, false);
+
+                    size_t cols = std::min(nr, nc - jr);
+                    for (size_t c = 0; c < cols; ++c) {
+                        float* y = Y + (j0 + jr + c) * M + i0;
+                        for (size_t r = 0; r < rows; ++r) {
+                            y[r] += alpha * acc[r * nr + c];
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+void gemm_ternary_1_28bit(size_t M, size_t N, size_t K, float alpha, const uint8_t* A_quantized,
+                          const float* A_scales, const float* X, float beta, float* Y,
+                          size_t block_size, size_t MR, size_t NR,
+                          const OutlierEntry* outliers, size_t outliers_per_block) {
+    if (outliers && outliers_per_block > 0) {
+        gemm_impl(M, N, K, alpha, A_quantized, F32Scales{A_scales}, X, beta, Y, block_size, MR, NR,
+                  TwoBitDecoder{a8_tables().ternary, 1.0f}, BlockOutliers{outliers, outliers_per_block});
+    } else {
+        gemm_impl(M, N, K, alpha, A_quantized, F32Scales{A_scales}, X, beta, Y, block_size, MR, NR,
+                  TwoBitDecoder{a8_tables().ternary, 1.0f}, NoOutliers());
+    }
+}
+
+void gemm_ternary_1_28bit_f16_scales(size_t M, size_t N, size_t K, float alpha, const uint8_t* A_quantized,
+                                     const uint16_t* A_scales, const float* X, float beta, float* Y,
+                                     size_t block_size, size_t MR, size_t NR,
+                                     const OutlierEntry* outliers, size_t outliers_per_block) {
+    if (outliers && outliers_per_block > 0) {
+        gemm_impl(M, N, K, alpha, A_quantized, F16Scales{A_scales}, X, beta, Y, block_size, MR, NR,
+                  TwoBitDecoder{a8_tables().ternary, 1.0f}, BlockOutliers{outliers, outliers_per_block});
+    } else {
+        gemm_impl(M, N, K, alpha, A_quantized, F16Scales{A_scales}, X, beta, Y, block_size, MR, NR,
+                  TwoBitDecoder{a8_tables().ternary, 1.0f}, NoOutliers());
+    }
+}
+
+void gemm_ternary_1_28bit_base3(size_t M, size_t N, size_t K, float alpha, const uint8_t* A_quantized,
+                                const float* A_scales, const float* X, float beta, float* Y,
+                                size_t block_size, size_t MR, size_t NR,
+                                const OutlierEntry* outliers, size_t outliers_per_block) {
+    if (outliers && outliers_per_block > 0) {
+        gemm_impl(M, N, K, alpha, A_quantized, F32Scales{A_scales}, X, beta, Y, block_size, MR, NR,
+                  Base3Decoder{base3_tables().trits, 1.0f}, BlockOutliers{outliers, outliers_per_block});
+    } else {
+        gemm_impl(M, N, K, alpha, A_quantized, F32Scales{A_scales}, X, beta, Y, block_size, MR, NR,
+                  Base3Decoder{base3_tables().trits, 1.0f}, NoOutliers());
+    }
+}
+
+void gemm_ternary_1_28bit_base3_f16_scales(size_t M, size_t N, size_t K, float alpha, const uint8_t* A_quantized,
+                                           const uint16_t* A_scales, const float* X, float beta, float* Y,
+                                           size_t block_size, size_t MR, size_t NR,
+                                           const OutlierEntry* outliers, size_t outliers_per_block) {
+    if (outliers && outliers_per_block > 0) {
+        gemm_impl(M, N, K, alpha, A_quantized, F16Scales{A_scales}, X, beta, Y, block_size, MR, NR,
+                  Base3Decoder{base3_tables().trits, 1.0f}, BlockOutliers{outliers, outliers_per_block});
+    } else {
+        gemm_impl(M, N, K, alpha, A_quantized, F16Scales{A_scales}, X, beta, Y, block_size, MR, NR,
+                  Base3Decoder{base3_tables().trits, 1.0f}, NoOutliers());
+    }
+}
+
+void gemm_quaternary_1_58bit(size_t M, size_t N, size_t K, float alpha, const uint8_t* A_quantized,
+                             const float* A_scales, const float* X, float beta, float* Y,
+                             size_t block_size, size_t MR, size_t NR,
+                             const OutlierEntry* outliers, size_t outliers_per_block) {
+    if (outliers && outliers_per_block > 0) {
+        gemm_impl(M, N, K, alpha, A_quantized, F32Scales{A_scales}, X, beta, Y, block_size, MR, NR,
+                  TwoBitDecoder{a8_tables().quaternary, 0.5f}, BlockOutliers{outliers, outliers_per_block});
+    } else {
+        gemm_impl(M, N, K, alpha, A_quantized, F32Scales{A_scales}, X, beta, Y, block_size, MR, NR,
+                  TwoBitDecoder{a8_tables().quaternary, 0.5f}, NoOutliers());
+    }
+}
+
+void gemm_quaternary_1_58bit_f16_scales(size_t M, size_t N, size_t K, float alpha, const uint8_t* A_quantized,
+                                        const uint16_t* A_scales, const float* X, float beta, float* Y,
+                                        size_t block_size, size_t MR, size_t NR,
+                                        const OutlierEntry* outliers, size_t outliers_per_block) {
+    if (outliers && outliers_per_block > 0) {
+        gemm_impl(M, N, K, alpha, A_quantized, F16Scales{A_scales}, X, beta, Y, block_size, MR, NR,
+                  TwoBitDecoder{a8_tables().quaternary, 0.5f}, BlockOutliers{outliers, outliers_per_block});
+    } else {
+        gemm_impl(M, N, K, alpha, A_quantized, F16Scales{A_scales}, X, beta, Y, block_size, MR, NR,
+                  TwoBitDecoder{a8_tables().quaternary, 0.5f}, NoOutliers());
+    }
+}
+
+void gemv_int8(size_t M, size_t K, float alpha, const int8_t* A_quantized,
+               const float* A_scales, const float* X, float beta, float* Y) {
+    // Activation codes live in per-thread scratch, reused across calls
+    thread_local std::vector<int8_t> X_q;
+    thread_local std::vector<float> X_scales;
+    size_t num_blocks = (K + GEMV_INT8_BLOCK - 1) / GEMV_INT8_BLOCK;
+    if (X_q.size() < K) {
+        X_q.resize(K);
+    }
+    if (X_scales.size() < num_blocks) {
+        X_scales.resize(num_blocks);
+    }
+    quantize_activations_int8(K, X, X_q.data(), X_scales.data(), GEMV_INT8_BLOCK);
+
+    if (beta == 0.0f) {
+        memset(Y, 0, M * sizeof(float));
+    } else if (beta != 1.0f) {
+        for (size_t i = 0; i < M; ++i) {
+            Y[i] *= beta;
+        }
+    }
+
+    const uint8_t* weights = reinterpret_cast<const uint8_t*>(A_quantized);
+    WeightStreamPrefetcher prefetcher(weights, M * K);
+    for (size_t row = 0; row < M; ++row) {
+        const int8_t* a = A_quantized + row * K;
+        float row_sum = 0.0f;
+        for (size_t block_idx = 0; block_idx < num_blocks; ++block_idx) {
+            size_t k_start = block_idx * GEMV_INT8_BLOCK;
+            size_t n = std::min(GEMV_INT8_BLOCK, K - k_start);
+            prefetcher.advance(weights + row * K + k_start);
+            row_sum += X_scales[block_idx] * static_cast<float>(dot_i8(a + k_start, X_q.data() + k_start, n));
+        }
+        Y[row] += alpha * A_scales[row] * row_sum;
+    }
+}
+
+void gemv_batch_1_28bit(size_t batch_size, size_t M, size_t K,
+                       const uint8_t* A_quantized, const float* A_scales,
+                       const float* X_batch, float* Y_batch, size_t block_size) {
+    // Same layout as the tiled GEMM: batch_size x K in, batch_size x M out
+    gemm_ternary_1_28bit(M, batch_size, K, 1.0f, A_quantized, A_scales,
+                         X_batch, 0.0f, Y_batch, block_size);
+}
+
 } // namespace neon
 } // namespace kernels
 } // namespace kipepeo
@@ -20,7 +20,7 @@ void snapdragon_matrix_multiply_f32(const float* A, const float* B, float* C,
     }
 }
 
-void snapdragon_matrix_multiply_f16(const __fp16* A, const __fp16* B, __fp16* C,
+void snapdragon_matrix_multiply_f16(const fp16_t* A, const fp16_t* B, fp16_t* C,
                                     size_t M, size_t N, size_t K, ChipType chip) {
     switch (chip) {
         case ChipType::QUALCOMM_SNAPDRAGON_7S_GEN2:
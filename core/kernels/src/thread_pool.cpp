@@ -0,0 +1,375 @@
+#include "kipepeo/kernels/thread_pool.h"
+#include "kipepeo/kernels/cpu_capabilities.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__) || defined(__ANDROID__)
+#include <sched.h>
+#define KIPEPEO_CAN_PIN_THREADS 1
+#endif
+
+namespace kipepeo {
+namespace kernels {
+
+namespace {
+
+// Below this much work per thread (weights for a GEMV row range) the wake-up
+// and join cost outweighs the split
+constexpr size_t MIN_COST_PER_THREAD = 32 * 1024;
+
+// Busy-wait iterations before a worker (or a waiting caller) sleeps;
+// roughly 50-100 us, enough to bridge consecutive GEMVs of a decode step
+constexpr int SPIN_ITERATIONS = 20000;
+
+inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+void pin_current_thread(const std::vector<int>& cpus) {
+#ifdef KIPEPEO_CAN_PIN_THREADS
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : cpus) {
+        CPU_SET(cpu, &set);
+    }
+    // Best effort: a restricted cpuset leaves the thread unpinned
+    sched_setaffinity(0, sizeof(set), &set);
+#else
+    (void)cpus;
+#endif
+}
+
+// One thread's place in a job: the cluster it is pinned to (empty = not
+// pinned), its speed relative to the slowest cluster, which sizes its
+// initial share, and the units it claims at a time
+struct Slot {
+    std::vector<int> cpus;
+    float speed;
+    size_t tile_units;
+    bool big_core;
+};
+
+// Fastest cores first, one slot per core. Each thread is pinned to its
+// core's whole cluster rather than the core, so the scheduler can still
+// move it off a core taken by another process without crossing clusters.
+// Speeds stay equal unless threads can actually be kept on their cluster.
+std::vector<Slot> plan_slots(size_t num_threads) {
+    std::vector<Slot> slots;
+#ifdef KIPEPEO_CAN_PIN_THREADS
+    std::vector<CpuCore> cores = get_cpu_capabilities().cores;
+    std::stable_sort(cores.begin(), cores.end(), [](const CpuCore& a, const CpuCore& b) {
+        return a.capacity > b.capacity;
+    });
+    if (!cores.empty() && cores.front().capacity > cores.back().capacity) {
+        uint32_t slowest = cores.back().capacity;
+        for (const CpuCore& core : cores) {
+            Slot slot;
+            for (const CpuCore& other : cores) {
+                if (other.capacity == core.capacity) {
+                    slot.cpus.push_back(other.cpu);
+                }
+            }
+            slot.speed = static_cast<float>(core.capacity) / static_cast<float>(slowest);
+            // A claim takes about the same time on every core, so the
+            // last claims of a job end together and a thief never waits
+            // behind a long little-core tile
+            slot.tile_units = std::max<size_t>(1, static_cast<size_t>(slot.speed + 0.5f));
+            slot.big_core = core.capacity > slowest;
+            slots.push_back(slot);
+        }
+    }
+#endif
+    slots.resize(std::min(slots.size(), num_threads));
+    slots.resize(num_threads, Slot{{}, slots.empty() ? 1.0f : slots.back().speed, 1, slots.empty()});
+    return slots;
+}
+
+thread_local bool t_in_job = false;
+thread_local bool t_big_core = true;
+
+// Unclaimed units [begin, end) of one slot, packed so the owner (taking
+// from the front) and thieves (taking from the back) race through one CAS
+struct alignas(64) SlotRange {
+    std::atomic<uint64_t> packed{0};
+};
+
+inline uint64_t pack_range(uint64_t begin, uint64_t end) {
+    return (begin << 32) | end;
+}
+
+struct alignas(64) WorkerState {
+    std::atomic<uint64_t> generation{0};
+};
+
+} // anonymous namespace
+
+class ThreadPool::Impl {
+public:
+    explicit Impl(size_t num_threads) {
+        if (num_threads == 0) {
+            num_threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+        }
+        slots = plan_slots(num_threads);
+        // Oversubscribed: a spinning thread would steal the core another
+        // thread of the same job needs, so park immediately
+        size_t hw = std::thread::hardware_concurrency();
+        spin_iterations = hw != 0 && num_threads > hw ? 0 : SPIN_ITERATIONS;
+        states.reset(new WorkerState[num_threads]);
+        ranges.reset(new SlotRange[num_threads]);
+        for (size_t w = 0; w + 1 < num_threads; ++w) {
+            workers.emplace_back(&Impl::worker_main, this, w);
+        }
+    }
+
+    ~Impl() {
+        {
+            std::lock_guard<std::mutex> lock(wake_mutex);
+            stop.store(true, std::memory_order_relaxed);
+        }
+        wake_cv.notify_all();
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+    }
+
+    void run(size_t count, size_t grain, size_t cost_per_item, RangeFnRef fn) {
+        grain = std::max<size_t>(grain, 1);
+        size_t units = (count + grain - 1) / grain;
+        size_t by_cost = count * cost_per_item / MIN_COST_PER_THREAD;
+        size_t active = std::min({slots.size(), units, std::max<size_t>(by_cost, 1)});
+
+        std::unique_lock<std::mutex> job_lock;
+        if (active > 1 && !t_in_job) {
+            job_lock = std::unique_lock<std::mutex>(job_mutex, std::try_to_lock);
+        }
+        if (!job_lock.owns_lock()) {
+            fn(0, count);
+            return;
+        }
+
+        // Initial ranges in proportion to slot speed; the caller takes the
+        // last (slowest) one since it is not pinned. Imbalance left over
+        // (a core busy with another process, a throttled cluster) is
+        // evened out by stealing.
+        float total = 0.0f;
+        for (size_t s = 0; s < active; ++s) {
+            total += slots[s].speed;
+        }
+        float cumulative = 0.0f;
+        size_t begin = 0;
+        for (size_t s = 0; s < active; ++s) {
+            cumulative += slots[s].speed;
+            size_t end = s + 1 == active ? units
+                : std::max(begin, std::min(units, static_cast<size_t>(
+                      static_cast<float>(units) * cumulative / total + 0.5f)));
+            ranges[s].packed.store(pack_range(begin, end), std::memory_order_relaxed);
+            begin = end;
+        }
+        job = &fn;
+        job_count = count;
+        job_grain = grain;
+        job_active = active;
+        pending.store(active - 1, std::memory_order_relaxed);
+
+        uint64_t generation = ++job_generation;
+        for (size_t w = 0; w + 1 < active; ++w) {
+            states[w].generation.store(generation, std::memory_order_release);
+        }
+        {
+            // Pairs with the predicate check of a worker about to sleep
+            std::lock_guard<std::mutex> lock(wake_mutex);
+        }
+        wake_cv.notify_all();
+
+        bool big_core = t_big_core;
+        t_in_job = true;
+        t_big_core = slots[active - 1].big_core;
+        work(active - 1);
+        t_in_job = false;
+        t_big_core = big_core;
+
+        for (int spin = 0; pending.load(std::memory_order_acquire) != 0 && spin < spin_iterations; ++spin) {
+            cpu_relax();
+        }
+        if (pending.load(std::memory_order_acquire) != 0) {
+            std::unique_lock<std::mutex> lock(wake_mutex);
+            done_cv.wait(lock, [this] { return pending.load(std::memory_order_acquire) == 0; });
+        }
+        job = nullptr;
+    }
+
+    std::vector<Slot> slots;   // slots[w] for worker w, the caller takes the last active one
+    std::vector<std::thread> workers;
+    std::unique_ptr<WorkerState[]> states;
+    int spin_iterations = SPIN_ITERATIONS;
+
+private:
+    // Claim tiles from the own range, then steal half of the largest
+    // remaining range until every range is empty
+    void work(size_t self) {
+        const size_t tile = slots[self].tile_units;
+        SlotRange& own = ranges[self];
+        for (;;) {
+            uint64_t packed = own.packed.load(std::memory_order_acquire);
+            uint64_t begin = packed >> 32;
+            uint64_t end = packed & 0xFFFFFFFFu;
+            if (begin < end) {
+                uint64_t claim_end = std::min<uint64_t>(end, begin + tile);
+                if (own.packed.compare_exchange_weak(packed, pack_range(claim_end, end),
+                                                     std::memory_order_acq_rel)) {
+                    (*job)(begin * job_grain, std::min<size_t>(claim_end * job_grain, job_count));
+                }
+                continue;
+            }
+            if (!steal(self)) {
+                return;
+            }
+        }
+    }
+
+    bool steal(size_t self) {
+        for (;;) {
+            size_t victim = job_active;
+            uint64_t most = 0;
+            for (size_t s = 0; s < job_active; ++s) {
+                uint64_t packed = ranges[s].packed.load(std::memory_order_acquire);
+                uint64_t remaining = (packed & 0xFFFFFFFFu) - std::min(packed >> 32, packed & 0xFFFFFFFFu);
+                if (s != self && remaining > most) {
+                    most = remaining;
+                    victim = s;
+                }
+            }
+            if (victim == job_active) {
+                return false;
+            }
+
+            uint64_t packed = ranges[victim].packed.load(std::memory_order_acquire);
+            uint64_t begin = packed >> 32;
+            uint64_t end = packed & 0xFFFFFFFFu;
+            if (begin >= end) {
+                continue;
+            }
+            uint64_t split = end - (end - begin + 1) / 2;
+            if (ranges[victim].packed.compare_exchange_strong(packed, pack_range(begin, split),
+                                                              std::memory_order_acq_rel)) {
+                // Own range is empty, so no thief touches it until this store
+                ranges[self].packed.store(pack_range(split, end), std::memory_order_release);
+                return true;
+            }
+        }
+    }
+
+    void worker_main(size_t index) {
+        if (!slots[index].cpus.empty()) {
+            pin_current_thread(slots[index].cpus);
+        }
+        t_in_job = true;
+        t_big_core = slots[index].big_core;
+        WorkerState& state = states[index];
+        uint64_t seen = 0;
+
+        for (;;) {
+            for (int spin = 0; state.generation.load(std::memory_order_acquire) == seen &&
+                               spin < spin_iterations; ++spin) {
+                cpu_relax();
+            }
+            if (state.generation.load(std::memory_order_acquire) == seen) {
+                std::unique_lock<std::mutex> lock(wake_mutex);
+                wake_cv.wait(lock, [&] {
+                    return stop.load(std::memory_order_relaxed) ||
+                           state.generation.load(std::memory_order_acquire) != seen;
+                });
+            }
+            if (stop.load(std::memory_order_relaxed)) {
+                return;
+            }
+            seen = state.generation.load(std::memory_order_acquire);
+
+            // Job fields were written before this worker's generation
+            work(index);
+            if (pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                std::lock_guard<std::mutex> lock(wake_mutex);
+                done_cv.notify_one();
+            }
+        }
+    }
+
+    std::mutex job_mutex;   // Held by the thread whose job is running
+
+    // Current job, stable until pending drops to zero
+    const RangeFnRef* job = nullptr;
+    size_t job_count = 0;
+    size_t job_grain = 1;
+    size_t job_active = 0;
+    std::unique_ptr<SlotRange[]> ranges;
+    uint64_t job_generation = 0;
+    std::atomic<size_t> pending{0};
+
+    std::mutex wake_mutex;
+    std::condition_variable wake_cv;
+    std::condition_variable done_cv;
+    std::atomic<bool> stop{false};
+};
+
+ThreadPool::ThreadPool(size_t num_threads)
+    : impl_(new Impl(num_threads)) {}
+
+ThreadPool::~ThreadPool() {
+    delete impl_;
+}
+
+size_t ThreadPool::num_threads() const {
+    return impl_->slots.size();
+}
+
+void ThreadPool::run(size_t count, size_t grain, size_t cost_per_item, RangeFnRef fn) {
+    if (count == 0) {
+        return;
+    }
+    impl_->run(count, grain, cost_per_item, fn);
+}
+
+// ========== Process-wide kernel pool ==========
+
+namespace {
+    std::mutex g_pool_mutex;
+    std::unique_ptr<ThreadPool> g_pool;
+    size_t g_requested_threads = 0;
+} // anonymous namespace
+
+ThreadPool& get_kernel_thread_pool() {
+    std::lock_guard<std::mutex> lock(g_pool_mutex);
+    if (!g_pool) {
+        g_pool.reset(new ThreadPool(g_requested_threads));
+    }
+    return *g_pool;
+}
+
+void set_kernel_num_threads(size_t num_threads) {
+    std::lock_guard<std::mutex> lock(g_pool_mutex);
+    if (g_pool && num_threads == g_requested_threads) {
+        return;
+    }
+    g_requested_threads = num_threads;
+    g_pool.reset();
+}
+
+size_t get_kernel_num_threads() {
+    return get_kernel_thread_pool().num_threads();
+}
+
+bool current_thread_on_big_core() {
+    return t_big_core;
+}
+
+} // namespace kernels
+} // namespace kipepeo
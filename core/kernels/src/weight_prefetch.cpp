@@ -0,0 +1,69 @@
+#include "kipepeo/kernels/weight_prefetch.h"
+#include "kipepeo/kernels/cpu_capabilities.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+
+namespace kipepeo {
+namespace kernels {
+
+namespace {
+
+constexpr size_t CACHE_LINE = 64;
+
+// L2 assumed when sysfs / sysctl report none
+constexpr size_t DEFAULT_L2_BYTES = 256 * 1024;
+
+std::atomic<size_t>& prefetch_distance() {
+    static std::atomic<size_t> distance([] {
+        const char* value = std::getenv("KIPEPEO_PREFETCH_DISTANCE");
+        return value ? static_cast<size_t>(std::strtoull(value, nullptr, 10)) : size_t(0);
+    }());
+    return distance;
+}
+
+// Pending layer-ahead range of this thread (prefetch_next_weights)
+thread_local WeightPrefetchRange pending_ahead = {nullptr, 0};
+
+} // anonymous namespace
+
+void set_weight_prefetch_distance(size_t bytes) {
+    prefetch_distance().store(bytes, std::memory_order_relaxed);
+}
+
+size_t get_weight_prefetch_distance() {
+    return prefetch_distance().load(std::memory_order_relaxed);
+}
+
+size_t get_layer_ahead_budget() {
+    static const size_t budget = [] {
+        size_t l2 = get_cpu_capabilities().caches.l2;
+        return (l2 != 0 ? l2 : DEFAULT_L2_BYTES) / 2;
+    }();
+    return budget;
+}
+
+void prefetch_next_weights(const void* data, size_t bytes) {
+    pending_ahead.data = static_cast<const uint8_t*>(data);
+    pending_ahead.bytes = data ? bytes : 0;
+}
+
+WeightPrefetchRange take_next_weights() {
+    WeightPrefetchRange ahead = pending_ahead;
+    pending_ahead = {nullptr, 0};
+    ahead.bytes = std::min(ahead.bytes, get_layer_ahead_budget());
+    return ahead;
+}
+
+void prefetch_row_share(const WeightPrefetchRange& ahead, size_t count, size_t begin, size_t end) {
+    // Lines are issued from the first line starting in the share, so
+    // neighbouring chunks never prefetch the same line twice
+    size_t from = (begin * ahead.bytes / count + CACHE_LINE - 1) / CACHE_LINE * CACHE_LINE;
+    size_t to = end * ahead.bytes / count;
+    for (size_t offset = from; offset < to; offset += CACHE_LINE) {
+        __builtin_prefetch(ahead.data + offset, 0, 2);
+    }
+}
+
+} // namespace kernels
+} // namespace kipepeo
@@ -0,0 +1,453 @@
+#include "kipepeo/kernels/x86/x86_kernels.h"
+#include <cstring>
+
+#include <immintrin.h>
+
+// Per-function target so this file builds with the default x86-64 flags;
+// callers only reach these functions once get_x86_level() >= AVX2
+#if defined(__GNUC__) || defined(__clang__)
+#define KIPEPEO_TARGET_AVX2 __attribute__((target("avx2,fma,f16c")))
+#else
+#define KIPEPEO_TARGET_AVX2
+#endif
+
+namespace kipepeo {
+namespace kernels {
+namespace x86 {
+
+namespace {
+
+// 2-bit codes of 8 consecutive values: the 16 bits holding them are
+// broadcast and lane i is shifted right by 2i. vpermilps only looks at
+// the low two bits of each index, so no masking is needed before the
+// level lookup.
+KIPEPEO_TARGET_AVX2
+inline __m256 lookup_8(uint32_t bits, __m256 levels, __m256i shifts) {
+    __m256i idx = _mm256_srlv_epi32(_mm256_set1_epi32(static_cast<int>(bits)), shifts);
+    return _mm256_permutevar_ps(levels, idx);
+}
+
+KIPEPEO_TARGET_AVX2
+inline __m128 lookup_4(uint32_t bits, __m128 levels) {
+    __m128i idx = _mm_srlv_epi32(_mm_set1_epi32(static_cast<int>(bits)), _mm_setr_epi32(0, 2, 4, 6));
+    return _mm_permutevar_ps(levels, idx);
+}
+
+KIPEPEO_TARGET_AVX2
+inline float hsum(__m256 v) {
+    __m128 s = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+    s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+    s = _mm_add_ss(s, _mm_movehdup_ps(s));
+    return _mm_cvtss_f32(s);
+}
+
+inline uint16_t load_u16(const uint8_t* p) {
+    uint16_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline uint32_t load_u32(const uint8_t* p) {
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+KIPEPEO_TARGET_AVX2
+float two_bit_dot(const uint8_t* packed, const float* x, size_t n, __m128 levels4) {
+    const __m256 levels = _mm256_set_m128(levels4, levels4);
+    const __m256i lo = _mm256_setr_epi32(0, 2, 4, 6, 8, 10, 12, 14);
+    const __m256i hi = _mm256_setr_epi32(16, 18, 20, 22, 24, 26, 28, 30);
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        uint32_t bits = load_u32(packed + i / 4);
+        acc0 = _mm256_fmadd_ps(lookup_8(bits, levels, lo), _mm256_loadu_ps(x + i), acc0);
+        acc1 = _mm256_fmadd_ps(lookup_8(bits, levels, hi), _mm256_loadu_ps(x + i + 8), acc1);
+    }
+    if (i + 8 <= n) {
+        acc0 = _mm256_fmadd_ps(lookup_8(load_u16(packed + i / 4), levels, lo), _mm256_loadu_ps(x + i), acc0);
+        i += 8;
+    }
+    float sum = hsum(_mm256_add_ps(acc0, acc1));
+    if (i < n) {
+        __m128 p = _mm_mul_ps(lookup_4(packed[i / 4], levels4), _mm_loadu_ps(x + i));
+        p = _mm_add_ps(p, _mm_movehl_ps(p, p));
+        p = _mm_add_ss(p, _mm_movehdup_ps(p));
+        sum += _mm_cvtss_f32(p);
+    }
+    return sum;
+}
+
+// Spread the 8 bits of a byte to the even bit positions of a 16-bit word,
+// so two movemasks (low and high code bit) assemble 8 packed 2-bit codes
+struct SpreadTable {
+    uint16_t even[256];
+
+    SpreadTable() {
+        for (int b = 0; b < 256; ++b) {
+            uint16_t v = 0;
+            for (int i = 0; i < 8; ++i) {
+                v |= static_cast<uint16_t>(((b >> i) & 1) << (2 * i));
+            }
+            even[b] = v;
+        }
+    }
+};
+
+const SpreadTable& spread_table() {
+    static const SpreadTable table;
+    return table;
+}
+
+inline uint16_t pack_codes(const SpreadTable& t, int bit0, int bit1) {
+    return static_cast<uint16_t>(t.even[bit0] | (t.even[bit1] << 1));
+}
+
+inline void store_u16(uint8_t* p, uint16_t v) {
+    std::memcpy(p, &v, sizeof(v));
+}
+
+// Ternary codes per lane: +1=10, 0=01, -1=00. A NaN compares false on both
+// sides and packs as 0, like the scalar quantizer.
+KIPEPEO_TARGET_AVX2
+inline void ternary_code_bits(__m256 v, __m256 thr, __m256 neg_thr, int& bit0, int& bit1) {
+    int gt = _mm256_movemask_ps(_mm256_cmp_ps(v, thr, _CMP_GT_OQ));
+    int lt = _mm256_movemask_ps(_mm256_cmp_ps(v, neg_thr, _CMP_LT_OQ));
+    bit0 = ~(gt | lt) & 0xFF;
+    bit1 = gt;
+}
+
+// Quaternary codes per lane: v > 1 -> 11, v > 0 -> 10, v > -1 -> 01, else 00
+KIPEPEO_TARGET_AVX2
+inline void quaternary_code_bits(__m256 v, int& bit0, int& bit1) {
+    int a = _mm256_movemask_ps(_mm256_cmp_ps(v, _mm256_set1_ps(-1.0f), _CMP_GT_OQ));
+    int b = _mm256_movemask_ps(_mm256_cmp_ps(v, _mm256_setzero_ps(), _CMP_GT_OQ));
+    int c = _mm256_movemask_ps(_mm256_cmp_ps(v, _mm256_set1_ps(1.0f), _CMP_GT_OQ));
+    bit0 = (a & ~b) | c;
+    bit1 = b;
+}
+
+// C[rows x cols] = A[rows x K] * B[K x cols] for one 4 x 16 tile (R <= 4
+// rows, cols <= 16 through load/store masks)
+template <int R>
+KIPEPEO_TARGET_AVX2
+void matmul_tile(const float* A, const float* B, float* C, size_t N, size_t K, size_t cols) {
+    const __m256i lane = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m256i mask0 = _mm256_cmpgt_epi32(_mm256_set1_epi32(static_cast<int>(cols)), lane);
+    const __m256i mask1 = _mm256_cmpgt_epi32(_mm256_set1_epi32(static_cast<int>(cols) - 8), lane);
+    const bool full = cols == 16;
+
+    __m256 acc[R][2];
+    for (int r = 0; r < R; ++r) {
+        acc[r][0] = _mm256_setzero_ps();
+        acc[r][1] = _mm256_setzero_ps();
+    }
+
+    for (size_t k = 0; k < K; ++k) {
+        const float* b = B + k * N;
+        __m256 b0 = full ? _mm256_loadu_ps(b) : _mm256_maskload_ps(b, mask0);
+        __m256 b1 = full ? _mm256_loadu_ps(b + 8) : _mm256_maskload_ps(b + 8, mask1);
+        for (int r = 0; r < R; ++r) {
+            __m256 a = _mm256_broadcast_ss(A + r * K + k);
+            acc[r][0] = _mm256_fmadd_ps(a, b0, acc[r][0]);
+            acc[r][1] = _mm256_fmadd_ps(a, b1, acc[r][1]);
+        }
+    }
+
+    for (int r = 0; r < R; ++r) {
+        float* c = C + r * N;
+        if (full) {
+            _mm256_storeu_ps(c, acc[r][0]);
+            _mm256_storeu_ps(c + 8, acc[r][1]);
+        } else {
+            _mm256_maskstore_ps(c, mask0, acc[r][0]);
+            _mm256_maskstore_ps(c + 8, mask1, acc[r][1]);
+        }
+    }
+}
+
+// R rows of one block at once (rows stride bytes apart, see
+// gemv_*_interleaved): every 8 activations are loaded once and feed R
+// independent accumulators
+template <int R>
+KIPEPEO_TARGET_AVX2
+void two_bit_dot_rows(const uint8_t* packed, size_t stride, const float* x, size_t n,
+                      __m128 levels4, float* out) {
+    const __m256 levels = _mm256_set_m128(levels4, levels4);
+    const __m256i lo = _mm256_setr_epi32(0, 2, 4, 6, 8, 10, 12, 14);
+    const __m256i hi = _mm256_setr_epi32(16, 18, 20, 22, 24, 26, 28, 30);
+    __m256 acc[R];
+    for (int r = 0; r < R; ++r) {
+        acc[r] = _mm256_setzero_ps();
+    }
+
+    // 16 values per step: one broadcast of a row's 32 code bits feeds both
+    // halves, as in two_bit_dot (the shuffle port is the bottleneck)
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m256 x0 = _mm256_loadu_ps(x + i);
+        __m256 x1 = _mm256_loadu_ps(x + i + 8);
+        for (int r = 0; r < R; ++r) {
+            uint32_t bits = load_u32(packed + r * stride + i / 4);
+            acc[r] = _mm256_fmadd_ps(lookup_8(bits, levels, lo), x0, acc[r]);
+            acc[r] = _mm256_fmadd_ps(lookup_8(bits, levels, hi), x1, acc[r]);
+        }
+    }
+    if (i + 8 <= n) {
+        __m256 xv = _mm256_loadu_ps(x + i);
+        for (int r = 0; r < R; ++r) {
+            acc[r] = _mm256_fmadd_ps(lookup_8(load_u16(packed + r * stride + i / 4), levels, lo), xv, acc[r]);
+        }
+        i += 8;
+    }
+    for (int r = 0; r < R; ++r) {
+        out[r] = hsum(acc[r]);
+    }
+    if (i < n) {
+        __m128 xv = _mm_loadu_ps(x + i);
+        for (int r = 0; r < R; ++r) {
+            __m128 p = _mm_mul_ps(lookup_4(packed[r * stride + i / 4], levels4), xv);
+            p = _mm_add_ps(p, _mm_movehl_ps(p, p));
+            p = _mm_add_ss(p, _mm_movehdup_ps(p));
+            out[r] += _mm_cvtss_f32(p);
+        }
+    }
+}
+
+KIPEPEO_TARGET_AVX2
+void two_bit_dot_rows_any(const uint8_t* packed, size_t stride, size_t rows, const float* x,
+                          size_t n, __m128 levels4, float* out) {
+    if (rows == 8) {
+        two_bit_dot_rows<8>(packed, stride, x, n, levels4, out);
+    } else if (rows == 4) {
+        two_bit_dot_rows<4>(packed, stride, x, n, levels4, out);
+    } else {
+        for (size_t r = 0; r < rows; ++r) {
+            two_bit_dot_rows<1>(packed + r * stride, stride, x, n, levels4, out + r);
+        }
+    }
+}
+
+} // anonymous namespace
+
+KIPEPEO_TARGET_AVX2
+float ternary_2bit_dot_avx2(const uint8_t* packed, const float* x, size_t n) {
+    return two_bit_dot(packed, x, n, _mm_setr_ps(-1.0f, 0.0f, 1.0f, 1.0f));
+}
+
+KIPEPEO_TARGET_AVX2
+float quaternary_2bit_dot_avx2(const uint8_t* packed, const float* x, size_t n) {
+    return two_bit_dot(packed, x, n, _mm_setr_ps(-1.5f, -0.5f, 0.5f, 1.5f));
+}
+
+KIPEPEO_TARGET_AVX2
+void ternary_2bit_dot_rows_avx2(const uint8_t* packed, size_t stride, size_t rows,
+                                const float* x, size_t n, float* out) {
+    two_bit_dot_rows_any(packed, stride, rows, x, n, _mm_setr_ps(-1.0f, 0.0f, 1.0f, 1.0f), out);
+}
+
+KIPEPEO_TARGET_AVX2
+void quaternary_2bit_dot_rows_avx2(const uint8_t* packed, size_t stride, size_t rows,
+                                   const float* x, size_t n, float* out) {
+    two_bit_dot_rows_any(packed, stride, rows, x, n, _mm_setr_ps(-1.5f, -0.5f, 0.5f, 1.5f), out);
+}
+
+KIPEPEO_TARGET_AVX2
+int32_t dot_i8_avx2(const int8_t* w, const int8_t* x, size_t n) {
+    // maddubs needs one unsigned operand: |w| * (x * sign(w)) == w * x.
+    // Pairwise int16 sums stay within 2 * 127 * 127, so maddubs never
+    // saturates for codes in [-127, 127].
+    __m256i acc = _mm256_setzero_si256();
+    const __m256i ones = _mm256_set1_epi16(1);
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i wv = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(w + i));
+        __m256i xv = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(x + i));
+        __m256i prod = _mm256_maddubs_epi16(_mm256_sign_epi8(wv, wv), _mm256_sign_epi8(xv, wv));
+        acc = _mm256_add_epi32(acc, _mm256_madd_epi16(prod, ones));
+    }
+    __m128i acc128 = _mm_add_epi32(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+    acc128 = _mm_add_epi32(acc128, _mm_shuffle_epi32(acc128, 0x4E));
+    acc128 = _mm_add_epi32(acc128, _mm_shuffle_epi32(acc128, 0xB1));
+    int32_t sum = _mm_cvtsi128_si32(acc128);
+    for (; i < n; ++i) {
+        sum += static_cast<int32_t>(w[i]) * x[i];
+    }
+    return sum;
+}
+
+KIPEPEO_TARGET_AVX2
+void matrix_multiply_f32_avx2(const float* A, const float* B, float* C,
+                              size_t M, size_t N, size_t K) {
+    for (size_t i = 0; i < M; i += 4) {
+        size_t rows = M - i < 4 ? M - i : 4;
+        for (size_t j = 0; j < N; j += 16) {
+            size_t cols = N - j < 16 ? N - j : 16;
+            const float* a = A + i * K;
+            float* c = C + i * N + j;
+            switch (rows) {
+                case 4: matmul_tile<4>(a, B + j, c, N, K, cols); break;
+                case 3: matmul_tile<3>(a, B + j, c, N, K, cols); break;
+                case 2: matmul_tile<2>(a, B + j, c, N, K, cols); break;
+                default: matmul_tile<1>(a, B + j, c, N, K, cols); break;
+            }
+        }
+    }
+}
+
+KIPEPEO_TARGET_AVX2
+void gemm_f32_micro_6x16_avx2(size_t kc, const float* a, const float* b,
+                              float* c, size_t ldc, bool accumulate) {
+    constexpr size_t MR = 6;
+    constexpr size_t NR = 16;
+    __m256 acc[MR][2];
+    for (size_t r = 0; r < MR; ++r) {
+        acc[r][0] = accumulate ? _mm256_loadu_ps(c + r * ldc) : _mm256_setzero_ps();
+        acc[r][1] = accumulate ? _mm256_loadu_ps(c + r * ldc + 8) : _mm256_setzero_ps();
+    }
+    for (size_t k = 0; k < kc; ++k) {
+        __m256 b0 = _mm256_loadu_ps(b + k * NR);
+        __m256 b1 = _mm256_loadu_ps(b + k * NR + 8);
+        const float* ak = a + k * MR;
+        for (size_t r = 0; r < MR; ++r) {
+            __m256 ar = _mm256_broadcast_ss(ak + r);
+            acc[r][0] = _mm256_fmadd_ps(ar, b0, acc[r][0]);
+            acc[r][1] = _mm256_fmadd_ps(ar, b1, acc[r][1]);
+        }
+    }
+    for (size_t r = 0; r < MR; ++r) {
+        _mm256_storeu_ps(c + r * ldc, acc[r][0]);
+        _mm256_storeu_ps(c + r * ldc + 8, acc[r][1]);
+    }
+}
+
+KIPEPEO_TARGET_AVX2
+float abs_max_avx2(const float* x, size_t n) {
+    // max_ps returns its second operand when either is NaN, so NaNs are
+    // skipped like std::max(max_abs, fabs(x)) does
+    const __m256 abs_mask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+    __m256 acc = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        acc = _mm256_max_ps(_mm256_and_ps(_mm256_loadu_ps(x + i), abs_mask), acc);
+    }
+    __m128 m = _mm_max_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+    m = _mm_max_ps(m, _mm_movehl_ps(m, m));
+    m = _mm_max_ss(m, _mm_movehdup_ps(m));
+    float result = _mm_cvtss_f32(m);
+    for (; i < n; ++i) {
+        float a = x[i] < 0.0f ? -x[i] : x[i];
+        if (a > result) result = a;
+    }
+    return result;
+}
+
+KIPEPEO_TARGET_AVX2
+void quantize_ternary_2bit_avx2(const float* w, size_t n, float inv_scale,
+                                float threshold, uint8_t* out) {
+    const SpreadTable& t = spread_table();
+    const __m256 inv = _mm256_set1_ps(inv_scale);
+    const __m256 thr = _mm256_set1_ps(threshold);
+    const __m256 neg_thr = _mm256_set1_ps(-threshold);
+    int bit0, bit1;
+
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        ternary_code_bits(_mm256_mul_ps(_mm256_loadu_ps(w + i), inv), thr, neg_thr, bit0, bit1);
+        store_u16(out + i / 4, pack_codes(t, bit0, bit1));
+    }
+    if (i < n) {
+        __m256 v = _mm256_castps128_ps256(_mm_mul_ps(_mm_loadu_ps(w + i), _mm256_castps256_ps128(inv)));
+        ternary_code_bits(v, thr, neg_thr, bit0, bit1);
+        out[i / 4] = static_cast<uint8_t>(pack_codes(t, bit0 & 0xF, bit1 & 0xF));
+    }
+}
+
+KIPEPEO_TARGET_AVX2
+void quantize_quaternary_2bit_avx2(const float* w, size_t n, float inv_scale, uint8_t* out) {
+    const SpreadTable& t = spread_table();
+    const __m256 inv = _mm256_set1_ps(inv_scale);
+    int bit0, bit1;
+
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        quaternary_code_bits(_mm256_mul_ps(_mm256_loadu_ps(w + i), inv), bit0, bit1);
+        store_u16(out + i / 4, pack_codes(t, bit0, bit1));
+    }
+    if (i < n) {
+        __m256 v = _mm256_castps128_ps256(_mm_mul_ps(_mm_loadu_ps(w + i), _mm256_castps256_ps128(inv)));
+        quaternary_code_bits(v, bit0, bit1);
+        out[i / 4] = static_cast<uint8_t>(pack_codes(t, bit0 & 0xF, bit1 & 0xF));
+    }
+}
+
+KIPEPEO_TARGET_AVX2
+void dequantize_2bit_avx2(const uint8_t* packed, size_t n, const float levels[4],
+                          float scale, float* out) {
+    const __m128 levels4 = _mm_mul_ps(_mm_loadu_ps(levels), _mm_set1_ps(scale));
+    const __m256 levels8 = _mm256_set_m128(levels4, levels4);
+    const __m256i lo = _mm256_setr_epi32(0, 2, 4, 6, 8, 10, 12, 14);
+
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        _mm256_storeu_ps(out + i, lookup_8(load_u16(packed + i / 4), levels8, lo));
+    }
+    if (i < n) {
+        _mm_storeu_ps(out + i, lookup_4(packed[i / 4], levels4));
+    }
+}
+
+KIPEPEO_TARGET_AVX2
+void ternary_fit_sums_avx2(const float* a, const float* c, size_t n, float threshold, float sums[2]) {
+    const __m256 thr = _mm256_set1_ps(threshold);
+    __m256 ca = _mm256_setzero_ps();
+    __m256 cc = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 av = _mm256_loadu_ps(a + i);
+        __m256 cv = _mm256_and_ps(_mm256_loadu_ps(c + i), _mm256_cmp_ps(av, thr, _CMP_GT_OQ));
+        ca = _mm256_fmadd_ps(cv, av, ca);
+        cc = _mm256_add_ps(cc, cv);
+    }
+    sums[0] = hsum(ca);
+    sums[1] = hsum(cc);
+    for (; i < n; ++i) {
+        if (a[i] > threshold) {
+            sums[0] += c[i] * a[i];
+            sums[1] += c[i];
+        }
+    }
+}
+
+KIPEPEO_TARGET_AVX2
+void quaternary_fit_sums_avx2(const float* a, const float* c, size_t n, float inv_scale, float sums[2]) {
+    const __m256 inv = _mm256_set1_ps(inv_scale);
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 inner = _mm256_set1_ps(0.5f);
+    const __m256 outer = _mm256_set1_ps(1.5f);
+    __m256 cal = _mm256_setzero_ps();
+    __m256 cll = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 av = _mm256_loadu_ps(a + i);
+        __m256 cv = _mm256_loadu_ps(c + i);
+        __m256 l = _mm256_blendv_ps(inner, outer, _mm256_cmp_ps(_mm256_mul_ps(av, inv), one, _CMP_GT_OQ));
+        __m256 cl = _mm256_mul_ps(cv, l);
+        cal = _mm256_fmadd_ps(cl, av, cal);
+        cll = _mm256_fmadd_ps(cl, l, cll);
+    }
+    sums[0] = hsum(cal);
+    sums[1] = hsum(cll);
+    for (; i < n; ++i) {
+        float l = a[i] * inv_scale > 1.0f ? 1.5f : 0.5f;
+        sums[0] += c[i] * l * a[i];
+        sums[1] += c[i] * l * l;
+    }
+}
+
+} // namespace x86
+} // namespace kernels
+} // namespace kipepeo
@@ -0,0 +1,187 @@
+#include "kipepeo/kernels/x86/x86_kernels.h"
+#include <cstring>
+
+// GCC 12.1/12.2 implement the unmasked AVX-512 intrinsics on top of
+// _mm512_undefined_*() and report that operand as uninitialized under
+// -Wall (GCC bug 105593, fixed in 12.3). The warning is attributed to
+// immintrin.h, so it is silenced around the include and the kernels that
+// inline it rather than per call.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+#include <immintrin.h>
+
+// Per-function target, as in avx2_kernels.cpp; reached only when
+// get_x86_level() == AVX512 (F/BW/VL/VNNI all present)
+#if defined(__GNUC__) || defined(__clang__)
+#define KIPEPEO_TARGET_AVX512 \
+    __attribute__((target("avx512f,avx512bw,avx512vl,avx512vnni,avx2,fma,f16c")))
+#else
+#define KIPEPEO_TARGET_AVX512
+#endif
+
+namespace kipepeo {
+namespace kernels {
+namespace x86 {
+
+namespace {
+
+// 16 2-bit codes per 32-bit word: broadcast, shift lane i right by 2i and
+// let vpermilps pick the level from the low two bits
+KIPEPEO_TARGET_AVX512
+inline __m512 lookup_16(uint32_t bits, __m512 levels) {
+    const __m512i shifts = _mm512_setr_epi32(0, 2, 4, 6, 8, 10, 12, 14,
+                                             16, 18, 20, 22, 24, 26, 28, 30);
+    __m512i idx = _mm512_srlv_epi32(_mm512_set1_epi32(static_cast<int>(bits)), shifts);
+    return _mm512_permutevar_ps(levels, idx);
+}
+
+KIPEPEO_TARGET_AVX512
+float two_bit_dot(const uint8_t* packed, const float* x, size_t n, __m128 levels4) {
+    const __m512 levels = _mm512_broadcast_f32x4(levels4);
+    __m512 acc0 = _mm512_setzero_ps();
+    __m512 acc1 = _mm512_setzero_ps();
+
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        uint32_t bits[2];
+        std::memcpy(bits, packed + i / 4, sizeof(bits));
+        acc0 = _mm512_fmadd_ps(lookup_16(bits[0], levels), _mm512_loadu_ps(x + i), acc0);
+        acc1 = _mm512_fmadd_ps(lookup_16(bits[1], levels), _mm512_loadu_ps(x + i + 16), acc1);
+    }
+    for (; i < n; i += 16) {
+        // Last 4..16 values: partial word, masked activation load
+        size_t count = n - i < 16 ? n - i : 16;
+        uint32_t bits = 0;
+        std::memcpy(&bits, packed + i / 4, count / 4);
+        __mmask16 mask = static_cast<__mmask16>((1u << count) - 1);
+        acc0 = _mm512_fmadd_ps(lookup_16(bits, levels), _mm512_maskz_loadu_ps(mask, x + i), acc0);
+    }
+    return _mm512_reduce_add_ps(_mm512_add_ps(acc0, acc1));
+}
+
+// C tile of R <= 4 rows and cols <= 32 columns (two zmm, tail masked)
+template <int R>
+KIPEPEO_TARGET_AVX512
+void matmul_tile(const float* A, const float* B, float* C, size_t N, size_t K, size_t cols) {
+    const __mmask16 mask0 = cols >= 16 ? static_cast<__mmask16>(0xFFFF)
+                                       : static_cast<__mmask16>((1u << cols) - 1);
+    const __mmask16 mask1 = cols >= 32 ? static_cast<__mmask16>(0xFFFF)
+                          : cols > 16 ? static_cast<__mmask16>((1u << (cols - 16)) - 1)
+                                      : static_cast<__mmask16>(0);
+
+    __m512 acc[R][2];
+    for (int r = 0; r < R; ++r) {
+        acc[r][0] = _mm512_setzero_ps();
+        acc[r][1] = _mm512_setzero_ps();
+    }
+
+    for (size_t k = 0; k < K; ++k) {
+        const float* b = B + k * N;
+        __m512 b0 = _mm512_maskz_loadu_ps(mask0, b);
+        __m512 b1 = _mm512_maskz_loadu_ps(mask1, b + 16);
+        for (int r = 0; r < R; ++r) {
+            __m512 a = _mm512_set1_ps(A[r * K + k]);
+            acc[r][0] = _mm512_fmadd_ps(a, b0, acc[r][0]);
+            acc[r][1] = _mm512_fmadd_ps(a, b1, acc[r][1]);
+        }
+    }
+
+    for (int r = 0; r < R; ++r) {
+        _mm512_mask_storeu_ps(C + r * N, mask0, acc[r][0]);
+        _mm512_mask_storeu_ps(C + r * N + 16, mask1, acc[r][1]);
+    }
+}
+
+} // anonymous namespace
+
+KIPEPEO_TARGET_AVX512
+float ternary_2bit_dot_avx512(const uint8_t* packed, const float* x, size_t n) {
+    return two_bit_dot(packed, x, n, _mm_setr_ps(-1.0f, 0.0f, 1.0f, 1.0f));
+}
+
+KIPEPEO_TARGET_AVX512
+float quaternary_2bit_dot_avx512(const uint8_t* packed, const float* x, size_t n) {
+    return two_bit_dot(packed, x, n, _mm_setr_ps(-1.5f, -0.5f, 0.5f, 1.5f));
+}
+
+KIPEPEO_TARGET_AVX512
+int32_t dot_i8_avx512_vnni(const int8_t* w, const int8_t* x, size_t n) {
+    // vpdpbusd multiplies unsigned by signed bytes: with u = x + 128,
+    // sum(u * w) - 128 * sum(w) == sum(x * w). 256-bit registers (VL) match
+    // the 160-value chunks of the int8 GEMVs without a masked tail.
+    const __m256i bias = _mm256_set1_epi8(static_cast<char>(0x80));
+    const __m256i ones = _mm256_set1_epi8(1);
+    __m256i acc = _mm256_setzero_si256();
+    __m256i wsum = _mm256_setzero_si256();
+
+    for (size_t i = 0; i < n; i += 32) {
+        __mmask32 mask = n - i >= 32 ? ~static_cast<__mmask32>(0)
+                                     : (static_cast<__mmask32>(1) << (n - i)) - 1;
+        __m256i wv = _mm256_maskz_loadu_epi8(mask, w + i);
+        __m256i uv = _mm256_xor_si256(_mm256_maskz_loadu_epi8(mask, x + i), bias);
+        acc = _mm256_dpbusd_epi32(acc, uv, wv);
+        wsum = _mm256_dpbusd_epi32(wsum, ones, wv);
+    }
+    __m256i total = _mm256_sub_epi32(acc, _mm256_slli_epi32(wsum, 7));
+    __m128i t = _mm_add_epi32(_mm256_castsi256_si128(total), _mm256_extracti128_si256(total, 1));
+    t = _mm_add_epi32(t, _mm_shuffle_epi32(t, 0x4E));
+    t = _mm_add_epi32(t, _mm_shuffle_epi32(t, 0xB1));
+    return _mm_cvtsi128_si32(t);
+}
+
+KIPEPEO_TARGET_AVX512
+void matrix_multiply_f32_avx512(const float* A, const float* B, float* C,
+                                size_t M, size_t N, size_t K) {
+    for (size_t i = 0; i < M; i += 4) {
+        size_t rows = M - i < 4 ? M - i : 4;
+        for (size_t j = 0; j < N; j += 32) {
+            size_t cols = N - j < 32 ? N - j : 32;
+            const float* a = A + i * K;
+            float* c = C + i * N + j;
+            switch (rows) {
+                case 4: matmul_tile<4>(a, B + j, c, N, K, cols); break;
+                case 3: matmul_tile<3>(a, B + j, c, N, K, cols); break;
+                case 2: matmul_tile<2>(a, B + j, c, N, K, cols); break;
+                default: matmul_tile<1>(a, B + j, c, N, K, cols); break;
+            }
+        }
+    }
+}
+
+KIPEPEO_TARGET_AVX512
+void gemm_f32_micro_12x32_avx512(size_t kc, const float* a, const float* b,
+                                 float* c, size_t ldc, bool accumulate) {
+    constexpr size_t MR = 12;
+    constexpr size_t NR = 32;
+    __m512 acc[MR][2];
+    for (size_t r = 0; r < MR; ++r) {
+        acc[r][0] = accumulate ? _mm512_loadu_ps(c + r * ldc) : _mm512_setzero_ps();
+        acc[r][1] = accumulate ? _mm512_loadu_ps(c + r * ldc + 16) : _mm512_setzero_ps();
+    }
+    for (size_t k = 0; k < kc; ++k) {
+        __m512 b0 = _mm512_loadu_ps(b + k * NR);
+        __m512 b1 = _mm512_loadu_ps(b + k * NR + 16);
+        const float* ak = a + k * MR;
+        for (size_t r = 0; r < MR; ++r) {
+            __m512 ar = _mm512_set1_ps(ak[r]);
+            acc[r][0] = _mm512_fmadd_ps(ar, b0, acc[r][0]);
+            acc[r][1] = _mm512_fmadd_ps(ar, b1, acc[r][1]);
+        }
+    }
+    for (size_t r = 0; r < MR; ++r) {
+        _mm512_storeu_ps(c + r * ldc, acc[r][0]);
+        _mm512_storeu_ps(c + r * ldc + 16, acc[r][1]);
+    }
+}
+
+} // namespace x86
+} // namespace kernels
+} // namespace kipepeo
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
@@ -0,0 +1,126 @@
+#include "kipepeo/kernels/x86/cpu_features.h"
+#include <cstdlib>
+#include <cstring>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+
+namespace kipepeo {
+namespace kernels {
+namespace x86 {
+
+namespace {
+
+#if defined(_MSC_VER) || defined(__x86_64__) || defined(__i386__)
+void cpuid(uint32_t leaf, uint32_t subleaf, uint32_t regs[4]) {
+#if defined(_MSC_VER)
+    int r[4];
+    __cpuidex(r, static_cast<int>(leaf), static_cast<int>(subleaf));
+    for (int i = 0; i < 4; ++i) regs[i] = static_cast<uint32_t>(r[i]);
+#else
+    __cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+uint64_t xgetbv0() {
+#if defined(_MSC_VER)
+    return _xgetbv(0);
+#else
+    uint32_t eax, edx;
+    __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return (static_cast<uint64_t>(edx) << 32) | eax;
+#endif
+}
+
+X86Features detect() {
+    X86Features f = {};
+    uint32_t regs[4];
+
+    cpuid(0, 0, regs);
+    uint32_t max_leaf = regs[0];
+    if (max_leaf < 7) {
+        return f;
+    }
+
+    cpuid(1, 0, regs);
+    bool osxsave = (regs[2] >> 27) & 1;
+    bool avx = (regs[2] >> 28) & 1;
+    bool fma = (regs[2] >> 12) & 1;
+    bool f16c = (regs[2] >> 29) & 1;
+    if (!osxsave || !avx) {
+        return f;
+    }
+
+    // The OS must save YMM (bits 1-2) and, for AVX-512, opmask/ZMM (bits 5-7)
+    uint64_t xcr0 = xgetbv0();
+    bool ymm_state = (xcr0 & 0x6) == 0x6;
+    bool zmm_state = (xcr0 & 0xE6) == 0xE6;
+    if (!ymm_state) {
+        return f;
+    }
+
+    cpuid(7, 0, regs);
+    f.avx2 = (regs[1] >> 5) & 1;
+    f.fma = fma;
+    f.f16c = f16c;
+    if (zmm_state) {
+        f.avx512f = (regs[1] >> 16) & 1;
+        f.avx512bw = (regs[1] >> 30) & 1;
+        f.avx512vl = (regs[1] >> 31) & 1;
+        f.avx512_vnni = (regs[2] >> 11) & 1;
+    }
+    return f;
+}
+#else
+X86Features detect() {
+    return X86Features{};
+}
+#endif
+
+X86Level detect_level() {
+    const X86Features& f = get_x86_features();
+    X86Level level = X86Level::SCALAR;
+    if (f.avx2 && f.fma && f.f16c) {
+        level = X86Level::AVX2;
+        if (f.avx512f && f.avx512bw && f.avx512vl && f.avx512_vnni) {
+            level = X86Level::AVX512;
+        }
+    }
+
+    const char* cap = std::getenv("KIPEPEO_X86_LEVEL");
+    if (cap) {
+        X86Level limit = level;
+        if (std::strcmp(cap, "scalar") == 0) limit = X86Level::SCALAR;
+        else if (std::strcmp(cap, "avx2") == 0) limit = X86Level::AVX2;
+        if (limit < level) level = limit;
+    }
+    return level;
+}
+
+} // anonymous namespace
+
+const X86Features& get_x86_features() {
+    static const X86Features features = detect();
+    return features;
+}
+
+X86Level get_x86_level() {
+    static const X86Level level = detect_level();
+    return level;
+}
+
+const char* get_x86_level_name(X86Level level) {
+    switch (level) {
+        case X86Level::AVX2: return "AVX2";
+        case X86Level::AVX512: return "AVX-512 VNNI";
+        case X86Level::SCALAR:
+        default: return "Scalar";
+    }
+}
+
+} // namespace x86
+} // namespace kernels
+} // namespace kipepeo
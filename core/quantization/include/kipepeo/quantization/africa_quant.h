@@ -3,6 +3,8 @@
 #include "kipepeo/quantization/types.h"
 #include "kipepeo/quantization/quantization_error.h"
 #include "kipepeo/quantization/hardware_detection.h"
+#include "kipepeo/quantization/memory_pool.h"
+#include "kipepeo/kernels/types.h"
 #include <stddef.h>
 #include <stdint.h>
 #include <functional>
@@ -23,6 +25,26 @@ namespace quantization {
  * - NEON-accelerated quantization/dequantization
  * - Memory-efficient bit packing
  * - Optimized for MediaTek Helio G99/G100, Unisoc T606, Snapdragon 7s Gen 2
+ *
+ * Optional outlier side channel: with QuantizationConfig::max_outliers_per_block
+ * > 0 and an OutlierEntry buffer, the largest outliers of each block (beyond
+ * 2.5 sigma) are stored as sparse (index, fp16 residual) pairs and the block
+ * scale is fitted to the remaining weights instead of being stretched by them.
+ * Slots are laid out like the metadata, outliers_per_block per block (see
+ * get_outlier_slot_count). dequantize_* and matvec_mul_* add the residuals
+ * back; matvec applies them in the same pass as the dense payload.
+ *
+ * Optional scale search: with QuantizationConfig::search_scales each block
+ * tries a grid of ternary thresholds (or quaternary level spacings), refits
+ * the scale by weighted least squares for the codes each one implies, and
+ * keeps the candidate with the lowest squared error. The configured
+ * threshold / max-abs spacing is always among the candidates, so the error
+ * never exceeds the default. The payload format is unchanged.
+ *
+ * Thread safety: dequantize_* and matvec_mul_* are reentrant and lock-free,
+ * so one instance can be shared by any number of inference threads. Per-call
+ * scratch lives in thread-local storage. Quantization and the setters are
+ * serialized per instance.
  */
 
 // Quantization metadata structure
@@ -33,6 +55,17 @@ struct QuantizationMeta {
     uint32_t codebook_size;   // Size of codebook (3 for 1.28-bit, 4 for 1.58-bit)
 };
 
+// Sparse outlier slot (index within block, fp16 residual); shared with the kernels
+using kernels::OutlierEntry;
+using kernels::OUTLIER_SLOT_EMPTY;
+
+// Bit packing layout for 1.28-bit (ternary) weights
+enum class TernaryPacking : uint8_t {
+    TWO_BIT,  // 4 values per byte: -1=00, 0=01, +1=10 (11 unused)
+    BASE3     // 5 values per byte (3^5 = 243), 1.6 bits per weight,
+              // every block starts on a byte boundary
+};
+
 // Progress callback function type
 // Called during long operations with progress (0.0 to 1.0)
 typedef std::function<void(float progress)> ProgressCallback;
@@ -41,9 +74,20 @@ typedef std::function<void(float progress)> ProgressCallback;
 struct QuantizationConfig {
     uint32_t block_size;              // Block size (0 = auto-detect)
     float threshold_1_28;             // Threshold for 1.28-bit (0.0 = auto)
-    bool use_memory_pooling;           // Enable memory pooling
+    bool use_memory_pooling;           // Draw scratch buffers from the instance pool
     bool detect_outliers;              // Enable outlier detection
+    uint32_t max_outliers_per_block;   // Sparse fp16 outlier slots per block
+                                       // (0 = no side channel)
     bool use_adaptive_thresholds;      // Use adaptive thresholds
+    bool search_scales;                // Per-block search for the scale (and
+                                       // ternary threshold) that minimises
+                                       // squared error, instead of max-abs
+    const float* scale_search_importance; // Optional non-negative error weight
+                                       // per position (K values for
+                                       // quantize_matrix_*, else count; nullptr = uniform)
+    TernaryPacking ternary_packing;    // Packing layout for 1.28-bit output
+    uint32_t num_threads;              // Worker threads for matrix quantization
+                                       // (0 = hardware.max_concurrent_ops)
     ProgressCallback progress_callback; // Progress callback (optional)
     HardwareCapabilities hardware;     // Hardware capabilities (auto-detected if not set)
     
@@ -52,7 +96,12 @@ struct QuantizationConfig {
         , threshold_1_28(0.0f)
         , use_memory_pooling(true)
         , detect_outliers(true)
+        , max_outliers_per_block(0)
         , use_adaptive_thresholds(true)
+        , search_scales(false)
+        , scale_search_importance(nullptr)
+        , ternary_packing(TernaryPacking::TWO_BIT)
+        , num_threads(0)
         , hardware(detect_hardware_capabilities())
     {}
 };
@@ -70,10 +119,13 @@ public:
      * 
      * @param weights Input float weights
      * @param count Number of weights
-     * @param output Output quantized buffer (size: count * 1.28 / 8 bytes)
+     * @param output Output quantized buffer
+     *               (size: get_ternary_buffer_size(count, block_size, config->ternary_packing))
      * @param metadata Output quantization metadata (per block)
      * @param block_size Block size for group quantization (0 = auto-detect)
      * @param config Optional configuration (nullptr = use defaults)
+     * @param outliers Optional outlier slots
+     *                 (size: get_outlier_slot_count(count, block_size, config->max_outliers_per_block))
      * @return QuantizationError code
      */
     QuantizationError quantize_1_28bit(
@@ -82,7 +134,8 @@ public:
         uint8_t* output,
         QuantizationMeta* metadata,
         uint32_t block_size = 0,
-        const QuantizationConfig* config = nullptr
+        const QuantizationConfig* config = nullptr,
+        OutlierEntry* outliers = nullptr
     );
     
     /**
@@ -98,6 +151,9 @@ public:
 
     /**
      * Dequantize 1.28-bit weights back to float
+     * @param packing Layout the weights were quantized with
+     * @param outliers Outlier slots written at quantization time (optional)
+     * @param outliers_per_block Slots per block
      * @return QuantizationError code
      */
     QuantizationError dequantize_1_28bit(
@@ -105,7 +161,10 @@ public:
         size_t count,
         float* output,
         const QuantizationMeta* metadata,
-        uint32_t block_size = 0
+        uint32_t block_size = 0,
+        TernaryPacking packing = TernaryPacking::TWO_BIT,
+        const OutlierEntry* outliers = nullptr,
+        uint32_t outliers_per_block = 0
     );
     
     /**
@@ -131,6 +190,7 @@ public:
      * @param metadata Output quantization metadata (per block)
      * @param block_size Block size for group quantization (0 = auto-detect)
      * @param config Optional configuration (nullptr = use defaults)
+     * @param outliers Optional outlier slots (see quantize_1_28bit)
      * @return QuantizationError code
      */
     QuantizationError quantize_1_58bit(
@@ -139,7 +199,8 @@ public:
         uint8_t* output,
         QuantizationMeta* metadata,
         uint32_t block_size = 0,
-        const QuantizationConfig* config = nullptr
+        const QuantizationConfig* config = nullptr,
+        OutlierEntry* outliers = nullptr
     );
     
     /**
@@ -155,6 +216,8 @@ public:
 
     /**
      * Dequantize 1.58-bit weights back to float
+     * @param outliers Outlier slots written at quantization time (optional)
+     * @param outliers_per_block Slots per block
      * @return QuantizationError code
      */
     QuantizationError dequantize_1_58bit(
@@ -162,7 +225,9 @@ public:
         size_t count,
         float* output,
         const QuantizationMeta* metadata,
-        uint32_t block_size = 0
+        uint32_t block_size = 0,
+        const OutlierEntry* outliers = nullptr,
+        uint32_t outliers_per_block = 0
     );
     
     /**
@@ -188,6 +253,9 @@ public:
      * @param Y Output vector (M elements)
      * @param M Number of rows in A
      * @param K Number of columns in A
+     * @param packing Layout matrix A was quantized with
+     * @param outliers Outlier slots of matrix A (optional)
+     * @param outliers_per_block Slots per block
      * @return QuantizationError code
      */
     QuantizationError matvec_mul_1_28bit(
@@ -196,7 +264,10 @@ public:
         const float* X,
         float* Y,
         size_t M,
-        size_t K
+        size_t K,
+        TernaryPacking packing = TernaryPacking::TWO_BIT,
+        const OutlierEntry* outliers = nullptr,
+        uint32_t outliers_per_block = 0
     );
 
     /**
@@ -209,7 +280,9 @@ public:
         const float* X,
         float* Y,
         size_t M,
-        size_t K
+        size_t K,
+        const OutlierEntry* outliers = nullptr,
+        uint32_t outliers_per_block = 0
     );
 
     // ========== Utility Functions ==========
@@ -222,10 +295,24 @@ public:
      */
     static size_t get_quantized_buffer_size(size_t count, float bits_per_weight);
 
+    /**
+     * Get exact buffer size for 1.28-bit output in the given packing layout
+     * @param count Number of weights (K for a single matrix row)
+     * @param block_size Block size used for quantization
+     * @param packing Ternary packing layout
+     * @return Required buffer size in bytes
+     */
+    static size_t get_ternary_buffer_size(size_t count, uint32_t block_size, TernaryPacking packing);
+
     /**
      * Get number of metadata blocks needed
      */
     static size_t get_metadata_count(size_t count, uint32_t block_size);
+    
+    /**
+     * Get number of OutlierEntry slots needed (one set per metadata block)
+     */
+    static size_t get_outlier_slot_count(size_t count, uint32_t block_size, uint32_t max_outliers_per_block);
 
     /**
      * Check if NEON optimizations are available and enabled
@@ -237,6 +324,23 @@ public:
      */
     void set_neon_enabled(bool enabled);
     
+    /**
+     * Enable/disable pooling of scratch buffers for calls that take no
+     * QuantizationConfig (default: enabled). Calls with a config follow
+     * QuantizationConfig::use_memory_pooling.
+     */
+    void set_memory_pooling_enabled(bool enabled);
+    
+    /**
+     * Get scratch pool statistics (peak bytes, reuse hits, system allocations)
+     */
+    MemoryPoolStats get_memory_pool_stats() const;
+    
+    /**
+     * Release all cached scratch buffers back to the system
+     */
+    void trim_memory_pool();
+    
     /**
      * Get hardware capabilities
      */
@@ -259,17 +363,36 @@ public:
         size_t output_buffer_size
     );
     
+    /**
+     * Validate outlier slots of an M x K matrix (M = 1 for a flat tensor)
+     * Every used slot must index inside its block and hold a finite residual
+     */
+    static QuantizationError validate_outliers(
+        const OutlierEntry* outliers,
+        size_t M,
+        size_t K,
+        uint32_t block_size,
+        uint32_t outliers_per_block
+    );
+    
     /**
      * Quantize a matrix (M x K) to 1.28-bit format
      * This is a convenience function that properly organizes metadata for matrix operations
      * 
+     * Rows are split into contiguous ranges across config->num_threads workers.
+     * Output is byte-identical to single-threaded quantization, and the progress
+     * callback receives monotonic progress aggregated over all workers.
+     * 
      * @param weights Input matrix weights (row-major, M * K elements)
      * @param M Number of rows
      * @param K Number of columns
-     * @param output Output quantized buffer
+     * @param output Output quantized buffer; each row occupies
+     *               get_ternary_buffer_size(K, block_size, config->ternary_packing) bytes
      * @param metadata Output metadata array (M * num_blocks_per_row elements)
      * @param block_size Block size for quantization
      * @param config Optional configuration
+     * @param outliers Optional outlier slots
+     *                 (M * num_blocks_per_row * config->max_outliers_per_block entries)
      * @return QuantizationError code
      */
     QuantizationError quantize_matrix_1_28bit(
@@ -279,11 +402,13 @@ public:
         uint8_t* output,
         QuantizationMeta* metadata,
         uint32_t block_size = 0,
-        const QuantizationConfig* config = nullptr
+        const QuantizationConfig* config = nullptr,
+        OutlierEntry* outliers = nullptr
     );
     
     /**
      * Quantize a matrix (M x K) to 1.58-bit format
+     * Row-parallel like quantize_matrix_1_28bit
      */
     QuantizationError quantize_matrix_1_58bit(
         const float* weights,
@@ -292,7 +417,8 @@ public:
         uint8_t* output,
         QuantizationMeta* metadata,
         uint32_t block_size = 0,
-        const QuantizationConfig* config = nullptr
+        const QuantizationConfig* config = nullptr,
+        OutlierEntry* outliers = nullptr
     );
 
     // ========== Legacy API (for compatibility) ==========
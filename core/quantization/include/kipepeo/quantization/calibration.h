@@ -0,0 +1,192 @@
+#pragma once
+
+#include "kipepeo/quantization/africa_quant.h"
+#include "kipepeo/quantization/quantization_error.h"
+#include "kipepeo/quantization/streaming_quantizer.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace kipepeo {
+namespace quantization {
+
+/**
+ * Storage formats a mixed-precision plan can assign to a tensor,
+ * ordered from cheapest to most accurate
+ */
+enum class PlanFormat : uint8_t {
+    TERNARY_1_28,      // AfricaQuant ternary (packing from the config)
+    QUATERNARY_1_58,   // AfricaQuant quaternary
+    Q4_0,              // llama.cpp Q4_0 (32-value blocks, fp16 scale)
+    F16                // Left unquantized
+};
+
+constexpr size_t PLAN_FORMAT_COUNT = 4;
+
+/**
+ * Reconstruction error measures (0 = exact)
+ */
+enum class ErrorMetric : uint8_t {
+    RELATIVE_MSE,   // ||W - W'||^2 / ||W||^2
+    COSINE          // 1 - cos(W, W') over the flattened tensor
+};
+
+/**
+ * Reconstruction error of one tensor under one format
+ */
+struct ReconstructionError {
+    float relative_mse;
+    float cosine;
+
+    float get(ErrorMetric metric) const {
+        return metric == ErrorMetric::COSINE ? cosine : relative_mse;
+    }
+};
+
+/**
+ * Measure the error between a tensor and its reconstruction
+ */
+ReconstructionError measure_reconstruction_error(const float* reference, const float* reconstructed, size_t count);
+
+/**
+ * Plan entry for one tensor
+ */
+struct TensorPlan {
+    std::string name;
+    size_t rows;
+    size_t cols;
+    PlanFormat format;
+    uint32_t block_size;              // AfricaQuant block size (Q4_0 always uses 32)
+    TernaryPacking packing;
+    uint32_t outliers_per_block;
+    float error;                      // Error of the chosen format under the plan metric
+    float bits_per_weight;            // Storage cost including scales and outliers
+    bool meets_budget;                // False when only the F16 fallback fits
+};
+
+/**
+ * QuantizationPlan - per-tensor format choices for a model conversion
+ *
+ * Saved as a small text file, one tensor per line, so a plan can be
+ * reviewed and hand-edited before conversion, where each entry drives
+ * StreamingQuantizer::begin(writer, entry, ...):
+ *
+ *   # kipepeo-quant-plan 1 <metric> <max_error>
+ *   <name> <rows> <cols> <format> <block_size> <packing> <outliers> <error> <bits>
+ */
+class QuantizationPlan {
+public:
+    QuantizationPlan();
+
+    ErrorMetric metric() const { return metric_; }
+    float max_error() const { return max_error_; }
+    void set_budget(ErrorMetric metric, float max_error);
+
+    void add(const TensorPlan& tensor);
+    void clear();
+
+    const std::vector<TensorPlan>& tensors() const { return tensors_; }
+
+    /**
+     * @return Entry for a tensor, or nullptr if the plan does not cover it
+     */
+    const TensorPlan* find(const std::string& name) const;
+
+    /**
+     * Weight-count-weighted average storage cost
+     */
+    double average_bits_per_weight() const;
+
+    /**
+     * Total payload size in bytes
+     */
+    uint64_t total_bytes() const;
+
+    QuantizationError save(const std::string& path) const;
+    QuantizationError load(const std::string& path);
+
+private:
+    ErrorMetric metric_;
+    float max_error_;
+    std::vector<TensorPlan> tensors_;
+};
+
+const char* get_plan_format_name(PlanFormat format);
+
+/**
+ * Storage cost of a K-column tensor in a format (weights, fp16 scales and
+ * outlier slots as stored in a tensor file); 0 if K or block_size is 0
+ */
+float get_plan_bits_per_weight(PlanFormat format, size_t K, uint32_t block_size,
+                               TernaryPacking packing, uint32_t outliers_per_block);
+
+/**
+ * Calibration settings
+ */
+struct CalibrationConfig {
+    ErrorMetric metric;
+    float max_error;                // Per-tensor error budget under metric
+    uint32_t block_size;            // AfricaQuant block size (0 = resolved per tensor
+                                    // like quantize_matrix_*)
+    size_t max_sample_rows;         // Rows measured per tensor (0 = all), evenly spaced
+    bool allow_q4;                  // Consider Q4_0 before falling back to F16
+    QuantizationConfig quant;       // Packing, outliers, threshold, threads
+
+    CalibrationConfig()
+        : metric(ErrorMetric::RELATIVE_MSE)
+        , max_error(0.05f)
+        , block_size(0)
+        , max_sample_rows(256)
+        , allow_q4(true)
+    {}
+};
+
+/**
+ * BitWidthPlanner - calibration pass that builds a mixed-precision plan
+ *
+ * For each tensor it quantizes a row sample with every candidate format,
+ * measures the reconstruction error and picks the cheapest format (fewest
+ * bits per weight; ternary before quaternary at equal cost, since it is
+ * also the faster kernel) whose error fits the budget. Tensors no format
+ * satisfies stay F16 and are flagged meets_budget = false.
+ */
+class BitWidthPlanner {
+public:
+    explicit BitWidthPlanner(const CalibrationConfig& config = CalibrationConfig());
+    ~BitWidthPlanner();
+
+    BitWidthPlanner(const BitWidthPlanner&) = delete;
+    BitWidthPlanner& operator=(const BitWidthPlanner&) = delete;
+
+    /**
+     * Measure one M x K tensor and add its plan entry
+     *
+     * @param name Tensor name (as it will appear in the converted model)
+     * @param weights Row-major values (only the sampled rows are read, so a
+     *                memory-mapped checkpoint is not paged in as a whole)
+     * @param M Number of rows
+     * @param K Number of columns
+     * @param source Element type of weights
+     * @param errors Optional; receives the error of every format
+     *               (indexed by PlanFormat)
+     * @return QuantizationError code
+     */
+    QuantizationError add_tensor(
+        const std::string& name,
+        const void* weights,
+        size_t M,
+        size_t K,
+        SourceFormat source = SourceFormat::F32,
+        ReconstructionError* errors = nullptr
+    );
+
+    const QuantizationPlan& plan() const;
+
+private:
+    class Impl;
+    Impl* impl_;
+};
+
+} // namespace quantization
+} // namespace kipepeo
@@ -16,7 +16,8 @@ struct HardwareCapabilities {
     size_t l2_cache_size;      // L2 cache size in bytes
     size_t l3_cache_size;      // L3 cache size in bytes (0 if not available)
     size_t total_memory;        // Total available memory in bytes
-    size_t available_memory;    // Available memory in bytes
+    size_t available_memory;    // Available memory in bytes at startup (a snapshot;
+                                // kernels::get_available_memory() is live)
     uint32_t cpu_cores;         // Number of CPU cores
     const char* cpu_model;      // CPU model string (e.g., "MediaTek Helio G99")
     
@@ -29,7 +30,10 @@ struct HardwareCapabilities {
 
 /**
  * Detect hardware capabilities and return optimal settings
- * This function should be called once at startup
+ * Probed once per process (kernels::get_cpu_capabilities); later calls
+ * return a copy of the cached result without any file I/O, so
+ * available_memory and the settings derived from it describe the process
+ * at startup, not the current free memory
  */
 HardwareCapabilities detect_hardware_capabilities();
 
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <mutex>
+#include <new>
+#include <unordered_map>
+#include <vector>
+
+namespace kipepeo {
+namespace quantization {
+
+/**
+ * Memory pool statistics
+ */
+struct MemoryPoolStats {
+    size_t bytes_in_use;         // Bytes currently handed out
+    size_t peak_bytes_in_use;    // High-water mark of bytes_in_use
+    size_t bytes_cached;         // Bytes held on free lists for reuse
+    size_t peak_bytes_reserved;  // High-water mark of in-use + cached bytes
+    uint64_t acquire_count;      // Total acquire() calls
+    uint64_t reuse_hits;         // acquire() calls served from a free list
+    uint64_t system_allocations; // acquire() calls that went to the system allocator
+};
+
+/**
+ * MemoryPool - size-class arena for quantization scratch buffers
+ *
+ * Requests are rounded up to a size class (four classes per power of two,
+ * so at most 25% slack) and returned blocks are kept on per-class free
+ * lists. Repeated per-tensor conversions of similar shapes are then served
+ * without touching malloc. All blocks are 64-byte aligned.
+ *
+ * Thread-safe: acquire/release take a short internal lock.
+ */
+class MemoryPool {
+public:
+    /**
+     * @param max_cached_bytes Upper bound on bytes kept on free lists;
+     *                         releases beyond it go back to the system
+     */
+    explicit MemoryPool(size_t max_cached_bytes = 64 * 1024 * 1024);
+    ~MemoryPool();
+
+    MemoryPool(const MemoryPool&) = delete;
+    MemoryPool& operator=(const MemoryPool&) = delete;
+
+    /**
+     * Get a 64-byte aligned block of at least bytes bytes
+     * @return Block pointer, or nullptr if bytes == 0 or allocation failed
+     */
+    void* acquire(size_t bytes);
+
+    /**
+     * Return a block obtained from acquire(bytes) with the same size
+     */
+    void release(void* ptr, size_t bytes);
+
+    /**
+     * Free every cached block
+     */
+    void trim();
+
+    MemoryPoolStats get_stats() const;
+    void reset_stats();
+
+    /**
+     * Size class a request of bytes bytes is rounded up to
+     */
+    static size_t size_class(size_t bytes);
+
+    static constexpr size_t ALIGNMENT = 64;
+
+private:
+    static void* system_alloc(size_t bytes);
+    static void system_free(void* ptr);
+
+    size_t max_cached_bytes_;
+    std::unordered_map<size_t, std::vector<void*>> free_lists_;
+    MemoryPoolStats stats_;
+    mutable std::mutex mutex_;
+};
+
+/**
+ * PooledBuffer - RAII scratch array drawn from a MemoryPool
+ *
+ * With a null pool (pooling disabled) the buffer is allocated from the
+ * system allocator directly, so callers use one code path either way.
+ * Contents are uninitialized.
+ */
+template <typename T>
+class PooledBuffer {
+public:
+    PooledBuffer() : pool_(nullptr), data_(nullptr), count_(0) {}
+
+    PooledBuffer(MemoryPool* pool, size_t count)
+        : pool_(nullptr), data_(nullptr), count_(0) {
+        allocate(pool, count);
+    }
+
+    ~PooledBuffer() { release(); }
+
+    PooledBuffer(const PooledBuffer&) = delete;
+    PooledBuffer& operator=(const PooledBuffer&) = delete;
+
+    /**
+     * (Re)allocate for count elements; previous contents are discarded
+     * @return false on allocation failure
+     */
+    bool allocate(MemoryPool* pool, size_t count) {
+        release();
+        if (count == 0) return true;
+        size_t bytes = count * sizeof(T);
+        void* ptr = pool ? pool->acquire(bytes)
+                         : ::operator new(bytes, std::nothrow);
+        if (!ptr) return false;
+        pool_ = pool;
+        data_ = static_cast<T*>(ptr);
+        count_ = count;
+        return true;
+    }
+
+    void release() {
+        if (data_) {
+            if (pool_) {
+                pool_->release(data_, count_ * sizeof(T));
+            } else {
+                ::operator delete(data_);
+            }
+        }
+        pool_ = nullptr;
+        data_ = nullptr;
+        count_ = 0;
+    }
+
+    T* data() { return data_; }
+    const T* data() const { return data_; }
+    size_t size() const { return count_; }
+    T& operator[](size_t i) { return data_[i]; }
+    const T& operator[](size_t i) const { return data_[i]; }
+
+private:
+    MemoryPool* pool_;
+    T* data_;
+    size_t count_;
+};
+
+} // namespace quantization
+} // namespace kipepeo
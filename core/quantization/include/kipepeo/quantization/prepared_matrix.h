@@ -0,0 +1,245 @@
+#pragma once
+
+#include "kipepeo/quantization/africa_quant.h"
+#include "kipepeo/quantization/quantization_error.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+namespace kipepeo {
+namespace quantization {
+
+/**
+ * AfricaQuant weight formats a prepared matrix can hold
+ */
+enum class WeightFormat : uint8_t {
+    TERNARY_1_28,     // 1.28-bit ternary {-1, 0, +1}
+    QUATERNARY_1_58   // 1.58-bit quaternary {-1.5, -0.5, +0.5, +1.5}
+};
+
+/**
+ * Storage precision of the per-block scale table
+ */
+enum class ScaleFormat : uint8_t {
+    F32,  // 4 bytes per block
+    F16   // 2 bytes per block (IEEE half)
+};
+
+/**
+ * PreparedMatrix - a quantized weight matrix ready for repeated matvec calls
+ *
+ * matvec_mul_1_28bit/1_58bit walk the QuantizationMeta array, copy and
+ * validate every scale on each call. A PreparedMatrix does that once at
+ * load time: it keeps the packed weights, a contiguous scale table
+ * (fp32 or fp16) and validated shape metadata, so matvec() performs no heap
+ * allocation and no metadata walk.
+ *
+ * matvec() is const and reentrant; one prepared matrix can be shared by
+ * any number of inference threads. Each call splits its rows across the
+ * kernel thread pool (kernels::set_kernel_num_threads).
+ *
+ * interleave() optionally converts a 2-bit matrix to the row-interleaved
+ * layout of kernels::neon::repack_2bit_interleaved, which matvec() then
+ * runs through the multi-row GEMV.
+ */
+class PreparedMatrix {
+public:
+    PreparedMatrix();
+    ~PreparedMatrix();
+
+    PreparedMatrix(PreparedMatrix&& other) noexcept;
+    PreparedMatrix& operator=(PreparedMatrix&& other) noexcept;
+    PreparedMatrix(const PreparedMatrix&) = delete;
+    PreparedMatrix& operator=(const PreparedMatrix&) = delete;
+
+    /**
+     * Prepare a row-major quantized matrix (as produced by
+     * AfricaQuant::quantize_matrix_1_28bit / quantize_matrix_1_58bit)
+     *
+     * @param quantized Packed weights (M rows, see row_bytes())
+     * @param metadata Metadata array (M * num_blocks_per_row entries)
+     * @param M Number of rows
+     * @param K Number of columns
+     * @param format Weight format
+     * @param packing Ternary packing layout (ignored for 1.58-bit)
+     * @param scale_format Precision of the resident scale table
+     * @param copy_weights Copy packed weights into the object; when false the
+     *                     caller's buffer is referenced and must outlive it
+     * @param outliers Outlier slots written at quantization time (optional,
+     *                 always copied)
+     * @param outliers_per_block Slots per block
+     * @return QuantizationError code
+     */
+    QuantizationError prepare(
+        const uint8_t* quantized,
+        const QuantizationMeta* metadata,
+        size_t M,
+        size_t K,
+        WeightFormat format,
+        TernaryPacking packing = TernaryPacking::TWO_BIT,
+        ScaleFormat scale_format = ScaleFormat::F32,
+        bool copy_weights = true,
+        const OutlierEntry* outliers = nullptr,
+        uint32_t outliers_per_block = 0
+    );
+
+    /**
+     * Prepare from an fp16 scale table instead of QuantizationMeta
+     * (e.g. a tensor of a MappedTensorFile). Scales are validated and copied;
+     * the resulting scale_format() is F16.
+     *
+     * @param quantized Packed weights (M rows, see row_bytes())
+     * @param scales_f16 Per-block scales as IEEE half bit patterns
+     *                   (M * num_blocks_per_row entries)
+     * @param block_size Quantization block size (power of two)
+     * @see prepare() for the remaining parameters
+     */
+    QuantizationError prepare_f16_scales(
+        const uint8_t* quantized,
+        const uint16_t* scales_f16,
+        size_t M,
+        size_t K,
+        uint32_t block_size,
+        WeightFormat format,
+        TernaryPacking packing = TernaryPacking::TWO_BIT,
+        bool copy_weights = true,
+        const OutlierEntry* outliers = nullptr,
+        uint32_t outliers_per_block = 0
+    );
+
+    /**
+     * Y = A * X (Y is overwritten)
+     * @param X Input vector (K elements)
+     * @param Y Output vector (M elements)
+     * @return QuantizationError code
+     */
+    QuantizationError matvec(const float* X, float* Y) const;
+
+    /**
+     * Y = A * X with an int8-quantized activation vector (W1.58A8)
+     * Quantize X once per layer with kernels::neon::quantize_activations_int8
+     * using block_size() and reuse it for every matrix that consumes it.
+     * @param X_q Activation codes (K elements)
+     * @param X_scales Activation block scales (blocks_per_row() elements)
+     * @param Y Output vector (M elements)
+     * @return QuantizationError code
+     */
+    QuantizationError matvec_int8(const int8_t* X_q, const float* X_scales, float* Y) const;
+
+    /**
+     * Y = A * X with half-precision activations (kernels::neon::gemv_*_f16)
+     * X and Y are IEEE half bit patterns; with fp16 scales this keeps
+     * activations, scales and outputs at 2 bytes each end to end.
+     * @param X Input vector (K elements)
+     * @param Y Output vector (M elements)
+     * @return QuantizationError code; ERROR_INVALID_CONFIG unless the matrix
+     *         has ScaleFormat::F16 scales, row-major layout and (for 1.28-bit)
+     *         the 2-bit packing
+     */
+    QuantizationError matvec_f16(const uint16_t* X, uint16_t* Y) const;
+
+    /**
+     * Layer-ahead hook: the next matvec (or *_chip_optimized GEMV) issued
+     * from this thread warms this matrix's leading weights into L2 while it
+     * computes (kernels::prefetch_next_weights). Call it on the next layer's
+     * matrix just before the current layer's matvec.
+     */
+    void prefetch_next() const;
+
+    /**
+     * Y = X * A^T for a batch of activation vectors (prompt prefill)
+     * Uses the tiled GEMM with the register tile of the detected chip.
+     * @param X Input vectors (N x K, row-major)
+     * @param N Number of vectors
+     * @param Y Output vectors (N x M, row-major)
+     * @return QuantizationError code
+     */
+    QuantizationError matmul(const float* X, size_t N, float* Y) const;
+
+    /**
+     * Repack weights and scales once into the row-interleaved layout
+     * (panels of rows_per_group rows, see kernels::neon::repack_2bit_interleaved)
+     *
+     * The weights are always copied, so a matrix prepared with
+     * copy_weights = false no longer references the caller's buffer
+     * afterwards. Only matvec() and matmul() accept an interleaved matrix;
+     * matvec_int8() and matvec_f16() return ERROR_INVALID_CONFIG.
+     *
+     * @param rows_per_group 4 or 8 (0 = kernels::get_gemv_interleave_rows())
+     * @return QuantizationError code; ERROR_INVALID_CONFIG for the base-3
+     *         packing or an already interleaved matrix,
+     *         ERROR_UNSUPPORTED_BLOCK_SIZE when block_size() < 4
+     */
+    QuantizationError interleave(uint32_t rows_per_group = 0);
+
+    /**
+     * Release weights and scales
+     */
+    void reset();
+
+    bool is_prepared() const { return weights_ != nullptr; }
+    size_t rows() const { return M_; }
+    size_t cols() const { return K_; }
+    uint32_t block_size() const { return block_size_; }
+    size_t blocks_per_row() const { return num_blocks_per_row_; }
+    size_t row_bytes() const { return row_bytes_; }
+    WeightFormat format() const { return format_; }
+    TernaryPacking packing() const { return packing_; }
+    ScaleFormat scale_format() const { return scale_format_; }
+    uint32_t interleaved_rows() const { return interleaved_rows_; }   // 0 = row-major
+    const uint8_t* weights() const { return weights_; }   // Weights and scales are interleaved
+                                                          // after interleave()
+    const float* scales_f32() const { return scales_f32_.empty() ? nullptr : scales_f32_.data(); }
+    const uint16_t* scales_f16() const { return scales_f16_.empty() ? nullptr : scales_f16_.data(); }
+    const OutlierEntry* outliers() const { return outliers_.empty() ? nullptr : outliers_.data(); }
+    uint32_t outliers_per_block() const { return outliers_per_block_; }
+
+    /**
+     * Resident memory held by the object (owned weights + scale table + outliers)
+     */
+    size_t memory_usage() const;
+
+private:
+    // Kernel calls for rows [begin, end) / a slice of the batch; the public
+    // entry points split the work across the kernel thread pool.
+    // matvec_rows writes row begin's output to y[0].
+    void matvec_rows(const float* X, float* y, size_t begin, size_t end) const;
+    void matvec_int8_rows(const int8_t* X_q, const float* X_scales, float* Y,
+                          size_t begin, size_t end) const;
+    void matvec_f16_rows(const uint16_t* X, uint16_t* Y, size_t begin, size_t end) const;
+    void matmul_vectors(const float* X, size_t N, float* Y, size_t MR, size_t NR) const;
+
+    QuantizationError adopt(
+        const uint8_t* quantized,
+        size_t M,
+        size_t K,
+        uint32_t block_size,
+        WeightFormat format,
+        TernaryPacking packing,
+        ScaleFormat scale_format,
+        bool copy_weights,
+        const OutlierEntry* outliers,
+        uint32_t outliers_per_block,
+        std::vector<float>& scales_f32,
+        std::vector<uint16_t>& scales_f16
+    );
+
+    const uint8_t* weights_;
+    std::vector<uint8_t> owned_weights_;
+    std::vector<float> scales_f32_;
+    std::vector<uint16_t> scales_f16_;
+    std::vector<OutlierEntry> outliers_;
+    size_t M_;
+    size_t K_;
+    uint32_t block_size_;
+    size_t num_blocks_per_row_;
+    size_t row_bytes_;
+    uint32_t outliers_per_block_;
+    uint32_t interleaved_rows_;
+    WeightFormat format_;
+    TernaryPacking packing_;
+    ScaleFormat scale_format_;
+};
+
+} // namespace quantization
+} // namespace kipepeo
@@ -37,6 +37,11 @@ enum class QuantizationError : int32_t {
     ERROR_INVALID_CONFIG = -40,
     ERROR_UNSUPPORTED_BLOCK_SIZE = -41,
     
+    // File errors
+    ERROR_FILE_IO = -50,
+    ERROR_INVALID_FILE_FORMAT = -51,
+    ERROR_TENSOR_NOT_FOUND = -52,
+    
     // Unknown error
     ERROR_UNKNOWN = -100
 };
@@ -0,0 +1,174 @@
+#pragma once
+
+#include "kipepeo/quantization/africa_quant.h"
+#include "kipepeo/quantization/prepared_matrix.h"
+#include "kipepeo/quantization/quantization_error.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <functional>
+#include <string>
+
+namespace kipepeo {
+namespace quantization {
+
+class TensorFileWriter;
+struct TensorPlan;
+
+/**
+ * Element type of the unquantized source tensor
+ */
+enum class SourceFormat : uint8_t {
+    F32,   // IEEE single
+    F16,   // IEEE half
+    BF16   // bfloat16 (upper half of an fp32)
+};
+
+/**
+ * Widen count source values to fp32
+ */
+void convert_source_to_f32(const void* values, size_t count, SourceFormat source, float* out);
+
+/**
+ * One batch of finished rows handed to a ChunkSink
+ * Pointers are only valid during the callback.
+ */
+struct QuantizedChunk {
+    size_t first_row;                   // Index of the first row in the tensor
+    size_t rows;                        // Rows in this chunk
+    const uint8_t* quantized;           // rows * row_bytes() packed bytes
+    const QuantizationMeta* metadata;   // rows * num_blocks_per_row entries
+    const OutlierEntry* outliers;       // Outlier slots, nullptr without a side channel
+};
+
+// Receives quantized rows in order; a non-SUCCESS return stops the stream
+typedef std::function<QuantizationError(const QuantizedChunk& chunk)> ChunkSink;
+
+/**
+ * StreamingQuantizer - quantizes an M x K tensor that never has to be
+ * resident as a whole
+ *
+ * Values are pushed in any granularity (whole rows, single blocks, or raw
+ * spans of an fp16/bf16 checkpoint) and converted into a staging buffer of
+ * chunk_rows rows. Each full chunk is quantized with
+ * quantize_matrix_1_28bit / quantize_matrix_1_58bit (row-parallel per the
+ * config) and handed to the sink, or appended to a TensorFileWriter, before
+ * the buffers are reused. Peak memory is therefore about
+ * chunk_rows * K * 4 bytes plus the packed chunk, independent of M.
+ *
+ * Output equals quantize_matrix_* on the whole tensor, with one exception:
+ * an adaptive 1.28-bit threshold is sampled from the first chunk instead of
+ * the whole tensor. Set QuantizationConfig::threshold_1_28 for
+ * byte-identical output.
+ *
+ * One instance encodes one tensor at a time and is not thread-safe.
+ */
+class StreamingQuantizer {
+public:
+    StreamingQuantizer();
+    ~StreamingQuantizer();
+
+    StreamingQuantizer(const StreamingQuantizer&) = delete;
+    StreamingQuantizer& operator=(const StreamingQuantizer&) = delete;
+
+    /**
+     * Start a tensor whose chunks go to a callback
+     *
+     * @param M Number of rows
+     * @param K Number of columns
+     * @param format Target weight format
+     * @param sink Receives every quantized chunk in row order
+     * @param block_size Block size (0 = config->block_size, then the
+     *                   get_optimal_block_size default for M * K)
+     * @param config Optional configuration (packing, threshold, outliers,
+     *               threads); progress_callback reports rows completed
+     * @param chunk_rows Rows per chunk (0 = about 4M values per chunk)
+     * @return QuantizationError code
+     */
+    QuantizationError begin(
+        size_t M,
+        size_t K,
+        WeightFormat format,
+        ChunkSink sink,
+        uint32_t block_size = 0,
+        const QuantizationConfig* config = nullptr,
+        size_t chunk_rows = 0
+    );
+
+    /**
+     * Start a tensor that is appended to a tensor file as it is encoded
+     * (TensorFileWriter::begin_tensor / append_rows / end_tensor). If the
+     * stream fails, writer.finish() reports the incomplete tensor.
+     */
+    QuantizationError begin(
+        TensorFileWriter& writer,
+        const std::string& name,
+        size_t M,
+        size_t K,
+        WeightFormat format,
+        uint32_t block_size = 0,
+        const QuantizationConfig* config = nullptr,
+        size_t chunk_rows = 0
+    );
+
+    /**
+     * Start a tensor as a mixed-precision plan entry prescribes (see
+     * BitWidthPlanner), appended to a tensor file under entry.name
+     *
+     * Format, block size, packing and outlier slots come from the entry;
+     * threshold and threads from config. A tensor file only stores
+     * AfricaQuant formats, so Q4_0 and F16 entries are left to the caller
+     * (ERROR_INVALID_CONFIG), as is a tensor whose shape differs from the
+     * one the plan was calibrated on (ERROR_INVALID_COUNT).
+     *
+     * @param M, K Shape of the source tensor
+     */
+    QuantizationError begin(
+        TensorFileWriter& writer,
+        const TensorPlan& entry,
+        size_t M,
+        size_t K,
+        const QuantizationConfig* config = nullptr,
+        size_t chunk_rows = 0
+    );
+
+    /**
+     * Push the next count values (row-major order, any split)
+     */
+    QuantizationError push(const void* values, size_t count, SourceFormat source = SourceFormat::F32);
+
+    /**
+     * Push the rest of the tensor straight from a file, e.g. the data
+     * section of a safetensors or GGUF checkpoint
+     *
+     * The region starting at offset is memory-mapped and streamed chunk by
+     * chunk; consumed source pages are released as the encoder passes them,
+     * so resident memory stays bounded even for tensors larger than RAM.
+     *
+     * @param path Source file
+     * @param offset Byte offset of the first value still to be pushed
+     * @param source Element type of the stored values
+     */
+    QuantizationError push_file(const std::string& path, uint64_t offset, SourceFormat source);
+
+    /**
+     * Quantize the staged tail and close the tensor; fails unless exactly
+     * M * K values were pushed
+     */
+    QuantizationError finish();
+
+    bool is_active() const;
+    size_t rows_done() const;
+    uint32_t block_size() const;
+
+    /**
+     * Packed bytes per row of the current tensor
+     */
+    size_t row_bytes() const;
+
+private:
+    class Impl;
+    Impl* impl_;
+};
+
+} // namespace quantization
+} // namespace kipepeo
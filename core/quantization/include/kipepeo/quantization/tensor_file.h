@@ -0,0 +1,258 @@
+#pragma once
+
+#include "kipepeo/quantization/africa_quant.h"
+#include "kipepeo/quantization/prepared_matrix.h"
+#include "kipepeo/quantization/quantization_error.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+namespace kipepeo {
+namespace quantization {
+
+/**
+ * AfricaQuant tensor file - on-disk container for prepared weight matrices
+ *
+ * Layout (little-endian):
+ *   TensorFileHeader                 offset 0, 64 bytes
+ *   payloads                         each starting on a 64-byte boundary:
+ *                                    packed weights, fp16 scales, outliers
+ *   TensorFileRecord[tensor_count]   at header.directory_offset
+ *
+ * Per tensor the file holds the packed rows exactly as the GEMV kernels
+ * read them, a compact fp16 scale table (2 bytes per block instead of a
+ * 16-byte QuantizationMeta) and optional outlier slots. The magic is only
+ * written by TensorFileWriter::finish(), so truncated files are rejected.
+ */
+constexpr char TENSOR_FILE_MAGIC[4] = {'K', 'P', 'A', 'Q'};
+constexpr uint32_t TENSOR_FILE_VERSION = 1;
+constexpr size_t TENSOR_FILE_ALIGNMENT = 64;
+constexpr size_t TENSOR_FILE_MAX_NAME = 63;
+
+struct TensorFileHeader {
+    char magic[4];              // TENSOR_FILE_MAGIC
+    uint32_t version;           // TENSOR_FILE_VERSION
+    uint32_t tensor_count;
+    uint32_t record_size;       // sizeof(TensorFileRecord)
+    uint64_t directory_offset;
+    uint64_t file_size;
+    uint8_t reserved[32];
+};
+
+struct TensorFileRecord {
+    char name[TENSOR_FILE_MAX_NAME + 1];  // NUL-terminated
+    uint64_t rows;
+    uint64_t cols;
+    uint32_t block_size;
+    uint32_t outliers_per_block;
+    uint8_t format;             // WeightFormat
+    uint8_t packing;            // TernaryPacking
+    uint8_t reserved[6];
+    uint64_t weights_offset;
+    uint64_t weights_bytes;
+    uint64_t scales_offset;     // fp16, rows * blocks_per_row entries
+    uint64_t scales_bytes;
+    uint64_t outliers_offset;   // OutlierEntry, 0 bytes when per_block == 0
+    uint64_t outliers_bytes;
+};
+
+static_assert(sizeof(TensorFileHeader) == 64, "TensorFileHeader must be 64 bytes");
+static_assert(sizeof(TensorFileRecord) == 144, "TensorFileRecord must be 144 bytes");
+
+/**
+ * TensorFileWriter - streams quantized matrices into a tensor file
+ *
+ * Each add_tensor() call writes its payload immediately, so a converter
+ * only needs one tensor in memory at a time.
+ */
+class TensorFileWriter {
+public:
+    TensorFileWriter();
+    ~TensorFileWriter();
+
+    TensorFileWriter(const TensorFileWriter&) = delete;
+    TensorFileWriter& operator=(const TensorFileWriter&) = delete;
+
+    /**
+     * Create (truncate) the output file
+     */
+    QuantizationError open(const std::string& path);
+
+    /**
+     * Append one quantized matrix (as produced by
+     * AfricaQuant::quantize_matrix_1_28bit / quantize_matrix_1_58bit)
+     *
+     * @param name Unique tensor name (at most TENSOR_FILE_MAX_NAME bytes)
+     * @param quantized Packed weights (M rows)
+     * @param metadata Metadata array (M * num_blocks_per_row entries);
+     *                 scales are stored as fp16
+     * @param M Number of rows
+     * @param K Number of columns
+     * @param format Weight format
+     * @param packing Ternary packing layout (ignored for 1.58-bit)
+     * @param outliers Outlier slots (optional)
+     * @param outliers_per_block Slots per block
+     * @return QuantizationError code
+     */
+    QuantizationError add_tensor(
+        const std::string& name,
+        const uint8_t* quantized,
+        const QuantizationMeta* metadata,
+        size_t M,
+        size_t K,
+        WeightFormat format,
+        TernaryPacking packing = TernaryPacking::TWO_BIT,
+        const OutlierEntry* outliers = nullptr,
+        uint32_t outliers_per_block = 0
+    );
+
+    /**
+     * Streaming form of add_tensor() for matrices produced in row chunks
+     * (see StreamingQuantizer): begin_tensor(), append_rows() until all M
+     * rows are written, then end_tensor(). Packed rows go straight to the
+     * file; only the fp16 scales and outlier slots are held until
+     * end_tensor() writes them.
+     */
+    QuantizationError begin_tensor(
+        const std::string& name,
+        size_t M,
+        size_t K,
+        WeightFormat format,
+        uint32_t block_size,
+        TernaryPacking packing = TernaryPacking::TWO_BIT,
+        uint32_t outliers_per_block = 0
+    );
+
+    /**
+     * Append the next rows of the open tensor
+     * @param quantized Packed rows (rows * packed row size bytes)
+     * @param metadata rows * num_blocks_per_row entries
+     * @param rows Number of rows
+     * @param outliers rows * num_blocks_per_row * outliers_per_block slots
+     *                 (required when the tensor was begun with slots)
+     */
+    QuantizationError append_rows(
+        const uint8_t* quantized,
+        const QuantizationMeta* metadata,
+        size_t rows,
+        const OutlierEntry* outliers = nullptr
+    );
+
+    /**
+     * Close the open tensor; fails unless exactly M rows were appended
+     */
+    QuantizationError end_tensor();
+
+    /**
+     * Write the directory and header and close the file
+     */
+    QuantizationError finish();
+
+    size_t tensor_count() const { return records_.size(); }
+
+private:
+    QuantizationError write_aligned(const void* data, size_t bytes, uint64_t& offset);
+    void abort();
+
+    FILE* file_;
+    uint64_t position_;
+    std::vector<TensorFileRecord> records_;
+
+    // Tensor between begin_tensor() and end_tensor()
+    bool streaming_;
+    TensorFileRecord pending_;
+    size_t pending_rows_;
+    std::vector<uint16_t> pending_scales_;
+    std::vector<OutlierEntry> pending_outliers_;
+};
+
+/**
+ * Description of one tensor in a mapped file; pointers refer into the mapping
+ */
+struct MappedTensorInfo {
+    std::string name;
+    WeightFormat format;
+    TernaryPacking packing;
+    size_t rows;
+    size_t cols;
+    uint32_t block_size;
+    uint32_t outliers_per_block;
+    const uint8_t* weights;
+    size_t weights_bytes;
+    const uint16_t* scales_f16;
+    const OutlierEntry* outliers;
+};
+
+/**
+ * MappedTensorFile - read-only, memory-mapped view of a tensor file
+ *
+ * open() maps the file and reads only the header and directory, so a cold
+ * start does not touch the weights. matrix() prepares a tensor on first use:
+ * the PreparedMatrix copies the (small) scale and outlier tables and
+ * references the packed weights in the mapping, which are paged in by the
+ * first matvec. Weight pages are clean file-backed pages, so the OS can
+ * drop cold layers under memory pressure and fault them back in later;
+ * evict() and prefetch() give it explicit hints.
+ *
+ * matrix() is thread-safe; returned pointers stay valid until close().
+ */
+class MappedTensorFile {
+public:
+    MappedTensorFile();
+    ~MappedTensorFile();
+
+    MappedTensorFile(const MappedTensorFile&) = delete;
+    MappedTensorFile& operator=(const MappedTensorFile&) = delete;
+
+    /**
+     * Map a tensor file and validate its header and directory
+     */
+    QuantizationError open(const std::string& path);
+
+    /**
+     * Unmap the file; invalidates every pointer handed out
+     */
+    void close();
+
+    bool is_open() const;
+    size_t tensor_count() const;
+    size_t file_size() const;
+
+    /**
+     * @return Tensor index, or -1 if there is no tensor of that name
+     */
+    int find(const std::string& name) const;
+
+    /**
+     * @return Tensor description, or nullptr if index is out of range
+     */
+    const MappedTensorInfo* info(size_t index) const;
+
+    /**
+     * Prepared matrix for a tensor, built on first use
+     * @param error Optional; receives the preparation status
+     * @return nullptr if the tensor does not exist or failed validation
+     */
+    const PreparedMatrix* matrix(size_t index, QuantizationError* error = nullptr);
+    const PreparedMatrix* matrix(const std::string& name, QuantizationError* error = nullptr);
+
+    /**
+     * Ask the OS to start reading a tensor's weights (e.g. the next layer)
+     */
+    void prefetch(size_t index) const;
+
+    /**
+     * Drop a tensor's resident weight pages; they are re-read from the file
+     * on next use
+     */
+    void evict(size_t index) const;
+
+private:
+    class Impl;
+    Impl* impl_;
+};
+
+} // namespace quantization
+} // namespace kipepeo
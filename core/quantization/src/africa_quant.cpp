@@ -1,32 +1,192 @@
 #include "kipepeo/quantization/africa_quant.h"
 #include "kipepeo/kernels/neon/quantized_gemm.h"
+#include "kipepeo/kernels/fp16.h"
 #include <cmath>
 #include <cstring>
 #include <algorithm>
+#include <atomic>
 #include <mutex>
+#include <system_error>
+#include <thread>
 #include <vector>
 
 #ifdef KIPEPEO_NEON_ENABLED
 #include <arm_neon.h>
 #endif
 
+#ifdef KIPEPEO_X86_ENABLED
+#include "kipepeo/kernels/x86/x86_kernels.h"
+#endif
+
 namespace kipepeo {
 namespace quantization {
 
+namespace {
+
+// Per-thread scratch for the lock-free compute paths (matvec, dequantize).
+// Grows to the largest request seen on the calling thread and is reused,
+// so concurrent callers never share or contend on a buffer.
+float* thread_scratch_floats(size_t count) {
+    thread_local std::vector<float> scratch;
+    if (scratch.size() < count) {
+        scratch.resize(count);
+    }
+    return scratch.data();
+}
+
+#ifdef KIPEPEO_X86_ENABLED
+// The scalar (non-NEON) quantizers hand whole bytes of 2-bit codes to the
+// AVX2 helpers; output is bit-identical to the per-value loops
+bool use_x86_simd() {
+    return kernels::x86::get_x86_level() >= kernels::x86::X86Level::AVX2;
+}
+#endif
+
+// Largest |w| of a block (NaNs are skipped, as std::max does)
+float block_abs_max(const float* w, size_t n) {
+#ifdef KIPEPEO_X86_ENABLED
+    if (use_x86_simd()) {
+        return kernels::x86::abs_max_avx2(w, n);
+    }
+#endif
+    float max_abs = 0.0f;
+    for (size_t i = 0; i < n; ++i) {
+        max_abs = std::max(max_abs, std::fabs(w[i]));
+    }
+    return max_abs;
+}
+
+// Byte -> four levels: entry b holds the levels of the 2-bit codes in byte
+// b (value i in bits 2i..2i+1), so a packed row dequantizes one byte at a
+// time without per-value bit extraction or branches
+struct ByteLevelTable {
+    alignas(16) float levels[256][4];
+
+    explicit ByteLevelTable(const float codes[4]) {
+        for (int b = 0; b < 256; ++b) {
+            for (int i = 0; i < 4; ++i) {
+                levels[b][i] = codes[(b >> (2 * i)) & 0b11];
+            }
+        }
+    }
+};
+
+const ByteLevelTable& ternary_byte_table() {
+    // 10 and 11 both decode to +1, as in the per-value decoder
+    static const float codes[4] = {-1.0f, 0.0f, 1.0f, 1.0f};
+    static const ByteLevelTable table(codes);
+    return table;
+}
+
+const ByteLevelTable& quaternary_byte_table() {
+    static const float codes[4] = {-1.5f, -0.5f, 0.5f, 1.5f};
+    static const ByteLevelTable table(codes);
+    return table;
+}
+
+// out[i] = level(code_i) * scale for n values (n % 4 == 0) through a byte
+// table; the fixed four-wide body is left to the compiler's vectorizer
+void dequantize_2bit_lut(const uint8_t* packed, size_t n, const ByteLevelTable& table,
+                         float scale, float* out) {
+    for (size_t b = 0; b < n / 4; ++b) {
+        const float* levels = table.levels[packed[b]];
+        float* o = out + 4 * b;
+        o[0] = levels[0] * scale;
+        o[1] = levels[1] * scale;
+        o[2] = levels[2] * scale;
+        o[3] = levels[3] * scale;
+    }
+}
+
+// Scale search candidates per block (see QuantizationConfig::search_scales)
+constexpr int SCALE_SEARCH_STEPS = 24;
+
+// Ternary candidate sums: over a[i] > threshold, sums[0] = sum c * a and
+// sums[1] = sum c
+void ternary_fit_sums(const float* a, const float* c, size_t n, float threshold, float sums[2]) {
+#ifdef KIPEPEO_X86_ENABLED
+    if (use_x86_simd()) {
+        kernels::x86::ternary_fit_sums_avx2(a, c, n, threshold, sums);
+        return;
+    }
+#endif
+    size_t i = 0;
+    float ca = 0.0f, cc = 0.0f;
+#ifdef KIPEPEO_NEON_ENABLED
+    float32x4_t ca_vec = vdupq_n_f32(0.0f);
+    float32x4_t cc_vec = vdupq_n_f32(0.0f);
+    float32x4_t thr_vec = vdupq_n_f32(threshold);
+    for (; i + 4 <= n; i += 4) {
+        float32x4_t av = vld1q_f32(a + i);
+        uint32x4_t mask = vcgtq_f32(av, thr_vec);
+        float32x4_t cv = vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(vld1q_f32(c + i)), mask));
+        ca_vec = vmlaq_f32(ca_vec, cv, av);
+        cc_vec = vaddq_f32(cc_vec, cv);
+    }
+    ca = vaddvq_f32(ca_vec);
+    cc = vaddvq_f32(cc_vec);
+#endif
+    for (; i < n; ++i) {
+        if (a[i] > threshold) {
+            ca += c[i] * a[i];
+            cc += c[i];
+        }
+    }
+    sums[0] = ca;
+    sums[1] = cc;
+}
+
+// Quaternary candidate sums: with l = (a[i] * inv_scale > 1 ? 1.5 : 0.5),
+// sums[0] = sum c * l * a and sums[1] = sum c * l * l
+void quaternary_fit_sums(const float* a, const float* c, size_t n, float inv_scale, float sums[2]) {
+#ifdef KIPEPEO_X86_ENABLED
+    if (use_x86_simd()) {
+        kernels::x86::quaternary_fit_sums_avx2(a, c, n, inv_scale, sums);
+        return;
+    }
+#endif
+    size_t i = 0;
+    float cal = 0.0f, cll = 0.0f;
+#ifdef KIPEPEO_NEON_ENABLED
+    float32x4_t cal_vec = vdupq_n_f32(0.0f);
+    float32x4_t cll_vec = vdupq_n_f32(0.0f);
+    float32x4_t inv_vec = vdupq_n_f32(inv_scale);
+    float32x4_t one = vdupq_n_f32(1.0f);
+    float32x4_t inner = vdupq_n_f32(0.5f);
+    float32x4_t outer = vdupq_n_f32(1.5f);
+    for (; i + 4 <= n; i += 4) {
+        float32x4_t av = vld1q_f32(a + i);
+        float32x4_t l = vbslq_f32(vcgtq_f32(vmulq_f32(av, inv_vec), one), outer, inner);
+        float32x4_t cl = vmulq_f32(vld1q_f32(c + i), l);
+        cal_vec = vmlaq_f32(cal_vec, cl, av);
+        cll_vec = vmlaq_f32(cll_vec, cl, l);
+    }
+    cal = vaddvq_f32(cal_vec);
+    cll = vaddvq_f32(cll_vec);
+#endif
+    for (; i < n; ++i) {
+        float l = a[i] * inv_scale > 1.0f ? 1.5f : 0.5f;
+        cal += c[i] * l * a[i];
+        cll += c[i] * l * l;
+    }
+    sums[0] = cal;
+    sums[1] = cll;
+}
+
+} // anonymous namespace
+
 // ========== Implementation Class ==========
 
 class AfricaQuant::Impl {
 public:
-    bool neon_enabled_;
+    std::atomic<bool> neon_enabled_;
     HardwareCapabilities hardware_caps_;
-    std::mutex mutex_;  // For thread safety
+    std::mutex mutex_;  // Serializes quantization and configuration changes;
+                        // matvec and dequantize never take it
     
-    // Memory pool for temporary buffers
-    struct MemoryPool {
-        std::vector<float*> float_pool;
-        std::vector<uint8_t*> uint8_pool;
-        size_t pool_size;
-    } memory_pool_;
+    // Size-class arena for temporary buffers (internally synchronized)
+    MemoryPool memory_pool_;
+    std::atomic<bool> pooling_enabled_;
 
     Impl() {
 #ifdef KIPEPEO_NEON_ENABLED
@@ -35,17 +195,15 @@ public:
         neon_enabled_ = false;
 #endif
         hardware_caps_ = detect_hardware_capabilities();
-        memory_pool_.pool_size = 0;
+        pooling_enabled_ = true;
     }
     
-    ~Impl() {
-        // Clean up memory pool
-        for (auto* ptr : memory_pool_.float_pool) {
-            delete[] ptr;
-        }
-        for (auto* ptr : memory_pool_.uint8_pool) {
-            delete[] ptr;
-        }
+    // Helper: Pool to draw scratch from (nullptr = plain heap allocation).
+    // Calls with a config follow QuantizationConfig::use_memory_pooling,
+    // everything else follows set_memory_pooling_enabled().
+    MemoryPool* scratch_pool(const QuantizationConfig* config = nullptr) {
+        bool enabled = config ? config->use_memory_pooling : pooling_enabled_.load();
+        return enabled ? &memory_pool_ : nullptr;
     }
     
     // Helper: Validate inputs
@@ -54,8 +212,7 @@ public:
         size_t count,
         const void* output,
         const void* metadata,
-        uint32_t block_size,
-        size_t output_buffer_size
+        uint32_t block_size
     ) {
         if (!weights) return QuantizationError::ERROR_NULL_POINTER;
         if (!output) return QuantizationError::ERROR_NULL_POINTER;
@@ -68,11 +225,8 @@ public:
             return QuantizationError::ERROR_INVALID_BLOCK_SIZE;
         }
         
-        // Check buffer size
-        size_t required_size = AfricaQuant::get_quantized_buffer_size(count, 1.58f);
-        if (output_buffer_size < required_size) {
-            return QuantizationError::ERROR_INVALID_BUFFER_SIZE;
-        }
+        // Output size depends on the packing layout; the packing loops
+        // guard against overflow of the exact packed size themselves
         
         // Check NEON alignment if using NEON
         if (neon_enabled_ && !is_neon_aligned(weights)) {
@@ -83,13 +237,19 @@ public:
     }
     
     // Helper: Detect outliers in a block
-    void detect_outliers(
+    // Writes the indices of values beyond 2.5 standard deviations into
+    // outlier_indices (scratch drawn from pool) and returns how many were found
+    size_t detect_outliers(
         const float* weights,
         size_t count,
         float& threshold,
-        std::vector<size_t>& outlier_indices
+        PooledBuffer<uint32_t>& outlier_indices,
+        MemoryPool* pool
     ) {
-        if (count == 0) return;
+        if (count == 0) return 0;
+        if (outlier_indices.size() < count && !outlier_indices.allocate(pool, count)) {
+            return 0;  // No scratch: the block is quantized without outliers
+        }
         
         // Compute statistics
         float sum = 0.0f;
@@ -110,13 +270,364 @@ public:
         
         // Outliers are values beyond 2.5 standard deviations
         float outlier_threshold = mean + 2.5f * std_dev;
+        threshold = outlier_threshold;
         
-        outlier_indices.clear();
+        size_t num_outliers = 0;
         for (size_t i = 0; i < count; ++i) {
             if (std::fabs(weights[i]) > outlier_threshold) {
-                outlier_indices.push_back(i);
+                outlier_indices[num_outliers++] = static_cast<uint32_t>(i);
+            }
+        }
+        return num_outliers;
+    }
+
+    // Sparse outlier side channel for one quantize call (see OutlierEntry).
+    // slots points at the first block's slots of the weights being quantized.
+    struct OutlierSink {
+        OutlierEntry* slots;
+        uint32_t per_block;
+        bool detect;       // false = emit empty slots only
+        MemoryPool* pool;  // Scratch for candidate indices
+    };
+    
+    // Helper: Set up the outlier side channel for a quantize call
+    // Returns nullptr when the caller passed no slots or no slots per block
+    const OutlierSink* resolve_outlier_sink(
+        const QuantizationConfig& config,
+        OutlierEntry* slots,
+        uint32_t block_size,
+        OutlierSink& sink,
+        QuantizationError& err
+    ) {
+        err = QuantizationError::SUCCESS;
+        if (!slots || config.max_outliers_per_block == 0) return nullptr;
+        // Slot indices are uint16_t and 0xFFFF marks an empty slot
+        if (block_size > 32768) {
+            err = QuantizationError::ERROR_UNSUPPORTED_BLOCK_SIZE;
+            return nullptr;
+        }
+        sink.slots = slots;
+        sink.per_block = config.max_outliers_per_block;
+        sink.detect = config.detect_outliers;
+        sink.pool = scratch_pool(&config);
+        return &sink;
+    }
+    
+    // Helper: Pick the block's outliers and the scale base for its body
+    // Candidates are the values detect_outliers() flags; the per_block largest
+    // magnitudes are kept (sorted by position) in scratch[0..n), and
+    // body_max_abs becomes the max |w| over the remaining weights.
+    size_t select_block_outliers(
+        const float* block,
+        size_t count,
+        const OutlierSink& sink,
+        PooledBuffer<uint32_t>& scratch,
+        float& body_max_abs
+    ) {
+        if (!sink.detect) return 0;
+        
+        float threshold;
+        size_t num_candidates = detect_outliers(block, count, threshold, scratch, sink.pool);
+        size_t num_outliers = std::min<size_t>(num_candidates, sink.per_block);
+        if (num_outliers == 0) return 0;
+        
+        uint32_t* idx = scratch.data();
+        std::partial_sort(idx, idx + num_outliers, idx + num_candidates,
+                          [block](uint32_t a, uint32_t b) {
+                              return std::fabs(block[a]) > std::fabs(block[b]);
+                          });
+        std::sort(idx, idx + num_outliers);
+        
+        body_max_abs = 0.0f;
+        size_t next = 0;
+        for (size_t i = 0; i < count; ++i) {
+            if (next < num_outliers && idx[next] == i) {
+                ++next;
+                continue;
+            }
+            body_max_abs = std::max(body_max_abs, std::fabs(block[i]));
+        }
+        return num_outliers;
+    }
+    
+    // Helper: Outlier selection step of the quantize loops
+    // With a side channel (outliers non-null) the scale is fitted to the
+    // block body and the largest outliers are carried as sparse fp16
+    // residuals; without one max_abs is left as the whole block's.
+    size_t fit_scale_to_block_body(
+        const float* block,
+        size_t count,
+        const OutlierSink* outliers,
+        PooledBuffer<uint32_t>& scratch,
+        float& max_abs
+    ) {
+        return outliers ? select_block_outliers(block, count, *outliers, scratch, max_abs) : 0;
+    }
+    
+    // Per-block scale search for one quantize call (see
+    // QuantizationConfig::search_scales). importance points at the error
+    // weight of the first value being quantized, nullptr = uniform.
+    struct ScaleSearch {
+        const float* importance;
+        MemoryPool* pool;  // Scratch for the per-block fits
+    };
+
+    // Helper: Error weights and |w| of a block body for the scale search
+    // Outliers get weight 0 since their residuals are stored exactly.
+    // a[i] = |w[i]| * norm; both arrays live in scratch (drawn from pool,
+    // reused across the blocks of a call). Returns false without scratch,
+    // in which case the block keeps its max-abs scale.
+    bool prepare_scale_search(
+        const float* block,
+        size_t count,
+        const float* importance,
+        const uint32_t* outlier_idx,
+        size_t num_outliers,
+        float norm,
+        PooledBuffer<float>& scratch,
+        MemoryPool* pool,
+        float*& a,
+        float*& c
+    ) {
+        if (scratch.size() < 2 * count && !scratch.allocate(pool, 2 * count)) {
+            return false;
+        }
+        a = scratch.data();
+        c = a + count;
+        for (size_t i = 0; i < count; ++i) {
+            a[i] = std::fabs(block[i] * norm);
+            c[i] = importance ? importance[i] : 1.0f;
+        }
+        for (size_t o = 0; o < num_outliers; ++o) {
+            c[outlier_idx[o]] = 0.0f;
+        }
+        return true;
+    }
+
+    // Helper: Error-minimising ternary threshold and scale for one block
+    // Codes are still w * inv_scale against threshold. For each candidate
+    // threshold the least-squares scale of the implied codes is
+    // sum(c|w|) / sum(c) over the nonzero codes, which leaves an error of
+    // sum(c w^2) - sum(c|w|)^2 / sum(c); the candidate maximising the
+    // second term wins. threshold and scale are updated in place.
+    void search_ternary_block(
+        const float* block,
+        size_t count,
+        const ScaleSearch& search,
+        size_t offset,
+        const uint32_t* outlier_idx,
+        size_t num_outliers,
+        PooledBuffer<float>& scratch,
+        float inv_scale,
+        float& threshold,
+        float& scale
+    ) {
+        float* a;
+        float* c;
+        const float* importance = search.importance ? search.importance + offset : nullptr;
+        if (!prepare_scale_search(block, count, importance, outlier_idx, num_outliers, inv_scale,
+                                  scratch, search.pool, a, c)) {
+            return;
+        }
+
+        float best_gain = 0.0f;
+        float best_threshold = threshold;
+        float best_level = 0.0f;
+        for (int step = 0; step <= SCALE_SEARCH_STEPS; ++step) {
+            // Step 0 is the configured threshold
+            float candidate = step == 0 ? threshold
+                                        : static_cast<float>(step) / (SCALE_SEARCH_STEPS + 1);
+            float sums[2];
+            ternary_fit_sums(a, c, count, candidate, sums);
+            if (sums[1] <= 0.0f) continue;
+            float gain = sums[0] * sums[0] / sums[1];
+            if (gain > best_gain) {
+                best_gain = gain;
+                best_threshold = candidate;
+                best_level = sums[0] / sums[1];
+            }
+        }
+
+        float fitted = best_level / inv_scale;
+        if (best_gain > 0.0f && fitted > 0.0f && std::isfinite(fitted)) {
+            threshold = best_threshold;
+            scale = fitted;
+        }
+    }
+
+    // Helper: Error-minimising quaternary level spacing for one block
+    // Candidate code scales shrink the max-abs spacing; for the codes each
+    // implies the least-squares scale is sum(c l |w|) / sum(c l^2) and the
+    // error sum(c w^2) - sum(c l |w|)^2 / sum(c l^2). inv_scale (used for
+    // coding) and scale (stored) are updated in place.
+    void search_quaternary_block(
+        const float* block,
+        size_t count,
+        const ScaleSearch& search,
+        size_t offset,
+        const uint32_t* outlier_idx,
+        size_t num_outliers,
+        PooledBuffer<float>& scratch,
+        float& inv_scale,
+        float& scale
+    ) {
+        float* a;
+        float* c;
+        const float* importance = search.importance ? search.importance + offset : nullptr;
+        if (!prepare_scale_search(block, count, importance, outlier_idx, num_outliers, 1.0f,
+                                  scratch, search.pool, a, c)) {
+            return;
+        }
+
+        float best_gain = 0.0f;
+        float best_inv = inv_scale;
+        float best_scale = scale;
+        for (int step = 0; step < SCALE_SEARCH_STEPS; ++step) {
+            // Spacing factors 1.0 (max-abs, the default) down to 0.25
+            float factor = 1.0f - 0.75f * static_cast<float>(step) / (SCALE_SEARCH_STEPS - 1);
+            float candidate_inv = inv_scale / factor;
+            float sums[2];
+            quaternary_fit_sums(a, c, count, candidate_inv, sums);
+            if (sums[1] <= 0.0f) continue;
+            float gain = sums[0] * sums[0] / sums[1];
+            if (gain > best_gain) {
+                best_gain = gain;
+                best_inv = candidate_inv;
+                best_scale = sums[0] / sums[1];
             }
         }
+
+        if (best_gain > 0.0f && best_scale > 0.0f && std::isfinite(best_scale) && std::isfinite(best_inv)) {
+            inv_scale = best_inv;
+            scale = best_scale;
+        }
+    }
+
+    // Helper: Set up the scale search for a quantize call
+    // Returns nullptr when the config keeps max-abs scaling
+    const ScaleSearch* resolve_scale_search(const QuantizationConfig& config, ScaleSearch& search) {
+        if (!config.search_scales) return nullptr;
+        search.importance = config.scale_search_importance;
+        search.pool = scratch_pool(&config);
+        return &search;
+    }
+
+    // Helper: Write a block's outlier slots
+    // Each outlier stores its residual against the dense payload, so the
+    // dense term plus the correction reproduces the weight to fp16 precision.
+    // Unused slots are marked OUTLIER_SLOT_EMPTY.
+    template <typename DequantFn>
+    QuantizationError store_block_outliers(
+        const float* block,
+        const uint32_t* idx,
+        size_t num_outliers,
+        OutlierEntry* slots,
+        uint32_t per_block,
+        DequantFn dequantize
+    ) {
+        for (size_t s = 0; s < per_block; ++s) {
+            if (s < num_outliers) {
+                float weight = block[idx[s]];
+                uint16_t residual = kernels::fp32_to_fp16(weight - dequantize(weight));
+                if (!std::isfinite(kernels::fp16_to_fp32(residual))) {
+                    return QuantizationError::ERROR_QUANTIZATION_FAILED;
+                }
+                slots[s].index = static_cast<uint16_t>(idx[s]);
+                slots[s].value = residual;
+            } else {
+                slots[s].index = OUTLIER_SLOT_EMPTY;
+                slots[s].value = 0;
+            }
+        }
+        return QuantizationError::SUCCESS;
+    }
+    
+    // Helper: Add outlier residuals onto dequantized weights
+    void apply_outliers(
+        float* output,
+        size_t count,
+        uint32_t block_size,
+        const OutlierEntry* outliers,
+        uint32_t per_block
+    ) {
+        size_t num_blocks = (count + block_size - 1) / block_size;
+        for (size_t block = 0; block < num_blocks; ++block) {
+            const OutlierEntry* slots = outliers + block * per_block;
+            float* block_out = output + block * block_size;
+            for (size_t s = 0; s < per_block && slots[s].index != OUTLIER_SLOT_EMPTY; ++s) {
+                block_out[slots[s].index] += kernels::fp16_to_fp32(slots[s].value);
+            }
+        }
+    }
+
+    // Helper: Resolve worker count for matrix quantization
+    static uint32_t resolve_num_threads(const QuantizationConfig& config, size_t M) {
+        uint32_t n = config.num_threads;
+        if (n == 0) n = config.hardware.max_concurrent_ops;
+        if (n == 0) n = 1;
+        return static_cast<uint32_t>(std::min<size_t>(n, M));
+    }
+    
+    // Helper: Run quantize_row(row) for every row in [0, M), split into
+    // contiguous row ranges across num_threads workers. Rows are independent,
+    // so the output matches the serial order exactly. Progress is counted in
+    // completed rows across all workers and reported under a lock so the
+    // callback is never invoked concurrently and never goes backwards.
+    template <typename RowFn>
+    QuantizationError quantize_rows_parallel(
+        size_t M,
+        uint32_t num_threads,
+        const ProgressCallback* progress_cb,
+        RowFn quantize_row
+    ) {
+        std::atomic<size_t> rows_done(0);
+        std::atomic<bool> failed(false);
+        QuantizationError first_error = QuantizationError::SUCCESS;
+        std::mutex report_mutex;
+        size_t rows_reported = 0;
+        
+        auto worker = [&](size_t row_begin, size_t row_end) {
+            for (size_t row = row_begin; row < row_end; ++row) {
+                if (failed.load(std::memory_order_relaxed)) return;
+                
+                QuantizationError err = quantize_row(row);
+                if (err != QuantizationError::SUCCESS) {
+                    std::lock_guard<std::mutex> lock(report_mutex);
+                    if (!failed.exchange(true)) first_error = err;
+                    return;
+                }
+                
+                size_t done = rows_done.fetch_add(1, std::memory_order_relaxed) + 1;
+                if (progress_cb && M > 10) {
+                    std::lock_guard<std::mutex> lock(report_mutex);
+                    if (done > rows_reported) {
+                        rows_reported = done;
+                        (*progress_cb)(static_cast<float>(done) / M);
+                    }
+                }
+            }
+        };
+        
+        if (num_threads <= 1) {
+            worker(0, M);
+        } else {
+            std::vector<std::thread> threads;
+            threads.reserve(num_threads - 1);
+            uint32_t started = 1;  // Ranges handed out, the caller's included
+            try {
+                for (; started < num_threads; ++started) {
+                    threads.emplace_back(worker, M * started / num_threads,
+                                         M * (started + 1) / num_threads);
+                }
+            } catch (const std::system_error&) {
+                // Out of threads: the caller runs the ranges no worker took
+            }
+            worker(0, M / num_threads);  // Calling thread takes the first range
+            worker(M * started / num_threads, M);
+            for (auto& th : threads) th.join();
+        }
+        
+        return first_error;
     }
 
     // ========== 1.28-bit Quantization (Ternary: {-1, 0, +1}) ==========
@@ -128,11 +639,12 @@ public:
         QuantizationMeta* metadata,
         uint32_t block_size,
         float threshold,
-        const ProgressCallback* progress_cb
+        const ProgressCallback* progress_cb,
+        const OutlierSink* outliers,
+        const ScaleSearch* search
     ) {
         // Validate inputs
-        size_t output_size = AfricaQuant::get_quantized_buffer_size(count, 1.28f);
-        QuantizationError err = validate_inputs_internal(weights, count, output, metadata, block_size, output_size);
+        QuantizationError err = validate_inputs_internal(weights, count, output, metadata, block_size);
         if (err != QuantizationError::SUCCESS) return err;
         
         if (threshold <= 0.0f) threshold = 0.33f; // Default threshold
@@ -148,6 +660,9 @@ public:
             return QuantizationError::ERROR_BUFFER_OVERFLOW;
         }
 
+        PooledBuffer<uint32_t> outlier_scratch;  // Reused across blocks
+        PooledBuffer<float> search_scratch;
+
         for (size_t block = 0; block < num_blocks; ++block) {
             // Progress callback
             if (progress_cb && num_blocks > 100) {
@@ -160,10 +675,10 @@ public:
             size_t block_count = end - start;
 
             // Compute scale for this block (max absolute value)
-            float max_abs = 0.0f;
-            for (size_t i = start; i < end; ++i) {
-                max_abs = std::max(max_abs, std::fabs(weights[i]));
-            }
+            float max_abs = block_abs_max(weights + start, block_count);
+
+            size_t num_outliers = fit_scale_to_block_body(weights + start, end - start, outliers,
+                                                          outlier_scratch, max_abs);
 
             float scale = max_abs > 0.0f ? max_abs : 1.0f;
             if (scale <= 0.0f || !std::isfinite(scale)) {
@@ -171,20 +686,50 @@ public:
             }
             float inv_scale = 1.0f / scale;
 
+            float block_threshold = threshold;
+            if (search) {
+                search_ternary_block(weights + start, end - start, *search, start,
+                                     outlier_scratch.data(), num_outliers, search_scratch,
+                                     inv_scale, block_threshold, scale);
+            }
+
             metadata[block].scale = scale;
             metadata[block].zero_point = 0.0f;
             metadata[block].block_size = block_size;
             metadata[block].codebook_size = 3; // {-1, 0, +1}
 
+            if (outliers) {
+                err = store_block_outliers(weights + start, outlier_scratch.data(), num_outliers,
+                                           outliers->slots + block * outliers->per_block,
+                                           outliers->per_block, [&](float w) {
+                    float v = w * inv_scale;
+                    return v > block_threshold ? scale : (v < -block_threshold ? -scale : 0.0f);
+                });
+                if (err != QuantizationError::SUCCESS) return err;
+            }
+
             // Quantize to ternary levels
-            for (size_t i = 0; i < block_count; ++i) {
+            size_t i = 0;
+#ifdef KIPEPEO_X86_ENABLED
+            if (bit_pos == 0 && use_x86_simd()) {
+                size_t n = block_count & ~static_cast<size_t>(3);
+                if (out_idx + n / 4 > max_output_size) {
+                    return QuantizationError::ERROR_BUFFER_OVERFLOW;
+                }
+                kernels::x86::quantize_ternary_2bit_avx2(weights + start, n, inv_scale, block_threshold,
+                                                         output + out_idx);
+                out_idx += n / 4;
+                i = n;
+            }
+#endif
+            for (; i < block_count; ++i) {
                 float normalized = weights[start + i] * inv_scale;
                 
                 // Quantize to {-1, 0, +1} using adaptive threshold
                 int8_t quantized;
-                if (normalized > threshold) {
+                if (normalized > block_threshold) {
                     quantized = 1;
-                } else if (normalized < -threshold) {
+                } else if (normalized < -block_threshold) {
                     quantized = -1;
                 } else {
                     quantized = 0;
@@ -234,7 +779,7 @@ public:
         uint32_t block_size
     ) {
         // Validate inputs
-        QuantizationError err = validate_inputs_internal(quantized, count, output, metadata, block_size, count * sizeof(float));
+        QuantizationError err = validate_inputs_internal(quantized, count, output, metadata, block_size);
         if (err != QuantizationError::SUCCESS) return err;
 
         size_t num_blocks = (count + block_size - 1) / block_size;
@@ -258,7 +803,25 @@ public:
                 return QuantizationError::ERROR_INVALID_SCALE;
             }
 
-            for (size_t i = 0; i < block_count; ++i) {
+            size_t i = 0;
+            if (bit_pos == 0 && block_count >= 4) {
+                // Whole bytes: bit_buffer holds quantized[in_idx - 1]
+                size_t n = block_count & ~static_cast<size_t>(3);
+                in_idx = in_idx - 1 + n / 4;
+                const uint8_t* packed = quantized + in_idx - n / 4;
+#ifdef KIPEPEO_X86_ENABLED
+                if (use_x86_simd()) {
+                    static const float levels[4] = {-1.0f, 0.0f, 1.0f, 1.0f};
+                    kernels::x86::dequantize_2bit_avx2(packed, n, levels, scale, output + start);
+                } else
+#endif
+                {
+                    dequantize_2bit_lut(packed, n, ternary_byte_table(), scale, output + start);
+                }
+                bit_buffer = in_idx < quantized_size ? quantized[in_idx++] : 0;
+                i = n;
+            }
+            for (; i < block_count; ++i) {
                 // Extract 2 bits
                 uint8_t packed = (bit_buffer >> bit_pos) & 0b11;
                 bit_pos += 2;
@@ -300,7 +863,7 @@ public:
         uint32_t block_size
     ) {
         // Validate inputs
-        QuantizationError err = validate_inputs_internal(quantized, count, output, metadata, block_size, count * sizeof(float));
+        QuantizationError err = validate_inputs_internal(quantized, count, output, metadata, block_size);
         if (err != QuantizationError::SUCCESS) return err;
         
         // Check alignment
@@ -405,17 +968,18 @@ public:
         QuantizationMeta* metadata,
         uint32_t block_size,
         float threshold,
-        const ProgressCallback* progress_cb
+        const ProgressCallback* progress_cb,
+        const OutlierSink* outliers,
+        const ScaleSearch* search
     ) {
         // Validate inputs
-        size_t output_size = AfricaQuant::get_quantized_buffer_size(count, 1.28f);
-        QuantizationError err = validate_inputs_internal(weights, count, output, metadata, block_size, output_size);
+        QuantizationError err = validate_inputs_internal(weights, count, output, metadata, block_size);
         if (err != QuantizationError::SUCCESS) return err;
         
         // Check alignment
         if (!is_neon_aligned(weights)) {
             // Fall back to scalar if not aligned
-            return quantize_1_28bit_scalar(weights, count, output, metadata, block_size, threshold, progress_cb);
+            return quantize_1_28bit_scalar(weights, count, output, metadata, block_size, threshold, progress_cb, outliers, search);
         }
         
         if (threshold <= 0.0f) threshold = 0.33f;
@@ -425,6 +989,9 @@ public:
         size_t out_idx = 0;
         size_t max_output_size = (count * 2 + 7) / 8;
 
+        PooledBuffer<uint32_t> outlier_scratch;  // Reused across blocks
+        PooledBuffer<float> search_scratch;
+
         for (size_t block = 0; block < num_blocks; ++block) {
             // Progress callback
             if (progress_cb && num_blocks > 100) {
@@ -464,21 +1031,41 @@ public:
                 max_abs = std::max(max_abs, std::fabs(weights[start + i]));
             }
 
+            size_t num_outliers = fit_scale_to_block_body(weights + start, end - start, outliers,
+                                                          outlier_scratch, max_abs);
+
             float scale = max_abs > 0.0f ? max_abs : 1.0f;
             if (scale <= 0.0f || !std::isfinite(scale)) {
                 return QuantizationError::ERROR_INVALID_SCALE;
             }
             float inv_scale = 1.0f / scale;
 
+            float block_threshold = threshold;
+            if (search) {
+                search_ternary_block(weights + start, end - start, *search, start,
+                                     outlier_scratch.data(), num_outliers, search_scratch,
+                                     inv_scale, block_threshold, scale);
+            }
+
             metadata[block].scale = scale;
             metadata[block].zero_point = 0.0f;
             metadata[block].block_size = block_size;
             metadata[block].codebook_size = 3;
 
+            if (outliers) {
+                err = store_block_outliers(weights + start, outlier_scratch.data(), num_outliers,
+                                           outliers->slots + block * outliers->per_block,
+                                           outliers->per_block, [&](float w) {
+                    float v = w * inv_scale;
+                    return v > block_threshold ? scale : (v < -block_threshold ? -scale : 0.0f);
+                });
+                if (err != QuantizationError::SUCCESS) return err;
+            }
+
             // Quantize using NEON with adaptive threshold
             float32x4_t inv_scale_vec = vdupq_n_f32(inv_scale);
-            float32x4_t threshold_pos = vdupq_n_f32(threshold);
-            float32x4_t threshold_neg = vdupq_n_f32(-threshold);
+            float32x4_t threshold_pos = vdupq_n_f32(block_threshold);
+            float32x4_t threshold_neg = vdupq_n_f32(-block_threshold);
 
             uint8_t bit_buffer = 0;
             int bit_pos = 0;
@@ -496,9 +1083,9 @@ public:
                 for (int j = 0; j < 4; ++j) {
                     float val = normalized[j];
                     int8_t quantized;
-                    if (val > threshold) {
+                    if (val > block_threshold) {
                         quantized = 1;
-                    } else if (val < -threshold) {
+                    } else if (val < -block_threshold) {
                         quantized = -1;
                     } else {
                         quantized = 0;
@@ -523,7 +1110,7 @@ public:
             // Handle remaining elements
             for (; i < block_count; ++i) {
                 float normalized = weights[start + i] * inv_scale;
-                int8_t quantized = (normalized > threshold) ? 1 : ((normalized < -threshold) ? -1 : 0);
+                int8_t quantized = (normalized > block_threshold) ? 1 : ((normalized < -block_threshold) ? -1 : 0);
                 uint8_t packed = (quantized == -1) ? 0b00 : ((quantized == 0) ? 0b01 : 0b10);
                 
                 if (out_idx >= max_output_size) {
@@ -558,6 +1145,154 @@ public:
     }
 #endif
 
+    // ========== 1.28-bit Base-3 Packing (5 ternary values per byte) ==========
+    
+    QuantizationError quantize_1_28bit_base3(
+        const float* weights,
+        size_t count,
+        uint8_t* output,
+        QuantizationMeta* metadata,
+        uint32_t block_size,
+        float threshold,
+        const ProgressCallback* progress_cb,
+        const OutlierSink* outliers,
+        const ScaleSearch* search
+    ) {
+        // Validate inputs
+        QuantizationError err = validate_inputs_internal(weights, count, output, metadata, block_size);
+        if (err != QuantizationError::SUCCESS) return err;
+        
+        if (threshold <= 0.0f) threshold = 0.33f; // Default threshold
+
+        size_t num_blocks = (count + block_size - 1) / block_size;
+        size_t out_idx = 0;
+        size_t max_output_size = kernels::neon::ternary_base3_packed_size(count, block_size);
+
+        PooledBuffer<uint32_t> outlier_scratch;  // Reused across blocks
+        PooledBuffer<float> search_scratch;
+
+        for (size_t block = 0; block < num_blocks; ++block) {
+            // Progress callback
+            if (progress_cb && num_blocks > 100) {
+                float progress = static_cast<float>(block) / num_blocks;
+                (*progress_cb)(progress);
+            }
+            
+            size_t start = block * block_size;
+            size_t end = std::min(start + block_size, count);
+
+            // Compute scale for this block (max absolute value)
+            float max_abs = block_abs_max(weights + start, end - start);
+
+            size_t num_outliers = fit_scale_to_block_body(weights + start, end - start, outliers,
+                                                          outlier_scratch, max_abs);
+
+            float scale = max_abs > 0.0f ? max_abs : 1.0f;
+            if (scale <= 0.0f || !std::isfinite(scale)) {
+                return QuantizationError::ERROR_INVALID_SCALE;
+            }
+            float inv_scale = 1.0f / scale;
+
+            float block_threshold = threshold;
+            if (search) {
+                search_ternary_block(weights + start, end - start, *search, start,
+                                     outlier_scratch.data(), num_outliers, search_scratch,
+                                     inv_scale, block_threshold, scale);
+            }
+
+            metadata[block].scale = scale;
+            metadata[block].zero_point = 0.0f;
+            metadata[block].block_size = block_size;
+            metadata[block].codebook_size = 3; // {-1, 0, +1}
+
+            if (outliers) {
+                err = store_block_outliers(weights + start, outlier_scratch.data(), num_outliers,
+                                           outliers->slots + block * outliers->per_block,
+                                           outliers->per_block, [&](float w) {
+                    float v = w * inv_scale;
+                    return v > block_threshold ? scale : (v < -block_threshold ? -scale : 0.0f);
+                });
+                if (err != QuantizationError::SUCCESS) return err;
+            }
+
+            // Pack 5 trits per byte: byte = t0 + 3*t1 + 9*t2 + 27*t3 + 81*t4,
+            // with t = quantized + 1. Blocks always start on a byte boundary.
+            for (size_t i = start; i < end; i += 5) {
+                size_t group_end = std::min(i + 5, end);
+                uint8_t packed = 0;
+                uint8_t weight = 1;
+                for (size_t j = i; j < group_end; ++j) {
+                    float normalized = weights[j] * inv_scale;
+                    uint8_t trit;
+                    if (normalized > block_threshold) {
+                        trit = 2;       // +1
+                    } else if (normalized < -block_threshold) {
+                        trit = 0;       // -1
+                    } else {
+                        trit = 1;       //  0
+                    }
+                    packed += trit * weight;
+                    weight *= 3;
+                }
+                // Short groups are padded with zeros (trit = 1)
+                for (size_t j = group_end; j < i + 5; ++j) {
+                    packed += weight;
+                    weight *= 3;
+                }
+
+                if (out_idx >= max_output_size) {
+                    return QuantizationError::ERROR_BUFFER_OVERFLOW;
+                }
+                output[out_idx++] = packed;
+            }
+        }
+        
+        if (progress_cb) {
+            (*progress_cb)(1.0f);
+        }
+
+        return QuantizationError::SUCCESS;
+    }
+
+    QuantizationError dequantize_1_28bit_base3(
+        const uint8_t* quantized,
+        size_t count,
+        float* output,
+        const QuantizationMeta* metadata,
+        uint32_t block_size
+    ) {
+        // Validate inputs
+        QuantizationError err = validate_inputs_internal(quantized, count, output, metadata, block_size);
+        if (err != QuantizationError::SUCCESS) return err;
+
+        size_t num_blocks = (count + block_size - 1) / block_size;
+        size_t in_idx = 0;
+
+        for (size_t block = 0; block < num_blocks; ++block) {
+            size_t start = block * block_size;
+            size_t end = std::min(start + block_size, count);
+
+            float scale = metadata[block].scale;
+            if (scale <= 0.0f || !std::isfinite(scale)) {
+                return QuantizationError::ERROR_INVALID_SCALE;
+            }
+
+            for (size_t i = start; i < end; i += 5) {
+                uint8_t packed = quantized[in_idx++];
+                if (packed >= 243) {
+                    return QuantizationError::ERROR_INVALID_QUANTIZED_DATA;
+                }
+                const int8_t* trits = kernels::neon::ternary_base3_lookup(packed);
+                size_t n = std::min<size_t>(5, end - i);
+                for (size_t j = 0; j < n; ++j) {
+                    output[i + j] = trits[j] * scale;
+                }
+            }
+        }
+
+        return QuantizationError::SUCCESS;
+    }
+
     // ========== 1.58-bit Quantization (Quaternary: {-1.5, -0.5, +0.5, +1.5}) ==========
     
     QuantizationError quantize_1_58bit_scalar(
@@ -566,11 +1301,12 @@ public:
         uint8_t* output,
         QuantizationMeta* metadata,
         uint32_t block_size,
-        const ProgressCallback* progress_cb
+        const ProgressCallback* progress_cb,
+        const OutlierSink* outliers,
+        const ScaleSearch* search
     ) {
         // Validate inputs
-        size_t output_size = AfricaQuant::get_quantized_buffer_size(count, 1.58f);
-        QuantizationError err = validate_inputs_internal(weights, count, output, metadata, block_size, output_size);
+        QuantizationError err = validate_inputs_internal(weights, count, output, metadata, block_size);
         if (err != QuantizationError::SUCCESS) return err;
 
         size_t num_blocks = (count + block_size - 1) / block_size;
@@ -583,6 +1319,9 @@ public:
             return QuantizationError::ERROR_BUFFER_OVERFLOW;
         }
 
+        PooledBuffer<uint32_t> outlier_scratch;  // Reused across blocks
+        PooledBuffer<float> search_scratch;
+
         for (size_t block = 0; block < num_blocks; ++block) {
             // Progress callback
             if (progress_cb && num_blocks > 100) {
@@ -595,10 +1334,10 @@ public:
             size_t block_count = end - start;
 
             // Compute scale
-            float max_abs = 0.0f;
-            for (size_t i = start; i < end; ++i) {
-                max_abs = std::max(max_abs, std::fabs(weights[i]));
-            }
+            float max_abs = block_abs_max(weights + start, block_count);
+
+            size_t num_outliers = fit_scale_to_block_body(weights + start, end - start, outliers,
+                                                          outlier_scratch, max_abs);
 
             float scale = max_abs > 0.0f ? (max_abs / 1.5f) : 1.0f;
             if (scale <= 0.0f || !std::isfinite(scale)) {
@@ -606,13 +1345,43 @@ public:
             }
             float inv_scale = 1.0f / scale;
 
+            if (search) {
+                search_quaternary_block(weights + start, end - start, *search, start,
+                                        outlier_scratch.data(), num_outliers, search_scratch,
+                                        inv_scale, scale);
+            }
+
             metadata[block].scale = scale;
             metadata[block].zero_point = 0.0f;
             metadata[block].block_size = block_size;
             metadata[block].codebook_size = 4; // {-1.5, -0.5, +0.5, +1.5}
 
+            if (outliers) {
+                err = store_block_outliers(weights + start, outlier_scratch.data(), num_outliers,
+                                           outliers->slots + block * outliers->per_block,
+                                           outliers->per_block, [&](float w) {
+                    float v = w * inv_scale;
+                    float level = v > 1.0f ? 1.5f : (v > 0.0f ? 0.5f : (v > -1.0f ? -0.5f : -1.5f));
+                    return level * scale;
+                });
+                if (err != QuantizationError::SUCCESS) return err;
+            }
+
             // Quantize to quaternary levels
-            for (size_t i = 0; i < block_count; ++i) {
+            size_t i = 0;
+#ifdef KIPEPEO_X86_ENABLED
+            if (bit_pos == 0 && use_x86_simd()) {
+                size_t n = block_count & ~static_cast<size_t>(3);
+                if (out_idx + n / 4 > max_output_size) {
+                    return QuantizationError::ERROR_BUFFER_OVERFLOW;
+                }
+                kernels::x86::quantize_quaternary_2bit_avx2(weights + start, n, inv_scale,
+                                                            output + out_idx);
+                out_idx += n / 4;
+                i = n;
+            }
+#endif
+            for (; i < block_count; ++i) {
                 float normalized = weights[start + i] * inv_scale;
                 
                 // Quantize to {-1.5, -0.5, +0.5, +1.5}
@@ -670,7 +1439,7 @@ public:
         uint32_t block_size
     ) {
         // Validate inputs
-        QuantizationError err = validate_inputs_internal(quantized, count, output, metadata, block_size, count * sizeof(float));
+        QuantizationError err = validate_inputs_internal(quantized, count, output, metadata, block_size);
         if (err != QuantizationError::SUCCESS) return err;
 
         // Dequantization levels
@@ -697,7 +1466,24 @@ public:
                 return QuantizationError::ERROR_INVALID_SCALE;
             }
 
-            for (size_t i = 0; i < block_count; ++i) {
+            size_t i = 0;
+            if (bit_pos == 0 && block_count >= 4) {
+                // Whole bytes: bit_buffer holds quantized[in_idx - 1]
+                size_t n = block_count & ~static_cast<size_t>(3);
+                in_idx = in_idx - 1 + n / 4;
+                const uint8_t* packed = quantized + in_idx - n / 4;
+#ifdef KIPEPEO_X86_ENABLED
+                if (use_x86_simd()) {
+                    kernels::x86::dequantize_2bit_avx2(packed, n, levels, scale, output + start);
+                } else
+#endif
+                {
+                    dequantize_2bit_lut(packed, n, quaternary_byte_table(), scale, output + start);
+                }
+                bit_buffer = in_idx < quantized_size ? quantized[in_idx++] : 0;
+                i = n;
+            }
+            for (; i < block_count; ++i) {
                 uint8_t packed = (bit_buffer >> bit_pos) & 0b11;
                 bit_pos += 2;
 
@@ -732,7 +1518,7 @@ public:
         uint32_t block_size
     ) {
         // Validate inputs
-        QuantizationError err = validate_inputs_internal(quantized, count, output, metadata, block_size, count * sizeof(float));
+        QuantizationError err = validate_inputs_internal(quantized, count, output, metadata, block_size);
         if (err != QuantizationError::SUCCESS) return err;
         
         // Check alignment
@@ -846,7 +1632,8 @@ QuantizationError AfricaQuant::quantize_1_28bit(
     uint8_t* output,
     QuantizationMeta* metadata,
     uint32_t block_size,
-    const QuantizationConfig* config
+    const QuantizationConfig* config,
+    OutlierEntry* outliers
 ) {
     std::lock_guard<std::mutex> lock(impl_->mutex_);
     
@@ -876,12 +1663,24 @@ QuantizationError AfricaQuant::quantize_1_28bit(
     
     const ProgressCallback* progress_cb = effective_config.progress_callback ? &effective_config.progress_callback : nullptr;
     
+    Impl::OutlierSink sink;
+    QuantizationError err;
+    const Impl::OutlierSink* outlier_sink = impl_->resolve_outlier_sink(effective_config, outliers, block_size, sink, err);
+    if (err != QuantizationError::SUCCESS) return err;
+    
+    Impl::ScaleSearch search;
+    const Impl::ScaleSearch* scale_search = impl_->resolve_scale_search(effective_config, search);
+    
+    if (effective_config.ternary_packing == TernaryPacking::BASE3) {
+        return impl_->quantize_1_28bit_base3(weights, count, output, metadata, block_size, threshold, progress_cb, outlier_sink, scale_search);
+    }
+    
 #ifdef KIPEPEO_NEON_ENABLED
     if (impl_->neon_enabled_) {
-        return impl_->quantize_1_28bit_neon(weights, count, output, metadata, block_size, threshold, progress_cb);
+        return impl_->quantize_1_28bit_neon(weights, count, output, metadata, block_size, threshold, progress_cb, outlier_sink, scale_search);
     }
 #endif
-    return impl_->quantize_1_28bit_scalar(weights, count, output, metadata, block_size, threshold, progress_cb);
+    return impl_->quantize_1_28bit_scalar(weights, count, output, metadata, block_size, threshold, progress_cb, outlier_sink, scale_search);
 }
 
 bool AfricaQuant::quantize_1_28bit_legacy(
@@ -900,10 +1699,11 @@ QuantizationError AfricaQuant::dequantize_1_28bit(
     size_t count,
     float* output,
     const QuantizationMeta* metadata,
-    uint32_t block_size
+    uint32_t block_size,
+    TernaryPacking packing,
+    const OutlierEntry* outliers,
+    uint32_t outliers_per_block
 ) {
-    std::lock_guard<std::mutex> lock(impl_->mutex_);
-    
     // Auto-detect block size from metadata if needed
     if (block_size == 0 && metadata) {
         block_size = metadata[0].block_size;
@@ -912,12 +1712,29 @@ QuantizationError AfricaQuant::dequantize_1_28bit(
         block_size = 128; // Default
     }
     
+    bool has_outliers = outliers && outliers_per_block > 0;
+    QuantizationError err = QuantizationError::SUCCESS;
+    if (has_outliers) {
+        err = validate_outliers(outliers, 1, count, block_size, outliers_per_block);
+        if (err != QuantizationError::SUCCESS) return err;
+    }
+    
+    if (packing == TernaryPacking::BASE3) {
+        err = impl_->dequantize_1_28bit_base3(quantized, count, output, metadata, block_size);
+    }
 #ifdef KIPEPEO_NEON_ENABLED
-    if (impl_->neon_enabled_) {
-        return impl_->dequantize_1_28bit_neon(quantized, count, output, metadata, block_size);
+    else if (impl_->neon_enabled_) {
+        err = impl_->dequantize_1_28bit_neon(quantized, count, output, metadata, block_size);
     }
 #endif
-    return impl_->dequantize_1_28bit_scalar(quantized, count, output, metadata, block_size);
+    else {
+        err = impl_->dequantize_1_28bit_scalar(quantized, count, output, metadata, block_size);
+    }
+    
+    if (err == QuantizationError::SUCCESS && has_outliers) {
+        impl_->apply_outliers(output, count, block_size, outliers, outliers_per_block);
+    }
+    return err;
 }
 
 bool AfricaQuant::dequantize_1_28bit_legacy(
@@ -937,7 +1754,8 @@ QuantizationError AfricaQuant::quantize_1_58bit(
     uint8_t* output,
     QuantizationMeta* metadata,
     uint32_t block_size,
-    const QuantizationConfig* config
+    const QuantizationConfig* config,
+    OutlierEntry* outliers
 ) {
     std::lock_guard<std::mutex> lock(impl_->mutex_);
     
@@ -959,7 +1777,15 @@ QuantizationError AfricaQuant::quantize_1_58bit(
     
     const ProgressCallback* progress_cb = effective_config.progress_callback ? &effective_config.progress_callback : nullptr;
     
-    return impl_->quantize_1_58bit_scalar(weights, count, output, metadata, block_size, progress_cb);
+    Impl::OutlierSink sink;
+    QuantizationError err;
+    const Impl::OutlierSink* outlier_sink = impl_->resolve_outlier_sink(effective_config, outliers, block_size, sink, err);
+    if (err != QuantizationError::SUCCESS) return err;
+    
+    Impl::ScaleSearch search;
+    const Impl::ScaleSearch* scale_search = impl_->resolve_scale_search(effective_config, search);
+    
+    return impl_->quantize_1_58bit_scalar(weights, count, output, metadata, block_size, progress_cb, outlier_sink, scale_search);
 }
 
 bool AfricaQuant::quantize_1_58bit_legacy(
@@ -978,10 +1804,10 @@ QuantizationError AfricaQuant::dequantize_1_58bit(
     size_t count,
     float* output,
     const QuantizationMeta* metadata,
-    uint32_t block_size
+    uint32_t block_size,
+    const OutlierEntry* outliers,
+    uint32_t outliers_per_block
 ) {
-    std::lock_guard<std::mutex> lock(impl_->mutex_);
-    
     // Auto-detect block size from metadata if needed
     if (block_size == 0 && metadata) {
         block_size = metadata[0].block_size;
@@ -990,12 +1816,27 @@ QuantizationError AfricaQuant::dequantize_1_58bit(
         block_size = 128; // Default
     }
     
+    bool has_outliers = outliers && outliers_per_block > 0;
+    QuantizationError err = QuantizationError::SUCCESS;
+    if (has_outliers) {
+        err = validate_outliers(outliers, 1, count, block_size, outliers_per_block);
+        if (err != QuantizationError::SUCCESS) return err;
+    }
+    
 #ifdef KIPEPEO_NEON_ENABLED
     if (impl_->neon_enabled_) {
-        return impl_->dequantize_1_58bit_neon(quantized, count, output, metadata, block_size);
+        err = impl_->dequantize_1_58bit_neon(quantized, count, output, metadata, block_size);
+    } else {
+        err = impl_->dequantize_1_58bit_scalar(quantized, count, output, metadata, block_size);
     }
+#else
+    err = impl_->dequantize_1_58bit_scalar(quantized, count, output, metadata, block_size);
 #endif
-    return impl_->dequantize_1_58bit_scalar(quantized, count, output, metadata, block_size);
+    
+    if (err == QuantizationError::SUCCESS && has_outliers) {
+        impl_->apply_outliers(output, count, block_size, outliers, outliers_per_block);
+    }
+    return err;
 }
 
 bool AfricaQuant::dequantize_1_58bit_legacy(
@@ -1014,10 +1855,21 @@ size_t AfricaQuant::get_quantized_buffer_size(size_t count, float bits_per_weigh
     return static_cast<size_t>(std::ceil(count * bits_per_weight / 8.0f)) + 16; // +16 for safety margin
 }
 
+size_t AfricaQuant::get_ternary_buffer_size(size_t count, uint32_t block_size, TernaryPacking packing) {
+    if (packing == TernaryPacking::BASE3) {
+        return kernels::neon::ternary_base3_packed_size(count, block_size);
+    }
+    return (count * 2 + 7) / 8; // 2 bits per value
+}
+
 size_t AfricaQuant::get_metadata_count(size_t count, uint32_t block_size) {
     return (count + block_size - 1) / block_size;
 }
 
+size_t AfricaQuant::get_outlier_slot_count(size_t count, uint32_t block_size, uint32_t max_outliers_per_block) {
+    return get_metadata_count(count, block_size) * max_outliers_per_block;
+}
+
 bool AfricaQuant::has_neon_support() const {
     return impl_->neon_enabled_;
 }
@@ -1031,6 +1883,18 @@ void AfricaQuant::set_neon_enabled(bool enabled) {
 #endif
 }
 
+void AfricaQuant::set_memory_pooling_enabled(bool enabled) {
+    impl_->pooling_enabled_ = enabled;
+}
+
+MemoryPoolStats AfricaQuant::get_memory_pool_stats() const {
+    return impl_->memory_pool_.get_stats();
+}
+
+void AfricaQuant::trim_memory_pool() {
+    impl_->memory_pool_.trim();
+}
+
 const HardwareCapabilities& AfricaQuant::get_hardware_capabilities() const {
     return impl_->hardware_caps_;
 }
@@ -1068,6 +1932,35 @@ QuantizationError AfricaQuant::validate_inputs(
     return QuantizationError::SUCCESS;
 }
 
+QuantizationError AfricaQuant::validate_outliers(
+    const OutlierEntry* outliers,
+    size_t M,
+    size_t K,
+    uint32_t block_size,
+    uint32_t outliers_per_block
+) {
+    if (outliers_per_block == 0) return QuantizationError::SUCCESS;
+    if (!outliers) return QuantizationError::ERROR_NULL_POINTER;
+    if (block_size == 0) return QuantizationError::ERROR_INVALID_BLOCK_SIZE;
+    
+    size_t num_blocks_per_row = (K + block_size - 1) / block_size;
+    for (size_t row = 0; row < M; ++row) {
+        for (size_t block = 0; block < num_blocks_per_row; ++block) {
+            size_t block_len = std::min<size_t>(block_size, K - block * block_size);
+            const OutlierEntry* slots = outliers + (row * num_blocks_per_row + block) * outliers_per_block;
+            for (size_t s = 0; s < outliers_per_block; ++s) {
+                if (slots[s].index == OUTLIER_SLOT_EMPTY) break;
+                // Index must fall inside the block; fp16 inf/NaN (exponent all ones) is rejected
+                if (slots[s].index >= block_len || (slots[s].value & 0x7C00u) == 0x7C00u) {
+                    return QuantizationError::ERROR_INVALID_QUANTIZED_DATA;
+                }
+            }
+        }
+    }
+    
+    return QuantizationError::SUCCESS;
+}
+
 // Matrix quantization helpers
 QuantizationError AfricaQuant::quantize_matrix_1_28bit(
     const float* weights,
@@ -1076,7 +1969,8 @@ QuantizationError AfricaQuant::quantize_matrix_1_28bit(
     uint8_t* output,
     QuantizationMeta* metadata,
     uint32_t block_size,
-    const QuantizationConfig* config
+    const QuantizationConfig* config,
+    OutlierEntry* outliers
 ) {
     std::lock_guard<std::mutex> lock(impl_->mutex_);
     
@@ -1105,7 +1999,8 @@ QuantizationError AfricaQuant::quantize_matrix_1_28bit(
     }
     
     size_t num_blocks_per_row = (K + block_size - 1) / block_size;
-    size_t quantized_bytes_per_row = (K * 2 + 7) / 8; // 2 bits per value
+    TernaryPacking packing = effective_config.ternary_packing;
+    size_t quantized_bytes_per_row = get_ternary_buffer_size(K, block_size, packing);
     
     // Get adaptive threshold
     float threshold = effective_config.threshold_1_28;
@@ -1117,35 +2012,41 @@ QuantizationError AfricaQuant::quantize_matrix_1_28bit(
     
     const ProgressCallback* progress_cb = effective_config.progress_callback ? &effective_config.progress_callback : nullptr;
     
-    // Quantize each row separately
-    for (size_t row = 0; row < M; ++row) {
+    Impl::OutlierSink sink;
+    QuantizationError err;
+    const Impl::OutlierSink* outlier_sink = impl_->resolve_outlier_sink(effective_config, outliers, block_size, sink, err);
+    if (err != QuantizationError::SUCCESS) return err;
+    
+    Impl::ScaleSearch search;
+    const Impl::ScaleSearch* scale_search = impl_->resolve_scale_search(effective_config, search);
+    
+    uint32_t num_threads = impl_->resolve_num_threads(effective_config, M);
+    
+    // Quantize rows in parallel; per-row progress is aggregated by the helper
+    return impl_->quantize_rows_parallel(M, num_threads, progress_cb, [&](size_t row) {
         const float* row_weights = weights + row * K;
         uint8_t* row_output = output + row * quantized_bytes_per_row;
         QuantizationMeta* row_metadata = metadata + row * num_blocks_per_row;
         
-        QuantizationError err;
-#ifdef KIPEPEO_NEON_ENABLED
-        if (impl_->neon_enabled_) {
-            err = impl_->quantize_1_28bit_neon(row_weights, K, row_output, row_metadata, block_size, threshold, progress_cb);
-        } else {
-            err = impl_->quantize_1_28bit_scalar(row_weights, K, row_output, row_metadata, block_size, threshold, progress_cb);
+        // Outlier slots are laid out like the metadata
+        Impl::OutlierSink row_sink;
+        const Impl::OutlierSink* row_outliers = nullptr;
+        if (outlier_sink) {
+            row_sink = *outlier_sink;
+            row_sink.slots += row * num_blocks_per_row * row_sink.per_block;
+            row_outliers = &row_sink;
         }
-#else
-        err = impl_->quantize_1_28bit_scalar(row_weights, K, row_output, row_metadata, block_size, threshold, progress_cb);
-#endif
         
-        if (err != QuantizationError::SUCCESS) {
-            return err;
+        if (packing == TernaryPacking::BASE3) {
+            return impl_->quantize_1_28bit_base3(row_weights, K, row_output, row_metadata, block_size, threshold, nullptr, row_outliers, scale_search);
         }
-        
-        // Update progress
-        if (progress_cb && M > 10) {
-            float progress = static_cast<float>(row + 1) / M;
-            (*progress_cb)(progress);
+#ifdef KIPEPEO_NEON_ENABLED
+        if (impl_->neon_enabled_) {
+            return impl_->quantize_1_28bit_neon(row_weights, K, row_output, row_metadata, block_size, threshold, nullptr, row_outliers, scale_search);
         }
-    }
-    
-    return QuantizationError::SUCCESS;
+#endif
+        return impl_->quantize_1_28bit_scalar(row_weights, K, row_output, row_metadata, block_size, threshold, nullptr, row_outliers, scale_search);
+    });
 }
 
 QuantizationError AfricaQuant::quantize_matrix_1_58bit(
@@ -1155,7 +2056,8 @@ QuantizationError AfricaQuant::quantize_matrix_1_58bit(
     uint8_t* output,
     QuantizationMeta* metadata,
     uint32_t block_size,
-    const QuantizationConfig* config
+    const QuantizationConfig* config,
+    OutlierEntry* outliers
 ) {
     std::lock_guard<std::mutex> lock(impl_->mutex_);
     
@@ -1188,26 +2090,33 @@ QuantizationError AfricaQuant::quantize_matrix_1_58bit(
     
     const ProgressCallback* progress_cb = effective_config.progress_callback ? &effective_config.progress_callback : nullptr;
     
-    // Quantize each row separately
-    for (size_t row = 0; row < M; ++row) {
+    Impl::OutlierSink sink;
+    QuantizationError err;
+    const Impl::OutlierSink* outlier_sink = impl_->resolve_outlier_sink(effective_config, outliers, block_size, sink, err);
+    if (err != QuantizationError::SUCCESS) return err;
+    
+    Impl::ScaleSearch search;
+    const Impl::ScaleSearch* scale_search = impl_->resolve_scale_search(effective_config, search);
+    
+    uint32_t num_threads = impl_->resolve_num_threads(effective_config, M);
+    
+    // Quantize rows in parallel; per-row progress is aggregated by the helper
+    return impl_->quantize_rows_parallel(M, num_threads, progress_cb, [&](size_t row) {
         const float* row_weights = weights + row * K;
         uint8_t* row_output = output + row * quantized_bytes_per_row;
         QuantizationMeta* row_metadata = metadata + row * num_blocks_per_row;
         
-        QuantizationError err = impl_->quantize_1_58bit_scalar(row_weights, K, row_output, row_metadata, block_size, progress_cb);
-        
-        if (err != QuantizationError::SUCCESS) {
-            return err;
+        // Outlier slots are laid out like the metadata
+        Impl::OutlierSink row_sink;
+        const Impl::OutlierSink* row_outliers = nullptr;
+        if (outlier_sink) {
+            row_sink = *outlier_sink;
+            row_sink.slots += row * num_blocks_per_row * row_sink.per_block;
+            row_outliers = &row_sink;
         }
         
-        // Update progress
-        if (progress_cb && M > 10) {
-            float progress = static_cast<float>(row + 1) / M;
-            (*progress_cb)(progress);
-        }
-    }
-    
-    return QuantizationError::SUCCESS;
+        return impl_->quantize_1_58bit_scalar(row_weights, K, row_output, row_metadata, block_size, nullptr, row_outliers, scale_search);
+    });
 }
 
 // Legacy API (delegates to 1.58-bit)
@@ -1217,9 +2126,11 @@ bool AfricaQuant::quantize(const float* weights, size_t count, uint8_t* output)
     if (block_size == 0) block_size = 128;
     
     size_t num_blocks = get_metadata_count(count, block_size);
-    QuantizationMeta* metadata = new QuantizationMeta[num_blocks];
-    QuantizationError err = quantize_1_58bit(weights, count, output, metadata, block_size, nullptr);
-    delete[] metadata;
+    PooledBuffer<QuantizationMeta> metadata;
+    if (!metadata.allocate(impl_->scratch_pool(), num_blocks)) {
+        return false;
+    }
+    QuantizationError err = quantize_1_58bit(weights, count, output, metadata.data(), block_size, nullptr);
     return err == QuantizationError::SUCCESS;
 }
 
@@ -1236,10 +2147,11 @@ QuantizationError AfricaQuant::matvec_mul_1_28bit(
     const float* X,
     float* Y,
     size_t M,
-    size_t K
+    size_t K,
+    TernaryPacking packing,
+    const OutlierEntry* outliers,
+    uint32_t outliers_per_block
 ) {
-    std::lock_guard<std::mutex> lock(impl_->mutex_);
-    
     // Validate inputs
     if (!quantized_A || !metadata_A || !X || !Y) {
         return QuantizationError::ERROR_NULL_POINTER;
@@ -1260,7 +2172,7 @@ QuantizationError AfricaQuant::matvec_mul_1_28bit(
     // Extract scales from metadata
     // Metadata is organized as: metadata_A[row * num_blocks_per_row + block_idx]
     // Each metadata entry contains the scale for that specific row and block
-    std::vector<float> scales(M * num_blocks_per_row);
+    float* scales = thread_scratch_floats(M * num_blocks_per_row);
     for (size_t row = 0; row < M; ++row) {
         for (size_t block = 0; block < num_blocks_per_row; ++block) {
             size_t metadata_idx = row * num_blocks_per_row + block;
@@ -1274,9 +2186,31 @@ QuantizationError AfricaQuant::matvec_mul_1_28bit(
         }
     }
     
-    // Calculate quantized data offset per row
-    // Each row's quantized data starts at: row * ((K * 2 + 7) / 8)
-    size_t quantized_bytes_per_row = (K * 2 + 7) / 8; // 2 bits per value
+    // Outlier slots are laid out like the metadata
+    if (!outliers) {
+        outliers_per_block = 0;
+    } else if (outliers_per_block > 0) {
+        QuantizationError err = validate_outliers(outliers, M, K, block_size, outliers_per_block);
+        if (err != QuantizationError::SUCCESS) return err;
+    }
+    
+    // Each row's quantized data starts at:
+    // row * get_ternary_buffer_size(K, block_size, packing)
+    if (packing == TernaryPacking::BASE3) {
+        kernels::neon::gemv_ternary_1_28bit_base3(
+            M, K,
+            1.0f,  // alpha
+            quantized_A,  // Row-major, byte-aligned blocks
+            scales,
+            X,
+            0.0f,  // beta (overwrite Y)
+            Y,
+            block_size,
+            outliers,  // Sparse residuals, applied in the same pass
+            outliers_per_block
+        );
+        return QuantizationError::SUCCESS;
+    }
     
     // Use optimized kernel from kernels module
     // The kernel expects quantized_A to be organized row-major
@@ -1284,11 +2218,13 @@ QuantizationError AfricaQuant::matvec_mul_1_28bit(
         M, K,
         1.0f,  // alpha
         quantized_A,  // Row-major quantized matrix
-        scales.data(),  // Scales organized as scales[row * num_blocks_per_row + block]
+        scales,  // Scales organized as scales[row * num_blocks_per_row + block]
         X,
         0.0f,  // beta (overwrite Y)
         Y,
-        block_size
+        block_size,
+        outliers,  // Sparse residuals, applied in the same pass
+        outliers_per_block
     );
     
     return QuantizationError::SUCCESS;
@@ -1300,10 +2236,10 @@ QuantizationError AfricaQuant::matvec_mul_1_58bit(
     const float* X,
     float* Y,
     size_t M,
-    size_t K
+    size_t K,
+    const OutlierEntry* outliers,
+    uint32_t outliers_per_block
 ) {
-    std::lock_guard<std::mutex> lock(impl_->mutex_);
-    
     // Validate inputs
     if (!quantized_A || !metadata_A || !X || !Y) {
         return QuantizationError::ERROR_NULL_POINTER;
@@ -1324,7 +2260,7 @@ QuantizationError AfricaQuant::matvec_mul_1_58bit(
     // Extract scales from metadata
     // Metadata is organized as: metadata_A[row * num_blocks_per_row + block_idx]
     // Each metadata entry contains the scale for that specific row and block
-    std::vector<float> scales(M * num_blocks_per_row);
+    float* scales = thread_scratch_floats(M * num_blocks_per_row);
     for (size_t row = 0; row < M; ++row) {
         for (size_t block = 0; block < num_blocks_per_row; ++block) {
             size_t metadata_idx = row * num_blocks_per_row + block;
@@ -1338,6 +2274,14 @@ QuantizationError AfricaQuant::matvec_mul_1_58bit(
         }
     }
     
+    // Outlier slots are laid out like the metadata
+    if (!outliers) {
+        outliers_per_block = 0;
+    } else if (outliers_per_block > 0) {
+        QuantizationError err = validate_outliers(outliers, M, K, block_size, outliers_per_block);
+        if (err != QuantizationError::SUCCESS) return err;
+    }
+    
     // Calculate quantized data offset per row
     // Each row's quantized data starts at: row * ((K * 2 + 7) / 8)
     size_t quantized_bytes_per_row = (K * 2 + 7) / 8; // 2 bits per value
@@ -1348,11 +2292,13 @@ QuantizationError AfricaQuant::matvec_mul_1_58bit(
         M, K,
         1.0f,  // alpha
         quantized_A,  // Row-major quantized matrix
-        scales.data(),  // Scales organized as scales[row * num_blocks_per_row + block]
+        scales,  // Scales organized as scales[row * num_blocks_per_row + block]
         X,
         0.0f,  // beta (overwrite Y)
         Y,
-        block_size
+        block_size,
+        outliers,  // Sparse residuals, applied in the same pass
+        outliers_per_block
     );
     
     return QuantizationError::SUCCESS;
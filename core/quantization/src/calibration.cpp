@@ -0,0 +1,417 @@
+#include "kipepeo/quantization/calibration.h"
+#include "kipepeo/kernels/fp16.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+namespace kipepeo {
+namespace quantization {
+
+namespace {
+
+constexpr size_t Q4_0_BLOCK = 32;
+constexpr int PLAN_FILE_VERSION = 1;
+
+const char* metric_name(ErrorMetric metric) {
+    return metric == ErrorMetric::COSINE ? "cosine" : "mse";
+}
+
+const char* packing_name(TernaryPacking packing) {
+    return packing == TernaryPacking::BASE3 ? "base3" : "2bit";
+}
+
+bool parse_format(const char* name, PlanFormat& format) {
+    for (size_t i = 0; i < PLAN_FORMAT_COUNT; ++i) {
+        if (strcmp(name, get_plan_format_name(static_cast<PlanFormat>(i))) == 0) {
+            format = static_cast<PlanFormat>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool valid_name(const std::string& name) {
+    if (name.empty() || name.size() > 255) return false;
+    for (char c : name) {
+        if (c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '#') return false;
+    }
+    return true;
+}
+
+// llama.cpp Q4_0 round trip: per 32 values d = (value of largest
+// magnitude) / -8 stored as fp16, q = clamp(x / d + 8.5, 0, 15)
+void q4_0_round_trip(const float* x, size_t n, float* out) {
+    for (size_t start = 0; start < n; start += Q4_0_BLOCK) {
+        size_t end = std::min(start + Q4_0_BLOCK, n);
+        float amax = 0.0f;
+        float max = 0.0f;
+        for (size_t i = start; i < end; ++i) {
+            if (std::fabs(x[i]) > amax) {
+                amax = std::fabs(x[i]);
+                max = x[i];
+            }
+        }
+        float d = kernels::fp16_to_fp32(kernels::fp32_to_fp16(max / -8.0f));
+        float id = d != 0.0f ? 1.0f / d : 0.0f;
+        for (size_t i = start; i < end; ++i) {
+            int q = static_cast<int>(x[i] * id + 8.5f);
+            q = std::min(15, std::max(0, q));
+            out[i] = static_cast<float>(q - 8) * d;
+        }
+    }
+}
+
+void f16_round_trip(const float* x, size_t n, float* out) {
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = kernels::fp16_to_fp32(kernels::fp32_to_fp16(x[i]));
+    }
+}
+
+} // anonymous namespace
+
+// ========== Error Measures ==========
+
+ReconstructionError measure_reconstruction_error(const float* reference, const float* reconstructed, size_t count) {
+    double err = 0.0, ref = 0.0, rec = 0.0, dot = 0.0;
+    for (size_t i = 0; i < count; ++i) {
+        double a = reference[i];
+        double b = reconstructed[i];
+        err += (a - b) * (a - b);
+        ref += a * a;
+        rec += b * b;
+        dot += a * b;
+    }
+
+    ReconstructionError result;
+    if (ref == 0.0) {
+        // All-zero tensor: exact iff the reconstruction is zero too
+        result.relative_mse = rec == 0.0 ? 0.0f : 1.0f;
+        result.cosine = rec == 0.0 ? 0.0f : 1.0f;
+        return result;
+    }
+    result.relative_mse = static_cast<float>(err / ref);
+    result.cosine = rec == 0.0 ? 1.0f : static_cast<float>(1.0 - dot / std::sqrt(ref * rec));
+    return result;
+}
+
+const char* get_plan_format_name(PlanFormat format) {
+    switch (format) {
+        case PlanFormat::TERNARY_1_28: return "q1_28";
+        case PlanFormat::QUATERNARY_1_58: return "q1_58";
+        case PlanFormat::Q4_0: return "q4_0";
+        case PlanFormat::F16:
+        default: return "f16";
+    }
+}
+
+float get_plan_bits_per_weight(PlanFormat format, size_t K, uint32_t block_size,
+                               TernaryPacking packing, uint32_t outliers_per_block) {
+    if (K == 0 || block_size == 0) return 0.0f;
+    double bits = 0.0;
+    switch (format) {
+        case PlanFormat::TERNARY_1_28:
+        case PlanFormat::QUATERNARY_1_58: {
+            size_t blocks = (K + block_size - 1) / block_size;
+            size_t row_bytes = (format == PlanFormat::TERNARY_1_28)
+                ? AfricaQuant::get_ternary_buffer_size(K, block_size, packing)
+                : (K * 2 + 7) / 8;
+            // Packed row + fp16 scale and outlier slots per block
+            bits = 8.0 * (row_bytes + blocks * (sizeof(uint16_t) + outliers_per_block * sizeof(OutlierEntry)));
+            break;
+        }
+        case PlanFormat::Q4_0:
+            bits = 8.0 * ((K + Q4_0_BLOCK - 1) / Q4_0_BLOCK) * (sizeof(uint16_t) + Q4_0_BLOCK / 2);
+            break;
+        case PlanFormat::F16:
+        default:
+            bits = 16.0 * K;
+            break;
+    }
+    return static_cast<float>(bits / K);
+}
+
+// ========== QuantizationPlan ==========
+
+QuantizationPlan::QuantizationPlan()
+    : metric_(ErrorMetric::RELATIVE_MSE)
+    , max_error_(0.0f)
+{}
+
+void QuantizationPlan::set_budget(ErrorMetric metric, float max_error) {
+    metric_ = metric;
+    max_error_ = max_error;
+}
+
+void QuantizationPlan::add(const TensorPlan& tensor) {
+    tensors_.push_back(tensor);
+}
+
+void QuantizationPlan::clear() {
+    tensors_.clear();
+}
+
+const TensorPlan* QuantizationPlan::find(const std::string& name) const {
+    for (const TensorPlan& tensor : tensors_) {
+        if (tensor.name == name) {
+            return &tensor;
+        }
+    }
+    return nullptr;
+}
+
+double QuantizationPlan::average_bits_per_weight() const {
+    double weights = 0.0, bits = 0.0;
+    for (const TensorPlan& tensor : tensors_) {
+        double n = static_cast<double>(tensor.rows) * tensor.cols;
+        weights += n;
+        bits += n * tensor.bits_per_weight;
+    }
+    return weights > 0.0 ? bits / weights : 0.0;
+}
+
+uint64_t QuantizationPlan::total_bytes() const {
+    double bits = 0.0;
+    for (const TensorPlan& tensor : tensors_) {
+        bits += static_cast<double>(tensor.rows) * tensor.cols * tensor.bits_per_weight;
+    }
+    return static_cast<uint64_t>(std::ceil(bits / 8.0));
+}
+
+QuantizationError QuantizationPlan::save(const std::string& path) const {
+    FILE* file = fopen(path.c_str(), "w");
+    if (!file) {
+        return QuantizationError::ERROR_FILE_IO;
+    }
+
+    fprintf(file, "# kipepeo-quant-plan %d %s %g\n", PLAN_FILE_VERSION, metric_name(metric_), max_error_);
+    fprintf(file, "# name rows cols format block_size packing outliers error bits\n");
+    for (const TensorPlan& t : tensors_) {
+        fprintf(file, "%s %zu %zu %s %u %s %u %.6g %.4f\n",
+                t.name.c_str(), t.rows, t.cols, get_plan_format_name(t.format), t.block_size,
+                packing_name(t.packing), t.outliers_per_block, t.error, t.bits_per_weight);
+    }
+
+    bool ok = !ferror(file);
+    ok = (fclose(file) == 0) && ok;
+    return ok ? QuantizationError::SUCCESS : QuantizationError::ERROR_FILE_IO;
+}
+
+QuantizationError QuantizationPlan::load(const std::string& path) {
+    FILE* file = fopen(path.c_str(), "r");
+    if (!file) {
+        return QuantizationError::ERROR_FILE_IO;
+    }
+
+    QuantizationPlan plan;
+    QuantizationError err = QuantizationError::SUCCESS;
+    char line[512];
+    bool have_header = false;
+    while (err == QuantizationError::SUCCESS && fgets(line, sizeof(line), file)) {
+        int version = 0;
+        char metric[16];
+        float max_error = 0.0f;
+        if (!have_header) {
+            if (sscanf(line, "# kipepeo-quant-plan %d %15s %f", &version, metric, &max_error) != 3 ||
+                version != PLAN_FILE_VERSION) {
+                err = QuantizationError::ERROR_INVALID_FILE_FORMAT;
+                break;
+            }
+            plan.set_budget(strcmp(metric, "cosine") == 0 ? ErrorMetric::COSINE : ErrorMetric::RELATIVE_MSE,
+                            max_error);
+            have_header = true;
+            continue;
+        }
+        if (line[0] == '#' || line[0] == '\n') {
+            continue;
+        }
+
+        char name[256], format[16], packing[16];
+        TensorPlan t;
+        if (sscanf(line, "%255s %zu %zu %15s %u %15s %u %f %f", name, &t.rows, &t.cols, format,
+                   &t.block_size, packing, &t.outliers_per_block, &t.error, &t.bits_per_weight) != 9 ||
+            !parse_format(format, t.format) || t.rows == 0 || t.cols == 0 ||
+            t.block_size == 0 || (t.block_size & (t.block_size - 1)) != 0 ||
+            plan.find(name) != nullptr) {
+            err = QuantizationError::ERROR_INVALID_FILE_FORMAT;
+            break;
+        }
+        t.name = name;
+        t.packing = strcmp(packing, "base3") == 0 ? TernaryPacking::BASE3 : TernaryPacking::TWO_BIT;
+        t.meets_budget = t.format != PlanFormat::F16 && t.error <= plan.max_error();
+        plan.add(t);
+    }
+    if (err == QuantizationError::SUCCESS && (ferror(file) || !have_header)) {
+        err = have_header ? QuantizationError::ERROR_FILE_IO : QuantizationError::ERROR_INVALID_FILE_FORMAT;
+    }
+    fclose(file);
+
+    if (err == QuantizationError::SUCCESS) {
+        *this = std::move(plan);
+    }
+    return err;
+}
+
+// ========== BitWidthPlanner ==========
+
+class BitWidthPlanner::Impl {
+public:
+    explicit Impl(const CalibrationConfig& config) : config_(config) {
+        config_.quant.progress_callback = nullptr;
+        plan_.set_budget(config.metric, config.max_error);
+    }
+
+    QuantizationError measure(const float* sample, size_t rows, size_t K, uint32_t block_size,
+                              ReconstructionError errors[PLAN_FORMAT_COUNT]);
+
+    CalibrationConfig config_;
+    AfricaQuant quant_;
+    QuantizationPlan plan_;
+};
+
+QuantizationError BitWidthPlanner::Impl::measure(
+    const float* sample, size_t rows, size_t K, uint32_t block_size,
+    ReconstructionError errors[PLAN_FORMAT_COUNT]) {
+    size_t count = rows * K;
+    size_t blocks_per_row = (K + block_size - 1) / block_size;
+    uint32_t per_block = config_.quant.max_outliers_per_block;
+    TernaryPacking packing = config_.quant.ternary_packing;
+    size_t row_bytes = std::max(AfricaQuant::get_ternary_buffer_size(K, block_size, packing),
+                                (K * 2 + 7) / 8);
+
+    std::vector<uint8_t> packed(rows * row_bytes);
+    std::vector<QuantizationMeta> metadata(rows * blocks_per_row);
+    std::vector<OutlierEntry> outliers(rows * blocks_per_row * per_block);
+    std::vector<float> rebuilt(count);
+    OutlierEntry* slots = per_block > 0 ? outliers.data() : nullptr;
+
+    // AfricaQuant formats: encode the sample and decode it row by row
+    for (int f = 0; f < 2; ++f) {
+        bool ternary = f == 0;
+        size_t stride = ternary ? AfricaQuant::get_ternary_buffer_size(K, block_size, packing) : (K * 2 + 7) / 8;
+        QuantizationError err = ternary
+            ? quant_.quantize_matrix_1_28bit(sample, rows, K, packed.data(), metadata.data(),
+                                             block_size, &config_.quant, slots)
+            : quant_.quantize_matrix_1_58bit(sample, rows, K, packed.data(), metadata.data(),
+                                             block_size, &config_.quant, slots);
+        for (size_t r = 0; r < rows && err == QuantizationError::SUCCESS; ++r) {
+            const OutlierEntry* row_slots = slots ? slots + r * blocks_per_row * per_block : nullptr;
+            err = ternary
+                ? quant_.dequantize_1_28bit(packed.data() + r * stride, K, rebuilt.data() + r * K,
+                                            metadata.data() + r * blocks_per_row, block_size, packing,
+                                            row_slots, per_block)
+                : quant_.dequantize_1_58bit(packed.data() + r * stride, K, rebuilt.data() + r * K,
+                                            metadata.data() + r * blocks_per_row, block_size,
+                                            row_slots, per_block);
+        }
+        if (err != QuantizationError::SUCCESS) {
+            return err;
+        }
+        errors[f] = measure_reconstruction_error(sample, rebuilt.data(), count);
+    }
+
+    for (size_t r = 0; r < rows; ++r) {
+        q4_0_round_trip(sample + r * K, K, rebuilt.data() + r * K);
+    }
+    errors[static_cast<size_t>(PlanFormat::Q4_0)] = measure_reconstruction_error(sample, rebuilt.data(), count);
+
+    f16_round_trip(sample, count, rebuilt.data());
+    errors[static_cast<size_t>(PlanFormat::F16)] = measure_reconstruction_error(sample, rebuilt.data(), count);
+    return QuantizationError::SUCCESS;
+}
+
+BitWidthPlanner::BitWidthPlanner(const CalibrationConfig& config) : impl_(new Impl(config)) {}
+
+BitWidthPlanner::~BitWidthPlanner() {
+    delete impl_;
+}
+
+QuantizationError BitWidthPlanner::add_tensor(
+    const std::string& name,
+    const void* weights,
+    size_t M,
+    size_t K,
+    SourceFormat source,
+    ReconstructionError* errors
+) {
+    if (!weights) {
+        return QuantizationError::ERROR_NULL_POINTER;
+    }
+    if (M == 0 || K == 0) {
+        return QuantizationError::ERROR_INVALID_COUNT;
+    }
+    if (!valid_name(name) || impl_->plan_.find(name)) {
+        return QuantizationError::ERROR_INVALID_CONFIG;
+    }
+
+    const CalibrationConfig& config = impl_->config_;
+
+    // Same block size resolution as quantize_matrix_*
+    uint32_t block_size = config.block_size ? config.block_size : config.quant.block_size;
+    if (block_size == 0) {
+        block_size = get_optimal_block_size(M * K, config.quant.hardware.available_memory);
+    }
+    if ((block_size & (block_size - 1)) != 0) {
+        return QuantizationError::ERROR_INVALID_BLOCK_SIZE;
+    }
+
+    // Evenly spaced row sample; only those rows are read from the source
+    size_t rows = (config.max_sample_rows == 0) ? M : std::min(M, config.max_sample_rows);
+    size_t element_size = source == SourceFormat::F32 ? sizeof(float) : sizeof(uint16_t);
+    std::vector<float> sample(rows * K);
+    for (size_t i = 0; i < rows; ++i) {
+        size_t row = i * M / rows;
+        convert_source_to_f32(static_cast<const uint8_t*>(weights) + row * K * element_size, K, source,
+                              sample.data() + i * K);
+    }
+
+    ReconstructionError measured[PLAN_FORMAT_COUNT];
+    QuantizationError err = impl_->measure(sample.data(), rows, K, block_size, measured);
+    if (err != QuantizationError::SUCCESS) {
+        return err;
+    }
+    if (errors) {
+        std::copy(measured, measured + PLAN_FORMAT_COUNT, errors);
+    }
+
+    TensorPlan plan;
+    plan.name = name;
+    plan.rows = M;
+    plan.cols = K;
+    plan.block_size = block_size;
+    plan.packing = config.quant.ternary_packing;
+    plan.outliers_per_block = config.quant.max_outliers_per_block;
+    plan.format = PlanFormat::F16;
+    plan.meets_budget = false;
+
+    // Cheapest candidate within budget; stable sort keeps ternary ahead of
+    // quaternary when both cost the same
+    PlanFormat candidates[PLAN_FORMAT_COUNT - 1] = {
+        PlanFormat::TERNARY_1_28, PlanFormat::QUATERNARY_1_58, PlanFormat::Q4_0
+    };
+    size_t num_candidates = config.allow_q4 ? 3 : 2;
+    std::stable_sort(candidates, candidates + num_candidates, [&](PlanFormat a, PlanFormat b) {
+        return get_plan_bits_per_weight(a, K, block_size, plan.packing, plan.outliers_per_block) <
+               get_plan_bits_per_weight(b, K, block_size, plan.packing, plan.outliers_per_block);
+    });
+    for (size_t i = 0; i < num_candidates; ++i) {
+        if (measured[static_cast<size_t>(candidates[i])].get(config.metric) <= config.max_error) {
+            plan.format = candidates[i];
+            plan.meets_budget = true;
+            break;
+        }
+    }
+
+    plan.error = measured[static_cast<size_t>(plan.format)].get(config.metric);
+    plan.bits_per_weight = get_plan_bits_per_weight(plan.format, K, block_size, plan.packing,
+                                                    plan.outliers_per_block);
+    impl_->plan_.add(plan);
+    return QuantizationError::SUCCESS;
+}
+
+const QuantizationPlan& BitWidthPlanner::plan() const {
+    return impl_->plan_;
+}
+
+} // namespace quantization
+} // namespace kipepeo
@@ -1,13 +1,8 @@
 #include "kipepeo/quantization/hardware_detection.h"
-#include <cstring>
+#include "kipepeo/kernels/cpu_capabilities.h"
 #include <algorithm>
 #include <cmath>
-#include <cstdio>
-
-#ifdef __ANDROID__
-#include <sys/sysinfo.h>
-#include <unistd.h>
-#endif
+#include <mutex>
 
 #ifdef KIPEPEO_NEON_ENABLED
 #include <arm_neon.h>
@@ -16,78 +11,43 @@
 namespace kipepeo {
 namespace quantization {
 
-// Static storage for CPU model
-static char cpu_model_buffer[128] = "Unknown";
+namespace {
 
-HardwareCapabilities detect_hardware_capabilities() {
+// Derived from the kernels' capability registry, so building the default
+// QuantizationConfig or an AfricaQuant never touches the file system
+HardwareCapabilities compute_hardware_capabilities() {
+    const kernels::CpuCapabilities& cpu = kernels::get_cpu_capabilities();
     HardwareCapabilities caps = {};
     
-    // Detect NEON support
-#ifdef KIPEPEO_NEON_ENABLED
-    caps.has_neon = true;
-#else
-    caps.has_neon = false;
-#endif
+    caps.has_neon = cpu.has_neon;
+    caps.has_fp16 = cpu.has_fp16;
     
-    // Detect FP16 support (ARMv8.2+)
-    caps.has_fp16 = false; // Conservative default
-    
-    // Cache sizes - use conservative defaults for low-end devices
-    // These are typical values for MediaTek Helio G99/G100, Unisoc T606
-    caps.l1_cache_size = 32 * 1024;  // 32KB L1 cache (typical)
-    caps.l2_cache_size = 256 * 1024; // 256KB L2 cache (typical)
-    caps.l3_cache_size = 0;          // No L3 cache on low-end devices
+    // Cache sizes of the fastest core from sysfs / sysctl; levels that
+    // cannot be read keep the typical Helio G99/G100, Unisoc T606 values
+    // (32KB L1, 256KB L2, no L3). The FP32 GEMM derives its blocking from
+    // the same numbers (kernels::neon::compute_gemm_blocking).
+    caps.l1_cache_size = cpu.caches.l1_data;
+    caps.l2_cache_size = cpu.caches.l2;
+    caps.l3_cache_size = cpu.caches.l3;
     
     // Memory detection
 #ifdef __ANDROID__
-    struct sysinfo info;
-    if (sysinfo(&info) == 0) {
-        caps.total_memory = info.totalram * info.mem_unit;
-        caps.available_memory = info.freeram * info.mem_unit;
+    if (cpu.total_memory != 0) {
+        caps.total_memory = cpu.total_memory;
+        caps.available_memory = cpu.available_memory;
     } else {
         // Fallback: assume 2GB total, 512MB available
         caps.total_memory = 2ULL * 1024 * 1024 * 1024;
         caps.available_memory = 512ULL * 1024 * 1024;
     }
-    
-    // CPU cores
-    caps.cpu_cores = sysconf(_SC_NPROCESSORS_ONLN);
-    if (caps.cpu_cores <= 0) {
-        caps.cpu_cores = 4; // Conservative default
-    }
 #else
     // Desktop/development defaults
     caps.total_memory = 8ULL * 1024 * 1024 * 1024;
     caps.available_memory = 4ULL * 1024 * 1024 * 1024;
-    caps.cpu_cores = 4;
 #endif
     
-    // CPU model detection (simplified - can be enhanced)
-    const char* cpuinfo_path = "/proc/cpuinfo";
-    FILE* f = fopen(cpuinfo_path, "r");
-    if (f) {
-        char line[256];
-        while (fgets(line, sizeof(line), f)) {
-            if (strncmp(line, "Hardware", 8) == 0 || 
-                strncmp(line, "model name", 10) == 0) {
-                // Extract model name
-                char* colon = strchr(line, ':');
-                if (colon) {
-                    colon++;
-                    while (*colon == ' ' || *colon == '\t') colon++;
-                    size_t len = strlen(colon);
-                    while (len > 0 && (colon[len-1] == '\n' || colon[len-1] == '\r')) {
-                        colon[--len] = '\0';
-                    }
-                    strncpy(cpu_model_buffer, colon, sizeof(cpu_model_buffer) - 1);
-                    cpu_model_buffer[sizeof(cpu_model_buffer) - 1] = '\0';
-                    break;
-                }
-            }
-        }
-        fclose(f);
-    }
-    caps.cpu_model = cpu_model_buffer;
+    caps.cpu_cores = cpu.cpu_count;
+    caps.cpu_model = cpu.cpu_model.c_str();
     
     // Determine optimal settings based on hardware
     if (caps.available_memory < 1ULL * 1024 * 1024 * 1024) {
@@ -114,6 +74,17 @@ HardwareCapabilities detect_hardware_capabilities() {
     return caps;
 }
 
+} // anonymous namespace
+
+HardwareCapabilities detect_hardware_capabilities() {
+    static std::once_flag once;
+    static HardwareCapabilities caps;
+    std::call_once(once, [] {
+        caps = compute_hardware_capabilities();
+    });
+    return caps;
+}
+
 uint32_t get_optimal_block_size(size_t model_size, size_t available_memory) {
     // For very large models (>10B parameters), use larger blocks if memory allows
     if (model_size > 10ULL * 1000 * 1000 * 1000) {
@@ -190,7 +161,7 @@ bool is_neon_aligned(const void* ptr) {
 }
 
 const char* get_cpu_model() {
-    return cpu_model_buffer;
+    return kernels::get_cpu_capabilities().cpu_model.c_str();
 }
 
 } // namespace quantization
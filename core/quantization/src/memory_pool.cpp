@@ -0,0 +1,130 @@
+#include "kipepeo/quantization/memory_pool.h"
+#include <algorithm>
+#include <new>
+
+namespace kipepeo {
+namespace quantization {
+
+MemoryPool::MemoryPool(size_t max_cached_bytes)
+    : max_cached_bytes_(max_cached_bytes)
+    , stats_() {
+}
+
+MemoryPool::~MemoryPool() {
+    trim();
+}
+
+size_t MemoryPool::size_class(size_t bytes) {
+    // Minimum class is one cache line worth of alignment blocks
+    const size_t min_class = 256;
+    if (bytes <= min_class) {
+        return min_class;
+    }
+
+    // Four classes per power of two: round up to a multiple of 2^(msb - 2)
+    size_t msb = 0;
+    for (size_t v = bytes - 1; v > 1; v >>= 1) {
+        ++msb;
+    }
+    size_t step = size_t(1) << (msb > 2 ? msb - 2 : 0);
+    return (bytes + step - 1) & ~(step - 1);
+}
+
+void* MemoryPool::system_alloc(size_t bytes) {
+    return ::operator new(bytes, std::align_val_t(ALIGNMENT), std::nothrow);
+}
+
+void MemoryPool::system_free(void* ptr) {
+    ::operator delete(ptr, std::align_val_t(ALIGNMENT));
+}
+
+void* MemoryPool::acquire(size_t bytes) {
+    if (bytes == 0) {
+        return nullptr;
+    }
+
+    size_t cls = size_class(bytes);
+    void* ptr = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats_.acquire_count++;
+
+        auto it = free_lists_.find(cls);
+        if (it != free_lists_.end() && !it->second.empty()) {
+            ptr = it->second.back();
+            it->second.pop_back();
+            stats_.reuse_hits++;
+            stats_.bytes_cached -= cls;
+            stats_.bytes_in_use += cls;
+            stats_.peak_bytes_in_use = std::max(stats_.peak_bytes_in_use, stats_.bytes_in_use);
+            return ptr;
+        }
+    }
+
+    // Miss: allocate outside the lock
+    ptr = system_alloc(cls);
+    if (!ptr) {
+        return nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_.system_allocations++;
+    stats_.bytes_in_use += cls;
+    stats_.peak_bytes_in_use = std::max(stats_.peak_bytes_in_use, stats_.bytes_in_use);
+    stats_.peak_bytes_reserved = std::max(stats_.peak_bytes_reserved,
+                                          stats_.bytes_in_use + stats_.bytes_cached);
+    return ptr;
+}
+
+void MemoryPool::release(void* ptr, size_t bytes) {
+    if (!ptr) {
+        return;
+    }
+
+    size_t cls = size_class(bytes);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats_.bytes_in_use -= cls;
+        if (stats_.bytes_cached + cls <= max_cached_bytes_) {
+            free_lists_[cls].push_back(ptr);
+            stats_.bytes_cached += cls;
+            return;
+        }
+    }
+
+    // Cache is full: give the block back to the system
+    system_free(ptr);
+}
+
+void MemoryPool::trim() {
+    std::unordered_map<size_t, std::vector<void*>> lists;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        lists.swap(free_lists_);
+        stats_.bytes_cached = 0;
+    }
+    for (auto& entry : lists) {
+        for (void* ptr : entry.second) {
+            system_free(ptr);
+        }
+    }
+}
+
+MemoryPoolStats MemoryPool::get_stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+void MemoryPool::reset_stats() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t in_use = stats_.bytes_in_use;
+    size_t cached = stats_.bytes_cached;
+    stats_ = MemoryPoolStats();
+    stats_.bytes_in_use = in_use;
+    stats_.bytes_cached = cached;
+    stats_.peak_bytes_in_use = in_use;
+    stats_.peak_bytes_reserved = in_use + cached;
+}
+
+} // namespace quantization
+} // namespace kipepeo
@@ -0,0 +1,578 @@
+#include "kipepeo/quantization/prepared_matrix.h"
+#include "kipepeo/kernels/neon/quantized_gemm.h"
+#include "kipepeo/kernels/kernel_dispatch.h"
+#include "kipepeo/kernels/thread_pool.h"
+#include "kipepeo/kernels/weight_prefetch.h"
+#include "kipepeo/kernels/fp16.h"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace kipepeo {
+namespace quantization {
+
+PreparedMatrix::PreparedMatrix()
+    : weights_(nullptr)
+    , M_(0)
+    , K_(0)
+    , block_size_(0)
+    , num_blocks_per_row_(0)
+    , row_bytes_(0)
+    , outliers_per_block_(0)
+    , interleaved_rows_(0)
+    , format_(WeightFormat::TERNARY_1_28)
+    , packing_(TernaryPacking::TWO_BIT)
+    , scale_format_(ScaleFormat::F32)
+{}
+
+PreparedMatrix::~PreparedMatrix() = default;
+
+PreparedMatrix::PreparedMatrix(PreparedMatrix&& other) noexcept
+    : PreparedMatrix() {
+    *this = std::move(other);
+}
+
+PreparedMatrix& PreparedMatrix::operator=(PreparedMatrix&& other) noexcept {
+    if (this != &other) {
+        // Moving a std::vector keeps its buffer, so weights_ stays valid
+        weights_ = other.weights_;
+        owned_weights_ = std::move(other.owned_weights_);
+        scales_f32_ = std::move(other.scales_f32_);
+        scales_f16_ = std::move(other.scales_f16_);
+        outliers_ = std::move(other.outliers_);
+        outliers_per_block_ = other.outliers_per_block_;
+        interleaved_rows_ = other.interleaved_rows_;
+        M_ = other.M_;
+        K_ = other.K_;
+        block_size_ = other.block_size_;
+        num_blocks_per_row_ = other.num_blocks_per_row_;
+        row_bytes_ = other.row_bytes_;
+        format_ = other.format_;
+        packing_ = other.packing_;
+        scale_format_ = other.scale_format_;
+        other.reset();
+    }
+    return *this;
+}
+
+void PreparedMatrix::reset() {
+    weights_ = nullptr;
+    owned_weights_.clear();
+    owned_weights_.shrink_to_fit();
+    scales_f32_.clear();
+    scales_f32_.shrink_to_fit();
+    scales_f16_.clear();
+    scales_f16_.shrink_to_fit();
+    outliers_.clear();
+    outliers_.shrink_to_fit();
+    outliers_per_block_ = 0;
+    interleaved_rows_ = 0;
+    M_ = 0;
+    K_ = 0;
+    block_size_ = 0;
+    num_blocks_per_row_ = 0;
+    row_bytes_ = 0;
+}
+
+QuantizationError PreparedMatrix::prepare(
+    const uint8_t* quantized,
+    const QuantizationMeta* metadata,
+    size_t M,
+    size_t K,
+    WeightFormat format,
+    TernaryPacking packing,
+    ScaleFormat scale_format,
+    bool copy_weights,
+    const OutlierEntry* outliers,
+    uint32_t outliers_per_block
+) {
+    // Validate inputs
+    if (!quantized || !metadata) {
+        return QuantizationError::ERROR_NULL_POINTER;
+    }
+    if (M == 0 || K == 0) {
+        return QuantizationError::ERROR_INVALID_COUNT;
+    }
+
+    uint32_t block_size = metadata[0].block_size;
+    if (block_size == 0 || (block_size & (block_size - 1)) != 0) {
+        return QuantizationError::ERROR_INVALID_BLOCK_SIZE;
+    }
+
+    uint32_t expected_codebook = (format == WeightFormat::TERNARY_1_28) ? 3 : 4;
+    size_t num_blocks_per_row = (K + block_size - 1) / block_size;
+    size_t num_scales = M * num_blocks_per_row;
+
+    // Validate every metadata entry once, here, instead of on every matvec
+    std::vector<float> scales_f32;
+    std::vector<uint16_t> scales_f16;
+    if (scale_format == ScaleFormat::F16) {
+        scales_f16.resize(num_scales);
+    } else {
+        scales_f32.resize(num_scales);
+    }
+
+    for (size_t i = 0; i < num_scales; ++i) {
+        const QuantizationMeta& meta = metadata[i];
+        if (meta.block_size != block_size || meta.codebook_size != expected_codebook) {
+            return QuantizationError::ERROR_INVALID_METADATA;
+        }
+        if (meta.scale <= 0.0f || !std::isfinite(meta.scale)) {
+            return QuantizationError::ERROR_INVALID_SCALE;
+        }
+
+        if (scale_format == ScaleFormat::F16) {
+            uint16_t half = kernels::fp32_to_fp16(meta.scale);
+            float rounded = kernels::fp16_to_fp32(half);
+            // Scale must survive the conversion (no overflow, no flush to zero)
+            if (rounded <= 0.0f || !std::isfinite(rounded)) {
+                return QuantizationError::ERROR_INVALID_SCALE;
+            }
+            scales_f16[i] = half;
+        } else {
+            scales_f32[i] = meta.scale;
+        }
+    }
+
+    return adopt(quantized, M, K, block_size, format, packing, scale_format, copy_weights,
+                 outliers, outliers_per_block, scales_f32, scales_f16);
+}
+
+QuantizationError PreparedMatrix::prepare_f16_scales(
+    const uint8_t* quantized,
+    const uint16_t* scales_f16,
+    size_t M,
+    size_t K,
+    uint32_t block_size,
+    WeightFormat format,
+    TernaryPacking packing,
+    bool copy_weights,
+    const OutlierEntry* outliers,
+    uint32_t outliers_per_block
+) {
+    if (!quantized || !scales_f16) {
+        return QuantizationError::ERROR_NULL_POINTER;
+    }
+    if (M == 0 || K == 0) {
+        return QuantizationError::ERROR_INVALID_COUNT;
+    }
+    if (block_size == 0 || (block_size & (block_size - 1)) != 0) {
+        return QuantizationError::ERROR_INVALID_BLOCK_SIZE;
+    }
+
+    size_t num_scales = M * ((K + block_size - 1) / block_size);
+    for (size_t i = 0; i < num_scales; ++i) {
+        float scale = kernels::fp16_to_fp32(scales_f16[i]);
+        if (scale <= 0.0f || !std::isfinite(scale)) {
+            return QuantizationError::ERROR_INVALID_SCALE;
+        }
+    }
+
+    std::vector<float> no_f32;
+    std::vector<uint16_t> scales(scales_f16, scales_f16 + num_scales);
+    return adopt(quantized, M, K, block_size, format, packing, ScaleFormat::F16, copy_weights,
+                 outliers, outliers_per_block, no_f32, scales);
+}
+
+QuantizationError PreparedMatrix::adopt(
+    const uint8_t* quantized,
+    size_t M,
+    size_t K,
+    uint32_t block_size,
+    WeightFormat format,
+    TernaryPacking packing,
+    ScaleFormat scale_format,
+    bool copy_weights,
+    const OutlierEntry* outliers,
+    uint32_t outliers_per_block,
+    std::vector<float>& scales_f32,
+    std::vector<uint16_t>& scales_f16
+) {
+    size_t num_blocks_per_row = (K + block_size - 1) / block_size;
+    size_t num_scales = M * num_blocks_per_row;
+
+    if (!outliers) {
+        outliers_per_block = 0;
+    } else if (outliers_per_block > 0) {
+        QuantizationError err = AfricaQuant::validate_outliers(outliers, M, K, block_size, outliers_per_block);
+        if (err != QuantizationError::SUCCESS) return err;
+    }
+
+    size_t row_bytes = (format == WeightFormat::TERNARY_1_28)
+        ? AfricaQuant::get_ternary_buffer_size(K, block_size, packing)
+        : (K * 2 + 7) / 8; // 2 bits per value
+
+    reset();
+
+    if (copy_weights) {
+        owned_weights_.assign(quantized, quantized + M * row_bytes);
+        weights_ = owned_weights_.data();
+    } else {
+        weights_ = quantized;
+    }
+    scales_f32_ = std::move(scales_f32);
+    scales_f16_ = std::move(scales_f16);
+    if (outliers_per_block > 0) {
+        outliers_.assign(outliers, outliers + num_scales * outliers_per_block);
+    }
+    outliers_per_block_ = outliers_per_block;
+    M_ = M;
+    K_ = K;
+    block_size_ = block_size;
+    num_blocks_per_row_ = num_blocks_per_row;
+    row_bytes_ = row_bytes;
+    format_ = format;
+    packing_ = (format == WeightFormat::TERNARY_1_28) ? packing : TernaryPacking::TWO_BIT;
+    scale_format_ = scale_format;
+
+    return QuantizationError::SUCCESS;
+}
+
+QuantizationError PreparedMatrix::interleave(uint32_t rows_per_group) {
+    if (!weights_) {
+        return QuantizationError::ERROR_INVALID_METADATA;
+    }
+    if (rows_per_group == 0) {
+        rows_per_group = static_cast<uint32_t>(kernels::get_gemv_interleave_rows());
+    }
+    if (rows_per_group != 4 && rows_per_group != 8) {
+        return QuantizationError::ERROR_INVALID_CONFIG;
+    }
+    if (packing_ == TernaryPacking::BASE3 || interleaved_rows_ != 0) {
+        return QuantizationError::ERROR_INVALID_CONFIG;
+    }
+    if (block_size_ < 4) {
+        // Blocks must start on a byte boundary to be moved as whole bytes
+        return QuantizationError::ERROR_UNSUPPORTED_BLOCK_SIZE;
+    }
+
+    std::vector<uint8_t> weights(kernels::neon::interleaved_2bit_size(M_, K_, rows_per_group));
+    kernels::neon::repack_2bit_interleaved(M_, K_, weights_, weights.data(), block_size_, rows_per_group);
+
+    size_t num_scales = (M_ + rows_per_group - 1) / rows_per_group * rows_per_group * num_blocks_per_row_;
+    if (scale_format_ == ScaleFormat::F16) {
+        std::vector<uint16_t> scales(num_scales);
+        kernels::neon::repack_scales_interleaved(M_, num_blocks_per_row_, scales_f16_.data(), scales.data(),
+                                                 rows_per_group);
+        scales_f16_ = std::move(scales);
+    } else {
+        std::vector<float> scales(num_scales);
+        kernels::neon::repack_scales_interleaved(M_, num_blocks_per_row_, scales_f32_.data(), scales.data(),
+                                                 rows_per_group);
+        scales_f32_ = std::move(scales);
+    }
+
+    owned_weights_ = std::move(weights);
+    weights_ = owned_weights_.data();
+    interleaved_rows_ = rows_per_group;
+    return QuantizationError::SUCCESS;
+}
+
+namespace {
+    // Row ranges handed to the kernel pool are multiples of 16: whole
+    // interleaved panels, and Y writes of different threads never share
+    // a cache line
+    constexpr size_t ROW_GRAIN = 16;
+
+    // fp16 outputs are 2 bytes: 32 rows per 64-byte line
+    constexpr size_t F16_ROW_GRAIN = 32;
+} // anonymous namespace
+
+void PreparedMatrix::matvec_rows(const float* X, float* y, size_t begin, size_t end) const {
+    // Every layout here keeps rows (or whole panels) contiguous, so a row
+    // range is the same kernel call on offset pointers
+    size_t M = end - begin;
+    const uint8_t* weights = weights_ + begin * row_bytes_;
+    size_t scale_offset = begin * num_blocks_per_row_;
+    const OutlierEntry* outliers = outliers_per_block_ > 0
+        ? outliers_.data() + scale_offset * outliers_per_block_ : nullptr;
+    const float* scales_f32 = scales_f32_.data() + (scales_f32_.empty() ? 0 : scale_offset);
+    const uint16_t* scales_f16 = scales_f16_.data() + (scales_f16_.empty() ? 0 : scale_offset);
+
+    bool f16 = scale_format_ == ScaleFormat::F16;
+    if (interleaved_rows_ != 0) {
+        if (format_ == WeightFormat::QUATERNARY_1_58) {
+            if (f16) {
+                kernels::neon::gemv_quaternary_1_58bit_interleaved_f16_scales(
+                    M, K_, 1.0f, weights, scales_f16, X, 0.0f, y, block_size_, interleaved_rows_,
+                    outliers, outliers_per_block_);
+            } else {
+                kernels::neon::gemv_quaternary_1_58bit_interleaved(
+                    M, K_, 1.0f, weights, scales_f32, X, 0.0f, y, block_size_, interleaved_rows_,
+                    outliers, outliers_per_block_);
+            }
+        } else {
+            if (f16) {
+                kernels::neon::gemv_ternary_1_28bit_interleaved_f16_scales(
+                    M, K_, 1.0f, weights, scales_f16, X, 0.0f, y, block_size_, interleaved_rows_,
+                    outliers, outliers_per_block_);
+            } else {
+                kernels::neon::gemv_ternary_1_28bit_interleaved(
+                    M, K_, 1.0f, weights, scales_f32, X, 0.0f, y, block_size_, interleaved_rows_,
+                    outliers, outliers_per_block_);
+            }
+        }
+    } else if (format_ == WeightFormat::QUATERNARY_1_58) {
+        if (f16) {
+            kernels::neon::gemv_quaternary_1_58bit_f16_scales(
+                M, K_, 1.0f, weights, scales_f16, X, 0.0f, y, block_size_,
+                outliers, outliers_per_block_);
+        } else {
+            kernels::neon::gemv_quaternary_1_58bit(
+                M, K_, 1.0f, weights, scales_f32, X, 0.0f, y, block_size_,
+                outliers, outliers_per_block_);
+        }
+    } else if (packing_ == TernaryPacking::BASE3) {
+        if (f16) {
+            kernels::neon::gemv_ternary_1_28bit_base3_f16_scales(
+                M, K_, 1.0f, weights, scales_f16, X, 0.0f, y, block_size_,
+                outliers, outliers_per_block_);
+        } else {
+            kernels::neon::gemv_ternary_1_28bit_base3(
+                M, K_, 1.0f, weights, scales_f32, X, 0.0f, y, block_size_,
+                outliers, outliers_per_block_);
+        }
+    } else {
+        if (f16) {
+            kernels::neon::gemv_ternary_1_28bit_f16_scales(
+                M, K_, 1.0f, weights, scales_f16, X, 0.0f, y, block_size_,
+                outliers, outliers_per_block_);
+        } else {
+            kernels::neon::gemv_ternary_1_28bit(
+                M, K_, 1.0f, weights, scales_f32, X, 0.0f, y, block_size_,
+                outliers, outliers_per_block_);
+        }
+    }
+}
+
+void PreparedMatrix::matvec_int8_rows(const int8_t* X_q, const float* X_scales, float* Y,
+                                      size_t begin, size_t end) const {
+    size_t M = end - begin;
+    const uint8_t* weights = weights_ + begin * row_bytes_;
+    size_t scale_offset = begin * num_blocks_per_row_;
+    const OutlierEntry* outliers = outliers_per_block_ > 0
+        ? outliers_.data() + scale_offset * outliers_per_block_ : nullptr;
+    const float* scales_f32 = scales_f32_.data() + (scales_f32_.empty() ? 0 : scale_offset);
+    const uint16_t* scales_f16 = scales_f16_.data() + (scales_f16_.empty() ? 0 : scale_offset);
+    float* y = Y + begin;
+
+    bool f16 = scale_format_ == ScaleFormat::F16;
+    if (format_ == WeightFormat::QUATERNARY_1_58) {
+        if (f16) {
+            kernels::neon::gemv_quaternary_1_58bit_a8_f16_scales(
+                M, K_, 1.0f, weights, scales_f16, X_q, X_scales, 0.0f, y, block_size_,
+                outliers, outliers_per_block_);
+        } else {
+            kernels::neon::gemv_quaternary_1_58bit_a8(
+                M, K_, 1.0f, weights, scales_f32, X_q, X_scales, 0.0f, y, block_size_,
+                outliers, outliers_per_block_);
+        }
+    } else if (packing_ == TernaryPacking::BASE3) {
+        if (f16) {
+            kernels::neon::gemv_ternary_1_28bit_base3_a8_f16_scales(
+                M, K_, 1.0f, weights, scales_f16, X_q, X_scales, 0.0f, y, block_size_,
+                outliers, outliers_per_block_);
+        } else {
+            kernels::neon::gemv_ternary_1_28bit_base3_a8(
+                M, K_, 1.0f, weights, scales_f32, X_q, X_scales, 0.0f, y, block_size_,
+                outliers, outliers_per_block_);
+        }
+    } else {
+        if (f16) {
+            kernels::neon::gemv_ternary_1_28bit_a8_f16_scales(
+                M, K_, 1.0f, weights, scales_f16, X_q, X_scales, 0.0f, y, block_size_,
+                outliers, outliers_per_block_);
+        } else {
+            kernels::neon::gemv_ternary_1_28bit_a8(
+                M, K_, 1.0f, weights, scales_f32, X_q, X_scales, 0.0f, y, block_size_,
+                outliers, outliers_per_block_);
+        }
+    }
+}
+
+void PreparedMatrix::matvec_f16_rows(const uint16_t* X, uint16_t* Y, size_t begin, size_t end) const {
+    size_t M = end - begin;
+    const uint8_t* weights = weights_ + begin * row_bytes_;
+    size_t scale_offset = begin * num_blocks_per_row_;
+    const OutlierEntry* outliers = outliers_per_block_ > 0
+        ? outliers_.data() + scale_offset * outliers_per_block_ : nullptr;
+    const uint16_t* scales_f16 = scales_f16_.data() + scale_offset;
+
+    if (format_ == WeightFormat::QUATERNARY_1_58) {
+        kernels::neon::gemv_quaternary_1_58bit_f16(
+            M, K_, 1.0f, weights, scales_f16, X, 0.0f, Y + begin, block_size_,
+            outliers, outliers_per_block_);
+    } else {
+        kernels::neon::gemv_ternary_1_28bit_f16(
+            M, K_, 1.0f, weights, scales_f16, X, 0.0f, Y + begin, block_size_,
+            outliers, outliers_per_block_);
+    }
+}
+
+QuantizationError PreparedMatrix::matvec(const float* X, float* Y) const {
+    if (!weights_) {
+        return QuantizationError::ERROR_INVALID_METADATA;
+    }
+    if (!X || !Y) {
+        return QuantizationError::ERROR_NULL_POINTER;
+    }
+
+    // Shape and scales were validated in prepare(); dispatch straight to the kernel
+    kernels::WeightPrefetchRange ahead = kernels::take_next_weights();
+    kernels::get_kernel_thread_pool().parallel_for(M_, ROW_GRAIN, K_, [&](size_t begin, size_t end) {
+        kernels::for_rows_prefetching(ahead, M_, begin, end, ROW_GRAIN, [&](size_t b, size_t e) {
+            matvec_rows(X, Y + b, b, e);
+        });
+    });
+    return QuantizationError::SUCCESS;
+}
+
+QuantizationError PreparedMatrix::matvec_int8(const int8_t* X_q, const float* X_scales, float* Y) const {
+    if (!weights_) {
+        return QuantizationError::ERROR_INVALID_METADATA;
+    }
+    if (!X_q || !X_scales || !Y) {
+        return QuantizationError::ERROR_NULL_POINTER;
+    }
+    if (interleaved_rows_ != 0) {
+        return QuantizationError::ERROR_INVALID_CONFIG;
+    }
+
+    kernels::WeightPrefetchRange ahead = kernels::take_next_weights();
+    kernels::get_kernel_thread_pool().parallel_for(M_, ROW_GRAIN, K_, [&](size_t begin, size_t end) {
+        kernels::for_rows_prefetching(ahead, M_, begin, end, ROW_GRAIN, [&](size_t b, size_t e) {
+            matvec_int8_rows(X_q, X_scales, Y, b, e);
+        });
+    });
+    return QuantizationError::SUCCESS;
+}
+
+QuantizationError PreparedMatrix::matvec_f16(const uint16_t* X, uint16_t* Y) const {
+    if (!weights_) {
+        return QuantizationError::ERROR_INVALID_METADATA;
+    }
+    if (!X || !Y) {
+        return QuantizationError::ERROR_NULL_POINTER;
+    }
+    if (scale_format_ != ScaleFormat::F16 || interleaved_rows_ != 0 ||
+        (format_ == WeightFormat::TERNARY_1_28 && packing_ != TernaryPacking::TWO_BIT)) {
+        return QuantizationError::ERROR_INVALID_CONFIG;
+    }
+
+    kernels::ThreadPool& pool = kernels::get_kernel_thread_pool();
+    kernels::WeightPrefetchRange ahead = kernels::take_next_weights();
+    if (kernels::neon::gemv_f16_native_accumulation()) {
+        pool.parallel_for(M_, F16_ROW_GRAIN, K_, [&](size_t begin, size_t end) {
+            kernels::for_rows_prefetching(ahead, M_, begin, end, F16_ROW_GRAIN, [&](size_t b, size_t e) {
+                matvec_f16_rows(X, Y, b, e);
+            });
+        });
+        return QuantizationError::SUCCESS;
+    }
+
+    // No fp16 arithmetic in this build: widen X once instead of once per
+    // row range and run the fp32-activation kernels, a stack tile of Y at
+    // a time
+    const float* x32 = kernels::neon::widen_f16_activations(K_, X);
+    pool.parallel_for(M_, F16_ROW_GRAIN, K_, [&](size_t begin, size_t end) {
+        kernels::for_rows_prefetching(ahead, M_, begin, end, F16_ROW_GRAIN, [&](size_t b, size_t e) {
+            float y32[F16_ROW_GRAIN];
+            for (size_t row = b; row < e; row += F16_ROW_GRAIN) {
+                size_t rows = std::min(F16_ROW_GRAIN, e - row);
+                matvec_rows(x32, y32, row, row + rows);
+                for (size_t i = 0; i < rows; ++i) {
+                    Y[row + i] = kernels::fp32_to_fp16(y32[i]);
+                }
+            }
+        });
+    });
+    return QuantizationError::SUCCESS;
+}
+
+void PreparedMatrix::prefetch_next() const {
+    if (!weights_) {
+        kernels::prefetch_next_weights(nullptr, 0);
+        return;
+    }
+    // Interleaved weights are owned and include the panel padding
+    size_t bytes = owned_weights_.empty() ? M_ * row_bytes_ : owned_weights_.size();
+    kernels::prefetch_next_weights(weights_, bytes);
+}
+
+QuantizationError PreparedMatrix::matmul(const float* X, size_t N, float* Y) const {
+    if (!weights_) {
+        return QuantizationError::ERROR_INVALID_METADATA;
+    }
+    if (!X || !Y) {
+        return QuantizationError::ERROR_NULL_POINTER;
+    }
+    if (N == 0) {
+        return QuantizationError::ERROR_INVALID_COUNT;
+    }
+
+    kernels::ThreadPool& pool = kernels::get_kernel_thread_pool();
+    if (interleaved_rows_ != 0) {
+        // The tiled GEMM expects row-major weights; fall back to one
+        // interleaved GEMV per activation vector
+        pool.parallel_for(N, 1, M_ * K_, [&](size_t begin, size_t end) {
+            for (size_t n = begin; n < end; ++n) {
+                matvec_rows(X + n * K_, Y + n * M_, 0, M_);
+            }
+        });
+        return QuantizationError::SUCCESS;
+    }
+
+    // Y is N x M, so threads take slices of the batch, each with the
+    // register tile of the core it runs on
+    pool.parallel_for(N, kernels::get_quantized_gemm_batch_grain(), M_ * K_, [&](size_t begin, size_t end) {
+        size_t MR, NR;
+        kernels::get_quantized_gemm_tile(MR, NR);
+        matmul_vectors(X + begin * K_, end - begin, Y + begin * M_, MR, NR);
+    });
+    return QuantizationError::SUCCESS;
+}
+
+void PreparedMatrix::matmul_vectors(const float* X, size_t N, float* Y, size_t MR, size_t NR) const {
+    bool f16 = scale_format_ == ScaleFormat::F16;
+    if (format_ == WeightFormat::QUATERNARY_1_58) {
+        if (f16) {
+            kernels::neon::gemm_quaternary_1_58bit_f16_scales(
+                M_, N, K_, 1.0f, weights_, scales_f16_.data(), X, 0.0f, Y, block_size_, MR, NR,
+                outliers(), outliers_per_block_);
+        } else {
+            kernels::neon::gemm_quaternary_1_58bit(
+                M_, N, K_, 1.0f, weights_, scales_f32_.data(), X, 0.0f, Y, block_size_, MR, NR,
+                outliers(), outliers_per_block_);
+        }
+    } else if (packing_ == TernaryPacking::BASE3) {
+        if (f16) {
+            kernels::neon::gemm_ternary_1_28bit_base3_f16_scales(
+                M_, N, K_, 1.0f, weights_, scales_f16_.data(), X, 0.0f, Y, block_size_, MR, NR,
+                outliers(), outliers_per_block_);
+        } else {
+            kernels::neon::gemm_ternary_1_28bit_base3(
+                M_, N, K_, 1.0f, weights_, scales_f32_.data(), X, 0.0f, Y, block_size_, MR, NR,
+                outliers(), outliers_per_block_);
+        }
+    } else {
+        if (f16) {
+            kernels::neon::gemm_ternary_1_28bit_f16_scales(
+                M_, N, K_, 1.0f, weights_, scales_f16_.data(), X, 0.0f, Y, block_size_, MR, NR,
+                outliers(), outliers_per_block_);
+        } else {
+            kernels::neon::gemm_ternary_1_28bit(
+                M_, N, K_, 1.0f, weights_, scales_f32_.data(), X, 0.0f, Y, block_size_, MR, NR,
+                outliers(), outliers_per_block_);
+        }
+    }
+}
+
+size_t PreparedMatrix::memory_usage() const {
+    return owned_weights_.size() +
+           scales_f32_.size() * sizeof(float) +
+           scales_f16_.size() * sizeof(uint16_t) +
+           outliers_.size() * sizeof(OutlierEntry);
+}
+
+} // namespace quantization
+} // namespace kipepeo
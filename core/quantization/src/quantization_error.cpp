@@ -39,6 +39,12 @@ const char* get_error_message(QuantizationError error) {
             return "Invalid quantization configuration";
         case QuantizationError::ERROR_UNSUPPORTED_BLOCK_SIZE:
             return "Unsupported block size";
+        case QuantizationError::ERROR_FILE_IO:
+            return "File I/O error";
+        case QuantizationError::ERROR_INVALID_FILE_FORMAT:
+            return "Invalid or corrupt tensor file";
+        case QuantizationError::ERROR_TENSOR_NOT_FOUND:
+            return "Tensor not found";
         case QuantizationError::ERROR_UNKNOWN:
         default:
             return "Unknown error";
@@ -0,0 +1,443 @@
+#include "kipepeo/quantization/streaming_quantizer.h"
+#include "kipepeo/quantization/calibration.h"
+#include "kipepeo/quantization/tensor_file.h"
+#include "kipepeo/kernels/fp16.h"
+#include <algorithm>
+#include <cstring>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace kipepeo {
+namespace quantization {
+
+namespace {
+
+// Default chunk: about 4M values (16 MB of fp32 staging)
+constexpr size_t DEFAULT_CHUNK_VALUES = size_t(1) << 22;
+
+size_t source_element_size(SourceFormat source) {
+    return source == SourceFormat::F32 ? 4 : 2;
+}
+
+} // anonymous namespace
+
+void convert_source_to_f32(const void* values, size_t count, SourceFormat source, float* out) {
+    switch (source) {
+        case SourceFormat::F32:
+            memcpy(out, values, count * sizeof(float));
+            break;
+        case SourceFormat::F16: {
+            const uint16_t* in = static_cast<const uint16_t*>(values);
+            for (size_t i = 0; i < count; ++i) {
+                out[i] = kernels::fp16_to_fp32(in[i]);
+            }
+            break;
+        }
+        case SourceFormat::BF16: {
+            // bfloat16 is the upper half of an fp32
+            const uint16_t* in = static_cast<const uint16_t*>(values);
+            for (size_t i = 0; i < count; ++i) {
+                uint32_t bits = static_cast<uint32_t>(in[i]) << 16;
+                memcpy(&out[i], &bits, sizeof(float));
+            }
+            break;
+        }
+    }
+}
+
+// ========== Implementation Class ==========
+
+class StreamingQuantizer::Impl {
+public:
+    Impl() { reset(); }
+
+    void reset() {
+        M_ = K_ = 0;
+        block_size_ = 0;
+        chunk_rows_ = 0;
+        row_bytes_ = 0;
+        blocks_per_row_ = 0;
+        outliers_per_block_ = 0;
+        rows_done_ = 0;
+        staged_ = 0;
+        threshold_resolved_ = false;
+        release();
+    }
+
+    // Drop the per-tensor state and buffers; the shape stays queryable
+    void release() {
+        active_ = false;
+        sink_ = nullptr;
+        writer_ = nullptr;
+        progress_ = nullptr;
+        staging_.clear();
+        staging_.shrink_to_fit();
+        packed_.clear();
+        packed_.shrink_to_fit();
+        metadata_.clear();
+        metadata_.shrink_to_fit();
+        outliers_.clear();
+        outliers_.shrink_to_fit();
+    }
+
+    QuantizationError begin(size_t M, size_t K, WeightFormat format, uint32_t block_size,
+                            const QuantizationConfig* config, size_t chunk_rows);
+    QuantizationError push(const void* values, size_t count, SourceFormat source);
+    QuantizationError push_file(const std::string& path, uint64_t offset, SourceFormat source);
+    QuantizationError finish();
+
+    // Quantize the staged rows and hand them on
+    QuantizationError flush();
+
+    // Abandon the tensor after an error
+    QuantizationError fail(QuantizationError err) {
+        reset();
+        return err;
+    }
+
+    AfricaQuant quant_;
+    QuantizationConfig config_;         // Threshold pinned, progress cleared
+    ProgressCallback progress_;
+    ChunkSink sink_;
+    TensorFileWriter* writer_;
+
+    bool active_;
+    WeightFormat format_;
+    size_t M_;
+    size_t K_;
+    uint32_t block_size_;
+    size_t chunk_rows_;
+    size_t row_bytes_;
+    size_t blocks_per_row_;
+    uint32_t outliers_per_block_;
+    size_t rows_done_;                  // Rows already handed on
+    size_t staged_;                     // Values in staging_
+    bool threshold_resolved_;
+
+    std::vector<float> staging_;        // chunk_rows * K values
+    std::vector<uint8_t> packed_;
+    std::vector<QuantizationMeta> metadata_;
+    std::vector<OutlierEntry> outliers_;
+};
+
+QuantizationError StreamingQuantizer::Impl::begin(
+    size_t M, size_t K, WeightFormat format, uint32_t block_size,
+    const QuantizationConfig* config, size_t chunk_rows) {
+    if (M == 0 || K == 0) {
+        return QuantizationError::ERROR_INVALID_COUNT;
+    }
+
+    config_ = config ? *config : QuantizationConfig();
+    progress_ = config_.progress_callback;
+    config_.progress_callback = nullptr;  // Reported per chunk instead
+
+    // Same block size resolution as quantize_matrix_*, on the full tensor size
+    if (block_size == 0) {
+        block_size = config_.block_size;
+        if (block_size == 0) {
+            block_size = get_optimal_block_size(M * K, config_.hardware.available_memory);
+        }
+    }
+    if ((block_size & (block_size - 1)) != 0) {
+        return QuantizationError::ERROR_INVALID_BLOCK_SIZE;
+    }
+
+    if (chunk_rows == 0) {
+        chunk_rows = std::max<size_t>(1, DEFAULT_CHUNK_VALUES / K);
+    }
+    chunk_rows = std::min(chunk_rows, M);
+
+    format_ = format;
+    M_ = M;
+    K_ = K;
+    block_size_ = block_size;
+    chunk_rows_ = chunk_rows;
+    blocks_per_row_ = (K + block_size - 1) / block_size;
+    row_bytes_ = (format == WeightFormat::TERNARY_1_28)
+        ? AfricaQuant::get_ternary_buffer_size(K, block_size, config_.ternary_packing)
+        : (K * 2 + 7) / 8; // 2 bits per value
+    outliers_per_block_ = config_.max_outliers_per_block;
+    rows_done_ = 0;
+    staged_ = 0;
+    threshold_resolved_ = format != WeightFormat::TERNARY_1_28;
+
+    staging_.resize(chunk_rows * K);
+    packed_.resize(chunk_rows * row_bytes_);
+    metadata_.resize(chunk_rows * blocks_per_row_);
+    outliers_.resize(chunk_rows * blocks_per_row_ * outliers_per_block_);
+    active_ = true;
+    return QuantizationError::SUCCESS;
+}
+
+QuantizationError StreamingQuantizer::Impl::flush() {
+    size_t rows = staged_ / K_;
+    if (rows == 0) {
+        return QuantizationError::SUCCESS;
+    }
+
+    // One threshold for the whole tensor, sampled from its first chunk
+    if (!threshold_resolved_) {
+        float threshold = config_.threshold_1_28;
+        if (threshold <= 0.0f && config_.use_adaptive_thresholds) {
+            threshold = get_adaptive_threshold_1_28(staging_.data(), staged_, config_.hardware);
+        } else if (threshold <= 0.0f) {
+            threshold = config_.hardware.optimal_threshold_1_28;
+        }
+        config_.threshold_1_28 = threshold;
+        config_.use_adaptive_thresholds = false;
+        threshold_resolved_ = true;
+    }
+
+    OutlierEntry* outliers = outliers_per_block_ > 0 ? outliers_.data() : nullptr;
+    QuantizationError err = (format_ == WeightFormat::TERNARY_1_28)
+        ? quant_.quantize_matrix_1_28bit(staging_.data(), rows, K_, packed_.data(), metadata_.data(),
+                                         block_size_, &config_, outliers)
+        : quant_.quantize_matrix_1_58bit(staging_.data(), rows, K_, packed_.data(), metadata_.data(),
+                                         block_size_, &config_, outliers);
+    if (err != QuantizationError::SUCCESS) {
+        return err;
+    }
+
+    if (writer_) {
+        err = writer_->append_rows(packed_.data(), metadata_.data(), rows, outliers);
+    } else {
+        QuantizedChunk chunk;
+        chunk.first_row = rows_done_;
+        chunk.rows = rows;
+        chunk.quantized = packed_.data();
+        chunk.metadata = metadata_.data();
+        chunk.outliers = outliers;
+        err = sink_(chunk);
+    }
+    if (err != QuantizationError::SUCCESS) {
+        return err;
+    }
+
+    rows_done_ += rows;
+    staged_ = 0;
+    if (progress_) {
+        progress_(static_cast<float>(rows_done_) / M_);
+    }
+    return QuantizationError::SUCCESS;
+}
+
+QuantizationError StreamingQuantizer::Impl::push(const void* values, size_t count, SourceFormat source) {
+    if (!active_) {
+        return QuantizationError::ERROR_INVALID_CONFIG;
+    }
+    if (!values) {
+        return QuantizationError::ERROR_NULL_POINTER;
+    }
+    if (count > (M_ - rows_done_) * K_ - staged_) {
+        return fail(QuantizationError::ERROR_BUFFER_OVERFLOW);
+    }
+
+    const uint8_t* in = static_cast<const uint8_t*>(values);
+    size_t element_size = source_element_size(source);
+    while (count > 0) {
+        size_t n = std::min(count, staging_.size() - staged_);
+        convert_source_to_f32(in, n, source, staging_.data() + staged_);
+        staged_ += n;
+        in += n * element_size;
+        count -= n;
+
+        if (staged_ == staging_.size()) {
+            QuantizationError err = flush();
+            if (err != QuantizationError::SUCCESS) {
+                return fail(err);
+            }
+        }
+    }
+    return QuantizationError::SUCCESS;
+}
+
+QuantizationError StreamingQuantizer::Impl::push_file(const std::string& path, uint64_t offset,
+                                                      SourceFormat source) {
+    if (!active_) {
+        return QuantizationError::ERROR_INVALID_CONFIG;
+    }
+
+    size_t element_size = source_element_size(source);
+    size_t remaining = (M_ - rows_done_) * K_ - staged_;
+    uint64_t bytes = static_cast<uint64_t>(remaining) * element_size;
+    if (remaining == 0) {
+        return QuantizationError::SUCCESS;
+    }
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return fail(QuantizationError::ERROR_FILE_IO);
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || offset > static_cast<uint64_t>(st.st_size) ||
+        bytes > static_cast<uint64_t>(st.st_size) - offset) {
+        ::close(fd);
+        return fail(QuantizationError::ERROR_INVALID_FILE_FORMAT);
+    }
+
+    // mmap offsets must be page aligned
+    uint64_t page = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+    uint64_t map_offset = offset & ~(page - 1);
+    size_t map_bytes = static_cast<size_t>(offset - map_offset + bytes);
+    void* mapping = mmap(nullptr, map_bytes, PROT_READ, MAP_PRIVATE, fd, static_cast<off_t>(map_offset));
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        return fail(QuantizationError::ERROR_FILE_IO);
+    }
+    uint8_t* base = static_cast<uint8_t*>(mapping);
+    madvise(base, map_bytes, MADV_SEQUENTIAL);
+
+    // Stream one staging buffer at a time and drop the source pages behind it
+    const uint8_t* src = base + (offset - map_offset);
+    size_t released = 0;
+    QuantizationError err = QuantizationError::SUCCESS;
+    while (remaining > 0 && err == QuantizationError::SUCCESS) {
+        size_t n = std::min(remaining, staging_.size() - staged_);
+        err = push(src, n, source);
+        src += n * element_size;
+        remaining -= n;
+
+        size_t consumed = static_cast<size_t>(src - base) & ~static_cast<size_t>(page - 1);
+        if (consumed > released) {
+            madvise(base + released, consumed - released, MADV_DONTNEED);
+            released = consumed;
+        }
+    }
+    munmap(mapping, map_bytes);
+    return err;
+}
+
+QuantizationError StreamingQuantizer::Impl::finish() {
+    if (!active_) {
+        return QuantizationError::ERROR_INVALID_CONFIG;
+    }
+    if (rows_done_ * K_ + staged_ != M_ * K_) {
+        return fail(QuantizationError::ERROR_INVALID_COUNT);
+    }
+
+    QuantizationError err = flush();
+    if (err == QuantizationError::SUCCESS && writer_) {
+        err = writer_->end_tensor();
+    }
+    if (err != QuantizationError::SUCCESS) {
+        return fail(err);
+    }
+    release();
+    return QuantizationError::SUCCESS;
+}
+
+// ========== Public Interface ==========
+
+StreamingQuantizer::StreamingQuantizer() : impl_(new Impl()) {}
+
+StreamingQuantizer::~StreamingQuantizer() {
+    delete impl_;
+}
+
+QuantizationError StreamingQuantizer::begin(
+    size_t M,
+    size_t K,
+    WeightFormat format,
+    ChunkSink sink,
+    uint32_t block_size,
+    const QuantizationConfig* config,
+    size_t chunk_rows
+) {
+    impl_->reset();
+    if (!sink) {
+        return QuantizationError::ERROR_NULL_POINTER;
+    }
+    QuantizationError err = impl_->begin(M, K, format, block_size, config, chunk_rows);
+    if (err != QuantizationError::SUCCESS) {
+        return impl_->fail(err);
+    }
+    impl_->sink_ = std::move(sink);
+    return QuantizationError::SUCCESS;
+}
+
+QuantizationError StreamingQuantizer::begin(
+    TensorFileWriter& writer,
+    const std::string& name,
+    size_t M,
+    size_t K,
+    WeightFormat format,
+    uint32_t block_size,
+    const QuantizationConfig* config,
+    size_t chunk_rows
+) {
+    impl_->reset();
+    QuantizationError err = impl_->begin(M, K, format, block_size, config, chunk_rows);
+    if (err == QuantizationError::SUCCESS) {
+        err = writer.begin_tensor(name, M, K, format, impl_->block_size_,
+                                  impl_->config_.ternary_packing, impl_->outliers_per_block_);
+    }
+    if (err != QuantizationError::SUCCESS) {
+        return impl_->fail(err);
+    }
+    impl_->writer_ = &writer;
+    return QuantizationError::SUCCESS;
+}
+
+QuantizationError StreamingQuantizer::begin(
+    TensorFileWriter& writer,
+    const TensorPlan& entry,
+    size_t M,
+    size_t K,
+    const QuantizationConfig* config,
+    size_t chunk_rows
+) {
+    impl_->reset();
+    WeightFormat format;
+    switch (entry.format) {
+    case PlanFormat::TERNARY_1_28:
+        format = WeightFormat::TERNARY_1_28;
+        break;
+    case PlanFormat::QUATERNARY_1_58:
+        format = WeightFormat::QUATERNARY_1_58;
+        break;
+    default:
+        return QuantizationError::ERROR_INVALID_CONFIG;
+    }
+    if (M != entry.rows || K != entry.cols) {
+        return QuantizationError::ERROR_INVALID_COUNT;
+    }
+
+    QuantizationConfig planned = config ? *config : QuantizationConfig();
+    planned.ternary_packing = entry.packing;
+    planned.max_outliers_per_block = entry.outliers_per_block;
+    return begin(writer, entry.name, M, K, format, entry.block_size, &planned, chunk_rows);
+}
+
+QuantizationError StreamingQuantizer::push(const void* values, size_t count, SourceFormat source) {
+    return impl_->push(values, count, source);
+}
+
+QuantizationError StreamingQuantizer::push_file(const std::string& path, uint64_t offset, SourceFormat source) {
+    return impl_->push_file(path, offset, source);
+}
+
+QuantizationError StreamingQuantizer::finish() {
+    return impl_->finish();
+}
+
+bool StreamingQuantizer::is_active() const {
+    return impl_->active_;
+}
+
+size_t StreamingQuantizer::rows_done() const {
+    return impl_->rows_done_;
+}
+
+uint32_t StreamingQuantizer::block_size() const {
+    return impl_->block_size_;
+}
+
+size_t StreamingQuantizer::row_bytes() const {
+    return impl_->row_bytes_;
+}
+
+} // namespace quantization
+} // namespace kipepeo
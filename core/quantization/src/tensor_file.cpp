@@ -0,0 +1,557 @@
+#include "kipepeo/quantization/tensor_file.h"
+#include "kipepeo/kernels/fp16.h"
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace kipepeo {
+namespace quantization {
+
+namespace {
+
+size_t packed_row_bytes(size_t K, uint32_t block_size, WeightFormat format, TernaryPacking packing) {
+    return (format == WeightFormat::TERNARY_1_28)
+        ? AfricaQuant::get_ternary_buffer_size(K, block_size, packing)
+        : (K * 2 + 7) / 8; // 2 bits per value
+}
+
+// product = a * b; false when it does not fit in 64 bits
+bool checked_mul(uint64_t a, uint64_t b, uint64_t& product) {
+    return !__builtin_mul_overflow(a, b, &product);
+}
+
+uint64_t align_up(uint64_t offset) {
+    return (offset + TENSOR_FILE_ALIGNMENT - 1) & ~static_cast<uint64_t>(TENSOR_FILE_ALIGNMENT - 1);
+}
+
+} // anonymous namespace
+
+// ========== TensorFileWriter ==========
+
+TensorFileWriter::TensorFileWriter()
+    : file_(nullptr)
+    , position_(0)
+    , streaming_(false)
+    , pending_rows_(0)
+{}
+
+TensorFileWriter::~TensorFileWriter() {
+    abort();
+}
+
+void TensorFileWriter::abort() {
+    if (file_) {
+        fclose(file_);
+        file_ = nullptr;
+    }
+    position_ = 0;
+    records_.clear();
+    streaming_ = false;
+    pending_scales_.clear();
+    pending_outliers_.clear();
+}
+
+QuantizationError TensorFileWriter::open(const std::string& path) {
+    abort();
+    file_ = fopen(path.c_str(), "wb");
+    if (!file_) {
+        return QuantizationError::ERROR_FILE_IO;
+    }
+
+    // Placeholder header without magic; finish() rewrites it
+    TensorFileHeader header;
+    memset(&header, 0, sizeof(header));
+    if (fwrite(&header, sizeof(header), 1, file_) != 1) {
+        abort();
+        return QuantizationError::ERROR_FILE_IO;
+    }
+    position_ = sizeof(header);
+    return QuantizationError::SUCCESS;
+}
+
+QuantizationError TensorFileWriter::write_aligned(const void* data, size_t bytes, uint64_t& offset) {
+    static const uint8_t zeros[TENSOR_FILE_ALIGNMENT] = {};
+    uint64_t aligned = align_up(position_);
+    size_t padding = static_cast<size_t>(aligned - position_);
+    if (padding > 0 && fwrite(zeros, 1, padding, file_) != padding) {
+        return QuantizationError::ERROR_FILE_IO;
+    }
+    if (bytes > 0 && fwrite(data, 1, bytes, file_) != bytes) {
+        return QuantizationError::ERROR_FILE_IO;
+    }
+    offset = aligned;
+    position_ = aligned + bytes;
+    return QuantizationError::SUCCESS;
+}
+
+QuantizationError TensorFileWriter::add_tensor(
+    const std::string& name,
+    const uint8_t* quantized,
+    const QuantizationMeta* metadata,
+    size_t M,
+    size_t K,
+    WeightFormat format,
+    TernaryPacking packing,
+    const OutlierEntry* outliers,
+    uint32_t outliers_per_block
+) {
+    if (!quantized || !metadata) {
+        return QuantizationError::ERROR_NULL_POINTER;
+    }
+    // An empty tensor has no metadata[0] to take the block size from
+    if (M == 0 || K == 0) {
+        return QuantizationError::ERROR_INVALID_COUNT;
+    }
+    if (!outliers) {
+        outliers_per_block = 0;
+    }
+
+    QuantizationError err = begin_tensor(name, M, K, format, metadata[0].block_size, packing,
+                                         outliers_per_block);
+    if (err == QuantizationError::SUCCESS) {
+        err = append_rows(quantized, metadata, M, outliers);
+    }
+    if (err == QuantizationError::SUCCESS) {
+        err = end_tensor();
+    }
+    return err;
+}
+
+QuantizationError TensorFileWriter::begin_tensor(
+    const std::string& name,
+    size_t M,
+    size_t K,
+    WeightFormat format,
+    uint32_t block_size,
+    TernaryPacking packing,
+    uint32_t outliers_per_block
+) {
+    if (!file_) {
+        return QuantizationError::ERROR_FILE_IO;
+    }
+    if (streaming_) {
+        return QuantizationError::ERROR_INVALID_CONFIG;
+    }
+    if (M == 0 || K == 0) {
+        return QuantizationError::ERROR_INVALID_COUNT;
+    }
+    if (name.empty() || name.size() > TENSOR_FILE_MAX_NAME) {
+        return QuantizationError::ERROR_INVALID_CONFIG;
+    }
+    for (const TensorFileRecord& record : records_) {
+        if (name == record.name) {
+            return QuantizationError::ERROR_INVALID_CONFIG;
+        }
+    }
+    if (block_size == 0 || (block_size & (block_size - 1)) != 0) {
+        return QuantizationError::ERROR_INVALID_BLOCK_SIZE;
+    }
+    if (format == WeightFormat::QUATERNARY_1_58) {
+        packing = TernaryPacking::TWO_BIT;
+    }
+
+    TensorFileRecord& record = pending_;
+    memset(&record, 0, sizeof(record));
+    memcpy(record.name, name.data(), name.size());
+    record.rows = M;
+    record.cols = K;
+    record.block_size = block_size;
+    record.outliers_per_block = outliers_per_block;
+    record.format = static_cast<uint8_t>(format);
+    record.packing = static_cast<uint8_t>(packing);
+    record.weights_bytes = M * packed_row_bytes(K, block_size, format, packing);
+
+    // Weights start here and grow with every append_rows()
+    QuantizationError err = write_aligned(nullptr, 0, record.weights_offset);
+    if (err != QuantizationError::SUCCESS) {
+        abort();
+        return err;
+    }
+
+    streaming_ = true;
+    pending_rows_ = 0;
+    pending_scales_.clear();
+    pending_outliers_.clear();
+    return QuantizationError::SUCCESS;
+}
+
+QuantizationError TensorFileWriter::append_rows(
+    const uint8_t* quantized,
+    const QuantizationMeta* metadata,
+    size_t rows,
+    const OutlierEntry* outliers
+) {
+    if (!file_ || !streaming_) {
+        return QuantizationError::ERROR_FILE_IO;
+    }
+    if (!quantized || !metadata) {
+        return QuantizationError::ERROR_NULL_POINTER;
+    }
+    TensorFileRecord& record = pending_;
+    if (rows == 0 || rows > record.rows - pending_rows_) {
+        return QuantizationError::ERROR_INVALID_COUNT;
+    }
+    uint32_t per_block = record.outliers_per_block;
+    if (per_block > 0 && !outliers) {
+        return QuantizationError::ERROR_NULL_POINTER;
+    }
+
+    // Same checks as PreparedMatrix::prepare with fp16 scales
+    WeightFormat format = static_cast<WeightFormat>(record.format);
+    uint32_t block_size = record.block_size;
+    uint32_t expected_codebook = (format == WeightFormat::TERNARY_1_28) ? 3 : 4;
+    size_t num_scales = rows * ((record.cols + block_size - 1) / block_size);
+    size_t first_scale = pending_scales_.size();
+    pending_scales_.resize(first_scale + num_scales);
+    for (size_t i = 0; i < num_scales; ++i) {
+        const QuantizationMeta& meta = metadata[i];
+        uint16_t half = kernels::fp32_to_fp16(meta.scale);
+        float rounded = kernels::fp16_to_fp32(half);
+        QuantizationError err = QuantizationError::SUCCESS;
+        if (meta.block_size != block_size || meta.codebook_size != expected_codebook) {
+            err = QuantizationError::ERROR_INVALID_METADATA;
+        } else if (meta.scale <= 0.0f || rounded <= 0.0f || !std::isfinite(rounded)) {
+            err = QuantizationError::ERROR_INVALID_SCALE;
+        }
+        if (err != QuantizationError::SUCCESS) {
+            pending_scales_.resize(first_scale);
+            return err;
+        }
+        pending_scales_[first_scale + i] = half;
+    }
+
+    if (per_block > 0) {
+        QuantizationError err = AfricaQuant::validate_outliers(outliers, rows, record.cols,
+                                                               block_size, per_block);
+        if (err != QuantizationError::SUCCESS) {
+            pending_scales_.resize(first_scale);
+            return err;
+        }
+        pending_outliers_.insert(pending_outliers_.end(), outliers, outliers + num_scales * per_block);
+    }
+
+    size_t bytes = rows * packed_row_bytes(record.cols, block_size, format,
+                                           static_cast<TernaryPacking>(record.packing));
+    if (fwrite(quantized, 1, bytes, file_) != bytes) {
+        abort();
+        return QuantizationError::ERROR_FILE_IO;
+    }
+    position_ += bytes;
+    pending_rows_ += rows;
+    return QuantizationError::SUCCESS;
+}
+
+QuantizationError TensorFileWriter::end_tensor() {
+    if (!file_ || !streaming_) {
+        return QuantizationError::ERROR_FILE_IO;
+    }
+    TensorFileRecord& record = pending_;
+    if (pending_rows_ != record.rows) {
+        return QuantizationError::ERROR_INVALID_COUNT;
+    }
+
+    record.scales_bytes = pending_scales_.size() * sizeof(uint16_t);
+    record.outliers_bytes = pending_outliers_.size() * sizeof(OutlierEntry);
+    QuantizationError err = write_aligned(pending_scales_.data(), record.scales_bytes,
+                                          record.scales_offset);
+    if (err == QuantizationError::SUCCESS) {
+        err = write_aligned(pending_outliers_.data(), record.outliers_bytes, record.outliers_offset);
+    }
+    if (err != QuantizationError::SUCCESS) {
+        abort();
+        return err;
+    }
+
+    records_.push_back(record);
+    streaming_ = false;
+    pending_scales_.clear();
+    pending_scales_.shrink_to_fit();
+    pending_outliers_.clear();
+    pending_outliers_.shrink_to_fit();
+    return QuantizationError::SUCCESS;
+}
+
+QuantizationError TensorFileWriter::finish() {
+    if (!file_) {
+        return QuantizationError::ERROR_FILE_IO;
+    }
+    if (streaming_) {
+        // A tensor was begun but never completed
+        abort();
+        return QuantizationError::ERROR_INVALID_COUNT;
+    }
+
+    TensorFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, TENSOR_FILE_MAGIC, sizeof(header.magic));
+    header.version = TENSOR_FILE_VERSION;
+    header.tensor_count = static_cast<uint32_t>(records_.size());
+    header.record_size = sizeof(TensorFileRecord);
+
+    QuantizationError err = write_aligned(records_.data(), records_.size() * sizeof(TensorFileRecord),
+                                          header.directory_offset);
+    header.file_size = position_;
+    if (err == QuantizationError::SUCCESS &&
+        (fseek(file_, 0, SEEK_SET) != 0 || fwrite(&header, sizeof(header), 1, file_) != 1)) {
+        err = QuantizationError::ERROR_FILE_IO;
+    }
+    if (fclose(file_) != 0 && err == QuantizationError::SUCCESS) {
+        err = QuantizationError::ERROR_FILE_IO;
+    }
+    file_ = nullptr;
+    position_ = 0;
+    records_.clear();
+    return err;
+}
+
+// ========== MappedTensorFile ==========
+
+class MappedTensorFile::Impl {
+public:
+    struct LazyMatrix {
+        std::once_flag once;
+        PreparedMatrix matrix;
+        QuantizationError status = QuantizationError::SUCCESS;
+    };
+
+    Impl() : mapping_(nullptr), size_(0) {}
+    ~Impl() { close(); }
+
+    QuantizationError open(const std::string& path);
+    void close();
+    const PreparedMatrix* matrix(size_t index, QuantizationError* error);
+    void advise(size_t index, int advice, bool round_outward) const;
+
+    uint8_t* mapping_;
+    size_t size_;
+    std::vector<MappedTensorInfo> tensors_;
+    std::unique_ptr<LazyMatrix[]> matrices_;
+
+private:
+    QuantizationError parse();
+    bool in_bounds(uint64_t offset, uint64_t bytes, bool aligned) const {
+        return offset <= size_ && bytes <= size_ - offset &&
+               (!aligned || offset % TENSOR_FILE_ALIGNMENT == 0);
+    }
+};
+
+QuantizationError MappedTensorFile::Impl::open(const std::string& path) {
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return QuantizationError::ERROR_FILE_IO;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(TensorFileHeader))) {
+        ::close(fd);
+        return QuantizationError::ERROR_INVALID_FILE_FORMAT;
+    }
+
+    // The mapping keeps the file referenced; nothing is read until touched
+    void* mapping = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        return QuantizationError::ERROR_FILE_IO;
+    }
+    mapping_ = static_cast<uint8_t*>(mapping);
+    size_ = static_cast<size_t>(st.st_size);
+
+    QuantizationError err = parse();
+    if (err != QuantizationError::SUCCESS) {
+        close();
+    }
+    return err;
+}
+
+QuantizationError MappedTensorFile::Impl::parse() {
+    TensorFileHeader header;
+    memcpy(&header, mapping_, sizeof(header));
+    if (memcmp(header.magic, TENSOR_FILE_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != TENSOR_FILE_VERSION ||
+        header.record_size != sizeof(TensorFileRecord) ||
+        header.file_size != size_ ||
+        !in_bounds(header.directory_offset,
+                   static_cast<uint64_t>(header.tensor_count) * sizeof(TensorFileRecord), true)) {
+        return QuantizationError::ERROR_INVALID_FILE_FORMAT;
+    }
+
+    const uint8_t* directory = mapping_ + header.directory_offset;
+    tensors_.resize(header.tensor_count);
+    for (size_t i = 0; i < header.tensor_count; ++i) {
+        TensorFileRecord record;
+        memcpy(&record, directory + i * sizeof(record), sizeof(record));
+
+        if (record.name[TENSOR_FILE_MAX_NAME] != '\0' ||
+            record.format > static_cast<uint8_t>(WeightFormat::QUATERNARY_1_58) ||
+            record.packing > static_cast<uint8_t>(TernaryPacking::BASE3) ||
+            record.rows == 0 || record.cols == 0 ||
+            record.block_size == 0 || (record.block_size & (record.block_size - 1)) != 0) {
+            return QuantizationError::ERROR_INVALID_FILE_FORMAT;
+        }
+
+        // Every row takes at least one weight byte and every 5 columns of a
+        // row at least one (base-3 packing), so larger dimensions cannot fit
+        // the file. The cap keeps the row size below from wrapping; the
+        // products are checked, since a wrapped byte count could match a
+        // crafted record and pass the bounds checks.
+        if (record.rows > size_ || record.cols / 5 > size_ ||
+            record.cols > std::numeric_limits<size_t>::max() / 2) {
+            return QuantizationError::ERROR_INVALID_FILE_FORMAT;
+        }
+        WeightFormat format = static_cast<WeightFormat>(record.format);
+        TernaryPacking packing = static_cast<TernaryPacking>(record.packing);
+        uint64_t blocks_per_row = (record.cols + record.block_size - 1) / record.block_size;
+        uint64_t row_bytes = packed_row_bytes(static_cast<size_t>(record.cols), record.block_size, format, packing);
+        uint64_t weights_bytes, num_scales, scales_bytes, outliers_bytes;
+        if (!checked_mul(record.rows, row_bytes, weights_bytes) ||
+            !checked_mul(record.rows, blocks_per_row, num_scales) ||
+            !checked_mul(num_scales, sizeof(uint16_t), scales_bytes) ||
+            !checked_mul(num_scales, static_cast<uint64_t>(record.outliers_per_block) * sizeof(OutlierEntry),
+                         outliers_bytes) ||
+            record.weights_bytes != weights_bytes ||
+            record.scales_bytes != scales_bytes ||
+            record.outliers_bytes != outliers_bytes ||
+            !in_bounds(record.weights_offset, record.weights_bytes, true) ||
+            !in_bounds(record.scales_offset, record.scales_bytes, true) ||
+            !in_bounds(record.outliers_offset, record.outliers_bytes, true)) {
+            return QuantizationError::ERROR_INVALID_FILE_FORMAT;
+        }
+
+        MappedTensorInfo& info = tensors_[i];
+        info.name = record.name;
+        info.format = format;
+        info.packing = packing;
+        info.rows = record.rows;
+        info.cols = record.cols;
+        info.block_size = record.block_size;
+        info.outliers_per_block = record.outliers_per_block;
+        info.weights = mapping_ + record.weights_offset;
+        info.weights_bytes = record.weights_bytes;
+        info.scales_f16 = reinterpret_cast<const uint16_t*>(mapping_ + record.scales_offset);
+        info.outliers = record.outliers_per_block > 0
+            ? reinterpret_cast<const OutlierEntry*>(mapping_ + record.outliers_offset)
+            : nullptr;
+    }
+
+    matrices_.reset(new LazyMatrix[tensors_.size()]);
+    return QuantizationError::SUCCESS;
+}
+
+void MappedTensorFile::Impl::close() {
+    matrices_.reset();
+    tensors_.clear();
+    if (mapping_) {
+        munmap(mapping_, size_);
+    }
+    mapping_ = nullptr;
+    size_ = 0;
+}
+
+const PreparedMatrix* MappedTensorFile::Impl::matrix(size_t index, QuantizationError* error) {
+    if (index >= tensors_.size()) {
+        if (error) *error = QuantizationError::ERROR_TENSOR_NOT_FOUND;
+        return nullptr;
+    }
+
+    LazyMatrix& lazy = matrices_[index];
+    std::call_once(lazy.once, [&]() {
+        const MappedTensorInfo& info = tensors_[index];
+        lazy.status = lazy.matrix.prepare_f16_scales(
+            info.weights, info.scales_f16, info.rows, info.cols, info.block_size,
+            info.format, info.packing, false, info.outliers, info.outliers_per_block);
+    });
+
+    if (error) *error = lazy.status;
+    return lazy.status == QuantizationError::SUCCESS ? &lazy.matrix : nullptr;
+}
+
+void MappedTensorFile::Impl::advise(size_t index, int advice, bool round_outward) const {
+    if (index >= tensors_.size()) {
+        return;
+    }
+    const MappedTensorInfo& info = tensors_[index];
+    uintptr_t page = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+    uintptr_t begin = reinterpret_cast<uintptr_t>(info.weights);
+    uintptr_t end = begin + info.weights_bytes;
+    if (round_outward) {
+        begin &= ~(page - 1);
+        end = (end + page - 1) & ~(page - 1);
+    } else {
+        // Only pages that belong to this tensor alone
+        begin = (begin + page - 1) & ~(page - 1);
+        end &= ~(page - 1);
+    }
+    if (begin < end) {
+        madvise(reinterpret_cast<void*>(begin), end - begin, advice);
+    }
+}
+
+MappedTensorFile::MappedTensorFile() : impl_(new Impl()) {}
+
+MappedTensorFile::~MappedTensorFile() {
+    delete impl_;
+}
+
+QuantizationError MappedTensorFile::open(const std::string& path) {
+    return impl_->open(path);
+}
+
+void MappedTensorFile::close() {
+    impl_->close();
+}
+
+bool MappedTensorFile::is_open() const {
+    return impl_->mapping_ != nullptr;
+}
+
+size_t MappedTensorFile::tensor_count() const {
+    return impl_->tensors_.size();
+}
+
+size_t MappedTensorFile::file_size() const {
+    return impl_->size_;
+}
+
+int MappedTensorFile::find(const std::string& name) const {
+    for (size_t i = 0; i < impl_->tensors_.size(); ++i) {
+        if (impl_->tensors_[i].name == name) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+const MappedTensorInfo* MappedTensorFile::info(size_t index) const {
+    return index < impl_->tensors_.size() ? &impl_->tensors_[index] : nullptr;
+}
+
+const PreparedMatrix* MappedTensorFile::matrix(size_t index, QuantizationError* error) {
+    return impl_->matrix(index, error);
+}
+
+const PreparedMatrix* MappedTensorFile::matrix(const std::string& name, QuantizationError* error) {
+    int index = find(name);
+    if (index < 0) {
+        if (error) *error = QuantizationError::ERROR_TENSOR_NOT_FOUND;
+        return nullptr;
+    }
+    return impl_->matrix(static_cast<size_t>(index), error);
+}
+
+void MappedTensorFile::prefetch(size_t index) const {
+    impl_->advise(index, MADV_WILLNEED, true);
+}
+
+void MappedTensorFile::evict(size_t index) const {
+    impl_->advise(index, MADV_DONTNEED, false);
+}
+
+} // namespace quantization
+} // namespace kipepeo
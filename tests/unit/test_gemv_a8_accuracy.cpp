@@ -0,0 +1,163 @@
+// Int8-activation (W1.58A8) GEMVs against the fp32-activation GEMVs on the
+// same quantized weights: two-bit and base-3 ternary and quaternary, fp32
+// and fp16 scales, with and without outlier slots.
+//
+// - Quantized X: relative L2 error of Y within ACTIVATION_TOLERANCE, the
+//   cost of 8-bit activations
+// - Dequantized X (X_q * X_scales) fed to the fp32 kernel: the two paths
+//   compute the same products and differ only in float rounding order
+//   (integer block sums vs float FMAs), so Y must agree to
+//   ROUNDING_TOLERANCE
+
+#include "kipepeo/kernels/fp16.h"
+#include "kipepeo/kernels/neon/quantized_gemm.h"
+#include "kipepeo/quantization/africa_quant.h"
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using namespace kipepeo;
+using namespace kipepeo::quantization;
+namespace neon = kipepeo::kernels::neon;
+
+namespace {
+
+constexpr size_t M = 256;
+constexpr size_t K = 1000;   // Partial last block
+constexpr uint32_t BLOCK_SIZE = 128;
+constexpr uint32_t OUTLIERS_PER_BLOCK = 2;
+constexpr double ACTIVATION_TOLERANCE = 0.01;
+constexpr double ROUNDING_TOLERANCE = 1e-5;
+
+typedef void (*GemvF32)(size_t, size_t, float, const uint8_t*, const float*, const float*,
+                        float, float*, size_t, const kernels::OutlierEntry*, size_t);
+typedef void (*GemvF16)(size_t, size_t, float, const uint8_t*, const uint16_t*, const float*,
+                        float, float*, size_t, const kernels::OutlierEntry*, size_t);
+typedef void (*GemvA8F32)(size_t, size_t, float, const uint8_t*, const float*, const int8_t*,
+                          const float*, float, float*, size_t, const kernels::OutlierEntry*, size_t);
+typedef void (*GemvA8F16)(size_t, size_t, float, const uint8_t*, const uint16_t*, const int8_t*,
+                          const float*, float, float*, size_t, const kernels::OutlierEntry*, size_t);
+
+struct Format {
+    const char* name;
+    bool quaternary;
+    TernaryPacking packing;
+    GemvF32 gemv;
+    GemvF16 gemv_f16;
+    GemvA8F32 gemv_a8;
+    GemvA8F16 gemv_a8_f16;
+};
+
+const Format FORMATS[] = {
+    {"ternary", false, TernaryPacking::TWO_BIT,
+     neon::gemv_ternary_1_28bit, neon::gemv_ternary_1_28bit_f16_scales,
+     neon::gemv_ternary_1_28bit_a8, neon::gemv_ternary_1_28bit_a8_f16_scales},
+    {"ternary_base3", false, TernaryPacking::BASE3,
+     neon::gemv_ternary_1_28bit_base3, neon::gemv_ternary_1_28bit_base3_f16_scales,
+     neon::gemv_ternary_1_28bit_base3_a8, neon::gemv_ternary_1_28bit_base3_a8_f16_scales},
+    {"quaternary", true, TernaryPacking::TWO_BIT,
+     neon::gemv_quaternary_1_58bit, neon::gemv_quaternary_1_58bit_f16_scales,
+     neon::gemv_quaternary_1_58bit_a8, neon::gemv_quaternary_1_58bit_a8_f16_scales},
+};
+
+double relative_error(const std::vector<float>& y, const std::vector<float>& reference) {
+    double diff = 0.0;
+    double norm = 0.0;
+    for (size_t i = 0; i < y.size(); ++i) {
+        diff += (double(y[i]) - reference[i]) * (double(y[i]) - reference[i]);
+        norm += double(reference[i]) * reference[i];
+    }
+    return std::sqrt(diff / norm);
+}
+
+} // anonymous namespace
+
+int main() {
+    std::mt19937 rng(42);
+    std::normal_distribution<float> gaussian(0.0f, 1.0f);
+    std::vector<float> weights(M * K), X(K);
+    for (float& w : weights) {
+        w = 0.02f * gaussian(rng);
+    }
+    for (float& x : X) {
+        x = gaussian(rng);
+    }
+
+    size_t blocks = (K + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    std::vector<int8_t> X_q(K);
+    std::vector<float> X_scales(blocks), X_deq(K);
+    neon::quantize_activations_int8(K, X.data(), X_q.data(), X_scales.data(), BLOCK_SIZE);
+    for (size_t k = 0; k < K; ++k) {
+        X_deq[k] = X_q[k] * X_scales[k / BLOCK_SIZE];
+    }
+
+    AfricaQuant quant;
+    int failures = 0;
+    for (const Format& format : FORMATS) {
+        for (uint32_t per_block : {0u, OUTLIERS_PER_BLOCK}) {
+            QuantizationConfig config;
+            config.block_size = BLOCK_SIZE;
+            config.ternary_packing = format.packing;
+            config.max_outliers_per_block = per_block;
+            size_t row_bytes = format.quaternary ? (K * 2 + 7) / 8
+                : AfricaQuant::get_ternary_buffer_size(K, BLOCK_SIZE, format.packing);
+            std::vector<uint8_t> packed(M * row_bytes);
+            std::vector<QuantizationMeta> meta(M * blocks);
+            std::vector<kernels::OutlierEntry> outliers(M * blocks * per_block);
+            kernels::OutlierEntry* slots = per_block > 0 ? outliers.data() : nullptr;
+            QuantizationError err = format.quaternary
+                ? quant.quantize_matrix_1_58bit(weights.data(), M, K, packed.data(), meta.data(),
+                                                BLOCK_SIZE, &config, slots)
+                : quant.quantize_matrix_1_28bit(weights.data(), M, K, packed.data(), meta.data(),
+                                                BLOCK_SIZE, &config, slots);
+            if (err != QuantizationError::SUCCESS) {
+                std::fprintf(stderr, "%s: quantization failed\n", format.name);
+                return 1;
+            }
+
+            std::vector<float> scales(M * blocks);
+            std::vector<uint16_t> scales_f16(M * blocks);
+            for (size_t i = 0; i < scales.size(); ++i) {
+                scales[i] = meta[i].scale;
+                scales_f16[i] = kernels::fp32_to_fp16(meta[i].scale);
+            }
+
+            for (bool f16 : {false, true}) {
+                std::vector<float> reference(M), reference_deq(M), y(M);
+                if (f16) {
+                    format.gemv_f16(M, K, 1.0f, packed.data(), scales_f16.data(), X.data(), 0.0f,
+                                    reference.data(), BLOCK_SIZE, slots, per_block);
+                    format.gemv_f16(M, K, 1.0f, packed.data(), scales_f16.data(), X_deq.data(), 0.0f,
+                                    reference_deq.data(), BLOCK_SIZE, slots, per_block);
+                    format.gemv_a8_f16(M, K, 1.0f, packed.data(), scales_f16.data(), X_q.data(),
+                                       X_scales.data(), 0.0f, y.data(), BLOCK_SIZE, slots, per_block);
+                } else {
+                    format.gemv(M, K, 1.0f, packed.data(), scales.data(), X.data(), 0.0f,
+                                reference.data(), BLOCK_SIZE, slots, per_block);
+                    format.gemv(M, K, 1.0f, packed.data(), scales.data(), X_deq.data(), 0.0f,
+                                reference_deq.data(), BLOCK_SIZE, slots, per_block);
+                    format.gemv_a8(M, K, 1.0f, packed.data(), scales.data(), X_q.data(),
+                                   X_scales.data(), 0.0f, y.data(), BLOCK_SIZE, slots, per_block);
+                }
+
+                double activation_error = relative_error(y, reference);
+                double rounding_error = relative_error(y, reference_deq);
+                bool ok = activation_error <= ACTIVATION_TOLERANCE && rounding_error <= ROUNDING_TOLERANCE;
+                std::printf("%-14s scales=%s outliers=%u  vs fp32 X: %.4f%%  vs dequantized X: %.2e  %s\n",
+                            format.name, f16 ? "f16" : "f32", per_block, 100.0 * activation_error,
+                            rounding_error, ok ? "ok" : "FAIL");
+                if (!ok) {
+                    ++failures;
+                }
+            }
+        }
+    }
+
+    if (failures != 0) {
+        std::fprintf(stderr, "FAILED: %d configurations out of tolerance\n", failures);
+        return 1;
+    }
+    std::printf("PASSED\n");
+    return 0;
+}
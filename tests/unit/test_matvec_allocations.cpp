@@ -0,0 +1,140 @@
+// PreparedMatrix GEMVs must not touch the heap once warmed up: decode runs
+// them for every layer of every token. Counts global operator new calls
+// around matvec / matvec_int8 / matvec_f16 and the fp16 dispatch GEMV on
+// 1 and 4 pool threads, with and without a pending layer-ahead prefetch.
+
+#include "kipepeo/kernels/fp16.h"
+#include "kipepeo/kernels/kernel_dispatch.h"
+#include "kipepeo/kernels/neon/quantized_gemm.h"
+#include "kipepeo/kernels/thread_pool.h"
+#include "kipepeo/quantization/prepared_matrix.h"
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <vector>
+
+namespace {
+std::atomic<size_t> g_allocations{0};
+}
+
+// noinline on all three: once GCC 12 inlines the malloc() / free() of the
+// replacements into std::vector, it pairs them with the operator new /
+// delete calls there and reports a false -Wmismatched-new-delete
+__attribute__((noinline)) void* operator new(size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size != 0 ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+__attribute__((noinline)) void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+__attribute__((noinline)) void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+using namespace kipepeo;
+using namespace kipepeo::quantization;
+
+namespace {
+
+constexpr size_t M = 1024;
+constexpr size_t K = 1024;
+constexpr uint32_t BLOCK_SIZE = 128;
+constexpr int CALLS = 16;
+
+template <typename Fn>
+size_t allocations_per_call(Fn&& fn) {
+    // Warm-up sizes thread-local scratch and one-time tables
+    for (int i = 0; i < 4; ++i) {
+        fn();
+    }
+    size_t before = g_allocations.load();
+    for (int i = 0; i < CALLS; ++i) {
+        fn();
+    }
+    return (g_allocations.load() - before + CALLS - 1) / CALLS;
+}
+
+} // anonymous namespace
+
+int main() {
+    std::mt19937 rng(7);
+    size_t blocks = (K + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    std::vector<uint8_t> weights(M * ((K * 2 + 7) / 8));
+    for (uint8_t& b : weights) {
+        b = static_cast<uint8_t>(rng());
+    }
+    std::vector<uint16_t> scales(M * blocks, 0x2266);   // ~0.05
+    std::vector<float> X(K), Y(M);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    for (float& x : X) {
+        x = dist(rng);
+    }
+    std::vector<int8_t> X_q(K);
+    std::vector<float> X_scales(blocks);
+    kernels::neon::quantize_activations_int8(K, X.data(), X_q.data(), X_scales.data(), BLOCK_SIZE);
+    std::vector<uint16_t> X_f16(K), Y_f16(M);
+    for (size_t k = 0; k < K; ++k) {
+        X_f16[k] = kernels::fp32_to_fp16(X[k]);
+    }
+
+    PreparedMatrix matrix, next;
+    if (matrix.prepare_f16_scales(weights.data(), scales.data(), M, K, BLOCK_SIZE,
+                                  WeightFormat::QUATERNARY_1_58) != QuantizationError::SUCCESS ||
+        next.prepare_f16_scales(weights.data(), scales.data(), M, K, BLOCK_SIZE,
+                                WeightFormat::QUATERNARY_1_58, TernaryPacking::TWO_BIT,
+                                false) != QuantizationError::SUCCESS) {
+        std::fprintf(stderr, "prepare failed\n");
+        return 1;
+    }
+
+    int failures = 0;
+    auto check = [&](const char* name, size_t threads, size_t count) {
+        std::printf("%-22s threads=%zu allocations/call=%zu\n", name, threads, count);
+        if (count != 0) {
+            ++failures;
+        }
+    };
+
+    for (size_t threads : {1, 4}) {
+        kernels::set_kernel_num_threads(threads);
+        check("matvec", threads, allocations_per_call([&] {
+            matrix.matvec(X.data(), Y.data());
+        }));
+        check("matvec_int8", threads, allocations_per_call([&] {
+            matrix.matvec_int8(X_q.data(), X_scales.data(), Y.data());
+        }));
+        check("matvec_f16", threads, allocations_per_call([&] {
+            matrix.matvec_f16(X_f16.data(), Y_f16.data());
+        }));
+        check("gemv_f16_dispatch", threads, allocations_per_call([&] {
+            kernels::gemv_quaternary_1_58bit_f16_chip_optimized(
+                M, K, 1.0f, weights.data(), scales.data(), X_f16.data(), 0.0f, Y_f16.data(), BLOCK_SIZE);
+        }));
+        check("matvec+prefetch_next", threads, allocations_per_call([&] {
+            next.prefetch_next();
+            matrix.matvec(X.data(), Y.data());
+        }));
+        check("matvec_int8+prefetch", threads, allocations_per_call([&] {
+            next.prefetch_next();
+            matrix.matvec_int8(X_q.data(), X_scales.data(), Y.data());
+        }));
+        check("matvec_f16+prefetch", threads, allocations_per_call([&] {
+            next.prefetch_next();
+            matrix.matvec_f16(X_f16.data(), Y_f16.data());
+        }));
+    }
+
+    if (failures != 0) {
+        std::fprintf(stderr, "FAILED: %d GEMV variants allocate per call\n", failures);
+        return 1;
+    }
+    std::printf("PASSED\n");
+    return 0;
+}
@@ -0,0 +1,97 @@
+// MappedTensorFile::open must reject records whose dimensions and byte
+// counts only agree after 64-bit wrap-around; such a record passes every
+// range check and the first matvec reads far outside the mapping.
+
+#include "kipepeo/quantization/tensor_file.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace kipepeo::quantization;
+
+namespace {
+
+constexpr size_t M = 4;
+constexpr size_t K = 8;   // one 2-byte quaternary row, one block per row
+
+bool write_valid(const std::string& path) {
+    std::vector<uint8_t> weights(M * 2, 0x1B);
+    std::vector<QuantizationMeta> meta(M, QuantizationMeta{0.5f, 0.0f, K, 4});
+    TensorFileWriter writer;
+    return writer.open(path) == QuantizationError::SUCCESS &&
+           writer.add_tensor("w", weights.data(), meta.data(), M, K,
+                             WeightFormat::QUATERNARY_1_58) == QuantizationError::SUCCESS &&
+           writer.finish() == QuantizationError::SUCCESS;
+}
+
+// Copy of the valid file with its only record edited by patch
+template <typename Patch>
+bool write_patched(const std::string& valid, const std::string& path, Patch&& patch) {
+    std::ifstream in(valid, std::ios::binary);
+    std::vector<char> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    TensorFileHeader header;
+    std::memcpy(&header, bytes.data(), sizeof(header));
+    TensorFileRecord record;
+    std::memcpy(&record, bytes.data() + header.directory_offset, sizeof(record));
+    patch(record);
+    std::memcpy(bytes.data() + header.directory_offset, &record, sizeof(record));
+    std::ofstream out(path, std::ios::binary);
+    out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    return out.good();
+}
+
+} // anonymous namespace
+
+int main() {
+    const std::string valid = "tensor_file_bounds_valid.kqt";
+    const std::string crafted = "tensor_file_bounds_crafted.kqt";
+    int failures = 0;
+
+    MappedTensorFile file;
+    if (!write_valid(valid) || file.open(valid) != QuantizationError::SUCCESS || !file.matrix(0)) {
+        std::fprintf(stderr, "FAILED: valid file does not open\n");
+        return 1;
+    }
+    file.close();
+
+    struct Case {
+        const char* name;
+        void (*patch)(TensorFileRecord&);
+    };
+    const Case cases[] = {
+        // 2^63 rows of 2 bytes: weights and scale byte counts wrap to 0
+        {"rows_wrap", [](TensorFileRecord& r) {
+            r.rows = uint64_t(1) << 63;
+            r.weights_bytes = 0;
+            r.scales_bytes = 0;
+        }},
+        // Columns far beyond what the file could hold
+        {"cols_cap", [](TensorFileRecord& r) {
+            r.cols = uint64_t(1) << 62;
+        }},
+    };
+    for (const Case& c : cases) {
+        if (!write_patched(valid, crafted, c.patch)) {
+            std::fprintf(stderr, "FAILED: cannot write %s\n", crafted.c_str());
+            return 1;
+        }
+        QuantizationError err = file.open(crafted);
+        bool rejected = err == QuantizationError::ERROR_INVALID_FILE_FORMAT;
+        std::printf("%-14s %s\n", c.name, rejected ? "rejected" : "ACCEPTED");
+        if (!rejected) {
+            ++failures;
+        }
+        file.close();
+    }
+
+    std::remove(valid.c_str());
+    std::remove(crafted.c_str());
+    if (failures != 0) {
+        std::fprintf(stderr, "FAILED: %d crafted records accepted\n", failures);
+        return 1;
+    }
+    std::printf("PASSED\n");
+    return 0;
+}
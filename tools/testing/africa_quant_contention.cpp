@@ -0,0 +1,122 @@
+// AfricaQuant contention benchmark
+//
+// 1..N threads call matvec_mul_1_28bit / matvec_mul_1_58bit on one shared
+// AfricaQuant instance and one shared quantized matrix, each with its own
+// X and Y. The compute path takes no lock, so calls/s should grow linearly
+// with the thread count up to the number of cores, until memory bandwidth
+// saturates. Prints calls/s, per-thread calls/s and scaling over one thread.
+//
+// Usage: kipepeo_africa_quant_contention [max_threads] [calls_per_thread]
+
+#include "kipepeo/quantization/africa_quant.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace kipepeo::quantization;
+
+namespace {
+
+// One attention projection of a 1B-class model: large enough to stream
+// from memory, small enough for many calls per second
+constexpr size_t M = 2048;
+constexpr size_t K = 2048;
+constexpr uint32_t BLOCK_SIZE = 128;
+
+struct Matrix {
+    std::vector<uint8_t> packed;
+    std::vector<QuantizationMeta> metadata;
+};
+
+// Wall time of threads x calls_per_thread calls started together
+template <typename Fn>
+double run_ms(size_t threads, int calls_per_thread, Fn&& call) {
+    std::atomic<size_t> ready{0};
+    std::atomic<bool> go{false};
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            std::vector<float> x(K, 0.01f * static_cast<float>(t + 1));
+            std::vector<float> y(M);
+            call(x.data(), y.data());   // Warm-up: sizes the thread's scratch
+            ready.fetch_add(1);
+            while (!go.load(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+            for (int i = 0; i < calls_per_thread; ++i) {
+                call(x.data(), y.data());
+            }
+        });
+    }
+    while (ready.load() != threads) {
+        std::this_thread::yield();
+    }
+    auto start = std::chrono::steady_clock::now();
+    go.store(true, std::memory_order_release);
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+} // anonymous namespace
+
+int main(int argc, char** argv) {
+    size_t max_threads = argc > 1 ? std::strtoul(argv[1], nullptr, 10)
+                                  : std::max(1u, std::thread::hardware_concurrency());
+    int calls_per_thread = argc > 2 ? std::atoi(argv[2]) : 50;
+    if (max_threads == 0 || calls_per_thread <= 0) {
+        std::fprintf(stderr, "usage: %s [max_threads] [calls_per_thread]\n", argv[0]);
+        return 1;
+    }
+
+    std::mt19937 rng(42);
+    std::normal_distribution<float> gaussian(0.0f, 0.02f);
+    std::vector<float> weights(M * K);
+    for (float& w : weights) {
+        w = gaussian(rng);
+    }
+
+    AfricaQuant quant;
+    size_t blocks = M * ((K + BLOCK_SIZE - 1) / BLOCK_SIZE);
+    Matrix ternary, quaternary;
+    ternary.packed.resize(M * AfricaQuant::get_ternary_buffer_size(K, BLOCK_SIZE, TernaryPacking::TWO_BIT));
+    ternary.metadata.resize(blocks);
+    quaternary.packed.resize(M * ((K * 2 + 7) / 8));
+    quaternary.metadata.resize(blocks);
+    if (quant.quantize_matrix_1_28bit(weights.data(), M, K, ternary.packed.data(), ternary.metadata.data(),
+                                      BLOCK_SIZE) != QuantizationError::SUCCESS ||
+        quant.quantize_matrix_1_58bit(weights.data(), M, K, quaternary.packed.data(), quaternary.metadata.data(),
+                                      BLOCK_SIZE) != QuantizationError::SUCCESS) {
+        std::fprintf(stderr, "quantization failed\n");
+        return 1;
+    }
+
+    std::printf("%zux%zu matvec on one shared AfricaQuant, %d calls per thread\n", M, K, calls_per_thread);
+    std::printf("%-10s %7s %12s %16s %8s\n", "format", "threads", "calls/s", "calls/s/thread", "scaling");
+    for (int q = 0; q < 2; ++q) {
+        double single = 0.0;
+        for (size_t threads = 1; threads <= max_threads; ++threads) {
+            double ms = run_ms(threads, calls_per_thread, [&](const float* x, float* y) {
+                if (q) {
+                    quant.matvec_mul_1_58bit(quaternary.packed.data(), quaternary.metadata.data(), x, y, M, K);
+                } else {
+                    quant.matvec_mul_1_28bit(ternary.packed.data(), ternary.metadata.data(), x, y, M, K);
+                }
+            });
+            double rate = static_cast<double>(threads * calls_per_thread) / (ms / 1000.0);
+            if (threads == 1) {
+                single = rate;
+            }
+            std::printf("%-10s %7zu %12.1f %16.1f %7.2fx\n", q ? "1.58-bit" : "1.28-bit",
+                        threads, rate, rate / threads, rate / single);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,105 @@
+// GEMV thread scaling benchmark
+//
+// Times gemv_ternary_1_28bit_chip_optimized and
+// gemv_quaternary_1_58bit_chip_optimized on LLaMA-7B sized layers with the
+// kernel pool set to 1..8 threads and prints time, weight bandwidth and
+// speedup over one thread.
+//
+// Usage: kipepeo_gemv_thread_scaling [max_threads] [iterations]
+
+#include "kipepeo/kernels/chip_detection.h"
+#include "kipepeo/kernels/kernel_dispatch.h"
+#include "kipepeo/kernels/thread_pool.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+using namespace kipepeo::kernels;
+
+namespace {
+
+struct Shape {
+    const char* name;
+    size_t M;
+    size_t K;
+};
+
+// Attention projection and FFN up/down of a 7B model
+const Shape SHAPES[] = {
+    {"attn 4096x4096", 4096, 4096},
+    {"ffn_up 11008x4096", 11008, 4096},
+    {"ffn_down 4096x11008", 4096, 11008},
+};
+
+constexpr size_t BLOCK_SIZE = 128;
+
+template <typename Fn>
+double time_ms(Fn&& fn, int iterations) {
+    fn();  // Warm-up: wakes the pool and faults the buffers in
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        fn();
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count() / iterations;
+}
+
+} // anonymous namespace
+
+int main(int argc, char** argv) {
+    size_t max_threads = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 8;
+    int iterations = argc > 2 ? std::atoi(argv[2]) : 20;
+    if (max_threads == 0 || iterations <= 0) {
+        std::fprintf(stderr, "usage: %s [max_threads] [iterations]\n", argv[0]);
+        return 1;
+    }
+
+    ChipType chip = detect_chip();
+    CoreLayout layout = get_chip_core_layout(chip);
+    std::printf("chip: %s (%zu big + %zu little cores)\n",
+                get_chip_name(chip), layout.big_cores, layout.little_cores);
+    std::printf("%-22s %-10s %7s %10s %9s %8s\n", "shape", "format", "threads", "ms", "GB/s", "speedup");
+
+    std::mt19937 rng(42);
+    for (const Shape& shape : SHAPES) {
+        size_t row_bytes = (shape.K * 2 + 7) / 8;
+        size_t num_blocks = shape.M * ((shape.K + BLOCK_SIZE - 1) / BLOCK_SIZE);
+        std::vector<uint8_t> weights(shape.M * row_bytes);
+        std::vector<float> scales(num_blocks);
+        std::vector<float> x(shape.K);
+        std::vector<float> y(shape.M);
+        std::uniform_int_distribution<int> byte(0, 255);
+        std::uniform_real_distribution<float> value(-1.0f, 1.0f);
+        for (uint8_t& b : weights) b = static_cast<uint8_t>(byte(rng));
+        for (float& s : scales) s = 0.01f + 0.01f * (value(rng) + 1.0f);
+        for (float& v : x) v = value(rng);
+
+        double bytes = static_cast<double>(weights.size() + scales.size() * sizeof(float));
+        for (int quaternary = 0; quaternary < 2; ++quaternary) {
+            double single_ms = 0.0;
+            for (size_t threads = 1; threads <= max_threads; ++threads) {
+                set_kernel_num_threads(threads);
+                double ms = time_ms([&] {
+                    if (quaternary) {
+                        gemv_quaternary_1_58bit_chip_optimized(shape.M, shape.K, 1.0f, weights.data(),
+                            scales.data(), x.data(), 0.0f, y.data(), BLOCK_SIZE);
+                    } else {
+                        gemv_ternary_1_28bit_chip_optimized(shape.M, shape.K, 1.0f, weights.data(),
+                            scales.data(), x.data(), 0.0f, y.data(), BLOCK_SIZE);
+                    }
+                }, iterations);
+                if (threads == 1) {
+                    single_ms = ms;
+                }
+                std::printf("%-22s %-10s %7zu %10.3f %9.2f %7.2fx\n", shape.name,
+                            quaternary ? "1.58-bit" : "1.28-bit", get_kernel_num_threads(),
+                            ms, bytes / (ms * 1e6), single_ms / ms);
+            }
+        }
+    }
+
+    set_kernel_num_threads(0);
+    return 0;
+}
@@ -0,0 +1,421 @@
+// Kernel micro-benchmark suite with memory roofline
+//
+// Measures the sustained read bandwidth of the device, then times the
+// GEMV (2-bit and plain int8), quantized GEMM and FP32 matmul kernels on
+// LLaMA layer shapes, both through the *_chip_optimized dispatch
+// (chip-specific kernel, kernel thread pool) and as the generic neon::
+// kernel on one thread. Every result carries GFLOP/s, weight GB/s, total
+// GB/s and the percentage of the memory roofline (arithmetic intensity x
+// measured bandwidth) reached.
+//
+// The quaternary GEMV is also swept over weight prefetch distances, and
+// run on two layers in turn with and without the layer-ahead hook
+// (weight_prefetch.h), to pick KIPEPEO_PREFETCH_DISTANCE for a device.
+//
+// Results are written as JSON (stdout, or the given file) so releases can
+// be compared; a readable table goes to stderr.
+//
+// Usage: kipepeo_kernel_roofline [iterations] [output.json]
+
+#include "kipepeo/kernels/autotuner.h"
+#include "kipepeo/kernels/chip_detection.h"
+#include "kipepeo/kernels/kernel_dispatch.h"
+#include "kipepeo/kernels/neon/packed_gemm.h"
+#include "kipepeo/kernels/neon/quantized_gemm.h"
+#include "kipepeo/kernels/thread_pool.h"
+#include "kipepeo/kernels/weight_prefetch.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+#ifndef KIPEPEO_VERSION_STRING
+#define KIPEPEO_VERSION_STRING "unknown"
+#endif
+
+using namespace kipepeo::kernels;
+
+namespace {
+
+constexpr int FORMAT_VERSION = 2;
+constexpr size_t BLOCK_SIZE = 128;
+constexpr size_t PREFILL_TOKENS = 32;
+
+// Stream prefetch distances swept on the quaternary GEMV (0 is the
+// regular generic run)
+const size_t PREFETCH_DISTANCES[] = {256, 512, 1024, 2048};
+
+// One linear layer: M output rows, K inputs. The LM head only ever sees
+// the last token, so it has no prefill GEMMs.
+struct Layer {
+    const char* name;
+    size_t M;
+    size_t K;
+    bool prefill;
+};
+
+const Layer LAYERS[] = {
+    // LLaMA-7B (hidden 4096, FFN 11008, vocabulary 32000)
+    {"llama7b.attn_qkvo", 4096, 4096, true},
+    {"llama7b.ffn_gate_up", 11008, 4096, true},
+    {"llama7b.ffn_down", 4096, 11008, true},
+    {"llama7b.lm_head", 32000, 4096, false},
+    // TinyLlama-1.1B (hidden 2048, FFN 5632)
+    {"llama1b.attn_q_o", 2048, 2048, true},
+    {"llama1b.ffn_gate_up", 5632, 2048, true},
+    {"llama1b.ffn_down", 2048, 5632, true},
+};
+
+struct Result {
+    std::string op;
+    std::string kernel;   // "dispatch", "generic", "generic_pf<distance>", "dispatch_ahead"
+    std::string shape;
+    size_t M;
+    size_t N;
+    size_t K;
+    size_t block_size;
+    size_t threads;
+    size_t prefetch_distance;
+    double median_ms;
+    double min_ms;
+    double flops;
+    double weight_bytes;
+    double total_bytes;
+};
+
+// Median and minimum over iterations, after one warm-up run
+void time_runs(const std::function<void()>& fn, int iterations, double& median_ms, double& min_ms) {
+    fn();
+    std::vector<double> ms(iterations);
+    for (int i = 0; i < iterations; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        auto end = std::chrono::steady_clock::now();
+        ms[i] = std::chrono::duration<double, std::milli>(end - start).count();
+    }
+    std::sort(ms.begin(), ms.end());
+    median_ms = ms[ms.size() / 2];
+    min_ms = ms[0];
+}
+
+// Sustained read bandwidth in bytes/s: every pool thread sums its share of
+// a buffer several times the last-level cache
+double measure_read_bandwidth(int iterations) {
+    CacheSizes caches = read_cache_sizes();
+    size_t bytes = std::min<size_t>(std::max<size_t>(caches.l3 * 4, size_t(64) << 20), size_t(512) << 20);
+    std::vector<uint64_t> buffer(bytes / sizeof(uint64_t));
+    for (size_t i = 0; i < buffer.size(); ++i) {
+        buffer[i] = i * 0x9E3779B97F4A7C15ull;
+    }
+
+    // Integer sums vectorize without -ffast-math; sink keeps them live
+    std::atomic<uint64_t> sink{0};
+    constexpr size_t GRAIN = 16384;   // 128 KB per range
+    double median_ms, min_ms;
+    time_runs([&] {
+        get_kernel_thread_pool().parallel_for(buffer.size(), GRAIN, 1, [&](size_t begin, size_t end) {
+            uint64_t s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+            size_t i = begin;
+            for (; i + 4 <= end; i += 4) {
+                s0 += buffer[i];
+                s1 += buffer[i + 1];
+                s2 += buffer[i + 2];
+                s3 += buffer[i + 3];
+            }
+            for (; i < end; ++i) {
+                s0 += buffer[i];
+            }
+            sink.fetch_add(s0 + s1 + s2 + s3, std::memory_order_relaxed);
+        });
+    }, iterations, median_ms, min_ms);
+    return bytes / (min_ms * 1e-3);
+}
+
+struct QuantizedLayer {
+    std::vector<uint8_t> weights;
+    std::vector<float> scales;
+    std::vector<uint8_t> interleaved;
+    std::vector<float> interleaved_scales;
+    size_t rows_per_group;
+
+    double weight_bytes() const {
+        return static_cast<double>(weights.size() + scales.size() * sizeof(float));
+    }
+};
+
+QuantizedLayer make_quantized_layer(const Layer& layer, std::mt19937& rng) {
+    QuantizedLayer q;
+    size_t row_bytes = (layer.K * 2 + 7) / 8;
+    size_t num_blocks_per_row = (layer.K + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    q.weights.resize(layer.M * row_bytes);
+    q.scales.resize(layer.M * num_blocks_per_row);
+    std::uniform_int_distribution<int> byte(0, 255);
+    std::uniform_real_distribution<float> scale(0.01f, 0.03f);
+    for (uint8_t& b : q.weights) b = static_cast<uint8_t>(byte(rng));
+    for (float& s : q.scales) s = scale(rng);
+
+    q.rows_per_group = get_gemv_interleave_rows();
+    size_t padded_rows = (layer.M + q.rows_per_group - 1) / q.rows_per_group * q.rows_per_group;
+    q.interleaved.resize(neon::interleaved_2bit_size(layer.M, layer.K, q.rows_per_group));
+    q.interleaved_scales.resize(padded_rows * num_blocks_per_row);
+    neon::repack_2bit_interleaved(layer.M, layer.K, q.weights.data(), q.interleaved.data(),
+                                  BLOCK_SIZE, q.rows_per_group);
+    neon::repack_scales_interleaved(layer.M, num_blocks_per_row, q.scales.data(),
+                                    q.interleaved_scales.data(), q.rows_per_group);
+    return q;
+}
+
+class Suite {
+public:
+    Suite(int iterations, double bandwidth)
+        : iterations_(iterations), bandwidth_(bandwidth) {}
+
+    void run(const char* op, const char* kernel, const Layer& layer, size_t N, size_t block_size,
+             size_t threads, double weight_bytes, double other_bytes, const std::function<void()>& fn) {
+        Result r;
+        r.op = op;
+        r.kernel = kernel;
+        r.shape = layer.name;
+        r.M = layer.M;
+        r.N = N;
+        r.K = layer.K;
+        r.block_size = block_size;
+        r.threads = threads;
+        r.prefetch_distance = get_weight_prefetch_distance();
+        r.flops = 2.0 * layer.M * N * layer.K;
+        r.weight_bytes = weight_bytes;
+        r.total_bytes = weight_bytes + other_bytes;
+        time_runs(fn, iterations_, r.median_ms, r.min_ms);
+        results_.push_back(r);
+
+        std::fprintf(stderr, "%-25s %-22s %-8s %4zu %9.3f %9.2f %9.2f %7.1f%%\n",
+                     r.op.c_str(), r.shape.c_str(), r.kernel.c_str(), r.N, r.median_ms,
+                     gflops(r), weight_gbps(r), roofline_pct(r));
+    }
+
+    void write_json(std::FILE* out, ChipType chip, const CacheSizes& caches) const {
+        std::fprintf(out, "{\n");
+        std::fprintf(out, "  \"format_version\": %d,\n", FORMAT_VERSION);
+        std::fprintf(out, "  \"kipepeo_version\": \"%s\",\n", KIPEPEO_VERSION_STRING);
+        std::fprintf(out, "  \"device\": {\n");
+        std::fprintf(out, "    \"chip\": \"%s\",\n", get_chip_name(chip));
+        std::fprintf(out, "    \"cpu_signature\": \"%s\",\n", get_cpu_signature().c_str());
+        std::fprintf(out, "    \"threads\": %zu,\n", get_kernel_num_threads());
+        std::fprintf(out, "    \"l1_data_bytes\": %zu,\n", caches.l1_data);
+        std::fprintf(out, "    \"l2_bytes\": %zu,\n", caches.l2);
+        std::fprintf(out, "    \"l3_bytes\": %zu,\n", caches.l3);
+        std::fprintf(out, "    \"read_bandwidth_gbps\": %.3f\n", bandwidth_ * 1e-9);
+        std::fprintf(out, "  },\n");
+        std::fprintf(out, "  \"iterations\": %d,\n", iterations_);
+        std::fprintf(out, "  \"autotuned\": %s,\n", get_kernel_autotuner().enabled() ? "true" : "false");
+        std::fprintf(out, "  \"results\": [\n");
+        for (size_t i = 0; i < results_.size(); ++i) {
+            const Result& r = results_[i];
+            std::fprintf(out,
+                "    {\"op\": \"%s\", \"kernel\": \"%s\", \"shape\": \"%s\", "
+                "\"M\": %zu, \"N\": %zu, \"K\": %zu, \"block_size\": %zu, \"threads\": %zu, "
+                "\"prefetch_distance\": %zu, "
+                "\"median_ms\": %.4f, \"min_ms\": %.4f, \"gflops\": %.3f, \"weight_gbps\": %.3f, "
+                "\"total_gbps\": %.3f, \"arithmetic_intensity\": %.4f, \"roofline_gflops\": %.3f, "
+                "\"roofline_pct\": %.2f}%s\n",
+                r.op.c_str(), r.kernel.c_str(), r.shape.c_str(), r.M, r.N, r.K, r.block_size, r.threads,
+                r.prefetch_distance, r.median_ms, r.min_ms, gflops(r), weight_gbps(r), r.total_bytes / (r.median_ms * 1e6),
+                r.flops / r.total_bytes, roofline_gflops(r), roofline_pct(r),
+                i + 1 < results_.size() ? "," : "");
+        }
+        std::fprintf(out, "  ]\n}\n");
+    }
+
+private:
+    static double gflops(const Result& r) {
+        return r.flops / (r.median_ms * 1e6);
+    }
+
+    static double weight_gbps(const Result& r) {
+        return r.weight_bytes / (r.median_ms * 1e6);
+    }
+
+    // Memory roofline: the FLOP/s reachable if every byte the kernel must
+    // move came from DRAM at the measured bandwidth
+    double roofline_gflops(const Result& r) const {
+        return r.flops / r.total_bytes * bandwidth_ * 1e-9;
+    }
+
+    double roofline_pct(const Result& r) const {
+        return 100.0 * gflops(r) / roofline_gflops(r);
+    }
+
+    int iterations_;
+    double bandwidth_;
+    std::vector<Result> results_;
+};
+
+} // anonymous namespace
+
+int main(int argc, char** argv) {
+    int iterations = argc > 1 ? std::atoi(argv[1]) : 10;
+    if (iterations <= 0) {
+        std::fprintf(stderr, "usage: %s [iterations] [output.json]\n", argv[0]);
+        return 1;
+    }
+    std::FILE* out = stdout;
+    if (argc > 2) {
+        out = std::fopen(argv[2], "w");
+        if (!out) {
+            std::fprintf(stderr, "cannot open %s\n", argv[2]);
+            return 1;
+        }
+    }
+
+    ChipType chip = detect_chip();
+    CacheSizes caches = read_cache_sizes();
+    size_t threads = get_kernel_num_threads();
+    double bandwidth = measure_read_bandwidth(iterations);
+    std::fprintf(stderr, "chip: %s, %zu threads, read bandwidth %.2f GB/s\n",
+                 get_chip_name(chip), threads, bandwidth * 1e-9);
+    std::fprintf(stderr, "%-25s %-22s %-8s %4s %9s %9s %9s %8s\n",
+                 "op", "shape", "kernel", "N", "ms", "GFLOP/s", "weight GB/s", "roofline");
+
+    Suite suite(iterations, bandwidth);
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> value(-1.0f, 1.0f);
+    for (const Layer& layer : LAYERS) {
+        QuantizedLayer q = make_quantized_layer(layer, rng);
+        size_t M = layer.M;
+        size_t K = layer.K;
+        size_t num_x_blocks = (K + BLOCK_SIZE - 1) / BLOCK_SIZE;
+        std::vector<float> x(PREFILL_TOKENS * K);
+        std::vector<float> y(PREFILL_TOKENS * M);
+        std::vector<int8_t> x_q(K);
+        std::vector<float> x_scales(num_x_blocks);
+        for (float& v : x) v = value(rng);
+        neon::quantize_activations_int8(K, x.data(), x_q.data(), x_scales.data(), BLOCK_SIZE);
+
+        double w = q.weight_bytes();
+        double w_interleaved = static_cast<double>(q.interleaved.size() +
+                                                   q.interleaved_scales.size() * sizeof(float));
+        double gemv_io = (K + M) * sizeof(float);
+        double gemv_a8_io = K + num_x_blocks * sizeof(float) + M * sizeof(float);
+        double gemm_io = PREFILL_TOKENS * (K + M) * sizeof(float);
+
+        // Decode: one token through the 2-bit GEMVs
+        suite.run("gemv_ternary", "dispatch", layer, 1, BLOCK_SIZE, threads, w, gemv_io, [&] {
+            gemv_ternary_1_28bit_chip_optimized(M, K, 1.0f, q.weights.data(), q.scales.data(),
+                                                x.data(), 0.0f, y.data(), BLOCK_SIZE);
+        });
+        suite.run("gemv_ternary", "generic", layer, 1, BLOCK_SIZE, 1, w, gemv_io, [&] {
+            neon::gemv_ternary_1_28bit(M, K, 1.0f, q.weights.data(), q.scales.data(),
+                                       x.data(), 0.0f, y.data(), BLOCK_SIZE);
+        });
+        suite.run("gemv_ternary_interleaved", "dispatch", layer, 1, BLOCK_SIZE, threads, w_interleaved, gemv_io, [&] {
+            gemv_ternary_1_28bit_interleaved_chip_optimized(M, K, 1.0f, q.interleaved.data(),
+                                                            q.interleaved_scales.data(), x.data(), 0.0f,
+                                                            y.data(), BLOCK_SIZE, q.rows_per_group);
+        });
+        suite.run("gemv_ternary_interleaved", "generic", layer, 1, BLOCK_SIZE, 1, w_interleaved, gemv_io, [&] {
+            neon::gemv_ternary_1_28bit_interleaved(M, K, 1.0f, q.interleaved.data(),
+                                                   q.interleaved_scales.data(), x.data(), 0.0f,
+                                                   y.data(), BLOCK_SIZE, q.rows_per_group);
+        });
+        suite.run("gemv_quaternary", "dispatch", layer, 1, BLOCK_SIZE, threads, w, gemv_io, [&] {
+            gemv_quaternary_1_58bit_chip_optimized(M, K, 1.0f, q.weights.data(), q.scales.data(),
+                                                   x.data(), 0.0f, y.data(), BLOCK_SIZE);
+        });
+        suite.run("gemv_quaternary", "generic", layer, 1, BLOCK_SIZE, 1, w, gemv_io, [&] {
+            neon::gemv_quaternary_1_58bit(M, K, 1.0f, q.weights.data(), q.scales.data(),
+                                          x.data(), 0.0f, y.data(), BLOCK_SIZE);
+        });
+
+        // Stream prefetch distances, then two layers in turn with each one
+        // warming the other (the flops and bytes of r.M x r.K count twice)
+        size_t default_distance = get_weight_prefetch_distance();
+        for (size_t distance : PREFETCH_DISTANCES) {
+            set_weight_prefetch_distance(distance);
+            std::string kernel = "generic_pf" + std::to_string(distance);
+            suite.run("gemv_quaternary", kernel.c_str(), layer, 1, BLOCK_SIZE, 1, w, gemv_io, [&] {
+                neon::gemv_quaternary_1_58bit(M, K, 1.0f, q.weights.data(), q.scales.data(),
+                                              x.data(), 0.0f, y.data(), BLOCK_SIZE);
+            });
+        }
+        set_weight_prefetch_distance(default_distance);
+
+        std::vector<uint8_t> other(q.weights.rbegin(), q.weights.rend());
+        auto layer_pair = [&](bool ahead) {
+            if (ahead) prefetch_next_weights(other.data(), other.size());
+            gemv_quaternary_1_58bit_chip_optimized(M, K, 1.0f, q.weights.data(), q.scales.data(),
+                                                   x.data(), 0.0f, y.data(), BLOCK_SIZE);
+            if (ahead) prefetch_next_weights(q.weights.data(), q.weights.size());
+            gemv_quaternary_1_58bit_chip_optimized(M, K, 1.0f, other.data(), q.scales.data(),
+                                                   x.data(), 0.0f, y.data(), BLOCK_SIZE);
+        };
+        suite.run("gemv_quaternary_pair", "dispatch", layer, 2, BLOCK_SIZE, threads, 2 * w, 2 * gemv_io, [&] {
+            layer_pair(false);
+        });
+        suite.run("gemv_quaternary_pair", "dispatch_ahead", layer, 2, BLOCK_SIZE, threads, 2 * w, 2 * gemv_io, [&] {
+            layer_pair(true);
+        });
+
+        // Decode with int8 activations (W1.58A8)
+        suite.run("gemv_ternary_a8", "dispatch", layer, 1, BLOCK_SIZE, threads, w, gemv_a8_io, [&] {
+            gemv_ternary_1_28bit_a8_chip_optimized(M, K, 1.0f, q.weights.data(), q.scales.data(),
+                                                   x_q.data(), x_scales.data(), 0.0f, y.data(), BLOCK_SIZE);
+        });
+        suite.run("gemv_ternary_a8", "generic", layer, 1, BLOCK_SIZE, 1, w, gemv_a8_io, [&] {
+            neon::gemv_ternary_1_28bit_a8(M, K, 1.0f, q.weights.data(), q.scales.data(),
+                                          x_q.data(), x_scales.data(), 0.0f, y.data(), BLOCK_SIZE);
+        });
+        suite.run("gemv_quaternary_a8", "dispatch", layer, 1, BLOCK_SIZE, threads, w, gemv_a8_io, [&] {
+            gemv_quaternary_1_58bit_a8_chip_optimized(M, K, 1.0f, q.weights.data(), q.scales.data(),
+                                                      x_q.data(), x_scales.data(), 0.0f, y.data(), BLOCK_SIZE);
+        });
+
+        // Plain int8 weights with per-row scales, on the same integer dot
+        // products, as the 8-bit baseline the 2-bit formats are weighed against
+        std::vector<int8_t> weights_i8(M * K);
+        std::vector<float> row_scales(M);
+        std::uniform_int_distribution<int> code(-127, 127);
+        for (int8_t& v : weights_i8) v = static_cast<int8_t>(code(rng));
+        for (float& s : row_scales) s = 1.0f / 127.0f;
+        double w_i8 = static_cast<double>(weights_i8.size() + row_scales.size() * sizeof(float));
+        suite.run("gemv_int8", "generic", layer, 1, neon::GEMV_INT8_BLOCK, 1, w_i8, gemv_io, [&] {
+            neon::gemv_int8(M, K, 1.0f, weights_i8.data(), row_scales.data(), x.data(), 0.0f, y.data());
+        });
+
+        if (!layer.prefill) {
+            continue;
+        }
+
+        // Prefill: a chunk of tokens through the tiled quantized GEMMs
+        suite.run("gemm_ternary", "dispatch", layer, PREFILL_TOKENS, BLOCK_SIZE, threads, w, gemm_io, [&] {
+            gemm_ternary_1_28bit_chip_optimized(M, PREFILL_TOKENS, K, 1.0f, q.weights.data(), q.scales.data(),
+                                                x.data(), 0.0f, y.data(), BLOCK_SIZE);
+        });
+        suite.run("gemm_quaternary", "dispatch", layer, PREFILL_TOKENS, BLOCK_SIZE, threads, w, gemm_io, [&] {
+            gemm_quaternary_1_58bit_chip_optimized(M, PREFILL_TOKENS, K, 1.0f, q.weights.data(), q.scales.data(),
+                                                   x.data(), 0.0f, y.data(), BLOCK_SIZE);
+        });
+
+        // Unquantized prefill: C (tokens x M) = X (tokens x K) * W (K x M)
+        std::vector<float> weights_f32(K * M);
+        for (float& v : weights_f32) v = value(rng);
+        double w_f32 = static_cast<double>(weights_f32.size() * sizeof(float));
+        suite.run("matmul_f32", "dispatch", layer, PREFILL_TOKENS, 0, threads, w_f32, gemm_io, [&] {
+            matrix_multiply_f32_chip_optimized(x.data(), weights_f32.data(), y.data(), PREFILL_TOKENS, M, K);
+        });
+        suite.run("matmul_f32", "generic", layer, PREFILL_TOKENS, 0, 1, w_f32, gemm_io, [&] {
+            neon::gemm_f32_packed(x.data(), weights_f32.data(), y.data(), PREFILL_TOKENS, M, K);
+        });
+    }
+
+    suite.write_json(out, chip, caches);
+    if (out != stdout) {
+        std::fclose(out);
+    }
+    return 0;
+}
@@ -0,0 +1,128 @@
+// Prompt prefill throughput: GEMV loop vs tiled GEMM
+//
+// Pushes a prompt of N tokens (default 512, llama.cpp's n_batch) through
+// LLaMA-7B and TinyLlama layers twice: once as N calls of the
+// *_chip_optimized GEMV, the way prefill ran before the tiled GEMMs, and
+// once as a single gemm_*_chip_optimized call. Prints time, tokens/s for
+// each, the GEMM speedup and the largest relative difference between the
+// two outputs.
+//
+// Usage: kipepeo_prefill_tokens [tokens] [iterations]
+
+#include "kipepeo/kernels/chip_detection.h"
+#include "kipepeo/kernels/kernel_dispatch.h"
+#include "kipepeo/kernels/thread_pool.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+using namespace kipepeo::kernels;
+
+namespace {
+
+struct Shape {
+    const char* name;
+    size_t M;
+    size_t K;
+};
+
+const Shape SHAPES[] = {
+    {"llm7b attn", 4096, 4096},
+    {"llm7b ffn_up", 11008, 4096},
+    {"llm7b ffn_down", 4096, 11008},
+    {"llm1b attn", 2048, 2048},
+    {"llm1b ffn_up", 5632, 2048},
+    {"llm1b ffn_down", 2048, 5632},
+};
+
+constexpr size_t BLOCK_SIZE = 128;
+
+template <typename Fn>
+double time_ms(Fn&& fn, int iterations) {
+    fn();  // Warm-up: wakes the pool and faults the buffers in
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        fn();
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count() / iterations;
+}
+
+// Largest |a - b| relative to the largest |b|
+float max_relative_diff(const std::vector<float>& a, const std::vector<float>& b) {
+    float diff = 0.0f;
+    float scale = 0.0f;
+    for (size_t i = 0; i < a.size(); ++i) {
+        diff = std::max(diff, std::fabs(a[i] - b[i]));
+        scale = std::max(scale, std::fabs(b[i]));
+    }
+    return scale > 0.0f ? diff / scale : diff;
+}
+
+} // anonymous namespace
+
+int main(int argc, char** argv) {
+    size_t tokens = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 512;
+    int iterations = argc > 2 ? std::atoi(argv[2]) : 3;
+    if (tokens == 0 || iterations <= 0) {
+        std::fprintf(stderr, "usage: %s [tokens] [iterations]\n", argv[0]);
+        return 1;
+    }
+
+    ChipType chip = detect_chip();
+    std::printf("chip: %s, %zu threads, %zu tokens\n",
+                get_chip_name(chip), get_kernel_num_threads(), tokens);
+    std::printf("%-16s %-9s %11s %11s %11s %11s %8s %9s\n", "shape", "format",
+                "gemv ms", "gemv tok/s", "gemm ms", "gemm tok/s", "speedup", "max diff");
+
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> byte(0, 255);
+    std::uniform_real_distribution<float> value(-1.0f, 1.0f);
+    for (const Shape& shape : SHAPES) {
+        size_t M = shape.M;
+        size_t K = shape.K;
+        size_t row_bytes = (K * 2 + 7) / 8;
+        std::vector<uint8_t> weights(M * row_bytes);
+        std::vector<float> scales(M * ((K + BLOCK_SIZE - 1) / BLOCK_SIZE));
+        std::vector<float> x(tokens * K);
+        std::vector<float> y_gemv(tokens * M);
+        std::vector<float> y_gemm(tokens * M);
+        for (uint8_t& b : weights) b = static_cast<uint8_t>(byte(rng));
+        for (float& s : scales) s = 0.01f + 0.01f * (value(rng) + 1.0f);
+        for (float& v : x) v = value(rng);
+
+        for (int quaternary = 0; quaternary < 2; ++quaternary) {
+            // One token at a time: every GEMV streams the whole matrix again
+            double gemv_ms = time_ms([&] {
+                for (size_t n = 0; n < tokens; ++n) {
+                    if (quaternary) {
+                        gemv_quaternary_1_58bit_chip_optimized(M, K, 1.0f, weights.data(), scales.data(),
+                            x.data() + n * K, 0.0f, y_gemv.data() + n * M, BLOCK_SIZE);
+                    } else {
+                        gemv_ternary_1_28bit_chip_optimized(M, K, 1.0f, weights.data(), scales.data(),
+                            x.data() + n * K, 0.0f, y_gemv.data() + n * M, BLOCK_SIZE);
+                    }
+                }
+            }, iterations);
+            double gemm_ms = time_ms([&] {
+                if (quaternary) {
+                    gemm_quaternary_1_58bit_chip_optimized(M, tokens, K, 1.0f, weights.data(), scales.data(),
+                        x.data(), 0.0f, y_gemm.data(), BLOCK_SIZE);
+                } else {
+                    gemm_ternary_1_28bit_chip_optimized(M, tokens, K, 1.0f, weights.data(), scales.data(),
+                        x.data(), 0.0f, y_gemm.data(), BLOCK_SIZE);
+                }
+            }, iterations);
+
+            std::printf("%-16s %-9s %11.2f %11.1f %11.2f %11.1f %7.2fx %9.2e\n", shape.name,
+                        quaternary ? "1.58-bit" : "1.28-bit",
+                        gemv_ms, tokens / (gemv_ms * 1e-3), gemm_ms, tokens / (gemm_ms * 1e-3),
+                        gemv_ms / gemm_ms, max_relative_diff(y_gemm, y_gemv));
+        }
+    }
+    return 0;
+}